@@ -11,6 +11,7 @@ macro(configure_project)
     option(VMTRACE "Enable VM tracing" OFF)
     option(EVM_OPTIMIZE "Enable VM optimizations (can distort tracing)" ON)
     option(FATDB "Enable fat state database" ON)
+    option(ROCKSDB "Build with the RocksDB database backend (select it with --db rocksdb)" OFF)
     option(PARANOID "Enable additional checks when validating transactions (deprecated)" OFF)
     option(MINIUPNPC "Build with UPnP support" OFF)
     option(FASTCTEST "Enable fast ctest" OFF)
@@ -49,6 +50,10 @@ macro(configure_project)
         add_definitions(-DETH_PARANOIA)
     endif ()
 
+    if (ROCKSDB)
+        add_definitions(-DETH_ROCKSDB)
+    endif ()
+
     if (VMTRACE)
         add_definitions(-DETH_VMTRACE)
     endif ()
@@ -86,7 +91,7 @@ macro(print_config)
     message("-- VMTRACE          VM execution tracing                     ${VMTRACE}")
     message("-- EVM_OPTIMIZE     Enable VM optimizations                  ${EVM_OPTIMIZE}")
     message("-- FATDB            Full database exploring                  ${FATDB}")
-    message("-- DB               Database implementation                  LEVELDB")
+    message("-- ROCKSDB          RocksDB database backend                 ${ROCKSDB}")
     message("-- PARANOID         -                                        ${PARANOID}")
     message("-- MINIUPNPC        -                                        ${MINIUPNPC}")
     message("------------------------------------------------------------- components")
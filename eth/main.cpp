@@ -33,11 +33,13 @@
 #include <boost/program_options.hpp>
 #include <boost/program_options/options_description.hpp>
 
+#include <libdevcore/DBFactory.h>
 #include <libdevcore/FileSystem.h>
 #include <libethashseal/EthashAux.h>
 #include <libevm/VM.h>
 #include <libevm/VMFactory.h>
 #include <libethcore/KeyManager.h>
+#include <libethereum/BlockArchive.h>
 #include <libethereum/Defaults.h>
 #include <libethereum/SnapshotImporter.h>
 #include <libethereum/SnapshotStorage.h>
@@ -146,7 +148,8 @@ enum class Format
 {
     Binary,
     Hex,
-    Human
+    Human,
+    Archive
 };
 
 void stopSealingAfterXBlocks(eth::Client* _c, unsigned _start, unsigned& io_mining)
@@ -228,6 +231,7 @@ int main(int argc, char** argv)
     string exportFrom = "1";
     string exportTo = "latest";
     Format exportFormat = Format::Binary;
+    bool exportReceipts = false;
 
     /// General params for Node operation
     NodeMode nodeMode = NodeMode::Full;
@@ -337,6 +341,23 @@ int main(int argc, char** argv)
     addClientOption("kill,K", "Kill the blockchain first.");
     addClientOption("rebuild,R", "Rebuild the blockchain from the existing database.");
     addClientOption("rescue", "Attempt to rescue a corrupt database.\n");
+    addClientOption("prune", po::value<unsigned>()->value_name("<blocks>"),
+        "Delete state no longer used by the last <blocks> blocks (default: keep all state).");
+    addClientOption("prune-checkpoint", po::value<unsigned>()->value_name("<blocks>"),
+        "When pruning, keep the complete state of every <blocks>th block.");
+    addClientOption("commit-queue", po::value<unsigned>()->value_name("<batches>"),
+        "Write state to disk on a background thread with up to <batches> commits waiting "
+        "(default: 0, write synchronously).");
+    addClientOption("commit-sync", po::value<unsigned>()->value_name("<batches>"),
+        "With --commit-queue, sync every <batches>th commit to disk (default: 0, never).");
+    addClientOption("flat-state", "Keep a flat table of the head state for reading accounts and "
+        "storage without walking the state trie.");
+    addClientOption("commit-journal", "Write each imported block's chain and state changes "
+        "through one write-ahead journal, synced once per block, so a crash cannot leave the "
+        "databases inconsistent.");
+    addClientOption("block-segments", po::value<unsigned>()->value_name("<depth>"),
+        "Copy blocks at least <depth> below the head into memory-mapped segment files and serve "
+        "historical block and transaction reads from them (default: 0, disabled).");
     addClientOption("import-presale", po::value<string>()->value_name("<file>"),
         "Import a pre-sale key; you'll need to specify the password to this key.");
     addClientOption("import-secret,s", po::value<string>()->value_name("<secret>"),
@@ -430,7 +451,12 @@ int main(int argc, char** argv)
     addImportExportOption("only", po::value<string>()->value_name("<n>"),
         "Equivalent to --export-from n --export-to n.");
     addImportExportOption(
-        "format", po::value<string>()->value_name("<binary/hex/human>"), "Set export format.");
+        "format", po::value<string>()->value_name("<binary/hex/human/archive>"),
+        "Set export format. 'archive' writes compressed, indexed chunks that --import reads "
+        "ahead and verifies in parallel.");
+    addImportExportOption("export-receipts",
+        "Include block receipts in an archive export. Importing the archive checks them against "
+        "the receipts of each imported block.");
     addImportExportOption("dont-check",
         "Prevent checking some block aspects. Faster importing, but to apply only when the data is "
         "known to be valid.");
@@ -459,6 +485,7 @@ int main(int argc, char** argv)
         .add(clientNetworking)
         .add(importExportMode)
         .add(vmProgramOptions(c_lineWidth))
+        .add(db::databaseProgramOptions(c_lineWidth))
         .add(generalOptions);
 
     po::variables_map vm;
@@ -621,6 +648,18 @@ int main(int argc, char** argv)
         alwaysConfirm = false;
     if (vm.count("db-path"))
         setDataDir(vm["db-path"].as<string>());
+    if (vm.count("prune"))
+        Defaults::setStatePruning(vm["prune"].as<unsigned>(),
+            vm.count("prune-checkpoint") ? vm["prune-checkpoint"].as<unsigned>() : 0);
+    if (vm.count("flat-state"))
+        Defaults::setFlatState(true);
+    if (vm.count("commit-journal"))
+        Defaults::setCommitJournal(true);
+    if (vm.count("block-segments"))
+        Defaults::setBlockSegments(vm["block-segments"].as<unsigned>());
+    if (vm.count("commit-queue"))
+        Defaults::setStateCommitQueue(vm["commit-queue"].as<unsigned>(),
+            vm.count("commit-sync") ? vm["commit-sync"].as<unsigned>() : 0);
     if (vm.count("ipcpath"))
         setIpcPath(vm["ipcpath"].as<string>());
     if (vm.count("genesis"))
@@ -799,12 +838,16 @@ int main(int argc, char** argv)
             exportFormat = Format::Hex;
         else if (m == "human")
             exportFormat = Format::Human;
+        else if (m == "archive")
+            exportFormat = Format::Archive;
         else
         {
             cerr << "Bad " << "--format" << " option: " << m << "\n";
             return -1;
         }
     }
+    if (vm.count("export-receipts"))
+        exportReceipts = true;
     if (vm.count("to"))
         exportTo = vm["to"].as<string>();
     if (vm.count("from"))
@@ -1043,6 +1086,21 @@ int main(int argc, char** argv)
         ostream& out = (filename.empty() || filename == "--") ? cout : fout;
 
         unsigned last = toNumber(exportTo);
+        if (exportFormat == Format::Archive)
+        {
+            BlockChain const& bc = web3.ethereum()->blockChain();
+            BlockArchiveWriter writer(out, exportReceipts);
+            for (unsigned i = toNumber(exportFrom); i <= last; ++i)
+            {
+                h256 const hash = bc.numberHash(i);
+                bytes const block = bc.block(hash);
+                bytes const receipts = exportReceipts ? bc.receipts(hash).rlp() : bytes();
+                writer.append(&block, &receipts);
+            }
+            writer.finish();
+            cerr << "Exported " << writer.index().size() << " chunks up to #" << writer.checkpoint().number << " " << writer.checkpoint().hash << "\n";
+            return 0;
+        }
         for (unsigned i = toNumber(exportFrom); i <= last; ++i)
         {
             bytes block = web3.ethereum()->blockChain().block(web3.ethereum()->blockChain().numberHash(i));
@@ -1070,14 +1128,38 @@ int main(int argc, char** argv)
         double last = 0;
         unsigned lastImported = 0;
         unsigned imported = 0;
-        while (in.peek() != -1)
+        unsigned queued = 0;
+        unsigned const importBatch = c_archiveChunkBlocks;
+
+        // Blocks are read, decompressed and linkage-checked on the reader's thread and
+        // verified by the block queue's verifiers; this thread only queues and commits.
+        BlockArchiveReader reader(in);
+        BlockArchiveReader::Entry entry;
+
+        // Archived receipts of blocks not imported yet; each is compared with the receipts the
+        // import produced once its block is in the chain.
+        BlockChain const& bc = web3.ethereum()->blockChain();
+        unordered_map<h256, bytes> archivedReceipts;
+        auto receiptsMatch = [&]()
         {
-            bytes block(8);
-            in.read((char*)block.data(), 8);
-            block.resize(RLP(block, RLP::LaissezFaire).actualSize());
-            in.read((char*)block.data() + 8, block.size() - 8);
+            for (auto it = archivedReceipts.begin(); it != archivedReceipts.end();)
+                if (!bc.isKnown(it->first))
+                    ++it;
+                else if (bc.receipts(it->first).rlp() != it->second)
+                {
+                    cerr << "Receipts of block " << it->first << " do not match the archive.\n";
+                    return false;
+                }
+                else
+                    it = archivedReceipts.erase(it);
+            return true;
+        };
 
-            switch (web3.ethereum()->queueBlock(block, safeImport))
+        while (reader.next(entry))
+        {
+            if (!entry.receipts.empty())
+                archivedReceipts[BlockHeader::headerHashFromBlock(entry.block)] = move(entry.receipts);
+            switch (web3.ethereum()->queueBlock(entry.block, safeImport))
             {
             case ImportResult::Success: good++; break;
             case ImportResult::AlreadyKnown: alreadyHave++; break;
@@ -1087,9 +1169,13 @@ int main(int argc, char** argv)
             default: bad++; break;
             }
 
-            // sync chain with queue
-            tuple<ImportRoute, bool, unsigned> r = web3.ethereum()->syncQueue(10);
+            // commit to the chain in large batches rather than after every block
+            if (++queued % importBatch)
+                continue;
+            tuple<ImportRoute, bool, unsigned> r = web3.ethereum()->syncQueue(2 * importBatch);
             imported += get<2>(r);
+            if (!receiptsMatch())
+                return -1;
 
             double e = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - t).count() / 1000.0;
             if ((unsigned)e >= last + 10)
@@ -1102,14 +1188,31 @@ int main(int argc, char** argv)
             }
         }
 
-        bool moreToImport = true;
-        while (moreToImport)
+        while (true)
         {
-            this_thread::sleep_for(chrono::seconds(1));
-            tie(ignore, moreToImport, ignore) = web3.ethereum()->syncQueue(100000);
+            tuple<ImportRoute, bool, unsigned> r = web3.ethereum()->syncQueue(100000);
+            imported += get<2>(r);
+            BlockQueueStatus const s = web3.ethereum()->blockQueueStatus();
+            if (!receiptsMatch())
+                return -1;
+            if (!get<1>(r) && !s.verified && !s.verifying && !s.unverified)
+                break;
+            if (!get<2>(r))
+                this_thread::sleep_for(chrono::milliseconds(10));
         }
         double e = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - t).count() / 1000.0;
         cout << imported << " imported in " << e << " seconds at " << (round(imported * 10 / e) / 10) << " blocks/s (#" << web3.ethereum()->number() << ")\n";
+
+        BlockArchiveCheckpoint const checkpoint = reader.checkpoint();
+        if (checkpoint.hash)
+        {
+            if (bc.numberHash(checkpoint.number) != checkpoint.hash || bc.info(checkpoint.hash).stateRoot() != checkpoint.stateRoot)
+            {
+                cerr << "Imported chain does not match the archive checkpoint #" << checkpoint.number << " " << checkpoint.hash << "\n";
+                return -1;
+            }
+            cout << "Archive checkpoint #" << checkpoint.number << " " << checkpoint.hash << " verified.\n";
+        }
         return 0;
     }
 
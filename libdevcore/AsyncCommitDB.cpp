@@ -0,0 +1,160 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AsyncCommitDB.h"
+#include "BufferedWriteBatch.h"
+#include "Log.h"
+
+namespace dev
+{
+namespace db
+{
+AsyncCommitDB::AsyncCommitDB(std::shared_ptr<DatabaseFace> _db, unsigned _queueDepth, unsigned _syncEvery):
+    m_db(std::move(_db)),
+    m_queueDepth(std::max(_queueDepth, 1u)),
+    m_syncEvery(_syncEvery)
+{
+    m_writer = std::thread([this]() { writerBody(); });
+}
+
+AsyncCommitDB::~AsyncCommitDB()
+{
+    {
+        Guard l(x_queue);
+        m_stop = true;
+    }
+    m_queueChanged.notify_all();
+    m_writer.join();
+}
+
+std::string AsyncCommitDB::lookup(Slice _key) const
+{
+    {
+        Guard l(x_queue);
+        std::string const key = _key.toString();
+        for (auto it = m_queue.rbegin(); it != m_queue.rend(); ++it)
+            if (auto const* write = (*it)->find(key))
+                return write->first ? write->second : std::string();
+    }
+    return m_db->lookup(_key);
+}
+
+bool AsyncCommitDB::exists(Slice _key) const
+{
+    {
+        Guard l(x_queue);
+        std::string const key = _key.toString();
+        for (auto it = m_queue.rbegin(); it != m_queue.rend(); ++it)
+            if (auto const* write = (*it)->find(key))
+                return write->first;
+    }
+    return m_db->exists(_key);
+}
+
+void AsyncCommitDB::insert(Slice _key, Slice _value)
+{
+    auto batch = createWriteBatch();
+    batch->insert(_key, _value);
+    commit(std::move(batch));
+}
+
+void AsyncCommitDB::kill(Slice _key)
+{
+    auto batch = createWriteBatch();
+    batch->kill(_key);
+    commit(std::move(batch));
+}
+
+std::unique_ptr<WriteBatchFace> AsyncCommitDB::createWriteBatch() const
+{
+    return std::unique_ptr<WriteBatchFace>(new BufferedWriteBatch());
+}
+
+void AsyncCommitDB::commit(std::unique_ptr<WriteBatchFace> _batch)
+{
+    auto* batchPtr = BufferedWriteBatch::cast(_batch.get(), "AsyncCommitDB");
+    _batch.release();
+
+    std::unique_lock<Mutex> l(x_queue);
+    m_queueChanged.wait(l, [&]() { return m_queue.size() < m_queueDepth; });
+    m_queue.emplace_back(batchPtr);
+    m_queueChanged.notify_all();
+}
+
+void AsyncCommitDB::forEach(std::function<bool(Slice, Slice)> f) const
+{
+    flush();
+    m_db->forEach(f);
+}
+
+void AsyncCommitDB::forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const
+{
+    flush();
+    m_db->forEachFrom(_from, f);
+}
+
+void AsyncCommitDB::sync()
+{
+    flush();
+    m_db->sync();
+}
+
+void AsyncCommitDB::flush() const
+{
+    std::unique_lock<Mutex> l(x_queue);
+    m_queueChanged.wait(l, [&]() { return m_queue.empty(); });
+}
+
+size_t AsyncCommitDB::queued() const
+{
+    Guard l(x_queue);
+    return m_queue.size();
+}
+
+void AsyncCommitDB::writerBody()
+{
+    setThreadName("dbWriter");
+    unsigned sinceSync = 0;
+    while (true)
+    {
+        BufferedWriteBatch const* batch;
+        {
+            std::unique_lock<Mutex> l(x_queue);
+            m_queueChanged.wait(l, [&]() { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+            batch = m_queue.front().get();
+        }
+
+        // The batch stays readable in the queue until it can be read from m_db.
+        commitWithRetries(*m_db, *batch, "database");
+        if (m_syncEvery && ++sinceSync >= m_syncEvery)
+        {
+            m_db->sync();
+            sinceSync = 0;
+        }
+
+        {
+            Guard l(x_queue);
+            m_queue.pop_front();
+        }
+        m_queueChanged.notify_all();
+    }
+}
+
+}  // namespace db
+}  // namespace dev
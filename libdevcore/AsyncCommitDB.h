@@ -0,0 +1,81 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "db.h"
+#include "Guards.h"
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+namespace dev
+{
+namespace db
+{
+class BufferedWriteBatch;
+
+/// Database which commits write batches on a writer thread of its own. Reads see the batches
+/// still queued, so callers can go on as if they had been written. Committing blocks while
+/// @a _queueDepth batches are waiting; every @a _syncEvery th write is synced to disk (none if 0).
+/// Queued batches are written before it is destroyed, but are lost if the process dies; the
+/// client then rewinds the chain to the last block whose state was written.
+class AsyncCommitDB : public DatabaseFace
+{
+public:
+    AsyncCommitDB(std::shared_ptr<DatabaseFace> _db, unsigned _queueDepth, unsigned _syncEvery);
+    ~AsyncCommitDB();
+
+    std::string lookup(Slice _key) const override;
+    bool exists(Slice _key) const override;
+    void insert(Slice _key, Slice _value) override;
+    void kill(Slice _key) override;
+
+    std::unique_ptr<WriteBatchFace> createWriteBatch() const override;
+    void commit(std::unique_ptr<WriteBatchFace> _batch) override;
+
+    void forEach(std::function<bool(Slice, Slice)> f) const override;
+    void forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const override;
+
+    void sync() override;
+    DatabaseCacheStats cacheStats() const override { return m_db->cacheStats(); }
+
+    /// Waits until every batch committed so far is written.
+    void flush() const;
+
+    /// @returns the number of batches not written yet.
+    size_t queued() const;
+
+private:
+    void writerBody();
+
+    std::shared_ptr<DatabaseFace> m_db;
+    unsigned const m_queueDepth;
+    unsigned const m_syncEvery;
+
+    mutable Mutex x_queue;
+    mutable std::condition_variable m_queueChanged;
+    /// Oldest first; the front is popped once it has been written.
+    std::deque<std::unique_ptr<BufferedWriteBatch>> m_queue;
+    bool m_stop = false;
+
+    std::thread m_writer;
+};
+
+}  // namespace db
+}  // namespace dev
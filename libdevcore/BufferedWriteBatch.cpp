@@ -0,0 +1,77 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BufferedWriteBatch.h"
+#include "Log.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+namespace dev
+{
+namespace db
+{
+void BufferedWriteBatch::applyTo(WriteBatchFace& io_batch) const
+{
+    for (auto const& w: m_writes)
+        if (w.second.first)
+            io_batch.insert(Slice(w.first.data(), w.first.size()), Slice(w.second.second.data(), w.second.second.size()));
+        else
+            io_batch.kill(Slice(w.first.data(), w.first.size()));
+}
+
+BufferedWriteBatch* BufferedWriteBatch::cast(WriteBatchFace* _batch, char const* _db)
+{
+    if (!_batch)
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("Cannot commit null batch"));
+    auto* ret = dynamic_cast<BufferedWriteBatch*>(_batch);
+    if (!ret)
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment(std::string("Invalid batch type passed to ") + _db + "::commit"));
+    return ret;
+}
+
+void writeFailed(char const* _what)
+{
+    cwarn << "Fail writing to " + std::string(_what) + ". Bombing out.";
+    std::exit(-1);
+}
+
+void commitWithRetries(DatabaseFace& _db, BufferedWriteBatch const& _batch, char const* _what)
+{
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        try
+        {
+            // Committing consumes the batch, so every try gets a fresh one.
+            auto writeBatch = _db.createWriteBatch();
+            _batch.applyTo(*writeBatch);
+            _db.commit(std::move(writeBatch));
+            return;
+        }
+        catch (boost::exception const& ex)
+        {
+            cwarn << "Error writing to " + std::string(_what) + ": " << boost::diagnostic_information(ex);
+            cwarn << "Sleeping for" << (i + 1) << "seconds, then retrying.";
+            std::this_thread::sleep_for(std::chrono::seconds(i + 1));
+        }
+    }
+    writeFailed(_what);
+}
+
+}  // namespace db
+}  // namespace dev
@@ -0,0 +1,70 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file BufferedWriteBatch.h
+ * Write batches held in memory, readable, by the database layers that write them later.
+ */
+
+#pragma once
+
+#include "db.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace dev
+{
+namespace db
+{
+/// The writes of a batch, last one per key, kept readable until they are applied to a database.
+class BufferedWriteBatch : public WriteBatchFace
+{
+public:
+    /// Key to whether it is inserted and its value.
+    using Writes = std::unordered_map<std::string, std::pair<bool, std::string>>;
+
+    void insert(Slice _key, Slice _value) override { m_writes[_key.toString()] = {true, _value.toString()}; }
+    void kill(Slice _key) override { m_writes[_key.toString()] = {false, std::string()}; }
+
+    Writes const& writes() const { return m_writes; }
+
+    /// @returns the write of @a _key, null if the batch has none.
+    std::pair<bool, std::string> const* find(std::string const& _key) const
+    {
+        auto const it = m_writes.find(_key);
+        return it == m_writes.end() ? nullptr : &it->second;
+    }
+
+    /// Adds the writes to @a io_batch.
+    void applyTo(WriteBatchFace& io_batch) const;
+
+    /// @returns @a _batch if it is a BufferedWriteBatch, else throws DatabaseError naming @a _db.
+    static BufferedWriteBatch* cast(WriteBatchFace* _batch, char const* _db);
+
+private:
+    Writes m_writes;
+};
+
+/// Logs that writing to @a _what failed for good and ends the process, as nothing written
+/// after it could be trusted.
+[[noreturn]] void writeFailed(char const* _what);
+
+/// Commits @a _batch to @a _db, retrying with growing pauses while it fails; calls writeFailed()
+/// with @a _what after the last try.
+void commitWithRetries(DatabaseFace& _db, BufferedWriteBatch const& _batch, char const* _what);
+
+}  // namespace db
+}  // namespace dev
@@ -0,0 +1,413 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CommitJournal.h"
+#include "BufferedWriteBatch.h"
+#include "CommonIO.h"
+#include "Log.h"
+#include "RLP.h"
+#include "SHA3.h"
+
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = boost::filesystem;
+
+namespace dev
+{
+namespace db
+{
+namespace
+{
+/// Records, or bytes of them, after which the databases are synced and the journal emptied.
+unsigned const c_checkpointRecords = 1024;
+uint64_t const c_checkpointBytes = 64 * 1024 * 1024;
+
+/// Length and checksum in front of every record.
+size_t const c_frameSize = 8;
+
+}  // namespace
+
+/// A database whose commits go through a CommitJournal. Its pending batches are guarded by the
+/// journal's lock, which reads only take while it has any.
+class JournaledDB : public DatabaseFace
+{
+public:
+    JournaledDB(std::shared_ptr<CommitJournal> _journal, std::string const& _id, std::shared_ptr<DatabaseFace> _db):
+        m_journal(std::move(_journal)), m_id(_id), m_db(std::move(_db))
+    {}
+    ~JournaledDB() { m_journal->detach(this); }
+
+    std::string lookup(Slice _key) const override
+    {
+        if (m_pending)
+        {
+            Guard l(m_journal->x_journal);
+            if (auto const* w = m_journal->pendingWrite_WITH_LOCK(this, _key.toString()))
+                return w->first ? w->second : std::string();
+        }
+        return m_db->lookup(_key);
+    }
+
+    bool exists(Slice _key) const override
+    {
+        if (m_pending)
+        {
+            Guard l(m_journal->x_journal);
+            if (auto const* w = m_journal->pendingWrite_WITH_LOCK(this, _key.toString()))
+                return w->first;
+        }
+        return m_db->exists(_key);
+    }
+
+    void insert(Slice _key, Slice _value) override
+    {
+        auto batch = createWriteBatch();
+        batch->insert(_key, _value);
+        commit(std::move(batch));
+    }
+
+    void kill(Slice _key) override
+    {
+        auto batch = createWriteBatch();
+        batch->kill(_key);
+        commit(std::move(batch));
+    }
+
+    std::unique_ptr<WriteBatchFace> createWriteBatch() const override { return std::unique_ptr<WriteBatchFace>(new BufferedWriteBatch()); }
+
+    void commit(std::unique_ptr<WriteBatchFace> _batch) override
+    {
+        BufferedWriteBatch::cast(_batch.get(), "JournaledDB");
+        m_journal->commit(*this, std::move(_batch));
+    }
+
+    /// Iterates the database itself; writes of a group still open are not seen.
+    void forEach(std::function<bool(Slice, Slice)> f) const override { m_db->forEach(f); }
+    void forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const override { m_db->forEachFrom(_from, f); }
+
+    void sync() override { m_db->sync(); }
+    DatabaseCacheStats cacheStats() const override { return m_db->cacheStats(); }
+
+private:
+    friend class CommitJournal;
+
+    std::shared_ptr<CommitJournal> m_journal;
+    std::string const m_id;
+    std::shared_ptr<DatabaseFace> m_db;
+    /// Batches held for this database in groups and queued records; changed under the
+    /// journal's lock, dropped only once they are written to m_db.
+    std::atomic<unsigned> m_pending = {0};
+};
+
+std::shared_ptr<CommitJournal> CommitJournal::open(fs::path const& _path)
+{
+    static Mutex s_lock;
+    static std::map<std::string, std::weak_ptr<CommitJournal>> s_journals;
+
+    Guard l(s_lock);
+    auto& entry = s_journals[fs::absolute(_path).string()];
+    std::shared_ptr<CommitJournal> ret = entry.lock();
+    // A journal whose file was removed (the databases were killed) is not picked up again.
+    if (!ret || !fs::exists(_path))
+    {
+        ret.reset(new CommitJournal(_path));
+        entry = ret;
+    }
+    return ret;
+}
+
+CommitJournal::CommitJournal(fs::path const& _path): m_path(_path)
+{
+    bytes const data = contents(m_path);
+    size_t pos = 0;
+    while (pos + c_frameSize <= data.size())
+    {
+        bytesConstRef const frame(data.data() + pos, data.size() - pos);
+        size_t const size = fromBigEndian<uint32_t>(frame.cropped(0, 4));
+        if (c_frameSize + size > frame.size())
+            break;
+        bytesConstRef const record = frame.cropped(c_frameSize, size);
+        if (!std::equal(frame.data() + 4, frame.data() + 8, sha3(record).data()))
+            break;
+        try
+        {
+            for (auto const& part: RLP(record, RLP::VeryStrict))
+                m_replayIds.insert(part[0].toString());
+        }
+        catch (...)
+        {
+            break;
+        }
+        m_replay.push_back(record.toBytes());
+        pos += c_frameSize + size;
+    }
+
+    if (pos != data.size())
+    {
+        cwarn << "Dropping" << (data.size() - pos) << "bytes of an unfinished record from commit journal" << m_path;
+        fs::resize_file(m_path, pos);
+    }
+    if (!m_replay.empty())
+        cnote << "Commit journal" << m_path << "has" << m_replay.size() << "records to write again";
+
+    m_records = m_replay.size();
+    m_size = pos;
+    reopen("ab");
+}
+
+CommitJournal::~CommitJournal()
+{
+    if (m_file)
+        std::fclose(m_file);
+}
+
+void CommitJournal::reopen(char const* _mode)
+{
+    if (m_file)
+        std::fclose(m_file);
+    m_file = std::fopen(m_path.string().c_str(), _mode);
+    if (!m_file)
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("Cannot open commit journal " + m_path.string()));
+}
+
+std::unique_ptr<DatabaseFace> CommitJournal::attach(std::string const& _id, std::shared_ptr<DatabaseFace> _db)
+{
+    {
+        Guard l(x_journal);
+        if (m_replayIds.count(_id))
+        {
+            for (auto const& record: m_replay)
+                for (auto const& part: RLP(record))
+                    if (part[0].toString() == _id)
+                    {
+                        auto batch = _db->createWriteBatch();
+                        for (auto const& w: part[1])
+                            if (w[1].toInt<unsigned>())
+                                batch->insert((Slice)w[0].toBytesConstRef(), (Slice)w[2].toBytesConstRef());
+                            else
+                                batch->kill((Slice)w[0].toBytesConstRef());
+                        _db->commit(std::move(batch));
+                    }
+            m_replayIds.erase(_id);
+            if (m_replayIds.empty())
+                m_replay.clear();
+        }
+    }
+
+    std::unique_ptr<JournaledDB> ret(new JournaledDB(shared_from_this(), _id, _db));
+    Guard l(x_journal);
+    m_attached.push_back(ret.get());
+    return std::unique_ptr<DatabaseFace>(ret.release());
+}
+
+void CommitJournal::detach(JournaledDB* _db)
+{
+    Guard f(x_flush);
+    uint64_t ticket = 0;
+    {
+        Guard l(x_journal);
+        // what a group still holds for it can only be written now
+        for (auto& g: m_groups)
+            if (std::any_of(g.second.writes.begin(), g.second.writes.end(), [&](Writes::value_type const& _w) { return _w.first == _db; }))
+                enqueue_WITH_LOCK(g.second.writes);
+        // and so can what is queued for it
+        if (!m_queued.empty())
+            ticket = m_queued.back().ticket;
+    }
+    flush_WITH_LOCK(ticket);
+    Guard l(x_journal);
+    m_attached.erase(std::remove(m_attached.begin(), m_attached.end(), _db), m_attached.end());
+}
+
+void CommitJournal::begin()
+{
+    Guard l(x_journal);
+    ++m_groups[std::this_thread::get_id()].depth;
+}
+
+void CommitJournal::end()
+{
+    uint64_t ticket = 0;
+    {
+        Guard l(x_journal);
+        auto const g = m_groups.find(std::this_thread::get_id());
+        if (g == m_groups.end() || --g->second.depth)
+            return;
+        ticket = enqueue_WITH_LOCK(g->second.writes);
+        m_groups.erase(g);
+    }
+    flush(ticket);
+}
+
+void CommitJournal::commit(JournaledDB& _db, std::unique_ptr<WriteBatchFace> _batch)
+{
+    std::unique_ptr<BufferedWriteBatch> batch(static_cast<BufferedWriteBatch*>(_batch.release()));
+    uint64_t ticket = 0;
+    {
+        Guard l(x_journal);
+        ++_db.m_pending;
+        auto const g = m_groups.find(std::this_thread::get_id());
+        if (g != m_groups.end())
+        {
+            g->second.writes.emplace_back(&_db, std::move(batch));
+            return;
+        }
+        Writes writes;
+        writes.emplace_back(&_db, std::move(batch));
+        ticket = enqueue_WITH_LOCK(writes);
+    }
+    flush(ticket);
+}
+
+std::pair<bool, std::string> const* CommitJournal::pendingWrite_WITH_LOCK(JournaledDB const* _db, std::string const& _key) const
+{
+    auto const latest = [&](Writes const& _writes) -> std::pair<bool, std::string> const* {
+        for (auto it = _writes.rbegin(); it != _writes.rend(); ++it)
+            if (it->first == _db)
+                if (auto const* write = it->second->find(_key))
+                    return write;
+        return nullptr;
+    };
+
+    auto const own = m_groups.find(std::this_thread::get_id());
+    if (own != m_groups.end())
+        if (auto const* write = latest(own->second.writes))
+            return write;
+    for (auto it = m_groups.begin(); it != m_groups.end(); ++it)
+        if (it != own)
+            if (auto const* write = latest(it->second.writes))
+                return write;
+    // then what is on its way to the databases, newest first
+    for (auto it = m_queued.rbegin(); it != m_queued.rend(); ++it)
+        if (auto const* write = latest(it->writes))
+            return write;
+    return nullptr;
+}
+
+uint64_t CommitJournal::enqueue_WITH_LOCK(Writes& io_writes)
+{
+    if (io_writes.empty())
+        return 0;
+
+    // One batch per database, in the order they were first written.
+    m_queued.push_back(Record{++m_lastTicket, Writes()});
+    Writes& merged = m_queued.back().writes;
+    for (auto const& w: io_writes)
+    {
+        auto it = std::find_if(merged.begin(), merged.end(), [&](Writes::value_type const& _m) { return _m.first == w.first; });
+        if (it == merged.end())
+        {
+            it = merged.emplace(merged.end(), w.first, std::unique_ptr<BufferedWriteBatch>(new BufferedWriteBatch));
+            ++w.first->m_pending;
+        }
+        w.second->applyTo(*it->second);
+    }
+    for (auto const& w: io_writes)
+        --w.first->m_pending;
+    io_writes.clear();
+    return m_lastTicket;
+}
+
+void CommitJournal::flush_WITH_LOCK(uint64_t _ticket)
+{
+    while (m_flushed < _ticket)
+    {
+        // Only the holder of x_flush takes records off the queue, so this one stays put while
+        // readers go on finding its writes.
+        Record const* next;
+        DEV_GUARDED(x_journal)
+            next = &m_queued.front();
+        Writes const& merged = next->writes;
+
+        RLPStream record(merged.size());
+        for (auto const& m: merged)
+        {
+            auto const& writes = m.second->writes();
+            record.appendList(2) << m.first->m_id;
+            record.appendList(writes.size());
+            for (auto const& w: writes)
+                record.appendList(3) << w.first << (w.second.first ? 1 : 0) << w.second.second;
+        }
+
+        bytes const& payload = record.out();
+        bytes frame(4);
+        toBigEndian(uint32_t(payload.size()), frame);
+        h256 const checksum = sha3(payload);
+        frame.insert(frame.end(), checksum.data(), checksum.data() + 4);
+
+        if (std::fwrite(frame.data(), 1, frame.size(), m_file) != frame.size() ||
+            std::fwrite(payload.data(), 1, payload.size(), m_file) != payload.size() ||
+            std::fflush(m_file))
+            db::writeFailed("commit journal");
+#if defined(_WIN32)
+        if (_commit(_fileno(m_file)))
+#else
+        if (fsync(fileno(m_file)))
+#endif
+            db::writeFailed("commit journal");
+
+        m_size += frame.size() + payload.size();
+        ++m_records;
+
+        for (auto const& m: merged)
+        {
+            auto writeBatch = m.first->m_db->createWriteBatch();
+            m.second->applyTo(*writeBatch);
+            m.first->m_db->commit(std::move(writeBatch));
+        }
+
+        m_flushed = next->ticket;
+        DEV_GUARDED(x_journal)
+        {
+            for (auto const& m: m_queued.front().writes)
+                --m.first->m_pending;
+            m_queued.pop_front();
+        }
+    }
+
+    if (m_records >= c_checkpointRecords || m_size >= c_checkpointBytes)
+        checkpoint_WITH_LOCK();
+}
+
+void CommitJournal::checkpoint_WITH_LOCK()
+{
+    // Databases are only detached holding x_flush, so these stay valid.
+    std::vector<JournaledDB*> attached;
+    {
+        Guard l(x_journal);
+        // Records of databases not attached yet are still to be written.
+        if (!m_replayIds.empty())
+            return;
+        attached = m_attached;
+    }
+    for (JournaledDB* db: attached)
+        db->m_db->sync();
+    reopen("wb");
+    m_records = 0;
+    m_size = 0;
+}
+
+}  // namespace db
+}  // namespace dev
@@ -0,0 +1,138 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "db.h"
+#include "Guards.h"
+
+#include <boost/filesystem/path.hpp>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace dev
+{
+namespace db
+{
+class BufferedWriteBatch;
+class JournaledDB;
+
+/// Write-ahead journal shared by several databases so that a group of writes spanning all of
+/// them is durable with a single fsync. Databases are wrapped with attach(); the commits a
+/// thread makes are held, readable, until the outermost Group it opened ends, are then
+/// appended to the journal as one record and synced, and only after that written to the
+/// databases, which need not sync themselves. Commits of threads without an open Group are a
+/// record each. Records still in the journal when the process dies are written again by
+/// attach() on the next start. Every so often the databases are synced and the journal
+/// emptied.
+/// Records are synced and written to the databases outside the lock readers take, and a
+/// database with nothing held for it is read without taking that lock at all.
+class CommitJournal : public std::enable_shared_from_this<CommitJournal>
+{
+public:
+    /// Holds the writes this thread makes through the journal until it goes out of scope; nests.
+    class Group
+    {
+    public:
+        explicit Group(CommitJournal* _journal): m_journal(_journal) { if (m_journal) m_journal->begin(); }
+        ~Group() { if (m_journal) m_journal->end(); }
+
+    private:
+        CommitJournal* m_journal;
+    };
+
+    /// @returns the journal at @a _path, shared with everyone else who opened the same path.
+    static std::shared_ptr<CommitJournal> open(boost::filesystem::path const& _path);
+
+    ~CommitJournal();
+
+    /// Wraps @a _db as the database named @a _id, first writing its part of any record left
+    /// in the journal.
+    std::unique_ptr<DatabaseFace> attach(std::string const& _id, std::shared_ptr<DatabaseFace> _db);
+
+    void begin();
+    void end();
+
+    /// @returns the number of records written since the journal was last emptied.
+    unsigned records() const { Guard l(x_flush); return m_records; }
+
+    /// Syncs the attached databases and empties the journal, keeping only the records of
+    /// databases not attached yet.
+    void checkpoint() { Guard l(x_flush); checkpoint_WITH_LOCK(); }
+
+private:
+    friend class JournaledDB;
+
+    /// Batches committed to the attached databases, oldest first.
+    using Writes = std::vector<std::pair<JournaledDB*, std::unique_ptr<BufferedWriteBatch>>>;
+
+    /// The Group a thread has open.
+    struct OpenGroup
+    {
+        unsigned depth = 0;
+        Writes writes;
+    };
+
+    /// A record queued for the journal, one batch per database, readable until it is written
+    /// to the databases.
+    struct Record
+    {
+        uint64_t ticket;
+        Writes writes;
+    };
+
+    explicit CommitJournal(boost::filesystem::path const& _path);
+
+    void commit(JournaledDB& _db, std::unique_ptr<WriteBatchFace> _batch);
+    void detach(JournaledDB* _db);
+    /// @returns the latest write of @a _key to @a _db still held in a group, the calling thread's first.
+    std::pair<bool, std::string> const* pendingWrite_WITH_LOCK(JournaledDB const* _db, std::string const& _key) const;
+    /// Queues @a io_writes as a record and empties them. Call holding x_journal.
+    /// @returns the ticket to pass to flush(), 0 if there was nothing to queue.
+    uint64_t enqueue_WITH_LOCK(Writes& io_writes);
+    /// Writes the queued records up to @a _ticket to the journal and then the databases.
+    void flush(uint64_t _ticket) { Guard l(x_flush); flush_WITH_LOCK(_ticket); }
+    /// As flush(), holding x_flush.
+    void flush_WITH_LOCK(uint64_t _ticket);
+    /// Call holding x_flush.
+    void checkpoint_WITH_LOCK();
+    void reopen(char const* _mode);
+
+    boost::filesystem::path m_path;
+
+    mutable Mutex x_journal;                ///< Guards the groups, the queued records and the attached databases.
+    std::map<std::thread::id, OpenGroup> m_groups;
+    std::deque<Record> m_queued;            ///< Records not yet written to the databases, oldest first.
+    uint64_t m_lastTicket = 0;
+    std::vector<JournaledDB*> m_attached;
+    std::vector<bytes> m_replay;            ///< Records found on open, kept until every database in them is attached.
+    std::set<std::string> m_replayIds;
+
+    mutable Mutex x_flush;                  ///< Guards the journal file; never taken while holding x_journal.
+    std::FILE* m_file = nullptr;
+    uint64_t m_flushed = 0;                 ///< Ticket of the last record written to the databases.
+    unsigned m_records = 0;
+    uint64_t m_size = 0;
+};
+
+}  // namespace db
+}  // namespace dev
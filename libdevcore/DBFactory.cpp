@@ -0,0 +1,319 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DBFactory.h"
+#include "Guards.h"
+#include "InMemoryDB.h"
+#include "LevelDB.h"
+#include "TrieNodeCache.h"
+
+#if ETH_ROCKSDB
+#include "RocksDB.h"
+#endif
+
+#include <boost/lexical_cast.hpp>
+
+#include <map>
+
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+namespace dev
+{
+namespace db
+{
+namespace
+{
+auto g_kind = DatabaseKind::LevelDB;
+
+/// A helper type to build the table of database implementations.
+///
+/// More readable than std::tuple.
+/// Fields are not initialized to allow usage of construction with initializer lists {}.
+struct DBKindTableEntry
+{
+    DatabaseKind kind;
+    const char* name;
+};
+
+/// The table of available database implementations.
+DBKindTableEntry dbKindsTable[] = {
+    {DatabaseKind::LevelDB, "leveldb"},
+#if ETH_ROCKSDB
+    {DatabaseKind::RocksDB, "rocksdb"},
+#endif
+    {DatabaseKind::MemoryDB, "memorydb"},
+};
+
+/// Databases whose settings can be given on the command line, and their defaults. The state
+/// database is read at random by trie node hash and gets most of the cache.
+DatabaseSettings tuned(size_t _cacheMB, size_t _writeBufferMB)
+{
+    DatabaseSettings ret;
+    ret.cacheSize = _cacheMB * 1024 * 1024;
+    ret.bloomBitsPerKey = 10;
+    ret.writeBufferSize = _writeBufferMB * 1024 * 1024;
+    return ret;
+}
+
+std::map<std::string, DatabaseSettings> g_settings = {
+    {"blocks", tuned(16, 4)},
+    {"extras", tuned(32, 8)},
+    {"state", tuned(128, 16)},
+};
+
+/// @returns the settings of the databases named @a _name without adding an entry for it.
+DatabaseSettings settingsOf(std::string const& _name)
+{
+    auto const it = g_settings.find(_name);
+    return it == g_settings.end() ? DatabaseSettings() : it->second;
+}
+
+/// Applies the values of a database tuning option, each either `<value>` for every database or
+/// `<db>:<value>` for one of them.
+template <class T>
+void applySetting(std::vector<std::string> const& _values, char const* _option,
+    T DatabaseSettings::*_setting, std::function<T(std::string const&)> const& _parse)
+{
+    for (auto const& s: _values)
+    {
+        auto const separatorPos = s.find(':');
+        try
+        {
+            T const value = _parse(separatorPos == s.npos ? s : s.substr(separatorPos + 1));
+            if (separatorPos == s.npos)
+                for (auto& settings: g_settings)
+                    settings.second.*_setting = value;
+            else if (g_settings.count(s.substr(0, separatorPos)))
+                g_settings[s.substr(0, separatorPos)].*_setting = value;
+            else
+                throw po::validation_error(po::validation_error::invalid_option_value, _option, s);
+        }
+        catch (boost::bad_lexical_cast const&)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, _option, s);
+        }
+    }
+}
+
+size_t parseMegabytes(std::string const& _s)
+{
+    return boost::lexical_cast<size_t>(_s) * 1024 * 1024;
+}
+
+int parseBits(std::string const& _s)
+{
+    return boost::lexical_cast<int>(_s);
+}
+
+bool parseOnOff(std::string const& _s)
+{
+    if (_s == "on")
+        return true;
+    if (_s == "off")
+        return false;
+    throw boost::bad_lexical_cast();
+}
+
+/// The contents of the in-memory databases of this process by path, so that a database closed
+/// and reopened (e.g. by BlockChain::reopen()) keeps its records like one on disk would.
+Mutex x_memoryStores;
+std::map<std::string, std::shared_ptr<InMemoryStore>> g_memoryStores;
+
+std::shared_ptr<InMemoryStore> memoryStore(fs::path const& _path)
+{
+    Guard l(x_memoryStores);
+    auto& store = g_memoryStores[_path.string()];
+    if (!store)
+        store = std::make_shared<InMemoryStore>();
+    return store;
+}
+}
+
+void validate(boost::any& v, const std::vector<std::string>& values, DatabaseKind* /* target_type */, int)
+{
+    // Make sure no previous assignment to 'v' was made.
+    po::validators::check_first_occurrence(v);
+
+    // Extract the first string from 'values'. If there is more than
+    // one string, it's an error, and exception will be thrown.
+    const std::string& s = po::validators::get_single_string(values);
+
+    for (auto& entry : dbKindsTable)
+    {
+        // Try to find a match in the table of databases.
+        if (s == entry.name)
+        {
+            v = entry.kind;
+            return;
+        }
+    }
+
+    throw po::validation_error(po::validation_error::invalid_option_value);
+}
+
+po::options_description databaseProgramOptions(unsigned _lineLength)
+{
+    // It must be a static object because boost expects const char*.
+    static const std::string description = [] {
+        std::string names;
+        for (auto& entry : dbKindsTable)
+        {
+            if (!names.empty())
+                names += ", ";
+            names += entry.name;
+        }
+
+        return "Select database implementation. Available options are: " + names + ".";
+    }();
+
+    po::options_description opts("Database Options", _lineLength);
+    auto add = opts.add_options();
+
+    add("db",
+        po::value<DatabaseKind>()
+            ->value_name("<name>")
+            ->default_value(DatabaseKind::LevelDB, "leveldb")
+            ->notifier(DBFactory::setKind),
+        description.data());
+
+    add("db-cache",
+        po::value<std::vector<std::string>>()
+            ->value_name("<[db:]MB>")
+            ->notifier([](std::vector<std::string> const& _v) {
+                applySetting<size_t>(_v, "db-cache", &DatabaseSettings::cacheSize, parseMegabytes);
+            }),
+        "Set the read cache of the blocks, extras or state database, or of all of them "
+        "(default: 16, 32 and 128).");
+    add("db-bloom-bits",
+        po::value<std::vector<std::string>>()
+            ->value_name("<[db:]bits>")
+            ->notifier([](std::vector<std::string> const& _v) {
+                applySetting<int>(_v, "db-bloom-bits", &DatabaseSettings::bloomBitsPerKey, parseBits);
+            }),
+        "Set the bloom filter bits per key, 0 for none (default: 10).");
+    add("db-write-buffer",
+        po::value<std::vector<std::string>>()
+            ->value_name("<[db:]MB>")
+            ->notifier([](std::vector<std::string> const& _v) {
+                applySetting<size_t>(_v, "db-write-buffer", &DatabaseSettings::writeBufferSize, parseMegabytes);
+            }),
+        "Set the write buffer (default: 4, 8 and 16).");
+    add("db-compression",
+        po::value<std::vector<std::string>>()
+            ->value_name("<[db:]on/off>")
+            ->notifier([](std::vector<std::string> const& _v) {
+                applySetting<bool>(_v, "db-compression", &DatabaseSettings::compression, parseOnOff);
+            }),
+        "Compress table files (default: on). The tuning options apply to LevelDB.");
+    add("trie-cache",
+        po::value<size_t>()
+            ->value_name("<MB>")
+            ->notifier([](size_t _mb) { TrieNodeCache::get().setCapacity(_mb * 1024 * 1024); }),
+        "Set the cache of state trie nodes shared by every state, 0 for none (default: 64).");
+
+    return opts;
+}
+
+void DBFactory::setKind(DatabaseKind _kind)
+{
+    g_kind = _kind;
+}
+
+DatabaseKind DBFactory::kind()
+{
+    return g_kind;
+}
+
+DatabaseSettings& DBFactory::settings(std::string const& _name)
+{
+    return g_settings[_name];
+}
+
+std::unique_ptr<DatabaseFace> DBFactory::create(fs::path const& _path)
+{
+    return create(g_kind, _path);
+}
+
+std::unique_ptr<DatabaseFace> DBFactory::create(DatabaseKind _kind, fs::path const& _path)
+{
+    switch (_kind)
+    {
+#if ETH_ROCKSDB
+    case DatabaseKind::RocksDB:
+        return std::unique_ptr<DatabaseFace>(new RocksDB(_path));
+#endif
+    case DatabaseKind::MemoryDB:
+        return std::unique_ptr<DatabaseFace>(new InMemoryDB(memoryStore(_path)));
+    case DatabaseKind::LevelDB:
+    default:
+        return std::unique_ptr<DatabaseFace>(new LevelDB(_path, settingsOf(_path.filename().string())));
+    }
+}
+
+void DBFactory::remove(fs::path const& _path)
+{
+    switch (g_kind)
+    {
+#if ETH_ROCKSDB
+    case DatabaseKind::RocksDB:
+        RocksDB::remove(_path);
+        break;
+#endif
+    case DatabaseKind::MemoryDB:
+    {
+        Guard l(x_memoryStores);
+        g_memoryStores.erase(_path.string());
+        break;
+    }
+    case DatabaseKind::LevelDB:
+    default:
+        fs::remove_all(_path);
+    }
+}
+
+void DBFactory::rename(fs::path const& _from, fs::path const& _to)
+{
+    switch (g_kind)
+    {
+#if ETH_ROCKSDB
+    case DatabaseKind::RocksDB:
+        RocksDB::rename(_from, _to);
+        break;
+#endif
+    case DatabaseKind::MemoryDB:
+    {
+        Guard l(x_memoryStores);
+        auto const it = g_memoryStores.find(_from.string());
+        if (it == g_memoryStores.end())
+            g_memoryStores.erase(_to.string());
+        else
+        {
+            g_memoryStores[_to.string()] = it->second;
+            g_memoryStores.erase(_from.string());
+        }
+        break;
+    }
+    case DatabaseKind::LevelDB:
+    default:
+        fs::remove_all(_to);
+        fs::rename(_from, _to);
+    }
+}
+
+}  // namespace db
+}  // namespace dev
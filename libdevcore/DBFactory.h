@@ -0,0 +1,73 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "db.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options/options_description.hpp>
+
+namespace dev
+{
+namespace db
+{
+enum class DatabaseKind
+{
+    LevelDB,
+    RocksDB,
+    MemoryDB
+};
+
+/// Provide a set of program options related to databases.
+///
+/// @param _lineLength  The line length for description text wrapping, the same as in
+///                     boost::program_options::options_description::options_description().
+boost::program_options::options_description databaseProgramOptions(
+    unsigned _lineLength = boost::program_options::options_description::m_default_line_length);
+
+class DBFactory
+{
+public:
+    DBFactory() = delete;
+    ~DBFactory() = delete;
+
+    /// Opens the database at @a _path with the global kind (controlled by setKind() function).
+    static std::unique_ptr<DatabaseFace> create(boost::filesystem::path const& _path);
+
+    /// Opens the database at @a _path with the kind provided.
+    static std::unique_ptr<DatabaseFace> create(DatabaseKind _kind, boost::filesystem::path const& _path);
+
+    /// Deletes the database at @a _path of the global kind. It must not be open.
+    static void remove(boost::filesystem::path const& _path);
+
+    /// Moves the database at @a _from of the global kind to @a _to, replacing anything there.
+    /// Neither may be open.
+    static void rename(boost::filesystem::path const& _from, boost::filesystem::path const& _to);
+
+    /// Set global database kind
+    static void setKind(DatabaseKind _kind);
+
+    /// @returns the settings of the databases named @a _name, i.e. opened at `<dir>/<_name>`.
+    /// Those of "blocks", "extras" and "state" are set by databaseProgramOptions().
+    static DatabaseSettings& settings(std::string const& _name);
+
+    static DatabaseKind kind();
+};
+
+}  // namespace db
+}  // namespace dev
@@ -0,0 +1,467 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file FlatState.cpp
+ */
+
+#include "FlatState.h"
+#include "CommonData.h"
+#include "Log.h"
+#include "RLP.h"
+#include "SHA3.h"
+#include "TrieDB.h"
+
+namespace dev
+{
+namespace
+{
+// The prefixes alone do not tell these records from trie nodes and code, whose hashes may start
+// with the same byte; their sizes do, as nothing else in the database is 37 or 77 bytes long.
+byte const c_accountPrefix = 0xfa;
+byte const c_slotPrefix = 0xfb;
+size_t const c_accountKeySize = 1 + 4 + 32;
+size_t const c_slotKeySize = 1 + 4 + 32 + 8 + 32;
+char const* const c_metaKey = "flatState";
+
+unsigned const c_maxRecorded = 256;
+unsigned const c_maxSteps = 64;
+unsigned const c_buildBatch = 10000;
+
+inline db::Slice toSlice(bytes const& _b)
+{
+    return db::Slice(reinterpret_cast<char const*>(_b.data()), _b.size());
+}
+
+void appendBigEndian(bytes& io_key, uint64_t _v, unsigned _size)
+{
+    for (int i = _size - 1; i >= 0; --i)
+        io_key.push_back(byte(_v >> (i * 8)));
+}
+
+/// [account RLP, incarnation] of an account.
+bytes accountKey(uint32_t _epoch, h256 const& _account)
+{
+    bytes ret(1, c_accountPrefix);
+    appendBigEndian(ret, _epoch, 4);
+    ret += _account.asBytes();
+    return ret;
+}
+
+bytes slotKey(uint32_t _epoch, h256 const& _account, uint64_t _incarnation, h256 const& _slot)
+{
+    bytes ret(1, c_slotPrefix);
+    appendBigEndian(ret, _epoch, 4);
+    ret += _account.asBytes();
+    appendBigEndian(ret, _incarnation, 8);
+    ret += _slot.asBytes();
+    return ret;
+}
+
+/// Trie nodes read straight from the database, for walking a state being rebuilt from.
+class NodeReader
+{
+public:
+    explicit NodeReader(db::DatabaseFace const& _db): m_db(_db) {}
+
+    std::string lookup(h256 const& _h) const
+    {
+        return m_db.lookup(db::Slice(reinterpret_cast<char const*>(_h.data()), _h.size));
+    }
+    bool exists(h256 const& _h) const { return !lookup(_h).empty(); }
+    // Never called when only reading.
+    void insert(h256 const&, bytesConstRef) {}
+    bool kill(h256 const&) { return false; }
+
+private:
+    db::DatabaseFace const& m_db;
+};
+
+}  // namespace
+
+FlatState::FlatState(std::shared_ptr<db::DatabaseFace> _db): m_db(std::move(_db))
+{
+    std::string const meta = m_db->lookup(db::Slice(c_metaKey));
+    if (!meta.empty())
+    {
+        RLP r(meta);
+        m_root = r[0].toHash<h256>();
+        m_epoch = r[1].toInt<uint32_t>();
+        m_nextIncarnation = r[2].toInt<uint64_t>();
+    }
+    m_target = m_root;
+}
+
+FlatState::~FlatState()
+{
+    m_stop = true;
+    if (m_builder.joinable())
+        m_builder.join();
+}
+
+h256 FlatState::root() const
+{
+    ReadGuard l(x_state);
+    return m_root;
+}
+
+bool FlatState::accountRecord(h256 const& _account, uint64_t& o_incarnation, std::string* o_account) const
+{
+    std::string const record = m_db->lookup(toSlice(accountKey(m_epoch, _account)));
+    if (record.empty())
+        return false;
+    RLP r(record);
+    o_incarnation = r[1].toInt<uint64_t>();
+    if (o_account)
+        *o_account = r[0].toString();
+    return true;
+}
+
+bool FlatState::account(h256 const& _root, h256 const& _account, std::string& o_account) const
+{
+    ReadGuard l(x_state);
+    if (!m_root || m_root != _root)
+        return false;
+    uint64_t incarnation;
+    if (!accountRecord(_account, incarnation, &o_account))
+        o_account.clear();
+    return true;
+}
+
+bool FlatState::storage(h256 const& _root, h256 const& _account, h256 const& _slot, u256& o_value) const
+{
+    ReadGuard l(x_state);
+    if (!m_root || m_root != _root)
+        return false;
+    o_value = 0;
+    uint64_t incarnation;
+    if (accountRecord(_account, incarnation, nullptr))
+    {
+        std::string const value = m_db->lookup(toSlice(slotKey(m_epoch, _account, incarnation, _slot)));
+        if (!value.empty())
+            o_value = RLP(value).toInt<u256>();
+    }
+    return true;
+}
+
+void FlatState::record(h256 const& _parent, h256 const& _root, Changes const& _changes)
+{
+    if (!_parent || _parent == _root)
+        return;
+    Guard l(x_recorded);
+    if (m_recorded.count(_root))
+        return;
+    m_recorded[_root] = Recorded{_parent, _changes};
+    m_recordOrder.push_back(_root);
+    if (m_recordOrder.size() > c_maxRecorded)
+    {
+        m_recorded.erase(m_recordOrder.front());
+        m_recordOrder.pop_front();
+    }
+}
+
+void FlatState::advance(h256 const& _root)
+{
+    WriteGuard l(x_state);
+    m_target = _root;
+    if (m_building || reach(_root))
+        return;
+    cnote << "Rebuilding flat state at" << _root;
+    startBuild();
+}
+
+void FlatState::waitForBuild()
+{
+    WriteGuard l(x_state);
+    m_built.wait(l, [&]() { return !m_building; });
+}
+
+bool FlatState::reach(h256 const& _root)
+{
+    if (_root == m_root)
+        return true;
+    if (!m_root)
+        return false;
+
+    // Walk back from _root through recorded changes to a state the table is or was at.
+    std::vector<std::pair<h256, Changes>> path;
+    {
+        Guard l(x_recorded);
+        h256 r = _root;
+        auto const wasAt = [&](h256 const& _r) {
+            if (_r == m_root)
+                return true;
+            for (auto const& s: m_steps)
+                if (s.from == _r)
+                    return true;
+            return false;
+        };
+        while (!wasAt(r))
+        {
+            auto it = m_recorded.find(r);
+            if (it == m_recorded.end() || path.size() >= c_maxRecorded)
+                return false;
+            path.emplace_back(r, it->second.changes);
+            r = it->second.parent;
+        }
+        // r is now where the path starts.
+        while (m_root != r)
+        {
+            undo(m_steps.back());
+            m_steps.pop_back();
+        }
+    }
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+        apply(it->first, it->second);
+    return true;
+}
+
+void FlatState::apply(h256 const& _root, Changes const& _changes)
+{
+    Step step;
+    step.from = m_root;
+    step.to = _root;
+    auto batch = m_db->createWriteBatch();
+    auto const write = [&](bytes const& _key, std::string const* _value) {
+        std::string const old = m_db->lookup(toSlice(_key));
+        step.undo.emplace_back(_key, std::make_pair(!old.empty(), old));
+        if (_value)
+            batch->insert(toSlice(_key), db::Slice(*_value));
+        else
+            batch->kill(toSlice(_key));
+    };
+
+    for (auto const& c: _changes)
+    {
+        bytes const key = accountKey(m_epoch, c.first);
+        uint64_t incarnation;
+        bool const existed = accountRecord(c.first, incarnation, nullptr);
+        if (c.second.account.empty())
+        {
+            write(key, nullptr);
+            continue;
+        }
+        if (!existed || c.second.clearedStorage)
+            incarnation = m_nextIncarnation++;
+        std::string const record = asString(rlpList(c.second.account, incarnation));
+        write(key, &record);
+        for (auto const& s: c.second.slots)
+        {
+            bytes const k = slotKey(m_epoch, c.first, incarnation, s.first);
+            if (s.second)
+            {
+                std::string const value = asString(rlp(s.second));
+                write(k, &value);
+            }
+            else
+                write(k, nullptr);
+        }
+    }
+
+    m_root = _root;
+    writeMeta(*batch);
+    m_db->commit(std::move(batch));
+
+    m_steps.push_back(std::move(step));
+    if (m_steps.size() > c_maxSteps)
+        m_steps.pop_front();
+}
+
+void FlatState::undo(Step const& _step)
+{
+    auto batch = m_db->createWriteBatch();
+    for (auto it = _step.undo.rbegin(); it != _step.undo.rend(); ++it)
+        if (it->second.first)
+            batch->insert(toSlice(it->first), db::Slice(it->second.second));
+        else
+            batch->kill(toSlice(it->first));
+    m_root = _step.from;
+    writeMeta(*batch);
+    m_db->commit(std::move(batch));
+}
+
+void FlatState::writeMeta(db::WriteBatchFace& _batch) const
+{
+    bytes const meta = rlpList(m_root, m_epoch, m_nextIncarnation);
+    _batch.insert(db::Slice(c_metaKey), toSlice(meta));
+}
+
+void FlatState::startBuild()
+{
+    m_building = true;
+    m_root = h256();
+    m_steps.clear();
+    if (m_builder.joinable())
+        m_builder.join();
+    m_builder = std::thread([this]() { buildBody(); });
+}
+
+void FlatState::buildBody()
+{
+    setThreadName("flatState");
+    while (!m_stop)
+    {
+        h256 root;
+        uint32_t epoch;
+        {
+            ReadGuard l(x_state);
+            root = m_target;
+            epoch = m_epoch + 1;
+        }
+
+        try
+        {
+            // Clears what an interrupted rebuild left under this epoch.
+            sweep();
+            build(root, epoch);
+            {
+                WriteGuard l(x_state);
+                m_epoch = epoch;
+                m_root = root;
+                auto batch = m_db->createWriteBatch();
+                writeMeta(*batch);
+                m_db->commit(std::move(batch));
+            }
+            sweep();
+        }
+        catch (Exception const& _e)
+        {
+            if (!m_stop)
+                cwarn << "Could not rebuild the flat state at" << root << ":" << _e.what();
+            WriteGuard l(x_state);
+            if (m_target != root && !m_stop)
+                continue;
+            break;
+        }
+
+        // The head may have moved on while building.
+        WriteGuard l(x_state);
+        if (reach(m_target))
+        {
+            cnote << "Flat state rebuilt at" << root;
+            break;
+        }
+        m_root = h256();
+    }
+
+    WriteGuard l(x_state);
+    m_building = false;
+    m_built.notify_all();
+}
+
+void FlatState::build(h256 const& _root, uint32_t _epoch)
+{
+    NodeReader reader(*m_db);
+    uint64_t incarnation;
+    {
+        ReadGuard l(x_state);
+        incarnation = m_nextIncarnation;
+    }
+
+    auto batch = m_db->createWriteBatch();
+    unsigned inBatch = 0;
+    auto const flushIfFull = [&]() {
+        if (++inBatch < c_buildBatch)
+            return;
+        m_db->commit(std::move(batch));
+        batch = m_db->createWriteBatch();
+        inBatch = 0;
+        if (m_stop)
+            BOOST_THROW_EXCEPTION(Exception() << errinfo_comment("Stopped"));
+    };
+
+    GenericTrieDB<NodeReader> accounts(&reader, _root, Verification::Skip);
+    for (auto const& a: accounts)
+    {
+        h256 const account(a.first);
+        std::string const value = a.second.toString();
+        bytes const record = rlpList(value, incarnation);
+        batch->insert(toSlice(accountKey(_epoch, account)), toSlice(record));
+        flushIfFull();
+
+        h256 const storageRoot = RLP(value)[2].toHash<h256>();
+        if (storageRoot != EmptyTrie)
+        {
+            GenericTrieDB<NodeReader> storage(&reader, storageRoot, Verification::Skip);
+            for (auto const& s: storage)
+            {
+                batch->insert(toSlice(slotKey(_epoch, account, incarnation, h256(s.first))), db::Slice(reinterpret_cast<char const*>(s.second.data()), s.second.size()));
+                flushIfFull();
+            }
+        }
+        ++incarnation;
+    }
+    m_db->commit(std::move(batch));
+
+    WriteGuard l(x_state);
+    m_nextIncarnation = incarnation;
+}
+
+void FlatState::sweep()
+{
+    uint32_t epoch;
+    {
+        ReadGuard l(x_state);
+        epoch = m_epoch;
+    }
+    bytes current;
+    appendBigEndian(current, epoch, 4);
+
+    // Records sort by prefix, then epoch, so the current epoch's are skipped with one seek. The
+    // database cannot be written while visiting it, so each pass deletes a batch of records and
+    // the next resumes where it stopped.
+    for (auto const& range: {std::make_pair(c_accountPrefix, c_accountKeySize), std::make_pair(c_slotPrefix, c_slotKeySize)})
+    {
+        bytes after(1, range.first);
+        appendBigEndian(after, uint64_t(epoch) + 1, 4);
+        std::string from(1, char(range.first));
+        while (!from.empty())
+        {
+            std::vector<std::string> stale;
+            std::string next;
+            m_db->forEachFrom(db::Slice(from.data(), from.size()), [&](db::Slice _key, db::Slice) {
+                if (byte(_key[0]) != range.first)
+                    return false;
+                if (_key.size() != range.second)
+                    return true;
+                if (!memcmp(_key.data() + 1, current.data(), 4))
+                {
+                    // Only an interrupted rebuild leaves later epochs behind.
+                    if (epoch != std::numeric_limits<uint32_t>::max())
+                        next = asString(after);
+                    return false;
+                }
+                stale.push_back(_key.toString());
+                if (stale.size() < c_buildBatch)
+                    return true;
+                next = stale.back();
+                return false;
+            });
+            if (m_stop)
+                BOOST_THROW_EXCEPTION(Exception() << errinfo_comment("Stopped"));
+            if (!stale.empty())
+            {
+                auto batch = m_db->createWriteBatch();
+                for (auto const& k: stale)
+                    batch->kill(db::Slice(k));
+                m_db->commit(std::move(batch));
+            }
+            from = next;
+        }
+    }
+}
+
+}
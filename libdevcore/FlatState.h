@@ -0,0 +1,137 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file FlatState.h
+ * Flat table of the accounts and storage of one state, read without walking the trie.
+ */
+
+#pragma once
+
+#include "Common.h"
+#include "FixedHash.h"
+#include "Guards.h"
+#include "db.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+namespace dev
+{
+
+/**
+ * Keeps every account of one state root, by address hash, and every storage slot, by account
+ * and slot hash, in plain records next to the trie nodes, so that reading that state takes one
+ * lookup instead of one per trie level. Accounts are stored as their trie RLP,
+ * [nonce, balance, storageRoot, codeHash], and slots as their trie RLP.
+ *
+ * States record() what their blocks changed. When a block becomes the head, advance() applies
+ * its changes, first undoing those of the blocks a reorganisation abandoned. If the head cannot
+ * be reached that way, the table is rebuilt from the trie on a thread of its own; reads fall
+ * back to the trie until then.
+ *
+ * Slots are keyed by an incarnation of their account, which is new whenever the account's
+ * storage is wiped, so that old slots never need deleting one by one. They are left behind
+ * instead. Shared by every copy of an OverlayDB.
+ */
+class FlatState
+{
+public:
+    /// What a state changed in an account.
+    struct AccountChange
+    {
+        std::string account;            ///< The new RLP of the account, empty if it was deleted.
+        bool clearedStorage = false;    ///< The storage was wiped before @a slots were set.
+        std::map<h256, u256> slots;     ///< New values by slot hash; 0 deletes.
+    };
+    /// By address hash.
+    using Changes = std::unordered_map<h256, AccountChange>;
+
+    explicit FlatState(std::shared_ptr<db::DatabaseFace> _db);
+    ~FlatState();
+
+    /// @returns the root of the state in the table, or h256() while there is none.
+    h256 root() const;
+
+    /// Reads the RLP of the account with address hash @a _account, empty if there is none.
+    /// @returns false if the table is not at @a _root.
+    bool account(h256 const& _root, h256 const& _account, std::string& o_account) const;
+    /// Reads a slot of the account with address hash @a _account; 0 if it is not set.
+    /// @returns false if the table is not at @a _root.
+    bool storage(h256 const& _root, h256 const& _account, h256 const& _slot, u256& o_value) const;
+
+    /// Notes that applying @a _changes to the state at @a _parent gives the one at @a _root.
+    void record(h256 const& _parent, h256 const& _root, Changes const& _changes);
+
+    /// Moves the table to the state at @a _root, through recorded changes or by rebuilding it.
+    void advance(h256 const& _root);
+
+    /// Waits until no rebuild is running.
+    void waitForBuild();
+
+private:
+    /// Previous values of the records a step wrote, to undo it; false for none.
+    struct Step
+    {
+        h256 from;
+        h256 to;
+        std::vector<std::pair<bytes, std::pair<bool, std::string>>> undo;
+    };
+
+    bool accountRecord(h256 const& _account, uint64_t& o_incarnation, std::string* o_account) const;
+    /// Moves the table to @a _root through undos and recorded changes. Needs x_state.
+    bool reach(h256 const& _root);
+    /// Applies @a _changes, leading to @a _root. Needs x_state.
+    void apply(h256 const& _root, Changes const& _changes);
+    void undo(Step const& _step);
+    void writeMeta(db::WriteBatchFace& _batch) const;
+
+    /// Starts rebuilding at m_target. Needs x_state.
+    void startBuild();
+    void buildBody();
+    /// Writes every account and slot of @a _root under epoch @a _epoch.
+    void build(h256 const& _root, uint32_t _epoch);
+    /// Deletes the records of every epoch but m_epoch.
+    void sweep();
+
+    std::shared_ptr<db::DatabaseFace> m_db;
+
+    mutable SharedMutex x_state;
+    h256 m_root;
+    h256 m_target;                  ///< What the table should be at.
+    uint32_t m_epoch = 0;           ///< Changes with each rebuild; part of every record's key.
+    uint64_t m_nextIncarnation = 0;
+    std::deque<Step> m_steps;       ///< Most recent last.
+
+    Mutex x_recorded;
+    struct Recorded
+    {
+        h256 parent;
+        Changes changes;
+    };
+    std::unordered_map<h256, Recorded> m_recorded;
+    std::deque<h256> m_recordOrder;
+
+    std::thread m_builder;
+    bool m_building = false;        ///< Guarded by x_state.
+    std::atomic<bool> m_stop{false};
+    std::condition_variable_any m_built;
+};
+
+}
@@ -0,0 +1,126 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "InMemoryDB.h"
+
+#include <vector>
+
+namespace dev
+{
+namespace db
+{
+namespace
+{
+class InMemoryWriteBatch : public WriteBatchFace
+{
+public:
+    void insert(Slice _key, Slice _value) override;
+    void kill(Slice _key) override;
+
+    /// Operations in the order they were added; a value-less entry kills its key.
+    std::vector<std::pair<std::string, std::unique_ptr<std::string>>> const& operations() const
+    {
+        return m_operations;
+    }
+
+private:
+    std::vector<std::pair<std::string, std::unique_ptr<std::string>>> m_operations;
+};
+
+void InMemoryWriteBatch::insert(Slice _key, Slice _value)
+{
+    m_operations.emplace_back(_key.toString(),
+        std::unique_ptr<std::string>(new std::string(_value.toString())));
+}
+
+void InMemoryWriteBatch::kill(Slice _key)
+{
+    m_operations.emplace_back(_key.toString(), nullptr);
+}
+
+}  // namespace
+
+InMemoryDB::InMemoryDB(std::shared_ptr<InMemoryStore> _store) : m_store(std::move(_store))
+{
+    assert(m_store);
+}
+
+std::string InMemoryDB::lookup(Slice _key) const
+{
+    ReadGuard l(m_store->x_records);
+    auto const it = m_store->records.find(_key.toString());
+    return it == m_store->records.end() ? std::string() : it->second;
+}
+
+bool InMemoryDB::exists(Slice _key) const
+{
+    ReadGuard l(m_store->x_records);
+    return m_store->records.count(_key.toString()) != 0;
+}
+
+void InMemoryDB::insert(Slice _key, Slice _value)
+{
+    WriteGuard l(m_store->x_records);
+    m_store->records[_key.toString()] = _value.toString();
+}
+
+void InMemoryDB::kill(Slice _key)
+{
+    WriteGuard l(m_store->x_records);
+    m_store->records.erase(_key.toString());
+}
+
+std::unique_ptr<WriteBatchFace> InMemoryDB::createWriteBatch() const
+{
+    return std::unique_ptr<WriteBatchFace>(new InMemoryWriteBatch());
+}
+
+void InMemoryDB::commit(std::unique_ptr<WriteBatchFace> _batch)
+{
+    if (!_batch)
+    {
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("Cannot commit null batch"));
+    }
+    auto* batchPtr = dynamic_cast<InMemoryWriteBatch*>(_batch.get());
+    if (!batchPtr)
+    {
+        BOOST_THROW_EXCEPTION(
+            DatabaseError() << errinfo_comment("Invalid batch type passed to InMemoryDB::commit"));
+    }
+    WriteGuard l(m_store->x_records);
+    for (auto const& op: batchPtr->operations())
+        if (op.second)
+            m_store->records[op.first] = *op.second;
+        else
+            m_store->records.erase(op.first);
+}
+
+void InMemoryDB::forEach(std::function<bool(Slice, Slice)> f) const
+{
+    forEachFrom(Slice(), f);
+}
+
+void InMemoryDB::forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const
+{
+    ReadGuard l(m_store->x_records);
+    for (auto it = m_store->records.lower_bound(_from.toString()); it != m_store->records.end(); ++it)
+        if (!f(Slice(it->first.data(), it->first.size()), Slice(it->second.data(), it->second.size())))
+            break;
+}
+
+}  // namespace db
+}  // namespace dev
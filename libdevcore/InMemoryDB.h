@@ -0,0 +1,60 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "db.h"
+#include "Guards.h"
+
+#include <map>
+
+namespace dev
+{
+namespace db
+{
+/// The records of one in-process database. Several InMemoryDB handles may share it, so that a
+/// database closed and reopened under the same path by DBFactory keeps its contents.
+struct InMemoryStore
+{
+    mutable SharedMutex x_records;
+    std::map<std::string, std::string> records;
+};
+
+/// DatabaseFace kept entirely in memory, for benchmarks and ephemeral test chains.
+class InMemoryDB : public DatabaseFace
+{
+public:
+    explicit InMemoryDB(std::shared_ptr<InMemoryStore> _store = std::make_shared<InMemoryStore>());
+
+    std::string lookup(Slice _key) const override;
+    bool exists(Slice _key) const override;
+    void insert(Slice _key, Slice _value) override;
+    void kill(Slice _key) override;
+
+    std::unique_ptr<WriteBatchFace> createWriteBatch() const override;
+    void commit(std::unique_ptr<WriteBatchFace> _batch) override;
+
+    /// Visits the records in key order; @a f must not write to this database.
+    void forEach(std::function<bool(Slice, Slice)> f) const override;
+    void forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const override;
+
+private:
+    std::shared_ptr<InMemoryStore> m_store;
+};
+
+}  // namespace db
+}  // namespace dev
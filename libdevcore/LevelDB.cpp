@@ -80,6 +80,39 @@ void LevelDBWriteBatch::kill(Slice _key)
     m_writeBatch.Delete(toLDBSlice(_key));
 }
 
+/// An LRU block cache which counts how many of its lookups hit.
+class CountingCache : public leveldb::Cache
+{
+public:
+    CountingCache(size_t _capacity, std::atomic<uint64_t>& o_hits, std::atomic<uint64_t>& o_misses)
+      : m_cache(leveldb::NewLRUCache(_capacity)), m_hits(o_hits), m_misses(o_misses)
+    {}
+
+    Handle* Insert(leveldb::Slice const& _key, void* _value, size_t _charge,
+        void (*_deleter)(leveldb::Slice const& _key, void* _value)) override
+    {
+        return m_cache->Insert(_key, _value, _charge, _deleter);
+    }
+
+    Handle* Lookup(leveldb::Slice const& _key) override
+    {
+        Handle* ret = m_cache->Lookup(_key);
+        ++(ret ? m_hits : m_misses);
+        return ret;
+    }
+
+    void Release(Handle* _handle) override { m_cache->Release(_handle); }
+    void* Value(Handle* _handle) override { return m_cache->Value(_handle); }
+    void Erase(leveldb::Slice const& _key) override { m_cache->Erase(_key); }
+    uint64_t NewId() override { return m_cache->NewId(); }
+    size_t TotalCharge() const override { return m_cache->TotalCharge(); }
+
+private:
+    std::unique_ptr<leveldb::Cache> m_cache;
+    std::atomic<uint64_t>& m_hits;
+    std::atomic<uint64_t>& m_misses;
+};
+
 }  // namespace
 
 leveldb::ReadOptions LevelDB::defaultReadOptions()
@@ -103,6 +136,34 @@ leveldb::Options LevelDB::defaultDBOptions()
 LevelDB::LevelDB(boost::filesystem::path const& _path, leveldb::ReadOptions _readOptions,
     leveldb::WriteOptions _writeOptions, leveldb::Options _dbOptions)
   : m_db(nullptr), m_readOptions(std::move(_readOptions)), m_writeOptions(std::move(_writeOptions))
+{
+    open(_path, _dbOptions);
+}
+
+LevelDB::LevelDB(boost::filesystem::path const& _path, DatabaseSettings const& _settings)
+  : m_cacheCapacity(_settings.cacheSize),
+    m_db(nullptr),
+    m_readOptions(defaultReadOptions()),
+    m_writeOptions(defaultWriteOptions())
+{
+    leveldb::Options options = defaultDBOptions();
+    if (_settings.cacheSize)
+    {
+        m_cache.reset(new CountingCache(_settings.cacheSize, m_cacheHits, m_cacheMisses));
+        options.block_cache = m_cache.get();
+    }
+    if (_settings.bloomBitsPerKey > 0)
+    {
+        m_filterPolicy.reset(leveldb::NewBloomFilterPolicy(_settings.bloomBitsPerKey));
+        options.filter_policy = m_filterPolicy.get();
+    }
+    if (_settings.writeBufferSize)
+        options.write_buffer_size = _settings.writeBufferSize;
+    options.compression = _settings.compression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+    open(_path, options);
+}
+
+void LevelDB::open(boost::filesystem::path const& _path, leveldb::Options const& _dbOptions)
 {
     auto db = static_cast<leveldb::DB*>(nullptr);
     auto const status = leveldb::DB::Open(_dbOptions, _path.string(), &db);
@@ -173,6 +234,11 @@ void LevelDB::commit(std::unique_ptr<WriteBatchFace> _batch)
 }
 
 void LevelDB::forEach(std::function<bool(Slice, Slice)> f) const
+{
+    forEachFrom(Slice(), f);
+}
+
+void LevelDB::forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const
 {
     std::unique_ptr<leveldb::Iterator> itr(m_db->NewIterator(m_readOptions));
     if (itr == nullptr)
@@ -180,7 +246,7 @@ void LevelDB::forEach(std::function<bool(Slice, Slice)> f) const
         BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("null iterator"));
     }
     auto keepIterating = true;
-    for (itr->SeekToFirst(); keepIterating && itr->Valid(); itr->Next())
+    for (itr->Seek(leveldb::Slice(_from.data(), _from.size())); keepIterating && itr->Valid(); itr->Next())
     {
         auto const dbKey = itr->key();
         auto const dbValue = itr->value();
@@ -190,5 +256,26 @@ void LevelDB::forEach(std::function<bool(Slice, Slice)> f) const
     }
 }
 
+void LevelDB::sync()
+{
+    // A synchronous write syncs the log, and with it every write before it.
+    leveldb::WriteOptions options = m_writeOptions;
+    options.sync = true;
+    leveldb::WriteBatch empty;
+    checkStatus(m_db->Write(options, &empty));
+}
+
+DatabaseCacheStats LevelDB::cacheStats() const
+{
+    DatabaseCacheStats ret;
+    if (!m_cache)
+        return ret;
+    ret.hits = m_cacheHits;
+    ret.misses = m_cacheMisses;
+    ret.used = m_cache->TotalCharge();
+    ret.capacity = m_cacheCapacity;
+    return ret;
+}
+
 }  // namespace db
 }  // namespace dev
@@ -20,9 +20,13 @@
 #include "db.h"
 
 #include <boost/filesystem.hpp>
+#include <leveldb/cache.h>
 #include <leveldb/db.h>
+#include <leveldb/filter_policy.h>
 #include <leveldb/write_batch.h>
 
+#include <atomic>
+
 namespace dev
 {
 namespace db
@@ -39,6 +43,10 @@ public:
         leveldb::WriteOptions _writeOptions = defaultWriteOptions(),
         leveldb::Options _dbOptions = defaultDBOptions());
 
+    /// Opens the database with defaultDBOptions() adjusted by @a _settings. The read cache it
+    /// creates counts its hits and misses for cacheStats().
+    LevelDB(boost::filesystem::path const& _path, DatabaseSettings const& _settings);
+
     std::string lookup(Slice _key) const override;
     bool exists(Slice _key) const override;
     void insert(Slice _key, Slice _value) override;
@@ -48,8 +56,21 @@ public:
     void commit(std::unique_ptr<WriteBatchFace> _batch) override;
 
     void forEach(std::function<bool(Slice, Slice)> f) const override;
+    void forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const override;
+
+    void sync() override;
+    DatabaseCacheStats cacheStats() const override;
 
 private:
+    void open(boost::filesystem::path const& _path, leveldb::Options const& _dbOptions);
+
+    // Declared before m_db, which uses them until it is closed.
+    std::atomic<uint64_t> m_cacheHits{0};
+    std::atomic<uint64_t> m_cacheMisses{0};
+    size_t m_cacheCapacity = 0;
+    std::unique_ptr<leveldb::Cache> m_cache;
+    std::unique_ptr<leveldb::FilterPolicy const> m_filterPolicy;
+
     std::unique_ptr<leveldb::DB> m_db;
     leveldb::ReadOptions const m_readOptions;
     leveldb::WriteOptions const m_writeOptions;
@@ -20,6 +20,8 @@
 #include <libdevcore/Common.h>
 #include "SHA3.h"
 #include "OverlayDB.h"
+#include "AsyncCommitDB.h"
+#include "BufferedWriteBatch.h"
 #include "TrieDB.h"
 
 namespace dev
@@ -46,10 +48,48 @@ inline db::Slice toSlice(bytes const& _b)
 OverlayDB::~OverlayDB() = default;
 
 void OverlayDB::commit()
+{
+    commit(nullptr);
+}
+
+void OverlayDB::commit(unsigned _number, h256 const& _id)
+{
+    StatePruner::Era const era{_number, _id};
+    commit(&era);
+}
+
+void OverlayDB::enableAsyncCommit(unsigned _queueDepth, unsigned _syncEvery)
+{
+    if (m_db)
+        m_db = std::make_shared<db::AsyncCommitDB>(m_db, _queueDepth, _syncEvery);
+}
+
+void OverlayDB::enableJournal(std::shared_ptr<db::CommitJournal> const& _journal)
+{
+    if (m_db)
+        m_db = _journal->attach("state", m_db);
+}
+
+void OverlayDB::enableFlatState()
+{
+    if (m_db)
+        m_flatState = std::make_shared<FlatState>(m_db);
+}
+
+void OverlayDB::enablePruning(unsigned _history, unsigned _checkpointInterval)
+{
+    if (m_db)
+        m_pruner = std::make_shared<StatePruner>(m_db, _history, _checkpointInterval);
+}
+
+void OverlayDB::commit(StatePruner::Era const* _era)
 {
     if (m_db)
     {
-        auto writeBatch = m_db->createWriteBatch();
+        std::unique_lock<Mutex> pruning;
+        if (m_pruner)
+            pruning = m_pruner->guard();
+        db::BufferedWriteBatch writeBatch;
 //      cnote << "Committing nodes to disk DB:";
 #if DEV_GUARDED_DB
         DEV_READ_GUARDED(x_this)
@@ -58,7 +98,7 @@ void OverlayDB::commit()
             for (auto const& i: m_main)
             {
                 if (i.second.second)
-                    writeBatch->insert(toSlice(i.first), toSlice(i.second.first));
+                    writeBatch.insert(toSlice(i.first), toSlice(i.second.first));
 //              cnote << i.first << "#" << m_main[i.first].second;
             }
             for (auto const& i: m_aux)
@@ -66,35 +106,20 @@ void OverlayDB::commit()
                 {
                     bytes b = i.first.asBytes();
                     b.push_back(255);   // for aux
-                    writeBatch->insert(toSlice(b), toSlice(i.second.first));
+                    writeBatch.insert(toSlice(b), toSlice(i.second.first));
                 }
+            if (m_pruner)
+                m_pruner->journal(writeBatch, m_main, m_deaths, _era);
         }
 
-        for (unsigned i = 0; i < 10; ++i)
-        {
-            try
-            {
-                m_db->commit(std::move(writeBatch));
-                break;
-            }
-            catch (boost::exception const& ex)
-            {
-                if (i == 9)
-                {
-                    cwarn << "Fail writing to state database. Bombing out.";
-                    exit(-1);
-                }
-                cwarn << "Error writing to state database: " << boost::diagnostic_information(ex);
-                cwarn << "Sleeping for" << (i + 1) << "seconds, then retrying.";
-                std::this_thread::sleep_for(std::chrono::seconds(i + 1));
-            }
-        }
+        db::commitWithRetries(*m_db, writeBatch, "state database");
 #if DEV_GUARDED_DB
         DEV_WRITE_GUARDED(x_this)
 #endif
         {
             m_aux.clear();
             m_main.clear();
+            m_deaths.clear();
         }
     }
 }
@@ -120,6 +145,7 @@ void OverlayDB::rollback()
     WriteGuard l(x_this);
 #endif
     m_main.clear();
+    m_deaths.clear();
 }
 
 std::string OverlayDB::lookup(h256 const& _h) const
@@ -128,7 +154,16 @@ std::string OverlayDB::lookup(h256 const& _h) const
     if (!ret.empty() || !m_db)
         return ret;
 
-    return m_db->lookup(toSlice(_h));
+    if (!m_nodeCache)
+        return m_db->lookup(toSlice(_h));
+
+    ret = m_nodeCache->lookup(_h);
+    if (ret.empty())
+    {
+        ret = m_db->lookup(toSlice(_h));
+        m_nodeCache->insert(_h, ret);
+    }
+    return ret;
 }
 
 bool OverlayDB::exists(h256 const& _h) const
@@ -143,6 +178,8 @@ void OverlayDB::kill(h256 const& _h)
 #if ETH_PARANOIA || 1
     if (!MemoryDB::kill(_h))
     {
+        if (m_pruner && _h != EmptyTrie)
+            m_deaths.push_back(_h);
         if (m_db)
         {
             if (!m_db->exists(toSlice(_h)))
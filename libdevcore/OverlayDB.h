@@ -24,8 +24,12 @@
 #include <memory>
 #include <libdevcore/db.h>
 #include <libdevcore/Common.h>
+#include <libdevcore/CommitJournal.h>
 #include <libdevcore/Log.h>
 #include <libdevcore/MemoryDB.h>
+#include <libdevcore/FlatState.h>
+#include <libdevcore/StatePruner.h>
+#include <libdevcore/TrieNodeCache.h>
 
 namespace dev
 {
@@ -52,6 +56,8 @@ public:
     OverlayDB& operator=(OverlayDB&&) = default;
 
     void commit();
+    /// Commits the changes made by block @a _id, number @a _number, journaling them if pruning.
+    void commit(unsigned _number, h256 const& _id);
 	void rollback();
 
 	std::string lookup(h256 const& _h) const;
@@ -60,10 +66,39 @@ public:
 
 	bytes lookupAux(h256 const& _h) const;
 
+	/// Writes commits to disk on a background thread, blocking once @a _queueDepth are waiting,
+	/// and syncs every @a _syncEvery th of them (none if 0). Call before enablePruning().
+	void enableAsyncCommit(unsigned _queueDepth, unsigned _syncEvery);
+
+	/// Commits through @a _journal, so that state written with a block reaches disk with it.
+	/// Call after enableAsyncCommit() and before the other features.
+	void enableJournal(std::shared_ptr<db::CommitJournal> const& _journal);
+
+	/// Keeps the nodes read from disk in @a _cache, which may be shared with other OverlayDBs.
+	void enableNodeCache(TrieNodeCache& _cache) { m_nodeCache = &_cache; }
+
+	/// Keeps a flat table of the accounts and storage of the head state next to the trie.
+	void enableFlatState();
+	std::shared_ptr<FlatState> const& flatState() const { return m_flatState; }
+
+	/// Deletes nodes of states older than the last @a _history blocks, except every
+	/// @a _checkpointInterval th block's (none if 0), once they are settled through pruner().
+	void enablePruning(unsigned _history, unsigned _checkpointInterval);
+	std::shared_ptr<StatePruner> const& pruner() const { return m_pruner; }
+
+	/// @returns the counters of the read cache of the backing database.
+	db::DatabaseCacheStats cacheStats() const { return m_db ? m_db->cacheStats() : db::DatabaseCacheStats(); }
+
 private:
 	using MemoryDB::clear;
 
+	void commit(StatePruner::Era const* _era);
+
     std::shared_ptr<db::DatabaseFace> m_db;
+	std::shared_ptr<StatePruner> m_pruner;
+	h256s m_deaths;		///< Nodes on disk killed since the last commit, if pruning.
+	TrieNodeCache* m_nodeCache = nullptr;
+	std::shared_ptr<FlatState> m_flatState;
 };
 
 }
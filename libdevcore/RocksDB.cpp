@@ -0,0 +1,380 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RocksDB.h"
+#include "Assertions.h"
+#include "Guards.h"
+
+#include <rocksdb/cache.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/table.h>
+
+#include <algorithm>
+#include <map>
+#include <thread>
+
+namespace fs = boost::filesystem;
+
+namespace dev
+{
+namespace db
+{
+namespace
+{
+size_t const c_blockCacheSize = 256 * 1024 * 1024;
+char const* const c_directory = "rocksdb";
+
+inline rocksdb::Slice toRocksDBSlice(Slice _slice)
+{
+    return rocksdb::Slice(_slice.data(), _slice.size());
+}
+
+DatabaseStatus toDatabaseStatus(rocksdb::Status const& _status)
+{
+    if (_status.ok())
+        return DatabaseStatus::Ok;
+    else if (_status.IsIOError())
+        return DatabaseStatus::IOError;
+    else if (_status.IsCorruption())
+        return DatabaseStatus::Corruption;
+    else if (_status.IsNotFound())
+        return DatabaseStatus::NotFound;
+    else if (_status.IsNotSupported())
+        return DatabaseStatus::NotSupported;
+    else if (_status.IsInvalidArgument())
+        return DatabaseStatus::InvalidArgument;
+    else
+        return DatabaseStatus::Unknown;
+}
+
+void checkStatus(rocksdb::Status const& _status, fs::path const& _path = {})
+{
+    if (_status.ok())
+        return;
+
+    DatabaseError ex;
+    ex << errinfo_dbStatusCode(toDatabaseStatus(_status))
+       << errinfo_dbStatusString(_status.ToString());
+    if (!_path.empty())
+        ex << errinfo_path(_path.string());
+
+    BOOST_THROW_EXCEPTION(ex);
+}
+
+class RocksDBWriteBatch : public WriteBatchFace
+{
+public:
+    explicit RocksDBWriteBatch(rocksdb::ColumnFamilyHandle* _family) : m_family(_family) {}
+
+    void insert(Slice _key, Slice _value) override;
+    void kill(Slice _key) override;
+
+    rocksdb::ColumnFamilyHandle* family() const { return m_family; }
+    rocksdb::WriteBatch& writeBatch() { return m_writeBatch; }
+
+private:
+    rocksdb::ColumnFamilyHandle* m_family;
+    rocksdb::WriteBatch m_writeBatch;
+};
+
+void RocksDBWriteBatch::insert(Slice _key, Slice _value)
+{
+    m_writeBatch.Put(m_family, toRocksDBSlice(_key), toRocksDBSlice(_value));
+}
+
+void RocksDBWriteBatch::kill(Slice _key)
+{
+    m_writeBatch.Delete(m_family, toRocksDBSlice(_key));
+}
+
+fs::path directoryOf(fs::path const& _path)
+{
+    return _path.parent_path() / fs::path(c_directory);
+}
+
+}  // namespace
+
+/// One open RocksDB database and the handles of its column families.
+class RocksDBInstance
+{
+public:
+    RocksDBInstance(fs::path const& _directory, rocksdb::Options const& _options);
+    ~RocksDBInstance();
+
+    /// Opens the given instance, or shares the one already open in @a _directory.
+    static std::shared_ptr<RocksDBInstance> open(
+        fs::path const& _directory, rocksdb::Options const& _options);
+
+    rocksdb::DB& db() { return *m_db; }
+
+    bool hasFamily(std::string const& _name) const;
+    /// @returns the handle of the column family @a _name, creating it if needed.
+    rocksdb::ColumnFamilyHandle* family(std::string const& _name);
+    void drop(std::string const& _name);
+
+private:
+    fs::path const m_directory;
+    rocksdb::ColumnFamilyOptions const m_familyOptions;
+    std::unique_ptr<rocksdb::DB> m_db;
+    mutable Mutex x_families;
+    std::map<std::string, rocksdb::ColumnFamilyHandle*> m_families;
+};
+
+RocksDBInstance::RocksDBInstance(fs::path const& _directory, rocksdb::Options const& _options)
+  : m_directory(_directory), m_familyOptions(_options)
+{
+    std::vector<std::string> names;
+    if (!rocksdb::DB::ListColumnFamilies(_options, _directory.string(), &names).ok())
+        names = {rocksdb::kDefaultColumnFamilyName};
+
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+    for (auto const& name: names)
+        descriptors.emplace_back(name, m_familyOptions);
+
+    std::vector<rocksdb::ColumnFamilyHandle*> handles;
+    auto db = static_cast<rocksdb::DB*>(nullptr);
+    auto const status = rocksdb::DB::Open(
+        rocksdb::DBOptions(_options), _directory.string(), descriptors, &handles, &db);
+    checkStatus(status, _directory);
+
+    assert(db);
+    m_db.reset(db);
+    for (size_t i = 0; i < names.size(); ++i)
+        m_families[names[i]] = handles[i];
+}
+
+RocksDBInstance::~RocksDBInstance()
+{
+    for (auto const& family: m_families)
+        m_db->DestroyColumnFamilyHandle(family.second);
+}
+
+std::shared_ptr<RocksDBInstance> RocksDBInstance::open(
+    fs::path const& _directory, rocksdb::Options const& _options)
+{
+    static Mutex s_x;
+    static std::map<std::string, std::weak_ptr<RocksDBInstance>> s_instances;
+
+    Guard l(s_x);
+    auto& instance = s_instances[_directory.string()];
+    auto ret = instance.lock();
+    if (!ret)
+    {
+        ret = std::make_shared<RocksDBInstance>(_directory, _options);
+        instance = ret;
+    }
+    return ret;
+}
+
+bool RocksDBInstance::hasFamily(std::string const& _name) const
+{
+    Guard l(x_families);
+    return m_families.count(_name) != 0;
+}
+
+rocksdb::ColumnFamilyHandle* RocksDBInstance::family(std::string const& _name)
+{
+    Guard l(x_families);
+    auto& handle = m_families[_name];
+    if (!handle)
+    {
+        auto const status = m_db->CreateColumnFamily(m_familyOptions, _name, &handle);
+        if (!status.ok())
+            m_families.erase(_name);
+        checkStatus(status, m_directory / fs::path(_name));
+    }
+    return handle;
+}
+
+void RocksDBInstance::drop(std::string const& _name)
+{
+    Guard l(x_families);
+    auto const it = m_families.find(_name);
+    if (it == m_families.end())
+        return;
+    checkStatus(m_db->DropColumnFamily(it->second), m_directory / fs::path(_name));
+    m_db->DestroyColumnFamilyHandle(it->second);
+    m_families.erase(it);
+}
+
+rocksdb::ReadOptions RocksDB::defaultReadOptions()
+{
+    return rocksdb::ReadOptions();
+}
+
+rocksdb::WriteOptions RocksDB::defaultWriteOptions()
+{
+    return rocksdb::WriteOptions();
+}
+
+rocksdb::Options RocksDB::defaultDBOptions()
+{
+    rocksdb::Options options;
+    options.create_if_missing = true;
+    options.create_missing_column_families = true;
+    options.max_open_files = 256;
+
+    // Background flushes and compactions on every core, and level compaction tuned for our
+    // write-heavy load; this also compresses all but the first levels with Snappy.
+    options.IncreaseParallelism(std::max<int>(2, std::thread::hardware_concurrency()));
+    options.OptimizeLevelStyleCompaction();
+
+    rocksdb::BlockBasedTableOptions table;
+    table.block_cache = rocksdb::NewLRUCache(c_blockCacheSize);
+    table.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10));
+    options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table));
+    return options;
+}
+
+RocksDB::RocksDB(fs::path const& _path, rocksdb::ReadOptions _readOptions,
+    rocksdb::WriteOptions _writeOptions, rocksdb::Options _dbOptions)
+  : m_readOptions(std::move(_readOptions)), m_writeOptions(std::move(_writeOptions))
+{
+    fs::create_directories(directoryOf(_path));
+    m_instance = RocksDBInstance::open(directoryOf(_path), _dbOptions);
+    m_family = m_instance->family(_path.filename().string());
+}
+
+RocksDB::~RocksDB() = default;
+
+std::string RocksDB::lookup(Slice _key) const
+{
+    std::string value;
+    auto const status = m_instance->db().Get(m_readOptions, m_family, toRocksDBSlice(_key), &value);
+    if (status.IsNotFound())
+        return std::string();
+
+    checkStatus(status);
+    return value;
+}
+
+bool RocksDB::exists(Slice _key) const
+{
+    std::string value;
+    auto const status = m_instance->db().Get(m_readOptions, m_family, toRocksDBSlice(_key), &value);
+    if (status.IsNotFound())
+        return false;
+
+    checkStatus(status);
+    return true;
+}
+
+void RocksDB::insert(Slice _key, Slice _value)
+{
+    auto const status = m_instance->db().Put(
+        m_writeOptions, m_family, toRocksDBSlice(_key), toRocksDBSlice(_value));
+    checkStatus(status);
+}
+
+void RocksDB::kill(Slice _key)
+{
+    auto const status = m_instance->db().Delete(m_writeOptions, m_family, toRocksDBSlice(_key));
+    checkStatus(status);
+}
+
+std::unique_ptr<WriteBatchFace> RocksDB::createWriteBatch() const
+{
+    return std::unique_ptr<WriteBatchFace>(new RocksDBWriteBatch(m_family));
+}
+
+void RocksDB::commit(std::unique_ptr<WriteBatchFace> _batch)
+{
+    if (!_batch)
+    {
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("Cannot commit null batch"));
+    }
+    auto* batchPtr = dynamic_cast<RocksDBWriteBatch*>(_batch.get());
+    if (!batchPtr || batchPtr->family() != m_family)
+    {
+        BOOST_THROW_EXCEPTION(
+            DatabaseError() << errinfo_comment("Invalid batch type passed to RocksDB::commit"));
+    }
+    auto const status = m_instance->db().Write(m_writeOptions, &batchPtr->writeBatch());
+    checkStatus(status);
+}
+
+void RocksDB::forEach(std::function<bool(Slice, Slice)> f) const
+{
+    forEachFrom(Slice(), f);
+}
+
+void RocksDB::forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const
+{
+    std::unique_ptr<rocksdb::Iterator> itr(m_instance->db().NewIterator(m_readOptions, m_family));
+    if (itr == nullptr)
+    {
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("null iterator"));
+    }
+    auto keepIterating = true;
+    for (itr->Seek(rocksdb::Slice(_from.data(), _from.size())); keepIterating && itr->Valid(); itr->Next())
+    {
+        auto const dbKey = itr->key();
+        auto const dbValue = itr->value();
+        Slice const key(dbKey.data(), dbKey.size());
+        Slice const value(dbValue.data(), dbValue.size());
+        keepIterating = f(key, value);
+    }
+}
+
+void RocksDB::sync()
+{
+    checkStatus(m_instance->db().SyncWAL());
+}
+
+void RocksDB::remove(fs::path const& _path)
+{
+    if (!fs::exists(directoryOf(_path)))
+        return;
+    RocksDBInstance::open(directoryOf(_path), defaultDBOptions())->drop(_path.filename().string());
+}
+
+void RocksDB::rename(fs::path const& _from, fs::path const& _to)
+{
+    assert(directoryOf(_from) == directoryOf(_to));
+    if (!fs::exists(directoryOf(_from)))
+        return;
+
+    auto instance = RocksDBInstance::open(directoryOf(_from), defaultDBOptions());
+    std::string const from = _from.filename().string();
+    std::string const to = _to.filename().string();
+    if (!instance->hasFamily(from))
+        return;
+
+    // Column families cannot be renamed, so copy the records over in batches.
+    unsigned const c_batchRecords = 4096;
+    instance->drop(to);
+    rocksdb::ColumnFamilyHandle* source = instance->family(from);
+    rocksdb::ColumnFamilyHandle* target = instance->family(to);
+    std::unique_ptr<rocksdb::Iterator> itr(instance->db().NewIterator(defaultReadOptions(), source));
+    rocksdb::WriteBatch batch;
+    for (itr->SeekToFirst(); itr->Valid(); itr->Next())
+    {
+        batch.Put(target, itr->key(), itr->value());
+        if (batch.Count() >= c_batchRecords)
+        {
+            checkStatus(instance->db().Write(defaultWriteOptions(), &batch), _to);
+            batch.Clear();
+        }
+    }
+    checkStatus(itr->status(), _from);
+    checkStatus(instance->db().Write(defaultWriteOptions(), &batch), _to);
+    itr.reset();
+    instance->drop(from);
+}
+
+}  // namespace db
+}  // namespace dev
@@ -0,0 +1,76 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "db.h"
+
+#include <boost/filesystem.hpp>
+#include <rocksdb/db.h>
+#include <rocksdb/write_batch.h>
+
+namespace dev
+{
+namespace db
+{
+class RocksDBInstance;
+
+/// A column family of a RocksDB database shared by every RocksDB opened in the same directory.
+/// A path such as `<chain>/12/extras` maps to the column family "extras" of the database in
+/// `<chain>/12/rocksdb`, so the extras and state of a chain share one block cache, write-ahead
+/// log and compaction pool.
+class RocksDB : public DatabaseFace
+{
+public:
+    static rocksdb::ReadOptions defaultReadOptions();
+    static rocksdb::WriteOptions defaultWriteOptions();
+    static rocksdb::Options defaultDBOptions();
+
+    explicit RocksDB(boost::filesystem::path const& _path,
+        rocksdb::ReadOptions _readOptions = defaultReadOptions(),
+        rocksdb::WriteOptions _writeOptions = defaultWriteOptions(),
+        rocksdb::Options _dbOptions = defaultDBOptions());
+    ~RocksDB();
+
+    std::string lookup(Slice _key) const override;
+    bool exists(Slice _key) const override;
+    void insert(Slice _key, Slice _value) override;
+    void kill(Slice _key) override;
+
+    std::unique_ptr<WriteBatchFace> createWriteBatch() const override;
+    void commit(std::unique_ptr<WriteBatchFace> _batch) override;
+
+    void forEach(std::function<bool(Slice, Slice)> f) const override;
+    void forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const override;
+
+    void sync() override;
+
+    /// Drops the column family behind @a _path. It must not be open.
+    static void remove(boost::filesystem::path const& _path);
+    /// Moves the contents of the column family behind @a _from to the one behind @a _to, which
+    /// must be in the same directory. Neither may be open.
+    static void rename(boost::filesystem::path const& _from, boost::filesystem::path const& _to);
+
+private:
+    std::shared_ptr<RocksDBInstance> m_instance;
+    rocksdb::ColumnFamilyHandle* m_family = nullptr;
+    rocksdb::ReadOptions const m_readOptions;
+    rocksdb::WriteOptions const m_writeOptions;
+};
+
+}  // namespace db
+}  // namespace dev
@@ -25,6 +25,7 @@
 #include <cstdlib>
 #include <cstring>
 #include "RLP.h"
+#include "SIMD.h"
 using namespace std;
 using namespace dev;
 
@@ -131,12 +132,6 @@ static inline void keccakf(void* state) {
 #define _(S) do { S } while (0)
 #define FOR(i, ST, L, S) \
   _(for (size_t i = 0; i < L; i += ST) { S; })
-#define mkapply_ds(NAME, S)                                          \
-  static inline void NAME(uint8_t* dst,                              \
-						  const uint8_t* src,                        \
-						  size_t len) {                              \
-	FOR(i, 1, len, S);                                               \
-  }
 #define mkapply_sd(NAME, S)                                          \
   static inline void NAME(const uint8_t* src,                        \
 						  uint8_t* dst,                              \
@@ -144,7 +139,10 @@ static inline void keccakf(void* state) {
 	FOR(i, 1, len, S);                                               \
   }
 
-mkapply_ds(xorin, dst[i] ^= src[i])  // xorin
+// Absorbs whole blocks and the padded tail; vectorised where the CPU allows.
+static inline void xorin(uint8_t* dst, const uint8_t* src, size_t len) {
+  simd::xorBytes(dst, src, len);
+}
 mkapply_sd(setout, dst[i] = src[i])  // setout
 
 #define P keccakf
@@ -0,0 +1,576 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SIMD.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DEV_SIMD_X86 1
+#include <immintrin.h>
+#define DEV_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define DEV_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DEV_SIMD_X86 0
+#endif
+
+namespace dev
+{
+namespace simd
+{
+namespace
+{
+unsigned const c_wordSize = 32;
+
+// Portable kernels: one lane at a time, every operation and width.
+
+template <class U>
+struct Lane
+{
+    using S = typename std::make_signed<U>::type;
+    static unsigned const bits = sizeof(U) * 8;
+
+    static U apply(LaneOp _op, U _a, U _b)
+    {
+        S const sa = static_cast<S>(_a);
+        S const sb = static_cast<S>(_b);
+        switch (_op)
+        {
+        case LaneOp::Add: return U(uint64_t(_a) + _b);
+        case LaneOp::Sub: return U(uint64_t(_a) - _b);
+        case LaneOp::Mul: return U(uint64_t(_a) * _b);
+        case LaneOp::Div: return _b ? U(_a / _b) : 0;
+        case LaneOp::Mod: return _b ? U(_a % _b) : 0;
+        case LaneOp::SDiv:
+            if (!sb)
+                return 0;
+            if (sb == -1)
+                return U(0 - uint64_t(_a));
+            return U(sa / sb);
+        case LaneOp::SMod: return sb && sb != -1 ? U(sa % sb) : 0;
+        case LaneOp::Lt: return _a < _b;
+        case LaneOp::SLt: return sa < sb;
+        case LaneOp::Gt: return _a > _b;
+        case LaneOp::SGt: return sa > sb;
+        case LaneOp::Eq: return _a == _b;
+        case LaneOp::Zero: return _a == 0;
+        case LaneOp::And: return _a & _b;
+        case LaneOp::Or: return _a | _b;
+        case LaneOp::Xor: return _a ^ _b;
+        case LaneOp::Not: return U(~_a);
+        case LaneOp::Shl: return _b < bits ? U(uint64_t(_a) << _b) : 0;
+        case LaneOp::Shr: return _b < bits ? U(_a >> _b) : 0;
+        case LaneOp::Sar:
+            if (_b >= bits)
+                return sa < 0 ? std::numeric_limits<U>::max() : 0;
+            return U(sa >> _b);
+        case LaneOp::Rol:
+        case LaneOp::Ror:
+        {
+            unsigned r = _b % bits;
+            if (_op == LaneOp::Ror && r)
+                r = bits - r;
+            return r ? U(uint64_t(_a) << r | uint64_t(_a) >> (bits - r)) : _a;
+        }
+        case LaneOp::Count: break;
+        }
+        return 0;
+    }
+};
+
+template <LaneOp Op, class U>
+void scalarLanes(void* o_r, void const* _a, void const* _b)
+{
+    unsigned const count = c_wordSize / sizeof(U);
+    U a[count];
+    U b[count];
+    std::memcpy(a, _a, c_wordSize);
+    std::memcpy(b, _b, c_wordSize);
+    for (unsigned i = 0; i < count; ++i)
+        a[i] = Lane<U>::apply(Op, a[i], b[i]);
+    std::memcpy(o_r, a, c_wordSize);
+}
+
+template <unsigned Op>
+struct ScalarTable
+{
+    static void fill(Kernels& o_k)
+    {
+        o_k.lanes[Op][Lanes8] = scalarLanes<LaneOp(Op), uint8_t>;
+        o_k.lanes[Op][Lanes16] = scalarLanes<LaneOp(Op), uint16_t>;
+        o_k.lanes[Op][Lanes32] = scalarLanes<LaneOp(Op), uint32_t>;
+        o_k.lanes[Op][Lanes64] = scalarLanes<LaneOp(Op), uint64_t>;
+        ScalarTable<Op + 1>::fill(o_k);
+    }
+};
+
+template <>
+struct ScalarTable<unsigned(LaneOp::Count)>
+{
+    static void fill(Kernels&) {}
+};
+
+void scalarXorBytes(uint8_t* o_dst, uint8_t const* _src, size_t _size)
+{
+    size_t i = 0;
+    for (; i + 8 <= _size; i += 8)
+    {
+        uint64_t d;
+        uint64_t s;
+        std::memcpy(&d, o_dst + i, 8);
+        std::memcpy(&s, _src + i, 8);
+        d ^= s;
+        std::memcpy(o_dst + i, &d, 8);
+    }
+    for (; i < _size; ++i)
+        o_dst[i] ^= _src[i];
+}
+
+void scalarCopyZeroExtend(uint8_t* o_dst, size_t _dstSize, uint8_t const* _src, size_t _srcSize)
+{
+    size_t const n = std::min(_dstSize, _srcSize);
+    if (n)
+        std::memcpy(o_dst, _src, n);
+    if (_dstSize > n)
+        std::memset(o_dst + n, 0, _dstSize - n);
+}
+
+Kernels makeScalar()
+{
+    Kernels k;
+    ScalarTable<0>::fill(k);
+    k.xorBytes = scalarXorBytes;
+    k.copyZeroExtend = scalarCopyZeroExtend;
+    return k;
+}
+
+#if DEV_SIMD_X86
+
+// SSE4.2 kernels: a word is two 128-bit halves. Multiplication is only vectorised for 16 and
+// 32-bit lanes, and division, shifts and rotates stay on the portable kernels.
+
+template <LaneWidth W>
+struct Sse42;
+
+template <>
+struct Sse42<Lanes8>
+{
+    DEV_TARGET_SSE42 static __m128i add(__m128i _a, __m128i _b) { return _mm_add_epi8(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i sub(__m128i _a, __m128i _b) { return _mm_sub_epi8(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i eq(__m128i _a, __m128i _b) { return _mm_cmpeq_epi8(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i gt(__m128i _a, __m128i _b) { return _mm_cmpgt_epi8(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i splat(uint64_t _v) { return _mm_set1_epi8(char(_v)); }
+};
+
+template <>
+struct Sse42<Lanes16>
+{
+    DEV_TARGET_SSE42 static __m128i add(__m128i _a, __m128i _b) { return _mm_add_epi16(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i sub(__m128i _a, __m128i _b) { return _mm_sub_epi16(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i mul(__m128i _a, __m128i _b) { return _mm_mullo_epi16(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i eq(__m128i _a, __m128i _b) { return _mm_cmpeq_epi16(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i gt(__m128i _a, __m128i _b) { return _mm_cmpgt_epi16(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i splat(uint64_t _v) { return _mm_set1_epi16(short(_v)); }
+};
+
+template <>
+struct Sse42<Lanes32>
+{
+    DEV_TARGET_SSE42 static __m128i add(__m128i _a, __m128i _b) { return _mm_add_epi32(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i sub(__m128i _a, __m128i _b) { return _mm_sub_epi32(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i mul(__m128i _a, __m128i _b) { return _mm_mullo_epi32(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i eq(__m128i _a, __m128i _b) { return _mm_cmpeq_epi32(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i gt(__m128i _a, __m128i _b) { return _mm_cmpgt_epi32(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i splat(uint64_t _v) { return _mm_set1_epi32(int(_v)); }
+};
+
+template <>
+struct Sse42<Lanes64>
+{
+    DEV_TARGET_SSE42 static __m128i add(__m128i _a, __m128i _b) { return _mm_add_epi64(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i sub(__m128i _a, __m128i _b) { return _mm_sub_epi64(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i eq(__m128i _a, __m128i _b) { return _mm_cmpeq_epi64(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i gt(__m128i _a, __m128i _b) { return _mm_cmpgt_epi64(_a, _b); }
+    DEV_TARGET_SSE42 static __m128i splat(uint64_t _v) { return _mm_set1_epi64x(int64_t(_v)); }
+};
+
+/// Applies the lane operation Op to both halves of the words.
+template <LaneOp Op, LaneWidth W>
+DEV_TARGET_SSE42 __m128i sse42Apply(__m128i _a, __m128i _b)
+{
+    using V = Sse42<W>;
+    __m128i const one = V::splat(1);
+    __m128i const sign = V::splat(uint64_t(1) << ((8 << W) - 1));
+    switch (Op)
+    {
+    case LaneOp::Add: return V::add(_a, _b);
+    case LaneOp::Sub: return V::sub(_a, _b);
+    case LaneOp::Eq: return _mm_and_si128(V::eq(_a, _b), one);
+    case LaneOp::Zero: return _mm_and_si128(V::eq(_a, _mm_setzero_si128()), one);
+    case LaneOp::SGt: return _mm_and_si128(V::gt(_a, _b), one);
+    case LaneOp::SLt: return _mm_and_si128(V::gt(_b, _a), one);
+    case LaneOp::Gt:
+        return _mm_and_si128(V::gt(_mm_xor_si128(_a, sign), _mm_xor_si128(_b, sign)), one);
+    case LaneOp::Lt:
+        return _mm_and_si128(V::gt(_mm_xor_si128(_b, sign), _mm_xor_si128(_a, sign)), one);
+    case LaneOp::And: return _mm_and_si128(_a, _b);
+    case LaneOp::Or: return _mm_or_si128(_a, _b);
+    case LaneOp::Xor: return _mm_xor_si128(_a, _b);
+    case LaneOp::Not: return _mm_xor_si128(_a, _mm_cmpeq_epi8(_a, _a));
+    default: return _mm_setzero_si128();
+    }
+}
+
+template <LaneWidth W>
+DEV_TARGET_SSE42 __m128i sse42Mul(__m128i _a, __m128i _b)
+{
+    return Sse42<W>::mul(_a, _b);
+}
+
+template <__m128i (*Apply)(__m128i, __m128i)>
+DEV_TARGET_SSE42 void sse42Lanes(void* o_r, void const* _a, void const* _b)
+{
+    __m128i const* a = static_cast<__m128i const*>(_a);
+    __m128i const* b = static_cast<__m128i const*>(_b);
+    __m128i const lo = Apply(_mm_loadu_si128(a), _mm_loadu_si128(b));
+    __m128i const hi = Apply(_mm_loadu_si128(a + 1), _mm_loadu_si128(b + 1));
+    _mm_storeu_si128(static_cast<__m128i*>(o_r), lo);
+    _mm_storeu_si128(static_cast<__m128i*>(o_r) + 1, hi);
+}
+
+template <LaneOp Op, LaneWidth W>
+void setSse42(Kernels& o_k)
+{
+    o_k.lanes[unsigned(Op)][W] = sse42Lanes<sse42Apply<Op, W>>;
+}
+
+template <LaneWidth W>
+void setSse42Width(Kernels& o_k)
+{
+    setSse42<LaneOp::Add, W>(o_k);
+    setSse42<LaneOp::Sub, W>(o_k);
+    setSse42<LaneOp::Eq, W>(o_k);
+    setSse42<LaneOp::Zero, W>(o_k);
+    setSse42<LaneOp::Lt, W>(o_k);
+    setSse42<LaneOp::SLt, W>(o_k);
+    setSse42<LaneOp::Gt, W>(o_k);
+    setSse42<LaneOp::SGt, W>(o_k);
+    setSse42<LaneOp::And, W>(o_k);
+    setSse42<LaneOp::Or, W>(o_k);
+    setSse42<LaneOp::Xor, W>(o_k);
+    setSse42<LaneOp::Not, W>(o_k);
+}
+
+DEV_TARGET_SSE42 void sse42XorBytes(uint8_t* o_dst, uint8_t const* _src, size_t _size)
+{
+    size_t i = 0;
+    for (; i + 16 <= _size; i += 16)
+    {
+        __m128i* d = reinterpret_cast<__m128i*>(o_dst + i);
+        __m128i const* s = reinterpret_cast<__m128i const*>(_src + i);
+        _mm_storeu_si128(d, _mm_xor_si128(_mm_loadu_si128(d), _mm_loadu_si128(s)));
+    }
+    scalarXorBytes(o_dst + i, _src + i, _size - i);
+}
+
+DEV_TARGET_SSE42 void sse42CopyZeroExtend(
+    uint8_t* o_dst, size_t _dstSize, uint8_t const* _src, size_t _srcSize)
+{
+    size_t const n = std::min(_dstSize, _srcSize);
+    __m128i const zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o_dst + i),
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(_src + i)));
+    if (i < n && i + 16 <= _dstSize)
+    {
+        // Zero the vector holding the end of the source first, then copy the source tail over it.
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o_dst + i), zero);
+        std::memcpy(o_dst + i, _src + i, n - i);
+        i += 16;
+    }
+    else if (i < n)
+        return scalarCopyZeroExtend(o_dst + i, _dstSize - i, _src + i, n - i);
+    for (; i + 16 <= _dstSize; i += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o_dst + i), zero);
+    if (i < _dstSize)
+        std::memset(o_dst + i, 0, _dstSize - i);
+}
+
+Kernels makeSse42()
+{
+    Kernels k = makeScalar();
+    setSse42Width<Lanes8>(k);
+    setSse42Width<Lanes16>(k);
+    setSse42Width<Lanes32>(k);
+    setSse42Width<Lanes64>(k);
+    k.lanes[unsigned(LaneOp::Mul)][Lanes16] = sse42Lanes<sse42Mul<Lanes16>>;
+    k.lanes[unsigned(LaneOp::Mul)][Lanes32] = sse42Lanes<sse42Mul<Lanes32>>;
+    k.xorBytes = sse42XorBytes;
+    k.copyZeroExtend = sse42CopyZeroExtend;
+    return k;
+}
+
+// AVX2 kernels: a word is one 256-bit register; otherwise as for SSE4.2. Each one clears the
+// upper register halves before returning, as unoptimised builds don't, or every SSE instruction
+// run afterwards by the rest of the program pays for the dirty state.
+
+template <LaneWidth W>
+struct Avx2;
+
+template <>
+struct Avx2<Lanes8>
+{
+    DEV_TARGET_AVX2 static __m256i add(__m256i _a, __m256i _b) { return _mm256_add_epi8(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i sub(__m256i _a, __m256i _b) { return _mm256_sub_epi8(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i eq(__m256i _a, __m256i _b) { return _mm256_cmpeq_epi8(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i gt(__m256i _a, __m256i _b) { return _mm256_cmpgt_epi8(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i splat(uint64_t _v) { return _mm256_set1_epi8(char(_v)); }
+};
+
+template <>
+struct Avx2<Lanes16>
+{
+    DEV_TARGET_AVX2 static __m256i add(__m256i _a, __m256i _b) { return _mm256_add_epi16(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i sub(__m256i _a, __m256i _b) { return _mm256_sub_epi16(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i mul(__m256i _a, __m256i _b) { return _mm256_mullo_epi16(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i eq(__m256i _a, __m256i _b) { return _mm256_cmpeq_epi16(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i gt(__m256i _a, __m256i _b) { return _mm256_cmpgt_epi16(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i splat(uint64_t _v) { return _mm256_set1_epi16(short(_v)); }
+};
+
+template <>
+struct Avx2<Lanes32>
+{
+    DEV_TARGET_AVX2 static __m256i add(__m256i _a, __m256i _b) { return _mm256_add_epi32(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i sub(__m256i _a, __m256i _b) { return _mm256_sub_epi32(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i mul(__m256i _a, __m256i _b) { return _mm256_mullo_epi32(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i eq(__m256i _a, __m256i _b) { return _mm256_cmpeq_epi32(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i gt(__m256i _a, __m256i _b) { return _mm256_cmpgt_epi32(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i splat(uint64_t _v) { return _mm256_set1_epi32(int(_v)); }
+};
+
+template <>
+struct Avx2<Lanes64>
+{
+    DEV_TARGET_AVX2 static __m256i add(__m256i _a, __m256i _b) { return _mm256_add_epi64(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i sub(__m256i _a, __m256i _b) { return _mm256_sub_epi64(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i eq(__m256i _a, __m256i _b) { return _mm256_cmpeq_epi64(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i gt(__m256i _a, __m256i _b) { return _mm256_cmpgt_epi64(_a, _b); }
+    DEV_TARGET_AVX2 static __m256i splat(uint64_t _v) { return _mm256_set1_epi64x(int64_t(_v)); }
+};
+
+template <LaneOp Op, LaneWidth W>
+DEV_TARGET_AVX2 __m256i avx2Apply(__m256i _a, __m256i _b)
+{
+    using V = Avx2<W>;
+    __m256i const one = V::splat(1);
+    __m256i const sign = V::splat(uint64_t(1) << ((8 << W) - 1));
+    switch (Op)
+    {
+    case LaneOp::Add: return V::add(_a, _b);
+    case LaneOp::Sub: return V::sub(_a, _b);
+    case LaneOp::Eq: return _mm256_and_si256(V::eq(_a, _b), one);
+    case LaneOp::Zero: return _mm256_and_si256(V::eq(_a, _mm256_setzero_si256()), one);
+    case LaneOp::SGt: return _mm256_and_si256(V::gt(_a, _b), one);
+    case LaneOp::SLt: return _mm256_and_si256(V::gt(_b, _a), one);
+    case LaneOp::Gt:
+        return _mm256_and_si256(V::gt(_mm256_xor_si256(_a, sign), _mm256_xor_si256(_b, sign)), one);
+    case LaneOp::Lt:
+        return _mm256_and_si256(V::gt(_mm256_xor_si256(_b, sign), _mm256_xor_si256(_a, sign)), one);
+    case LaneOp::And: return _mm256_and_si256(_a, _b);
+    case LaneOp::Or: return _mm256_or_si256(_a, _b);
+    case LaneOp::Xor: return _mm256_xor_si256(_a, _b);
+    case LaneOp::Not: return _mm256_xor_si256(_a, _mm256_cmpeq_epi8(_a, _a));
+    default: return _mm256_setzero_si256();
+    }
+}
+
+template <LaneWidth W>
+DEV_TARGET_AVX2 __m256i avx2Mul(__m256i _a, __m256i _b)
+{
+    return Avx2<W>::mul(_a, _b);
+}
+
+template <__m256i (*Apply)(__m256i, __m256i)>
+DEV_TARGET_AVX2 void avx2Lanes(void* o_r, void const* _a, void const* _b)
+{
+    __m256i const r = Apply(_mm256_loadu_si256(static_cast<__m256i const*>(_a)),
+        _mm256_loadu_si256(static_cast<__m256i const*>(_b)));
+    _mm256_storeu_si256(static_cast<__m256i*>(o_r), r);
+    _mm256_zeroupper();
+}
+
+template <LaneOp Op, LaneWidth W>
+void setAvx2(Kernels& o_k)
+{
+    o_k.lanes[unsigned(Op)][W] = avx2Lanes<avx2Apply<Op, W>>;
+}
+
+template <LaneWidth W>
+void setAvx2Width(Kernels& o_k)
+{
+    setAvx2<LaneOp::Add, W>(o_k);
+    setAvx2<LaneOp::Sub, W>(o_k);
+    setAvx2<LaneOp::Eq, W>(o_k);
+    setAvx2<LaneOp::Zero, W>(o_k);
+    setAvx2<LaneOp::Lt, W>(o_k);
+    setAvx2<LaneOp::SLt, W>(o_k);
+    setAvx2<LaneOp::Gt, W>(o_k);
+    setAvx2<LaneOp::SGt, W>(o_k);
+    setAvx2<LaneOp::And, W>(o_k);
+    setAvx2<LaneOp::Or, W>(o_k);
+    setAvx2<LaneOp::Xor, W>(o_k);
+    setAvx2<LaneOp::Not, W>(o_k);
+}
+
+DEV_TARGET_AVX2 void avx2XorBytes(uint8_t* o_dst, uint8_t const* _src, size_t _size)
+{
+    size_t i = 0;
+    for (; i + 32 <= _size; i += 32)
+    {
+        __m256i* d = reinterpret_cast<__m256i*>(o_dst + i);
+        __m256i const* s = reinterpret_cast<__m256i const*>(_src + i);
+        _mm256_storeu_si256(d, _mm256_xor_si256(_mm256_loadu_si256(d), _mm256_loadu_si256(s)));
+    }
+    _mm256_zeroupper();
+    sse42XorBytes(o_dst + i, _src + i, _size - i);
+}
+
+DEV_TARGET_AVX2 void avx2CopyZeroExtend(
+    uint8_t* o_dst, size_t _dstSize, uint8_t const* _src, size_t _srcSize)
+{
+    size_t const n = std::min(_dstSize, _srcSize);
+    __m256i const zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o_dst + i),
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(_src + i)));
+    if (i < n && i + 32 <= _dstSize)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o_dst + i), zero);
+        _mm256_zeroupper();
+        std::memcpy(o_dst + i, _src + i, n - i);
+        i += 32;
+    }
+    else if (i < n)
+    {
+        _mm256_zeroupper();
+        return sse42CopyZeroExtend(o_dst + i, _dstSize - i, _src + i, n - i);
+    }
+    for (; i + 32 <= _dstSize; i += 32)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o_dst + i), zero);
+    _mm256_zeroupper();
+    if (i < _dstSize)
+        std::memset(o_dst + i, 0, _dstSize - i);
+}
+
+Kernels makeAvx2()
+{
+    Kernels k = makeSse42();
+    setAvx2Width<Lanes8>(k);
+    setAvx2Width<Lanes16>(k);
+    setAvx2Width<Lanes32>(k);
+    setAvx2Width<Lanes64>(k);
+    k.lanes[unsigned(LaneOp::Mul)][Lanes16] = avx2Lanes<avx2Mul<Lanes16>>;
+    k.lanes[unsigned(LaneOp::Mul)][Lanes32] = avx2Lanes<avx2Mul<Lanes32>>;
+    k.xorBytes = avx2XorBytes;
+    k.copyZeroExtend = avx2CopyZeroExtend;
+    return k;
+}
+
+#endif
+
+std::atomic<Kernels const*> g_active{nullptr};
+
+}  // namespace
+
+Isa detectedIsa()
+{
+#if DEV_SIMD_X86
+    static Isa const s_isa = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return Isa::AVX2;
+        if (__builtin_cpu_supports("sse4.2"))
+            return Isa::SSE42;
+        return Isa::Scalar;
+    }();
+    return s_isa;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+Kernels const& kernels(Isa _isa)
+{
+    static Kernels const s_scalar = makeScalar();
+#if DEV_SIMD_X86
+    static Kernels const s_sse42 = makeSse42();
+    static Kernels const s_avx2 = makeAvx2();
+    if (_isa == Isa::AVX2)
+        return s_avx2;
+    if (_isa == Isa::SSE42)
+        return s_sse42;
+#else
+    (void)_isa;
+#endif
+    return s_scalar;
+}
+
+Kernels const& kernels()
+{
+    Kernels const* k = g_active.load(std::memory_order_acquire);
+    if (!k)
+    {
+        k = &kernels(detectedIsa());
+        g_active.store(k, std::memory_order_release);
+    }
+    return *k;
+}
+
+Isa activeIsa()
+{
+    Kernels const& k = kernels();
+    for (Isa isa : {Isa::AVX2, Isa::SSE42})
+        if (isa <= detectedIsa() && &kernels(isa) == &k)
+            return isa;
+    return Isa::Scalar;
+}
+
+void setIsa(Isa _isa)
+{
+    g_active.store(&kernels(std::min(_isa, detectedIsa())), std::memory_order_release);
+}
+
+char const* isaName(Isa _isa)
+{
+    switch (_isa)
+    {
+    case Isa::AVX2: return "avx2";
+    case Isa::SSE42: return "sse4.2";
+    case Isa::Scalar: break;
+    }
+    return "scalar";
+}
+
+}  // namespace simd
+}  // namespace dev
@@ -0,0 +1,124 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file SIMD.h
+ * Lane-wise kernels over 32-byte words and byte ranges, dispatched at runtime to the best
+ * instruction set the CPU supports.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dev
+{
+namespace simd
+{
+enum class Isa
+{
+    Scalar,
+    SSE42,
+    AVX2
+};
+
+/// Lane widths of a 32-byte word, as log2 of the lane size in bytes.
+enum LaneWidth
+{
+    Lanes8,
+    Lanes16,
+    Lanes32,
+    Lanes64,
+    LaneWidthCount
+};
+
+/// Lane-wise operations. Signed variants interpret each lane as two's complement; comparisons
+/// and Zero yield 1 or 0 per lane; division and remainder by zero yield 0, as the EVM does.
+enum class LaneOp
+{
+    Add,
+    Sub,
+    Mul,
+    Div,
+    SDiv,
+    Mod,
+    SMod,
+    Lt,
+    SLt,
+    Gt,
+    SGt,
+    Eq,
+    Zero,
+    And,
+    Or,
+    Xor,
+    Not,
+    Shl,
+    Shr,
+    Sar,
+    Rol,
+    Ror,
+    Count
+};
+
+/// A kernel reading two 32-byte words @a _a and @a _b and writing the 32-byte word @a o_r.
+/// Unary operations ignore @a _b. The words may alias one another.
+using WordKernel = void (*)(void* o_r, void const* _a, void const* _b);
+
+struct Kernels
+{
+    WordKernel lanes[static_cast<unsigned>(LaneOp::Count)][LaneWidthCount];
+    /// o_dst[i] ^= _src[i] for i < _size.
+    void (*xorBytes)(uint8_t* o_dst, uint8_t const* _src, size_t _size);
+    /// Copies @a _srcSize bytes to @a o_dst and zero-fills it up to @a _dstSize.
+    void (*copyZeroExtend)(uint8_t* o_dst, size_t _dstSize, uint8_t const* _src, size_t _srcSize);
+};
+
+/// @returns the best instruction set supported by this CPU and build.
+Isa detectedIsa();
+
+/// @returns the instruction set the kernels currently dispatch to.
+Isa activeIsa();
+
+/// Selects the kernels for @a _isa, capped at detectedIsa(). Meant for tests and benchmarks;
+/// not safe to call while other threads use the kernels.
+void setIsa(Isa _isa);
+
+char const* isaName(Isa _isa);
+
+/// @returns the kernel table of the active instruction set.
+Kernels const& kernels();
+
+/// @returns the kernel table of @a _isa, which must not exceed detectedIsa().
+Kernels const& kernels(Isa _isa);
+
+inline WordKernel laneKernel(LaneOp _op, LaneWidth _width)
+{
+    return kernels().lanes[static_cast<unsigned>(_op)][_width];
+}
+
+inline void xorBytes(uint8_t* o_dst, uint8_t const* _src, size_t _size)
+{
+    kernels().xorBytes(o_dst, _src, _size);
+}
+
+inline void copyZeroExtend(uint8_t* o_dst, size_t _dstSize, uint8_t const* _src, size_t _srcSize)
+{
+    kernels().copyZeroExtend(o_dst, _dstSize, _src, _srcSize);
+}
+
+}  // namespace simd
+}  // namespace dev
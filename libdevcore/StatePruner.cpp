@@ -0,0 +1,238 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file StatePruner.cpp
+ */
+
+#include "StatePruner.h"
+#include "CommonData.h"
+#include "MemoryDB.h"
+#include "RLP.h"
+
+#include <algorithm>
+
+namespace dev
+{
+namespace
+{
+// Keys next to the 32-byte nodes and the 33-byte aux entries ending in 255.
+byte const c_recordSuffix = 254;
+char const c_eraPrefix = 'E';
+char const c_journalPrefix = 'J';
+char const* const c_metaKey = "statePruner";
+
+inline db::Slice toSlice(bytes const& _b)
+{
+    return db::Slice(reinterpret_cast<char const*>(_b.data()), _b.size());
+}
+
+inline db::Slice toSlice(h256 const& _h)
+{
+    return db::Slice(reinterpret_cast<char const*>(_h.data()), _h.size);
+}
+
+/// The reference count of node @a _h, stored as [count, number of the block which created it].
+bytes recordKey(h256 const& _h)
+{
+    bytes ret = _h.asBytes();
+    ret.push_back(c_recordSuffix);
+    return ret;
+}
+
+/// The hashes of the blocks journaled with number @a _number.
+bytes eraKey(unsigned _number)
+{
+    bytes ret(1, c_eraPrefix);
+    for (int i = 7; i >= 0; --i)
+        ret.push_back(byte(uint64_t(_number) >> (i * 8)));
+    return ret;
+}
+
+/// The nodes block @a _id added, as [hash, count] pairs, and the ones it removed.
+bytes journalKey(unsigned _number, h256 const& _id)
+{
+    bytes ret = eraKey(_number);
+    ret[0] = c_journalPrefix;
+    ret += _id.asBytes();
+    return ret;
+}
+
+}  // namespace
+
+StatePruner::StatePruner(std::shared_ptr<db::DatabaseFace> _db, unsigned _history, unsigned _checkpointInterval):
+    m_db(std::move(_db)),
+    m_history(std::max(_history, 1u)),
+    m_checkpointInterval(_checkpointInterval)
+{
+    std::string const meta = m_db->lookup(db::Slice(c_metaKey));
+    if (!meta.empty())
+    {
+        RLP const r(meta);
+        m_started = true;
+        m_settled = r[0].toInt<unsigned>();
+        m_lastEra = r[1].toInt<unsigned>();
+    }
+}
+
+void StatePruner::journal(db::WriteBatchFace& io_batch,
+    std::unordered_map<h256, std::pair<std::string, unsigned>> const& _main, h256s const& _deaths,
+    Era const* _era)
+{
+    if (_era && m_started && _era->number <= m_settled)
+    {
+        // Settling has passed it, so nothing would release references it took. Its new nodes
+        // are kept for good, like those written before pruning was enabled.
+        dbdebug << "Not journaling block" << _era->id << "#" << _era->number << "below the settled" << m_settled;
+        return;
+    }
+
+    unsigned const born = _era ? _era->number : m_lastEra;
+    unsigned added = 0;
+    for (auto const& i: _main)
+        if (i.second.second)
+        {
+            addReferences(io_batch, i.first, i.second.second, born);
+            ++added;
+        }
+
+    if (!_era)
+        return;
+
+    if (!m_started)
+    {
+        m_started = true;
+        m_settled = _era->number ? _era->number - 1 : 0;
+    }
+    m_lastEra = std::max(m_lastEra, _era->number);
+
+    RLPStream journal(2);
+    journal.appendList(added);
+    for (auto const& i: _main)
+        if (i.second.second)
+            journal.appendList(2) << i.first << i.second.second;
+    journal << _deaths;
+    io_batch.insert(toSlice(journalKey(_era->number, _era->id)), toSlice(journal.out()));
+
+    bytes const key = eraKey(_era->number);
+    std::string const index = m_db->lookup(toSlice(key));
+    h256s ids = index.empty() ? h256s() : RLP(index).toVector<h256>();
+    if (std::find(ids.begin(), ids.end(), _era->id) == ids.end())
+    {
+        ids.push_back(_era->id);
+        io_batch.insert(toSlice(key), toSlice(rlp(ids)));
+    }
+    writeMeta(io_batch);
+}
+
+void StatePruner::addReferences(db::WriteBatchFace& io_batch, h256 const& _h, unsigned _count, unsigned _born)
+{
+    bytes const key = recordKey(_h);
+    std::string const record = m_db->lookup(toSlice(key));
+    if (!record.empty())
+    {
+        RLP const r(record);
+        io_batch.insert(toSlice(key), toSlice(rlpList(r[0].toInt<unsigned>() + _count, r[1].toInt<unsigned>())));
+    }
+    else if (!m_db->exists(toSlice(_h)))
+        io_batch.insert(toSlice(key), toSlice(rlpList(_count, _born)));
+    // Otherwise it was written before pruning was enabled and is never deleted.
+}
+
+void StatePruner::canonicalise(unsigned _head, std::function<h256(unsigned)> const& _canonical)
+{
+    Guard l(x_pruner);
+    if (!m_started)
+        return;
+
+    while (m_settled + m_history < _head)
+    {
+        unsigned const number = m_settled + 1;
+        auto batch = m_db->createWriteBatch();
+        settle(*batch, number, _canonical(number));
+        m_settled = number;
+        writeMeta(*batch);
+        m_db->commit(std::move(batch));
+    }
+}
+
+void StatePruner::settle(db::WriteBatchFace& io_batch, unsigned _number, h256 const& _canonical)
+{
+    bytes const key = eraKey(_number);
+    std::string const index = m_db->lookup(toSlice(key));
+    if (index.empty())
+        return;
+    io_batch.kill(toSlice(key));
+
+    // Per node: removals by the canonical block and additions by the others.
+    std::unordered_map<h256, std::pair<unsigned, unsigned>> released;
+    for (auto const& id: RLP(index).toVector<h256>())
+    {
+        bytes const journalK = journalKey(_number, id);
+        std::string const journal = m_db->lookup(toSlice(journalK));
+        io_batch.kill(toSlice(journalK));
+        if (journal.empty())
+            continue;
+
+        RLP const r(journal);
+        if (id == _canonical)
+            for (auto const& h: r[1].toVector<h256>())
+                ++released[h].first;
+        else
+            for (auto const& added: r[0])
+                released[added[0].toHash<h256>()].second += added[1].toInt<unsigned>();
+    }
+
+    unsigned pruned = 0;
+    for (auto const& i: released)
+    {
+        bytes const recordK = recordKey(i.first);
+        std::string const record = m_db->lookup(toSlice(recordK));
+        if (record.empty())
+            continue;
+
+        RLP const r(record);
+        unsigned const count = r[0].toInt<unsigned>();
+        unsigned const born = r[1].toInt<unsigned>();
+        unsigned const drop = (checkpointed(born, _number) ? 0 : i.second.first) + i.second.second;
+        if (!drop)
+            continue;
+        if (count > drop)
+            io_batch.insert(toSlice(recordK), toSlice(rlpList(count - drop, born)));
+        else
+        {
+            io_batch.kill(toSlice(i.first));
+            io_batch.kill(toSlice(recordK));
+            ++pruned;
+        }
+    }
+    m_prunedNodes += pruned;
+    dbdebug << "Settled block number" << _number << ": pruned" << pruned << "of" << released.size() << "nodes";
+}
+
+bool StatePruner::checkpointed(unsigned _born, unsigned _number) const
+{
+    if (!m_checkpointInterval || !_number)
+        return false;
+    unsigned const lastCheckpoint = (_number - 1) / m_checkpointInterval * m_checkpointInterval;
+    return _born <= lastCheckpoint;
+}
+
+void StatePruner::writeMeta(db::WriteBatchFace& io_batch) const
+{
+    io_batch.insert(db::Slice(c_metaKey), toSlice(rlpList(m_settled, m_lastEra)));
+}
+
+}
@@ -0,0 +1,98 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file StatePruner.h
+ * Reference-counted deletion of state trie nodes that no kept block state uses any more.
+ */
+
+#pragma once
+
+#include "Common.h"
+#include "FixedHash.h"
+#include "Guards.h"
+#include "db.h"
+
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+
+namespace dev
+{
+
+/**
+ * Keeps the state of the last `history` blocks, and of every `checkpointInterval`th block, and
+ * deletes every other trie node once it falls out of that window.
+ *
+ * Each node written while pruning gets an on-disk reference count next to it; nodes written
+ * before pruning was enabled have none and are kept for good. Each block's commit is journaled
+ * with the nodes it added and the ones it removed. Once a block number is `history` blocks
+ * behind the head, the canonical block's removals are applied and the additions of the other
+ * blocks of that number are undone; nodes whose count drops to zero are deleted.
+ *
+ * A removal is not applied to a node which already existed at the last checkpoint, so
+ * checkpoint states stay complete. Shared by every copy of an OverlayDB.
+ */
+class StatePruner
+{
+public:
+    /// The block a commit is journaled under.
+    struct Era
+    {
+        unsigned number;
+        h256 id;
+    };
+
+    StatePruner(std::shared_ptr<db::DatabaseFace> _db, unsigned _history, unsigned _checkpointInterval);
+
+    unsigned history() const { return m_history; }
+    unsigned checkpointInterval() const { return m_checkpointInterval; }
+
+    /// Must be held from journal() until the batch passed to it is committed.
+    std::unique_lock<Mutex> guard() { return std::unique_lock<Mutex>(x_pruner); }
+
+    /// Adds the references of the nodes in @a _main, and the journal of @a _era if given, to
+    /// @a io_batch. @a _deaths are the nodes the commit removed from the database. Does nothing
+    /// for an era at or below the last one settled.
+    void journal(db::WriteBatchFace& io_batch,
+        std::unordered_map<h256, std::pair<std::string, unsigned>> const& _main,
+        h256s const& _deaths, Era const* _era);
+
+    /// Settles every journaled block number which is now at least history() behind @a _head.
+    /// @a _canonical gives the hash of the canonical block of a number.
+    void canonicalise(unsigned _head, std::function<h256(unsigned)> const& _canonical);
+
+    /// @returns the number of nodes deleted since this was created.
+    uint64_t prunedNodes() const { return m_prunedNodes; }
+
+private:
+    void addReferences(db::WriteBatchFace& io_batch, h256 const& _h, unsigned _count, unsigned _born);
+    void settle(db::WriteBatchFace& io_batch, unsigned _number, h256 const& _canonical);
+    /// @returns true if a node created at era @a _born must outlive removal at @a _number.
+    bool checkpointed(unsigned _born, unsigned _number) const;
+    void writeMeta(db::WriteBatchFace& io_batch) const;
+
+    std::shared_ptr<db::DatabaseFace> m_db;
+    unsigned const m_history;
+    unsigned const m_checkpointInterval;
+
+    Mutex x_pruner;
+    bool m_started = false;        ///< Whether anything was journaled yet.
+    unsigned m_settled = 0;        ///< The last block number settled.
+    unsigned m_lastEra = 0;        ///< The highest block number journaled.
+    std::atomic<uint64_t> m_prunedNodes{0};
+};
+
+}
@@ -18,10 +18,17 @@
 #include "TrieHash.h"
 #include "TrieCommon.h"
 #include "TrieDB.h"	// @TODO replace ASAP!
+#include "WorkerPool.h"
 
 namespace dev
 {
 
+namespace
+{
+/// Branches none of whose subtries has this many items are hashed on the thread which reaches them.
+size_t const c_minParallelItems = 128;
+}
+
 void hash256aux(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, RLPStream& _rlp);
 
 void hash256rlp(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, RLPStream& _rlp)
@@ -59,15 +66,42 @@ void hash256rlp(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_i
 			auto b = _begin;
 			if (_preLen == b->first.size())
 				++b;
+			HexMap::const_iterator begins[16];
+			HexMap::const_iterator ends[16];
+			bool large = false;
 			for (auto i = 0; i < 16; ++i)
 			{
-				auto n = b;
-				for (; n != _end && n->first[_preLen] == i; ++n) {}
-				if (b == n)
-					_rlp << "";
-				else
-					hash256aux(_s, b, n, _preLen + 1, _rlp);
-				b = n;
+				auto n = begins[i] = i ? ends[i - 1] : b;
+				size_t items = 0;
+				for (; n != _end && n->first[_preLen] == i; ++n, ++items) {}
+				ends[i] = n;
+				large = large || items >= c_minParallelItems;
+			}
+
+			if (!large)
+				for (auto i = 0; i < 16; ++i)
+				{
+					if (begins[i] == ends[i])
+						_rlp << "";
+					else
+						hash256aux(_s, begins[i], ends[i], _preLen + 1, _rlp);
+				}
+			else
+			{
+				// The subtries are shared with the helper threads; their results are put in place in order afterwards.
+				bytes hashed[16];
+				WorkerPool::shared().forEach(16, 1, [&](size_t i) {
+					if (begins[i] == ends[i])
+						return;
+					RLPStream s;
+					hash256aux(_s, begins[i], ends[i], _preLen + 1, s);
+					s.swapOut(hashed[i]);
+				});
+				for (auto i = 0; i < 16; ++i)
+					if (hashed[i].empty())
+						_rlp << "";
+					else
+						_rlp.appendRaw(hashed[i]);
 			}
 			if (_preLen == _begin->first.size())
 				_rlp << _begin->second;
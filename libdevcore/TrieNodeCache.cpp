@@ -0,0 +1,124 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file TrieNodeCache.cpp
+ */
+
+#include "TrieNodeCache.h"
+
+namespace dev
+{
+
+namespace
+{
+/// Bytes an entry takes besides its node: the key, the list node and the index bucket.
+size_t const c_entryOverhead = 96;
+
+size_t entrySize(std::string const& _node)
+{
+    return _node.size() + c_entryOverhead;
+}
+}
+
+TrieNodeCache::TrieNodeCache(size_t _capacity):
+    m_shardCapacity(_capacity / c_shards)
+{}
+
+TrieNodeCache& TrieNodeCache::get()
+{
+    static TrieNodeCache s_cache(64 * 1024 * 1024);
+    return s_cache;
+}
+
+std::string TrieNodeCache::lookup(h256 const& _h)
+{
+    Shard& shard = shardOf(_h);
+    {
+        Guard l(shard.x_entries);
+        auto it = shard.index.find(_h);
+        if (it != shard.index.end())
+        {
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            ++m_hits;
+            return it->second->second;
+        }
+    }
+    ++m_misses;
+    return std::string();
+}
+
+void TrieNodeCache::insert(h256 const& _h, std::string const& _node)
+{
+    if (_node.empty() || entrySize(_node) > m_shardCapacity)
+        return;
+
+    Shard& shard = shardOf(_h);
+    Guard l(shard.x_entries);
+    if (shard.index.count(_h))
+        return;
+    shard.entries.emplace_front(_h, _node);
+    shard.index[_h] = shard.entries.begin();
+    shard.used += entrySize(_node);
+    evict(shard);
+}
+
+void TrieNodeCache::setCapacity(size_t _capacity)
+{
+    m_shardCapacity = _capacity / c_shards;
+    for (Shard& shard: m_shards)
+    {
+        Guard l(shard.x_entries);
+        evict(shard);
+    }
+}
+
+void TrieNodeCache::clear()
+{
+    for (Shard& shard: m_shards)
+    {
+        Guard l(shard.x_entries);
+        shard.entries.clear();
+        shard.index.clear();
+        shard.used = 0;
+    }
+}
+
+db::DatabaseCacheStats TrieNodeCache::stats() const
+{
+    db::DatabaseCacheStats ret;
+    ret.hits = m_hits;
+    ret.misses = m_misses;
+    ret.capacity = m_shardCapacity * c_shards;
+    for (Shard const& shard: m_shards)
+    {
+        Guard l(shard.x_entries);
+        ret.used += shard.used;
+    }
+    return ret;
+}
+
+void TrieNodeCache::evict(Shard& _shard)
+{
+    while (_shard.used > m_shardCapacity)
+    {
+        auto const& last = _shard.entries.back();
+        _shard.used -= entrySize(last.second);
+        _shard.index.erase(last.first);
+        _shard.entries.pop_back();
+    }
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file TrieNodeCache.h
+ * Process-wide cache of state trie nodes read from disk.
+ */
+
+#pragma once
+
+#include "FixedHash.h"
+#include "Guards.h"
+#include "db.h"
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <unordered_map>
+
+namespace dev
+{
+
+/**
+ * Least-recently-used cache of trie nodes keyed by their hash, bounded in bytes.
+ *
+ * A node's hash fixes its content, so one cache can serve every OverlayDB of the process and
+ * entries never go stale. It is split into shards with a lock each so that concurrent States
+ * rarely wait on each other. A capacity of 0 disables it.
+ */
+class TrieNodeCache
+{
+public:
+    explicit TrieNodeCache(size_t _capacity);
+
+    /// The cache shared by the state databases of this process.
+    static TrieNodeCache& get();
+
+    /// @returns the node hashing to @a _h, or an empty string if it is not cached.
+    std::string lookup(h256 const& _h);
+    void insert(h256 const& _h, std::string const& _node);
+
+    void setCapacity(size_t _capacity);
+    void clear();
+
+    db::DatabaseCacheStats stats() const;
+
+private:
+    static unsigned const c_shards = 16;
+
+    struct Shard
+    {
+        mutable Mutex x_entries;
+        /// Most recently used first.
+        std::list<std::pair<h256, std::string>> entries;
+        std::unordered_map<h256, std::list<std::pair<h256, std::string>>::iterator> index;
+        size_t used = 0;
+    };
+
+    Shard& shardOf(h256 const& _h) { return m_shards[_h[0] % c_shards]; }
+    /// Drops the least recently used entries of @a _shard until it fits. Needs its lock.
+    void evict(Shard& _shard);
+
+    std::array<Shard, c_shards> m_shards;
+    std::atomic<size_t> m_shardCapacity;
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+};
+
+}
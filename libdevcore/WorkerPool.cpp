@@ -0,0 +1,133 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "WorkerPool.h"
+#include "CommonData.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+namespace dev
+{
+struct WorkerPool::Batch
+{
+    Batch(size_t _count, function<void(size_t)> const& _f): count(_count), f(_f) {}
+
+    /// Calls f for unclaimed indices until none is left.
+    void work();
+
+    size_t const count;
+    function<void(size_t)> const& f;  ///< Only called for claimed indices, it goes away once all are done.
+    atomic<size_t> next{0};
+    atomic<size_t> done{0};
+    size_t helpers = 0;               ///< Helpers still to join in. Guarded by x_batches.
+    Mutex x_done;
+    condition_variable finished;      ///< Signaled when done reaches count.
+};
+
+void WorkerPool::Batch::work()
+{
+    for (size_t i = next++; i < count; i = next++)
+    {
+        f(i);
+        if (++done == count)
+        {
+            Guard l(x_done);
+            finished.notify_all();
+        }
+    }
+}
+
+WorkerPool& WorkerPool::shared()
+{
+    static WorkerPool s_pool(max(thread::hardware_concurrency(), 1U) - 1U);
+    return s_pool;
+}
+
+WorkerPool::WorkerPool(unsigned _helpers)
+{
+    for (unsigned i = 0; i < _helpers; ++i)
+        m_helpers.emplace_back([=]() {
+            setThreadName("helper" + toString(i));
+            helperBody();
+        });
+}
+
+WorkerPool::~WorkerPool()
+{
+    DEV_GUARDED(x_batches)
+        m_stopping = true;
+    m_ready.notify_all();
+    for (auto& h: m_helpers)
+        h.join();
+}
+
+void WorkerPool::forEach(size_t _count, size_t _grain, function<void(size_t)> const& _f)
+{
+    if (!_count)
+        return;
+
+    auto batch = make_shared<Batch>(_count, _f);
+    size_t const threads = min<size_t>(m_helpers.size() + 1, _count / max<size_t>(_grain, 1));
+    if (threads > 1)
+    {
+        DEV_GUARDED(x_batches)
+        {
+            batch->helpers = threads - 1;
+            m_batches.push_back(batch);
+        }
+        m_ready.notify_all();
+    }
+
+    batch->work();
+    {
+        unique_lock<Mutex> l(batch->x_done);
+        batch->finished.wait(l, [&]() { return batch->done == batch->count; });
+    }
+
+    // helpers that did not get to it before all items were claimed have nothing left to do
+    if (threads > 1)
+        DEV_GUARDED(x_batches)
+        {
+            auto it = find(m_batches.begin(), m_batches.end(), batch);
+            if (it != m_batches.end())
+                m_batches.erase(it);
+        }
+}
+
+void WorkerPool::helperBody()
+{
+    while (true)
+    {
+        shared_ptr<Batch> batch;
+        {
+            unique_lock<Mutex> l(x_batches);
+            m_ready.wait(l, [&]() { return !m_batches.empty() || m_stopping; });
+            if (m_stopping)
+                return;
+            batch = m_batches.front();
+            if (!--batch->helpers)
+                m_batches.pop_front();
+        }
+        batch->work();
+    }
+}
+
+}
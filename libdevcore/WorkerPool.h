@@ -0,0 +1,69 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file WorkerPool.h
+ * Helper threads, started once, that share short bursts of independent work with the threads
+ * that need it done.
+ */
+
+#pragma once
+
+#include "Guards.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace dev
+{
+/**
+ * @brief A fixed set of helper threads joining callers in working through batches of independent
+ * items. The caller always works on its own batch too, so a batch completes even while every
+ * helper is busy with another one.
+ * @threadsafe
+ */
+class WorkerPool
+{
+public:
+    /// The pool of the whole process, with one helper fewer than there are cores.
+    static WorkerPool& shared();
+
+    explicit WorkerPool(unsigned _helpers);
+    ~WorkerPool();
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    unsigned helpers() const { return m_helpers.size(); }
+
+    /// Calls @a _f with every index below @a _count and returns once all of the calls have.
+    /// Helpers join in only as long as each thread gets at least @a _grain items. @a _f must not throw.
+    void forEach(size_t _count, size_t _grain, std::function<void(size_t)> const& _f);
+
+private:
+    struct Batch;
+    void helperBody();
+
+    Mutex x_batches;
+    std::condition_variable m_ready;               ///< Signaled when a batch is queued or the pool stops.
+    std::deque<std::shared_ptr<Batch>> m_batches;  ///< Batches still wanting helpers, oldest first.
+    bool m_stopping = false;
+    std::vector<std::thread> m_helpers;
+};
+
+}
@@ -24,6 +24,7 @@
 #include "Exceptions.h"
 #include "dbfwd.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -51,6 +52,26 @@ protected:
     WriteBatchFace& operator=(WriteBatchFace&&) = delete;
 };
 
+/// Tuning of one database. Zero leaves a setting at the backend's default.
+struct DatabaseSettings
+{
+    size_t cacheSize = 0;        ///< Bytes of uncompressed blocks kept in an LRU read cache.
+    int bloomBitsPerKey = 0;     ///< Bits per key of the bloom filter on each table file.
+    size_t writeBufferSize = 0;  ///< Bytes buffered in memory before being written out sorted.
+    bool compression = true;
+};
+
+/// Counters of a database's read cache.
+struct DatabaseCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t used = 0;      ///< Bytes currently held.
+    size_t capacity = 0;
+
+    double hitRate() const { return hits + misses ? double(hits) / double(hits + misses) : 0; }
+};
+
 class DatabaseFace
 {
 public:
@@ -68,6 +89,16 @@ public:
     // of each record in the database. If `f` returns false, the `forEach`
     // method must return immediately.
     virtual void forEach(std::function<bool(Slice, Slice)> f) const = 0;
+
+    /// Like forEach(), but visits the records in key order, starting at the first whose key is
+    /// not less than @a _from.
+    virtual void forEachFrom(Slice _from, std::function<bool(Slice, Slice)> f) const = 0;
+
+    /// Waits until every write committed so far is on disk.
+    virtual void sync() {}
+
+    /// @returns the counters of the read cache, all zero if the database does not keep one.
+    virtual DatabaseCacheStats cacheStats() const { return DatabaseCacheStats(); }
 };
 
 DEV_SIMPLE_EXCEPTION(DatabaseError);
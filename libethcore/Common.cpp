@@ -145,6 +145,24 @@ void badBlock(bytesConstRef _block, string const& _err)
 	badBlockInfo(bi, _err);
 }
 
+std::ostream& operator<<(std::ostream& _out, ImportResult _r)
+{
+	switch (_r)
+	{
+	case ImportResult::Success: return _out << "Success";
+	case ImportResult::UnknownParent: return _out << "UnknownParent";
+	case ImportResult::FutureTimeKnown: return _out << "FutureTimeKnown";
+	case ImportResult::FutureTimeUnknown: return _out << "FutureTimeUnknown";
+	case ImportResult::AlreadyInChain: return _out << "AlreadyInChain";
+	case ImportResult::AlreadyKnown: return _out << "AlreadyKnown";
+	case ImportResult::Malformed: return _out << "Malformed";
+	case ImportResult::OverbidGasPrice: return _out << "OverbidGasPrice";
+	case ImportResult::BadChain: return _out << "BadChain";
+	case ImportResult::ZeroSignature: return _out << "ZeroSignature";
+	}
+	return _out << "Unknown";
+}
+
 string TransactionSkeleton::userReadable(bool _toProxy, function<pair<bool, string>(TransactionSkeleton const&)> const& _getNatSpec, function<string(Address const&)> const& _formatAddress) const
 {
 	if (creation)
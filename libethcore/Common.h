@@ -126,6 +126,9 @@ enum class ImportResult
 	ZeroSignature
 };
 
+/// Streams the name of @a _r, e.g. "AlreadyKnown".
+std::ostream& operator<<(std::ostream& _out, ImportResult _r);
+
 struct ImportRequirements
 {
 	using value = unsigned;
@@ -85,6 +85,8 @@ public:
 	Address const& safeSender() const noexcept;
 	/// Force the sender to a particular value. This will result in an invalid transaction RLP.
 	void forceSender(Address const& _a) { m_sender = _a; }
+	/// @returns true if the sender has been determined already, so that sender() does no recovery.
+	bool hasSender() const { return !!m_sender; }
 
 	/// @throws TransactionIsUnsigned if signature was not initialized
 	/// @throws InvalidSValue if the signature has an invalid S value.
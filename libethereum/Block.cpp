@@ -22,11 +22,13 @@
 #include "Block.h"
 
 #include <ctime>
+#include <atomic>
 #include <boost/filesystem.hpp>
 #include <boost/timer.hpp>
 #include <libdevcore/CommonIO.h>
 #include <libdevcore/Assertions.h>
 #include <libdevcore/TrieHash.h>
+#include <libdevcore/WorkerPool.h>
 #include <libethcore/Exceptions.h>
 #include <libethcore/SealEngine.h>
 #include <libevm/VMFactory.h>
@@ -45,6 +47,82 @@ namespace fs = boost::filesystem;
 
 static const unsigned c_maxSyncTransactions = 1024;
 
+namespace dev
+{
+namespace eth
+{
+
+/// A transaction executed by Block::speculate() against the state at the start of a sync pass.
+struct SpeculativeTx
+{
+	bool ok = false;			///< Executed without throwing.
+	bool applied = false;		///< Merged into the block from this speculation.
+	size_t sender = 0;			///< Index of the first transaction of its sender.
+	SpeculativeTx const* previous = nullptr;	///< The one before it from the same sender, which it ran after.
+	StateAccessLog log;
+	StateDiff diff;
+	u256 gasUsed;
+	uint8_t status = 0;
+	LogEntries logs;
+};
+
+/// Who last changed each account and storage slot while merging speculated transactions.
+struct SpeculativeMerge
+{
+	static const size_t c_anyone = (size_t)-1;		///< Executed in order or changed by several senders.
+
+	std::unordered_map<Address, size_t> accounts;
+	std::map<std::pair<Address, u256>, size_t> slots;
+};
+
+}
+}
+
+namespace
+{
+
+template <class Owners, class K> void noteChange(Owners& io_owners, K const& _key, size_t _owner)
+{
+	auto it = io_owners.emplace(_key, _owner).first;
+	if (it->second != _owner)
+		it->second = SpeculativeMerge::c_anyone;
+}
+
+void noteWrites(StateAccessLog const& _log, size_t _owner, SpeculativeMerge& io_merged)
+{
+	for (auto const& a: _log.writes)
+		noteChange(io_merged.accounts, a, _owner);
+	for (auto const& c: _log.credits)
+		noteChange(io_merged.accounts, c.first, _owner);
+	for (auto const& s: _log.storageWrites)
+		noteChange(io_merged.slots, s, _owner);
+}
+
+/// @returns true if @a _spec looked at an account or storage slot that another sender changed since it was speculated.
+bool conflicts(SpeculativeTx const& _spec, SpeculativeMerge const& _merged)
+{
+	auto changed = [&](Address const& _a)
+	{
+		auto it = _merged.accounts.find(_a);
+		return it != _merged.accounts.end() && it->second != _spec.sender;
+	};
+	for (auto const& a: _spec.log.reads)
+		if (changed(a))
+			return true;
+	for (auto const& a: _spec.log.writes)
+		if (changed(a))
+			return true;
+	for (auto const& s: _spec.log.storageReads)
+	{
+		auto it = _merged.slots.find(s);
+		if (it != _merged.slots.end() && it->second != _spec.sender)
+			return true;
+	}
+	return false;
+}
+
+}
+
 const char* BlockSafeExceptions::name() { return EthViolet "⚙" EthBlue " ℹ"; }
 const char* BlockDetail::name() { return EthViolet "⚙" EthWhite " ◌"; }
 const char* BlockTrace::name() { return EthViolet "⚙" EthGray " ◎"; }
@@ -60,6 +138,35 @@ public:
     void clear() override {}
 };
 
+/// The chain's last block hashes, preceded by those of sealed blocks it has not imported yet.
+class UnimportedLastBlockHashes: public eth::LastBlockHashesFace
+{
+public:
+    UnimportedLastBlockHashes(eth::LastBlockHashesFace const& _chain, vector<pair<BlockHeader, h256Hash>> const& _unimported):
+        m_chain(_chain), m_unimported(_unimported) {}
+
+    h256s precedingHashes(h256 const& _mostRecentHash) const override
+    {
+        h256s ret;
+        h256 h = _mostRecentHash;
+        for (auto const& u: m_unimported)
+            if (u.first.hash() == h)
+            {
+                ret.push_back(h);
+                h = u.first.parentHash();
+            }
+        h256s const chain = m_chain.precedingHashes(h);
+        size_t const room = ret.size() < chain.size() ? chain.size() - ret.size() : 0;
+        ret.insert(ret.end(), chain.begin(), chain.begin() + room);
+        return ret;
+    }
+    void clear() override {}
+
+private:
+    eth::LastBlockHashesFace const& m_chain;
+    vector<pair<BlockHeader, h256Hash>> const& m_unimported;
+};
+
 }
 
 
@@ -94,9 +201,11 @@ Block::Block(Block const& _s):
     m_precommit(_s.m_state),
     m_previousBlock(_s.m_previousBlock),
     m_currentBlock(_s.m_currentBlock),
+    m_unimported(_s.m_unimported),
     m_currentBytes(_s.m_currentBytes),
     m_author(_s.m_author),
-    m_sealEngine(_s.m_sealEngine)
+    m_sealEngine(_s.m_sealEngine),
+    m_syncThreads(_s.m_syncThreads)
 {
     m_committedToSeal = false;
 }
@@ -112,9 +221,11 @@ Block& Block::operator=(Block const& _s)
     m_transactionSet = _s.m_transactionSet;
     m_previousBlock = _s.m_previousBlock;
     m_currentBlock = _s.m_currentBlock;
+    m_unimported = _s.m_unimported;
     m_currentBytes = _s.m_currentBytes;
     m_author = _s.m_author;
     m_sealEngine = _s.m_sealEngine;
+    m_syncThreads = _s.m_syncThreads;
 
     m_precommit = m_state;
     m_committedToSeal = false;
@@ -307,6 +418,8 @@ bool Block::sync(BlockChain const& _bc, h256 const& _block, BlockHeader const& _
         ret = true;
     }
 #endif
+    // Whatever we built on is in the chain now, or was left behind.
+    m_unimported.clear();
     return ret;
 }
 
@@ -320,16 +433,49 @@ pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, TransactionQu
     // TRANSACTIONS
     pair<TransactionReceipts, bool> ret;
 
-    auto ts = _tq.topTransactions(c_maxSyncTransactions, m_transactionSet);
+    // Transactions of blocks we built on stay in the queue until the chain imports them.
+    while (!m_unimported.empty() && _bc.isKnown(m_unimported.back().first.hash()))
+        m_unimported.pop_back();
+    h256Hash known;
+    if (!m_unimported.empty())
+    {
+        known = m_transactionSet;
+        for (auto const& u: m_unimported)
+            known.insert(u.second.begin(), u.second.end());
+    }
+
+    auto ts = _tq.topTransactions(c_maxSyncTransactions, m_unimported.empty() ? m_transactionSet : known);
     ret.second = (ts.size() == c_maxSyncTransactions);	// say there's more to the caller if we hit the limit
 
-    assert(_bc.currentHash() == m_currentBlock.parentHash());
+    assert(buildsOn(_bc.currentHash()));
+    UnimportedLastBlockHashes const lastBlockHashes(_bc.lastBlockHashes(), m_unimported);
     auto deadline =  chrono::steady_clock::now() + chrono::milliseconds(msTimeout);
 	int64_t now = utcTime();
+	unsigned const threads = m_syncThreads ? m_syncThreads : (unsigned)min<u256>(_bc.chainParams().u256Param("parallelSyncThreads"), 64);
 
 	for (int goodTxs = max(0, (int)ts.size() - 1); goodTxs < (int)ts.size(); )
 	{
 		goodTxs = 0;
+
+		// Each pass speculates everything still pending against the state it starts from.
+		vector<SpeculativeTx> specs;
+		unordered_map<h256, size_t> speculated;
+		SpeculativeMerge merged;
+		if (threads > 1)
+		{
+			vector<Transaction const*> pending;
+			for (auto const& t: ts)
+				if (!m_transactionSet.count(t.sha3()) && t.time() + 240*TIME_PER_SECOND >= now)
+					pending.push_back(&t);
+			if (pending.size() > 1)
+			{
+				uncommitToSeal();
+				specs = speculate(lastBlockHashes, pending, threads);
+				for (size_t i = 0; i < pending.size(); ++i)
+					speculated.emplace(pending[i]->sha3(), i);
+			}
+		}
+
 		//for (auto const& t: ts)
 		for(auto iter = ts.begin(); iter != ts.end();)
 		{
@@ -348,7 +494,13 @@ pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, TransactionQu
 					else if (t.gasPrice() >= _gp.ask(*this))
 					{
 //						Timer t;
-						execute(_bc.lastBlockHashes(), t);
+						if (threads > 1)
+						{
+							auto spec = speculated.find(t.sha3());
+							executeSpeculated(lastBlockHashes, t, spec == speculated.end() ? nullptr : &specs[spec->second], merged);
+						}
+						else
+							execute(lastBlockHashes, t);
 						ret.first.push_back(m_receipts.back());
 						++goodTxs;
 //						cnote << "TX took:" << t.elapsed() * 1000;
@@ -704,6 +856,112 @@ ExecutionResult Block::execute(LastBlockHashesFace const& _lh, Transaction const
     return resultReceipt.first;
 }
 
+vector<SpeculativeTx> Block::speculate(LastBlockHashesFace const& _lh, vector<Transaction const*> const& _ts, unsigned _threads) const
+{
+	vector<SpeculativeTx> ret(_ts.size());
+	vector<vector<size_t>> senders;
+	unordered_map<Address, size_t> senderIndex;
+	for (size_t i = 0; i < _ts.size(); ++i)
+	{
+		auto it = senderIndex.emplace(_ts[i]->sender(), senders.size()).first;
+		if (it->second == senders.size())
+			senders.emplace_back();
+		auto& txs = senders[it->second];
+		ret[i].sender = txs.empty() ? i : txs.front();
+		ret[i].previous = txs.empty() ? nullptr : &ret[txs.back()];
+		txs.push_back(i);
+	}
+
+	atomic<size_t> next(0);
+	u256 const startGasUsed = gasUsed();
+	// Each item works on a copy of the state, taking senders until none are left.
+	auto work = [&](size_t)
+	{
+		if (next >= senders.size())
+			return;
+		State state(m_state);
+		EnvInfo const envInfo(info(), _lh, startGasUsed);
+		for (size_t s = next++; s < senders.size(); s = next++)
+		{
+			size_t const savepoint = state.savepoint();
+			bool dirty = false;
+			for (size_t i: senders[s])
+			{
+				SpeculativeTx& spec = ret[i];
+				state.setAccessLog(&spec.log);
+				try
+				{
+					auto resultReceipt = state.execute(envInfo, *m_sealEngine, *_ts[i], Permanence::Uncommitted);
+					spec.diff = state.diff(spec.log);
+					spec.gasUsed = resultReceipt.second.cumulativeGasUsed() - startGasUsed;
+					if (resultReceipt.second.hasStatusCode())
+						spec.status = resultReceipt.second.statusCode();
+					spec.logs = resultReceipt.second.log();
+					spec.ok = true;
+				}
+				catch (...)
+				{
+					// Executed again in order, which reports the failure; the rest of the sender's depend on it.
+				}
+				state.setAccessLog(nullptr);
+				if (!spec.ok)
+				{
+					dirty = true;
+					break;
+				}
+				// Kills are not in the changelog.
+				for (auto const& d: spec.diff)
+					dirty = dirty || !d.second.alive;
+			}
+			if (dirty)
+				state = m_state;
+			else
+				state.rollback(savepoint);
+		}
+	};
+
+	WorkerPool::shared().forEach(min<size_t>(_threads, senders.size()), 1, work);
+	return ret;
+}
+
+void Block::executeSpeculated(LastBlockHashesFace const& _lh, Transaction const& _t, SpeculativeTx* io_spec, SpeculativeMerge& io_merged)
+{
+	uncommitToSeal();
+
+	if (io_spec && io_spec->ok && !io_spec->log.exclusive && (!io_spec->previous || io_spec->previous->applied) &&
+		_t.gas() <= info().gasLimit() - gasUsed() && !conflicts(*io_spec, io_merged))
+	{
+		m_state.apply(io_spec->diff);
+		bool const removeEmptyAccounts = info().number() >= m_sealEngine->chainParams().EIP158ForkBlock;
+		m_state.commit(removeEmptyAccounts ? State::CommitBehaviour::RemoveEmptyAccounts : State::CommitBehaviour::KeepEmptyAccounts);
+
+		u256 const cumulativeGasUsed = gasUsed() + io_spec->gasUsed;
+		m_receipts.push_back(info().number() >= m_sealEngine->chainParams().byzantiumForkBlock ?
+			TransactionReceipt(io_spec->status, cumulativeGasUsed, io_spec->logs) :
+			TransactionReceipt(m_state.rootHash(), cumulativeGasUsed, io_spec->logs));
+		m_transactions.push_back(_t);
+		m_transactionSet.insert(_t.sha3());
+		io_spec->applied = true;
+		noteWrites(io_spec->log, io_spec->sender, io_merged);
+		return;
+	}
+
+	StateAccessLog log;
+	m_state.setAccessLog(&log);
+	try
+	{
+		execute(_lh, _t);
+	}
+	catch (...)
+	{
+		m_state.setAccessLog(nullptr);
+		noteWrites(log, SpeculativeMerge::c_anyone, io_merged);
+		throw;
+	}
+	m_state.setAccessLog(nullptr);
+	noteWrites(log, SpeculativeMerge::c_anyone, io_merged);
+}
+
 void Block::applyRewards(vector<BlockHeader> const& _uncleBlockHeaders, u256 const& _blockReward)
 {
     u256 r = _blockReward;
@@ -769,7 +1027,8 @@ void Block::commitToSeal(BlockChain const& _bc, bytes const& _extraData)
 
     RLPStream unclesData;
     unsigned unclesCount = 0;
-    if (m_previousBlock.number() != 0)
+    // Blocks the chain has yet to import have no kin in it to look for uncles among.
+    if (m_previousBlock.number() != 0 && m_unimported.empty())
     {
         // Find great-uncles (or second-cousins or whatever they are) - children of great-grandparents, great-great-grandparents... that were not already uncles in previous generations.
         clog(StateDetail) << "Checking " << m_previousBlock.hash() << ", parent=" << m_previousBlock.parentHash();
@@ -883,6 +1142,31 @@ bool Block::sealBlock(bytesConstRef _header)
     return true;
 }
 
+bool Block::buildOn(BlockHeader const& _sealed)
+{
+    if (isSealed())
+        BOOST_THROW_EXCEPTION(InvalidOperationOnSealedBlock());
+
+    if (_sealed.hash(WithoutSeal) != m_currentBlock.hash(WithoutSeal) || _sealed.stateRoot() != rootHash())
+        return false;
+
+    // The committed trie nodes are still in our overlay, so the state carries straight over.
+    m_unimported.emplace(m_unimported.begin(), _sealed, m_transactionSet);
+    m_previousBlock = _sealed;
+    resetCurrent();
+    return true;
+}
+
+bool Block::buildsOn(h256 const& _hash) const
+{
+    if (m_currentBlock.parentHash() == _hash)
+        return true;
+    for (auto const& u: m_unimported)
+        if (u.first.parentHash() == _hash)
+            return true;
+    return false;
+}
+
 h256 Block::stateRootBeforeTx(unsigned _i) const
 {
     _i = min<unsigned>(_i, m_transactions.size());
@@ -921,7 +1205,8 @@ void Block::cleanup()
         throw;
     }
 
-    m_state.db().commit();	// TODO: State API for this?
+    m_state.recordFlatChanges();
+    m_state.db().commit(unsigned(m_currentBlock.number()), m_currentBlock.hash());	// TODO: State API for this?
 
     if (isChannelVisible<StateTrace>()) // Avoid calling toHex if not needed
         clog(StateTrace) << "Committed: stateRoot" << m_currentBlock.stateRoot() << "=" << rootHash() << "=" << toHex(asBytes(db().lookup(rootHash())));
@@ -50,6 +50,8 @@ class State;
 class TransactionQueue;
 struct VerifiedBlockRef;
 class LastBlockHashesFace;
+struct SpeculativeTx;
+struct SpeculativeMerge;
 
 struct BlockChat: public LogChannel { static const char* name(); static const int verbosity = 4; };
 struct BlockTrace: public LogChannel { static const char* name(); static const int verbosity = 5; };
@@ -221,6 +223,11 @@ public:
 	/// @returns a list of receipts one for each transaction placed from the queue into the state and bool, true iff there are more transactions to be processed.
 	std::pair<TransactionReceipts, bool> sync(BlockChain const& _bc, TransactionQueue& _tq, GasPricer const& _gp, unsigned _msTimeout = 100);
 
+	/// Set how many threads sync() executes queued transactions on; 0 takes "parallelSyncThreads" from the chain params.
+	/// With more than one, transactions run speculatively on copies of the state and are merged in queue order,
+	/// executing again only those that read something changed by a transaction merged before them.
+	void setSyncThreads(unsigned _threads) { m_syncThreads = _threads; }
+
 	/// Sync our state with the block chain.
 	/// This basically involves wiping ourselves if we've been superceded and rebuilding from the transaction queue.
 	bool sync(BlockChain const& _bc);
@@ -270,6 +277,16 @@ public:
 	/// @returns true if sealed - in this case you can no longer append transactions.
 	bool isSealed() const { return !m_currentBytes.empty(); }
 
+	/// Moves on to the block after @a _sealed, the header this block was just sealed with, before
+	/// the chain has imported it. Sealing drops the committed state, so call this on a copy taken
+	/// between commitToSeal() and sealBlock().
+	/// @returns false if @a _sealed is not the header that was committed.
+	bool buildOn(BlockHeader const& _sealed);
+
+	/// @returns true if @a _hash is the parent of this block, or of one of the blocks given to
+	/// buildOn() that the chain had not imported.
+	bool buildsOn(h256 const& _hash) const;
+
 	/// Get the complete current block, including valid nonce.
 	/// Only valid when isSealed() is true.
 	bytes const& blockData() const { return m_currentBytes; }
@@ -284,6 +301,15 @@ private:
 	/// Undo the changes to the state for committing to mine.
 	void uncommitToSeal();
 
+	/// Executes each of @a _ts against the current state on one of at most @a _threads copies of it,
+	/// on the shared helper threads.
+	/// Transactions from one sender run in turn on the same copy, each after the ones before it.
+	std::vector<SpeculativeTx> speculate(LastBlockHashesFace const& _lh, std::vector<Transaction const*> const& _ts, unsigned _threads) const;
+
+	/// Appends @a _t from @a io_spec if nothing it saw was since changed by another sender, otherwise executes it.
+	/// Either way what it wrote is added to @a io_merged.
+	void executeSpeculated(LastBlockHashesFace const& _lh, Transaction const& _t, SpeculativeTx* io_spec, SpeculativeMerge& io_merged);
+
 	/// Execute the given block, assuming it corresponds to m_currentBlock.
 	/// Throws on failure.
 	u256 enact(VerifiedBlockRef const& _block, BlockChain const& _bc);
@@ -308,6 +334,7 @@ private:
 
 	BlockHeader m_previousBlock;				///< The previous block's information.
 	BlockHeader m_currentBlock;					///< The current block's information.
+	std::vector<std::pair<BlockHeader, h256Hash>> m_unimported;	///< Blocks given to buildOn() with their transactions, most recent first.
 	bytes m_currentBytes;						///< The current block's bytes.
 	bool m_committedToSeal = false;				///< Have we committed to mine on the present m_currentBlock?
 
@@ -317,6 +344,8 @@ private:
 	Address m_author;							///< Our address (i.e. the address to which fees go).
 
 	SealEngineFace* m_sealEngine = nullptr;		///< The chain's seal engine.
+
+	unsigned m_syncThreads = 0;					///< See setSyncThreads().
 };
 
 
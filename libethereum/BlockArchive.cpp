@@ -0,0 +1,328 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file BlockArchive.cpp
+ */
+
+#include "BlockArchive.h"
+#include <istream>
+#include <ostream>
+#include <libdevcore/Log.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/TrieHash.h>
+#include <libethcore/BlockHeader.h>
+
+#include <snappy.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+namespace
+{
+
+char const c_archiveMagic[] = "ethblkar";
+size_t const c_magicSize = sizeof(c_archiveMagic) - 1;
+byte const c_archiveVersion = 1;
+byte const c_withReceiptsFlag = 1;
+
+/// Upper bound for a chunk on either side of compression; guards against corrupt sizes.
+size_t const c_maxChunkSize = 16 * c_archiveChunkBytes;
+
+}
+
+BlockArchiveWriter::BlockArchiveWriter(ostream& _out, bool _withReceipts):
+	m_out(_out),
+	m_withReceipts(_withReceipts)
+{
+	bytes header(c_archiveMagic, c_archiveMagic + c_magicSize);
+	header.push_back(c_archiveVersion);
+	header.push_back(_withReceipts ? c_withReceiptsFlag : 0);
+	write(&header);
+}
+
+void BlockArchiveWriter::append(bytesConstRef _block, bytesConstRef _receipts)
+{
+	BlockHeader const header(_block);
+	if (!m_pendingCount)
+		m_pendingFirst = header.number();
+
+	RLPStream item(m_withReceipts ? 2 : 1);
+	item.appendRaw(_block);
+	if (m_withReceipts)
+		item.appendRaw(_receipts.empty() ? bytesConstRef(&RLPEmptyList) : _receipts);
+	m_pending += item.out();
+	++m_pendingCount;
+
+	m_checkpoint.number = header.number();
+	m_checkpoint.hash = header.hash();
+	m_checkpoint.stateRoot = header.stateRoot();
+
+	if (m_pendingCount >= c_archiveChunkBlocks || m_pending.size() >= c_archiveChunkBytes)
+		flushChunk();
+}
+
+void BlockArchiveWriter::flushChunk()
+{
+	if (!m_pendingCount)
+		return;
+
+	RLPStream chunk;
+	chunk.appendList(m_pendingCount);
+	chunk.appendRaw(m_pending, m_pendingCount);
+
+	string compressed;
+	snappy::Compress((char const*)chunk.out().data(), chunk.out().size(), &compressed);
+
+	BlockArchiveChunk entry;
+	entry.firstNumber = m_pendingFirst;
+	entry.count = m_pendingCount;
+	entry.offset = m_offset;
+	m_index.push_back(entry);
+
+	bytes size(4);
+	toBigEndian(uint32_t(compressed.size()), size);
+	write(&size);
+	write(bytesConstRef(compressed));
+
+	m_pending.clear();
+	m_pendingCount = 0;
+}
+
+void BlockArchiveWriter::finish()
+{
+	flushChunk();
+	bytes terminator(4, 0);
+	write(&terminator);
+
+	RLPStream trailer(2);
+	trailer.appendList(m_index.size());
+	for (auto const& c: m_index)
+		trailer.appendList(3) << c.firstNumber << c.count << u256(c.offset);
+	trailer.appendList(3) << m_checkpoint.number << m_checkpoint.hash << m_checkpoint.stateRoot;
+
+	bytes tail(8);
+	toBigEndian(m_offset, tail);
+	tail += bytes(c_archiveMagic, c_archiveMagic + c_magicSize);
+	write(&trailer.out());
+	write(&tail);
+	m_out.flush();
+}
+
+void BlockArchiveWriter::write(bytesConstRef _data)
+{
+	m_out.write((char const*)_data.data(), _data.size());
+	m_offset += _data.size();
+}
+
+BlockArchiveReader::BlockArchiveReader(istream& _in, size_t _readAhead):
+	m_in(_in),
+	m_readAhead(max<size_t>(_readAhead, 1))
+{
+	m_prefix.resize(c_magicSize + 2);
+	m_in.read((char*)m_prefix.data(), m_prefix.size());
+	m_prefix.resize(m_in.gcount());
+	if (m_prefix.size() == c_magicSize + 2 && equal(m_prefix.begin(), m_prefix.begin() + c_magicSize, c_archiveMagic))
+	{
+		if (m_prefix[c_magicSize] != c_archiveVersion)
+			BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Unsupported block archive version"));
+		m_isArchive = true;
+		m_withReceipts = m_prefix[c_magicSize + 1] & c_withReceiptsFlag;
+		m_prefix.clear();
+	}
+
+	m_reader = thread([this]()
+	{
+		setThreadName("archive");
+		try
+		{
+			if (m_isArchive)
+				readArchive();
+			else
+				readLegacy();
+		}
+		catch (...)
+		{
+			Guard l(x_queue);
+			m_error = current_exception();
+		}
+		Guard l(x_queue);
+		m_done = true;
+		m_queueChanged.notify_all();
+	});
+}
+
+BlockArchiveReader::~BlockArchiveReader()
+{
+	{
+		Guard l(x_queue);
+		m_stop = true;
+		m_queueChanged.notify_all();
+	}
+	if (m_reader.joinable())
+		m_reader.join();
+}
+
+bool BlockArchiveReader::next(Entry& o_entry)
+{
+	unique_lock<Mutex> l(x_queue);
+	m_queueChanged.wait(l, [&](){ return !m_queue.empty() || m_done; });
+	if (!m_queue.empty())
+	{
+		o_entry = move(m_queue.front());
+		m_queue.pop_front();
+		m_queueChanged.notify_all();
+		return true;
+	}
+	if (m_error)
+		rethrow_exception(m_error);
+	return false;
+}
+
+void BlockArchiveReader::push(bytes&& _block, bytes&& _receipts)
+{
+	unique_lock<Mutex> l(x_queue);
+	m_queueChanged.wait(l, [&](){ return m_queue.size() < m_readAhead || m_stop; });
+	m_queue.push_back(Entry{move(_block), move(_receipts)});
+	m_queueChanged.notify_all();
+}
+
+void BlockArchiveReader::readArchive()
+{
+	while (true)
+	{
+		bytes size(4);
+		m_in.read((char*)size.data(), size.size());
+		if (m_in.gcount() != 4)
+			BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Truncated block archive"));
+		size_t const compressedSize = fromBigEndian<uint32_t>(size);
+		if (!compressedSize)
+			break;
+		if (compressedSize > c_maxChunkSize)
+			BOOST_THROW_EXCEPTION(BlockArchiveChunkTooBig());
+
+		string compressed(compressedSize, 0);
+		m_in.read(&compressed[0], compressedSize);
+		if ((size_t)m_in.gcount() != compressedSize)
+			BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Truncated block archive"));
+
+		size_t uncompressedSize = 0;
+		if (!snappy::GetUncompressedLength(compressed.data(), compressed.size(), &uncompressedSize) || uncompressedSize > c_maxChunkSize)
+			BOOST_THROW_EXCEPTION(BlockArchiveChunkTooBig());
+		string chunk;
+		if (!snappy::Uncompress(compressed.data(), compressed.size(), &chunk))
+			BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Corrupt block archive chunk"));
+
+		for (auto const& item: RLP(chunk, RLP::VeryStrict))
+		{
+			if (item.itemCount() != (m_withReceipts ? 2u : 1u))
+				BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Bad block archive item"));
+			bytesConstRef block = item[0].data();
+			BlockHeader const header(block);
+			if (m_lastHash && header.parentHash() != m_lastHash)
+				BOOST_THROW_EXCEPTION(BlockArchiveBrokenChain() << errinfo_hash256(header.hash()));
+
+			bytes receipts;
+			if (m_withReceipts)
+			{
+				vector<bytesConstRef> receiptsData;
+				for (auto const& r: item[1])
+					receiptsData.push_back(r.data());
+				if (orderedTrieRoot(receiptsData) != header.receiptsRoot())
+					BOOST_THROW_EXCEPTION(BlockArchiveReceiptsMismatch() << errinfo_hash256(header.hash()));
+				receipts = item[1].data().toBytes();
+			}
+
+			m_lastHash = header.hash();
+			push(block.toBytes(), move(receipts));
+			if (m_stop)
+				return;
+		}
+	}
+	readTrailer();
+}
+
+void BlockArchiveReader::readTrailer()
+{
+	bytes rest;
+	char buffer[4096];
+	while (m_in.read(buffer, sizeof(buffer)) || m_in.gcount())
+		rest.insert(rest.end(), buffer, buffer + m_in.gcount());
+	if (rest.size() < 8 + c_magicSize || !equal(rest.end() - c_magicSize, rest.end(), c_archiveMagic))
+		BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Missing block archive trailer"));
+	rest.resize(rest.size() - 8 - c_magicSize);
+
+	RLP const trailer(rest, RLP::VeryStrict);
+	if (trailer.itemCount() != 2 || trailer[1].itemCount() != 3)
+		BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Bad block archive trailer"));
+
+	vector<BlockArchiveChunk> index;
+	for (auto const& c: trailer[0])
+	{
+		BlockArchiveChunk entry;
+		entry.firstNumber = c[0].toInt<unsigned>();
+		entry.count = c[1].toInt<unsigned>();
+		entry.offset = c[2].toInt<uint64_t>();
+		index.push_back(entry);
+	}
+	BlockArchiveCheckpoint checkpoint;
+	checkpoint.number = trailer[1][0].toInt<unsigned>();
+	checkpoint.hash = trailer[1][1].toHash<h256>();
+	checkpoint.stateRoot = trailer[1][2].toHash<h256>();
+	if (m_lastHash && checkpoint.hash != m_lastHash)
+		BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Block archive checkpoint does not match its last block"));
+
+	Guard l(x_queue);
+	m_index = move(index);
+	m_checkpoint = checkpoint;
+}
+
+void BlockArchiveReader::readLegacy()
+{
+	while (!m_stop)
+	{
+		bytes block = move(m_prefix);
+		m_prefix.clear();
+		size_t const have = block.size();
+		if (have < 8)
+		{
+			block.resize(8);
+			m_in.read((char*)block.data() + have, 8 - have);
+			block.resize(have + m_in.gcount());
+		}
+		if (block.empty())
+			return;
+		if (block.size() < 8)
+			BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Truncated block"));
+
+		size_t const size = RLP(block, RLP::LaissezFaire).actualSize();
+		if (size < block.size())
+		{
+			// Sniffing may have read past a very small block; keep the excess for the next one.
+			m_prefix.assign(block.begin() + size, block.end());
+			block.resize(size);
+		}
+		else
+		{
+			size_t const read = block.size();
+			block.resize(size);
+			m_in.read((char*)block.data() + read, size - read);
+			if ((size_t)m_in.gcount() != size - read)
+				BOOST_THROW_EXCEPTION(InvalidBlockArchive() << errinfo_comment("Truncated block"));
+		}
+		push(move(block), bytes());
+	}
+}
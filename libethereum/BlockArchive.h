@@ -0,0 +1,160 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file BlockArchive.h
+ * Chunked, snappy-compressed block archive used by eth --export/--import.
+ *
+ * Layout: an 8-byte magic, a version byte and a flags byte, followed by chunks each
+ * prefixed with its 4-byte big-endian compressed size. A chunk holds the RLP list of
+ * [block] or [block, receipts] items of up to c_archiveChunkBlocks consecutive blocks.
+ * A zero size marks the trailer: RLP [index, checkpoint], where index lists
+ * [firstNumber, count, offset] per chunk and checkpoint is [number, hash, stateRoot] of
+ * the last block, then the 8-byte big-endian offset of that RLP and the magic again.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iosfwd>
+#include <thread>
+#include <libdevcore/Common.h>
+#include <libdevcore/Exceptions.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+
+namespace dev
+{
+namespace eth
+{
+
+DEV_SIMPLE_EXCEPTION(InvalidBlockArchive);
+DEV_SIMPLE_EXCEPTION(BlockArchiveChunkTooBig);
+DEV_SIMPLE_EXCEPTION(BlockArchiveBrokenChain);
+DEV_SIMPLE_EXCEPTION(BlockArchiveReceiptsMismatch);
+
+/// Maximum number of blocks and uncompressed bytes put into a single chunk.
+static const unsigned c_archiveChunkBlocks = 1000;
+static const size_t c_archiveChunkBytes = 4 * 1024 * 1024;
+
+struct BlockArchiveChunk
+{
+	unsigned firstNumber = 0;
+	unsigned count = 0;
+	uint64_t offset = 0;
+};
+
+/// The last block of an archive; importers check the chain they built against it.
+struct BlockArchiveCheckpoint
+{
+	unsigned number = 0;
+	h256 hash;
+	h256 stateRoot;
+};
+
+/**
+ * @brief Streams consecutive blocks (and optionally their receipts) into an archive.
+ * Works on non-seekable streams; offsets are tracked rather than queried.
+ */
+class BlockArchiveWriter
+{
+public:
+	BlockArchiveWriter(std::ostream& _out, bool _withReceipts);
+
+	/// Appends the next block. @a _receipts is the RLP list of the block's receipts and is
+	/// ignored unless the archive was opened with receipts.
+	void append(bytesConstRef _block, bytesConstRef _receipts = bytesConstRef());
+
+	/// Flushes the last chunk and writes the index and checkpoint. Must be called once.
+	void finish();
+
+	std::vector<BlockArchiveChunk> const& index() const { return m_index; }
+	BlockArchiveCheckpoint const& checkpoint() const { return m_checkpoint; }
+
+private:
+	void flushChunk();
+	void write(bytesConstRef _data);
+
+	std::ostream& m_out;
+	bool m_withReceipts;
+	uint64_t m_offset = 0;
+
+	bytes m_pending;				///< RLP of the items of the chunk being built.
+	unsigned m_pendingCount = 0;
+	unsigned m_pendingFirst = 0;
+
+	std::vector<BlockArchiveChunk> m_index;
+	BlockArchiveCheckpoint m_checkpoint;
+};
+
+/**
+ * @brief Reads blocks back from an archive on a read-ahead thread.
+ * Decompression, parent-hash linkage and receipts-root checks all happen off the caller's
+ * thread, which only pops ready blocks. Streams without the archive magic are read as the
+ * legacy concatenated block RLP written by --format binary.
+ */
+class BlockArchiveReader
+{
+public:
+	struct Entry
+	{
+		bytes block;
+		bytes receipts;
+	};
+
+	explicit BlockArchiveReader(std::istream& _in, size_t _readAhead = 2 * c_archiveChunkBlocks);
+	~BlockArchiveReader();
+
+	/// Waits for the next block. @returns false once the stream is exhausted; rethrows any
+	/// error hit by the read-ahead thread.
+	bool next(Entry& o_entry);
+
+	bool isArchive() const { return m_isArchive; }
+	bool hasReceipts() const { return m_withReceipts; }
+
+	/// Index and checkpoint from the trailer; valid once next() returned false.
+	std::vector<BlockArchiveChunk> index() const { Guard l(x_queue); return m_index; }
+	BlockArchiveCheckpoint checkpoint() const { Guard l(x_queue); return m_checkpoint; }
+
+private:
+	void readArchive();
+	void readLegacy();
+	void readTrailer();
+	void push(bytes&& _block, bytes&& _receipts);
+
+	std::istream& m_in;
+	size_t m_readAhead;
+	bool m_isArchive = false;
+	bool m_withReceipts = false;
+	bytes m_prefix;					///< Bytes consumed while sniffing a legacy stream.
+	h256 m_lastHash;				///< Hash of the last block pushed, for linkage checks.
+
+	mutable Mutex x_queue;
+	std::condition_variable m_queueChanged;
+	std::deque<Entry> m_queue;
+	bool m_done = false;
+	std::atomic<bool> m_stop = {false};
+	std::exception_ptr m_error;
+	std::vector<BlockArchiveChunk> m_index;
+	BlockArchiveCheckpoint m_checkpoint;
+
+	std::thread m_reader;
+};
+
+}
+}
@@ -22,17 +22,19 @@
 #include "BlockChain.h"
 
 #include "Block.h"
+#include "BlockSegmentStore.h"
 #include "Defaults.h"
 #include "GenesisInfo.h"
 #include "ImportPerformanceLogger.h"
 #include "State.h"
 #include <libdevcore/Assertions.h>
 #include <libdevcore/Common.h>
-#include <libdevcore/DBImpl.h>
+#include <libdevcore/DBFactory.h>
 #include <libdevcore/FileSystem.h>
 #include <libdevcore/FixedHash.h>
 #include <libdevcore/RLP.h>
 #include <libdevcore/TrieHash.h>
+#include <libdevcore/WorkerPool.h>
 #include <libethcore/BlockHeader.h>
 #include <libethcore/Exceptions.h>
 
@@ -166,6 +168,27 @@ void addBlockInfo(Exception& io_ex, BlockHeader const& _header, bytes&& _blockDa
         io_ex << errinfo_extraData(_header.extraData());
 }
 
+/// Below this many transactions per thread, handing some to a helper costs more than the recovery it saves.
+size_t const c_minRecoveriesPerThread = 16;
+
+/// Recovers and caches the sender of each of @a _ts, spread over the shared helper threads.
+/// @returns for each transaction what its recovery threw, if anything.
+vector<exception_ptr> recoverSenders(vector<Transaction> const& _ts)
+{
+    vector<exception_ptr> ret(_ts.size());
+    WorkerPool::shared().forEach(_ts.size(), c_minRecoveriesPerThread, [&](size_t i) {
+        try
+        {
+            _ts[i].sender();
+        }
+        catch (...)
+        {
+            ret[i] = current_exception();
+        }
+    });
+    return ret;
+}
+
 }
 
 
@@ -239,22 +262,31 @@ unsigned BlockChain::open(fs::path const& _path, WithExisting _we)
     {
         cnote << "Killing extras database (DB minor version:" << lastMinor << " != our miner version: " << c_minorProtocolVersion << ").";
         DEV_IGNORE_EXCEPTIONS(fs::remove_all(extrasPath / fs::path("details.old")));
-        fs::rename(extrasPath / fs::path("extras"), extrasPath / fs::path("extras.old"));
-        fs::remove_all(extrasPath / fs::path("state"));
+        db::DBFactory::rename(extrasPath / fs::path("extras"), extrasPath / fs::path("extras.old"));
+        db::DBFactory::remove(extrasPath / fs::path("state"));
         writeFile(extrasPath / fs::path("minor"), rlp(c_minorProtocolVersion));
+        DEV_IGNORE_EXCEPTIONS(fs::remove(extrasPath / fs::path("journal")));
         lastMinor = (unsigned)RLP(status);
     }
     if (_we == WithExisting::Kill)
     {
         cnote << "Killing blockchain & extras database (WithExisting::Kill).";
-        fs::remove_all(chainPath / fs::path("blocks"));
-        fs::remove_all(extrasPath / fs::path("extras"));
+        db::DBFactory::remove(chainPath / fs::path("blocks"));
+        db::DBFactory::remove(extrasPath / fs::path("extras"));
+        DEV_IGNORE_EXCEPTIONS(fs::remove_all(chainPath / fs::path("segments")));
+        DEV_IGNORE_EXCEPTIONS(fs::remove(extrasPath / fs::path("journal")));
     }
 
     try
     {
-        m_blocksDB.reset(new db::DBImpl(chainPath / fs::path("blocks")));
-        m_extrasDB.reset(new db::DBImpl(extrasPath / fs::path("extras")));
+        m_blocksDB = db::DBFactory::create(chainPath / fs::path("blocks"));
+        m_extrasDB = db::DBFactory::create(extrasPath / fs::path("extras"));
+        if (Defaults::get()->m_commitJournal)
+        {
+            m_journal = db::CommitJournal::open(extrasPath / fs::path("journal"));
+            m_blocksDB = m_journal->attach("blocks", std::move(m_blocksDB));
+            m_extrasDB = m_journal->attach("extras", std::move(m_extrasDB));
+        }
     }
     catch (db::DatabaseError const& ex)
     {
@@ -299,6 +331,10 @@ unsigned BlockChain::open(fs::path const& _path, WithExisting _we)
 
     m_lastBlockNumber = number(m_lastBlockHash);
 
+    m_segmentDepth = Defaults::get()->m_blockSegmentDepth;
+    if (m_segmentDepth)
+        m_segments.reset(new BlockSegmentStore(chainPath / fs::path("segments")));
+
     ctrace << "Opened blockchain DB. Latest: " << currentHash() << (lastMinor == c_minorProtocolVersion ? "(rebuild not needed)" : "*** REBUILD NEEDED ***");
     return lastMinor;
 }
@@ -320,8 +356,10 @@ void BlockChain::close()
 {
     ctrace << "Closing blockchain DB";
     // Not thread safe...
+    m_segments.reset();
     m_extrasDB.reset();
     m_blocksDB.reset();
+    m_journal.reset();
     DEV_WRITE_GUARDED(x_lastBlockHash)
     {
         m_lastBlockHash = m_genesisHash;
@@ -353,12 +391,18 @@ void BlockChain::rebuild(fs::path const& _path, std::function<void(unsigned, uns
     // - REINSERT ALL BLOCKS
     ///////////////////////////////
 
+    // Nothing journaled for the old extras may be written again to the new ones after a crash.
+    if (m_journal)
+        m_journal->checkpoint();
+
     // Keep extras DB around, but under a temp name
     m_extrasDB.reset();
-    fs::rename(extrasPath / fs::path("extras"), extrasPath / fs::path("extras.old"));
+    db::DBFactory::rename(extrasPath / fs::path("extras"), extrasPath / fs::path("extras.old"));
     std::unique_ptr<db::DatabaseFace> oldExtrasDB(
-        new db::DBImpl(extrasPath / fs::path("extras.old")));
-    m_extrasDB.reset(new db::DBImpl(extrasPath / fs::path("extras")));
+        db::DBFactory::create(extrasPath / fs::path("extras.old")));
+    m_extrasDB = db::DBFactory::create(extrasPath / fs::path("extras"));
+    if (m_journal)
+        m_extrasDB = m_journal->attach("extras", std::move(m_extrasDB));
 
     // Open a fresh state DB
     Block s = genesisBlock(State::openDB(path.string(), m_genesisHash, WithExisting::Kill));
@@ -534,6 +578,8 @@ void BlockChain::insert(bytes const& _block, bytesConstRef _receipts, bool _must
 
 void BlockChain::insert(VerifiedBlockRef _block, bytesConstRef _receipts, bool _mustBeNew)
 {
+    db::CommitJournal::Group journalGroup(m_journal.get());
+
     // Check block doesn't already exist first!
     if (_mustBeNew)
         checkBlockIsNew(_block);
@@ -637,6 +683,8 @@ ImportRoute BlockChain::import(VerifiedBlockRef const& _block, OverlayDB const&
 {
     //@tidy This is a behemoth of a method - could do to be split into a few smaller ones.
 	class Timer timer;
+    // State, blocks and extras written for this block reach disk together, with one sync.
+    db::CommitJournal::Group journalGroup(m_journal.get());
     ImportPerformanceLogger performanceLogger;
 
     // Check block doesn't already exist first!
@@ -714,6 +762,16 @@ ImportRoute BlockChain::import(VerifiedBlockRef const& _block, OverlayDB const&
     bytes const receipts = br.rlp();
     auto ret = insertBlockAndExtras(_block, ref(receipts), td, performanceLogger);
 	cdebug << "timer.elapsed()=" << timer.elapsed();
+
+    // Now that the chain may have moved on, old states can be pruned.
+    if (auto const& pruner = _db.pruner())
+    {
+        pruner->canonicalise(number(), [&](unsigned _n) { return numberHash(_n); });
+    }
+    if (auto const& flat = _db.flatState())
+    {
+        flat->advance(info().stateRoot());
+    }
 	return ret;
 }
 
@@ -726,6 +784,7 @@ ImportRoute BlockChain::insertWithoutParent(bytes const& _block, bytesConstRef _
 
     checkBlockTimestamp(block.info);
 
+    db::CommitJournal::Group journalGroup(m_journal.get());
     ImportPerformanceLogger performanceLogger;
     return insertBlockAndExtras(block, _receipts, _totalDifficulty, performanceLogger);
 }
@@ -967,7 +1026,10 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
     });
 
     if (!route.empty())
+    {
         noteCanonChanged();
+        appendFinalised();
+    }
 
     if (isImportedAndBest && m_onBlockImport)
         m_onBlockImport(_block.info);
@@ -1102,6 +1164,19 @@ void BlockChain::rewind(unsigned _newHead)
     }
 }
 
+void BlockChain::rewindToState(OverlayDB const& _db)
+{
+    unsigned const head = number();
+    unsigned n = head;
+    while (n > 0 && !_db.exists(info(numberHash(n)).stateRoot()))
+        --n;
+    if (n < head)
+    {
+        cwarn << "State of blocks" << (n + 1) << "to" << head << "was not written. Rewinding to" << n;
+        rewind(n);
+    }
+}
+
 tuple<h256s, h256, unsigned> BlockChain::treeRoute(h256 const& _from, h256 const& _to, bool _common, bool _pre, bool _post) const
 {
     if (!_from || !_to)
@@ -1195,6 +1270,8 @@ void BlockChain::updateStats() const
         m_lastStats.memBlockHashes = getHashSize(m_blockHashes);
     DEV_READ_GUARDED(x_transactionAddresses)
         m_lastStats.memTransactionAddresses = getHashSize(m_transactionAddresses);
+    m_lastStats.blocksDB = m_blocksDB ? m_blocksDB->cacheStats() : db::DatabaseCacheStats();
+    m_lastStats.extrasDB = m_extrasDB ? m_extrasDB->cacheStats() : db::DatabaseCacheStats();
 }
 
 void BlockChain::garbageCollect(bool _force)
@@ -1414,6 +1491,13 @@ bytes BlockChain::block(h256 const& _hash) const
     if (_hash == m_genesisHash)
         return m_params.genesisBlock();
 
+    if (m_segments)
+    {
+        bytesConstRef const b = m_segments->block(_hash);
+        if (!b.empty())
+            return b.toBytes();
+    }
+
     {
         ReadGuard l(x_blocks);
         auto it = m_blocks.find(_hash);
@@ -1437,11 +1521,49 @@ bytes BlockChain::block(h256 const& _hash) const
     return m_blocks[_hash];
 }
 
+void BlockChain::appendFinalised()
+{
+    if (!m_segments)
+        return;
+
+    // Catch up a bounded number of blocks per import so a long-running chain that enables
+    // segments does not stall a single import.
+    unsigned const head = number();
+    unsigned const from = m_segments->lastNumber() + 1;
+    for (unsigned n = from; n + m_segmentDepth <= head && n < from + 256; ++n)
+    {
+        h256 const hash = numberHash(n);
+        bytes const b = block(hash);
+        if (b.empty())
+            break;
+        m_segments->append(n, &b);
+    }
+}
+
+bytes BlockChain::transaction(h256 const& _blockHash, unsigned _i) const
+{
+    if (m_segments)
+    {
+        bytesConstRef const t = m_segments->transaction(_blockHash, _i);
+        if (!t.empty())
+            return t.toBytes();
+    }
+    bytes b = block(_blockHash);
+    return RLP(b)[1][_i].data().toBytes();
+}
+
 bytes BlockChain::headerData(h256 const& _hash) const
 {
     if (_hash == m_genesisHash)
         return m_genesisHeaderBytes;
 
+    if (m_segments)
+    {
+        bytesConstRef const b = m_segments->block(_hash);
+        if (!b.empty())
+            return BlockHeader::extractHeader(b).data().toBytes();
+    }
+
     {
         ReadGuard l(x_blocks);
         auto it = m_blocks.find(_hash);
@@ -1548,14 +1670,33 @@ VerifiedBlockRef BlockChain::verifyBlock(bytesConstRef _block, std::function<voi
         }
     i = 0;
     if (_ir & (ImportRequirements::TransactionBasic | ImportRequirements::TransactionSignatures))
+    {
+        // Decode everything up to the first bad transaction, then recover the senders of
+        // those in parallel so that enactment finds them cached. Failures are reported in order below.
+        bool const checkSignatures = !!(_ir & ImportRequirements::TransactionSignatures);
+        exception_ptr badTransaction;
+        for (RLP const& tr: r[1])
+            try
+            {
+                res.transactions.push_back(Transaction(tr.data(), checkSignatures ? CheckTransaction::Cheap : CheckTransaction::None));
+            }
+            catch (...)
+            {
+                badTransaction = current_exception();
+                break;
+            }
+        vector<exception_ptr> const badSenders = checkSignatures ? recoverSenders(res.transactions) : vector<exception_ptr>(res.transactions.size());
+
         for (RLP const& tr: r[1])
         {
             bytesConstRef d = tr.data();
             try
             {
-                Transaction t(d, (_ir & ImportRequirements::TransactionSignatures) ? CheckTransaction::Everything : CheckTransaction::None);
-                m_sealEngine->verifyTransaction(_ir, t, h, 0); // the gasUsed vs blockGasLimit is checked later in enact function
-                res.transactions.push_back(t);
+                if (i == res.transactions.size())
+                    rethrow_exception(badTransaction);
+                if (badSenders[i])
+                    rethrow_exception(badSenders[i]);
+                m_sealEngine->verifyTransaction(_ir, res.transactions[i], h, 0); // the gasUsed vs blockGasLimit is checked later in enact function
             }
             catch (Exception& ex)
             {
@@ -1569,6 +1710,7 @@ VerifiedBlockRef BlockChain::verifyBlock(bytesConstRef _block, std::function<voi
             }
             ++i;
         }
+    }
     res.block = bytesConstRef(_block);
 
 	if(_ir & ImportRequirements::CheckSigns && !sealEngine()->checkBlockSign(h, _block)){
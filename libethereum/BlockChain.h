@@ -29,6 +29,7 @@
 #include "State.h"
 #include "Transaction.h"
 #include "VerifiedBlock.h"
+#include <libdevcore/CommitJournal.h>
 #include <libdevcore/db.h>
 #include <libdevcore/Exceptions.h>
 #include <libdevcore/Log.h>
@@ -63,6 +64,7 @@ static const h256s NullH256s;
 class State;
 class Block;
 class ImportPerformanceLogger;
+class BlockSegmentStore;
 
 DEV_SIMPLE_EXCEPTION(AlreadyHaveBlock);
 DEV_SIMPLE_EXCEPTION(FutureTime);
@@ -221,7 +223,7 @@ public:
 	std::pair<h256, unsigned> transactionLocation(Address const& _from, u256 const& _nonce) const { TransactionAddress ta = queryExtras<TransactionAddress, ExtraAccountsIndexAddress>(sha3(rlpList(_from, _nonce)), m_accountsIndexAddress, x_accountsIndexAddress, NullTransactionAddress); if (!ta) return std::pair<h256, unsigned>(h256(), 0); return std::make_pair(ta.blockHash, ta.index); }
 
     /// Get a block's transaction (RLP format) for the given block hash (or the most recent mined if none given) & index. Thread-safe.
-    bytes transaction(h256 const& _blockHash, unsigned _i) const { bytes b = block(_blockHash); return RLP(b)[1][_i].data().toBytes(); }
+    bytes transaction(h256 const& _blockHash, unsigned _i) const;
 	bytes transaction(Address const& _from, u256 const& _nonce) const { cdebug << "_from=" << _from << ",_nonce=" << _nonce << "sha3(rlpList(_from, _nonce)=" << sha3(rlpList(_from, _nonce)); TransactionAddress ta = queryExtras<TransactionAddress, ExtraAccountsIndexAddress>(sha3(rlpList(_from, _nonce)), m_accountsIndexAddress, x_accountsIndexAddress, NullTransactionAddress); if (!ta) return bytes(); return transaction(ta.blockHash, ta.index); }
     bytes transaction(unsigned _i) const { return transaction(currentHash(), _i); }
 
@@ -251,6 +253,9 @@ public:
     /// Alter the head of the chain to some prior block along it.
     void rewind(unsigned _newHead);
 
+    /// Rewinds the head to the last block whose state is in @a _db, for when state writes were lost.
+    void rewindToState(OverlayDB const& _db);
+
     /// Rescue the database.
     void rescue(OverlayDB const& _db);
 
@@ -288,10 +293,12 @@ public:
         unsigned memReceipts;
         unsigned memTransactionAddresses;
         unsigned memBlockHashes;
+        db::DatabaseCacheStats blocksDB;
+        db::DatabaseCacheStats extrasDB;
         unsigned memTotal() const { return memBlocks + memDetails + memLogBlooms + memReceipts + memTransactionAddresses + memBlockHashes; }
     };
 
-    /// @returns statistics about memory usage.
+    /// @returns statistics about memory usage and the read caches of the blocks and extras databases.
     Statistics usage(bool _freshen = false) const { if (_freshen) updateStats(); return m_lastStats; }
 
     /// Deallocate unused data.
@@ -375,6 +382,9 @@ private:
     void clearCachesDuringChainReversion(unsigned _firstInvalid);
     void clearBlockBlooms(unsigned _begin, unsigned _end);
 
+    /// Appends the canonical blocks that are now m_segmentDepth below the head to m_segments.
+    void appendFinalised();
+
     /// The caches of the disk DB and their locks.
     mutable SharedMutex x_blocks;
     mutable BlocksHash m_blocks;
@@ -410,6 +420,12 @@ private:
     /// The disk DBs. Thread-safe, so no need for locks.
     std::unique_ptr<db::DatabaseFace> m_blocksDB;
     std::unique_ptr<db::DatabaseFace> m_extrasDB;
+    /// Write-ahead journal the blocks, extras and state databases commit through; null if disabled.
+    std::shared_ptr<db::CommitJournal> m_journal;
+
+    /// Memory-mapped copies of blocks at least m_segmentDepth below the head; null if disabled.
+    std::unique_ptr<BlockSegmentStore> m_segments;
+    unsigned m_segmentDepth = 0;
 
     /// Hash of the last (valid) block on the longest chain.
     mutable boost::shared_mutex x_lastBlockHash; // should protect both m_lastBlockHash and m_lastBlockNumber
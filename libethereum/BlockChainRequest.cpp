@@ -40,7 +40,10 @@ using namespace dev::eth;
 using namespace p2p;
 
 #define MAX_REQUEST_COUNT 8
-const unsigned REQUEST_BODY_TIMEOUT = 10000;
+const unsigned c_chunkHeaders = MAX_REQUEST_COUNT * 8;		///< Headers asked from one peer at a time
+const unsigned c_chunkBodies = MAX_REQUEST_COUNT * 4;		///< Bodies asked from one peer at a time
+const unsigned c_skeletonHeaders = 128;						///< Gap anchors asked from the sync peer at a time
+const uint64_t c_assignTimeout = 5 * TIME_PER_SECOND;		///< Before EthereumPeer::tick drops the peer
 
 Blocker::Blocker(bytesConstRef _block, unsigned _type, NodeID _id)
 {
@@ -51,8 +54,10 @@ Blocker::Blocker(bytesConstRef _block, unsigned _type, NodeID _id)
 			{
 				BlockHeader header(_block, HeaderData);
 				hash = header.hash();
-				head = _block.toBytes();
+				head = _block;
 				parent = header.parentHash();
+				number = static_cast<unsigned>(header.number());
+				root = Header { header.transactionsRoot(), header.sha3Uncles() };
 				cdebug << "Blocker_head:header.number()=" << header.number() << ",header.hash()=" << header.hash() << ",_id=" << _id << ",time=" << time;
 			}
 			break;
@@ -61,20 +66,17 @@ Blocker::Blocker(bytesConstRef _block, unsigned _type, NodeID _id)
 				BlockHeader header(_block);
 				RLP block(_block);
 
-				head = block[0].data().toBytes();
-				
-				RLPStream blockStream(block.itemCount()-1);
-				for(size_t i = 1; i < block.itemCount(); i++)
-					blockStream.appendRaw(block[i].data());
-				blockStream.swapOut(body);
-				
+				head = block[0].data();
+				body = block.payload().cropped(head.size());
+
 				hash = header.hash();
 				parent = header.parentHash();
+				number = static_cast<unsigned>(header.number());
+				root = Header { header.transactionsRoot(), header.sha3Uncles() };
 
-				RLP rlpbody(body);
-				auto txList = rlpbody[0];
+				auto txList = block[1];
 				h256 transactionRoot = trieRootOver(txList.itemCount(), [&](unsigned i){ return rlp(i); }, [&](unsigned i){ return txList[i].data().toBytes(); });
-				h256 uncles = sha3(rlpbody[1].data());
+				h256 uncles = sha3(block[2].data());
 
 				if(header.sha3Uncles() != uncles || transactionRoot != header.transactionsRoot()){
 					cdebug << "BOOST_THROW_EXCEPTION: uncles=" << uncles << "header.sha3Uncles()=" << header.sha3Uncles() << ",transactionRoot=" << transactionRoot << ",header.transactionsRoot()=" << header.transactionsRoot() << ",_id=" << _id << ",time=" << time;
@@ -89,75 +91,299 @@ Blocker::Blocker(bytesConstRef _block, unsigned _type, NodeID _id)
 	}	
 }
 
+BlockSlot* BlockRing::find(unsigned _number)
+{
+	return const_cast<BlockSlot*>(static_cast<BlockRing const*>(this)->find(_number));
+}
+
+BlockSlot const* BlockRing::find(unsigned _number) const
+{
+	if(!m_count)
+		return nullptr;
+
+	if(inWindow(_number)){
+		BlockSlot const& s = slot(_number);
+		return s.used && s.number == _number ? &s : nullptr;
+	}
+
+	auto it = m_ahead.find(_number);
+	return it != m_ahead.end() ? &it->second : nullptr;
+}
+
+BlockSlot& BlockRing::insert(unsigned _number)
+{
+	if(BlockSlot* s = find(_number)){
+		release(*s);
+		*s = BlockSlot();
+		s->number = _number;
+		s->used = true;
+		return *s;
+	}
+
+	if(!m_count){
+		m_base = m_last = _number;
+	}else{
+		if(_number < m_base)
+			rebase(_number);
+		m_last = max(m_last, _number);
+	}
+	++m_count;
+
+	BlockSlot fresh;
+	fresh.number = _number;
+	fresh.used = true;
+	if(!inWindow(_number))
+		return m_ahead[_number] = fresh;
+
+	return slot(_number) = fresh;
+}
+
+void BlockRing::erase(unsigned _number)
+{
+	BlockSlot* s = find(_number);
+	if(!s)
+		return;
+
+	release(*s);
+	if(inWindow(_number))
+		*s = BlockSlot();
+	else
+		m_ahead.erase(_number);
+
+	if(!--m_count){
+		clear();
+		return;
+	}
+
+	if(_number == m_last){
+		unsigned number = m_base;
+		for(unsigned n = m_base; next(n);)
+			number = n;
+		m_last = number;
+	}
+
+	if(_number == m_base){
+		unsigned number = m_base;
+		next(number);
+		rebase(number);
+	}
+
+	if(m_dead > m_arena.size() / 2 && m_dead > (1 << 20))
+		compact();
+}
+
+void BlockRing::clear()
+{
+	for(auto& s: m_slots)
+		s = BlockSlot();
+	m_ahead.clear();
+	m_base = m_last = 0;
+	m_count = 0;
+	m_arena.clear();
+	m_dead = 0;
+}
+
+bool BlockRing::next(unsigned& _number) const
+{
+	if(!m_count || _number >= m_last)
+		return false;
+
+	for(unsigned n = max(_number + 1, m_base); inWindow(n); ++n){
+		BlockSlot const& s = slot(n);
+		if(s.used && s.number == n){
+			_number = n;
+			return true;
+		}
+	}
+
+	auto it = m_ahead.upper_bound(_number);
+	if(it == m_ahead.end())
+		return false;
+
+	_number = it->first;
+	return true;
+}
+
+/*
+move the window to start at _base, numbers that fall off its end wait in m_ahead and the ones it now covers come back
+*/
+void BlockRing::rebase(unsigned _base)
+{
+	if(_base < m_base){
+		for(auto& s: m_slots){
+			if(s.used && s.number - _base >= c_size){
+				m_ahead[s.number] = s;
+				s = BlockSlot();
+			}
+		}
+	}
+
+	m_base = _base;
+	for(auto it = m_ahead.begin(); it != m_ahead.end() && inWindow(it->first);){
+		slot(it->first) = it->second;
+		it = m_ahead.erase(it);
+	}
+}
+
+void BlockRing::release(BlockSlot const& _slot)
+{
+	m_dead += _slot.hasBody() ? _slot.blockSize : _slot.headSize;
+}
+
+void BlockRing::storeHead(BlockSlot& _slot, bytesConstRef _head)
+{
+	release(_slot);
+	_slot.head = m_arena.size();
+	_slot.headSize = _head.size();
+	_slot.block = _slot.blockSize = 0;
+	m_arena.insert(m_arena.end(), _head.begin(), _head.end());
+}
+
+void BlockRing::storeBody(BlockSlot& _slot, bytesConstRef _payload)
+{
+	assert(_slot.hasHead() && !_slot.hasBody());
+
+	//list prefix as RLPStream writes it, then the header copied out of the arena and the body
+	size_t length = _slot.headSize + _payload.size();
+	byte prefix[9];
+	size_t prefixSize = 1;
+	if(length < c_rlpListImmLenCount){
+		prefix[0] = byte(c_rlpListStart + length);
+	}else{
+		size_t bytes = bytesRequired(length);
+		prefix[0] = byte(c_rlpListIndLenZero + bytes);
+		for(size_t i = 0; i < bytes; ++i)
+			prefix[bytes - i] = byte(length >> (8 * i));
+		prefixSize += bytes;
+	}
+
+	size_t block = m_arena.size();
+	m_arena.resize(block + prefixSize + length);
+	byte* out = m_arena.data() + block;
+	memcpy(out, prefix, prefixSize);
+	memcpy(out + prefixSize, m_arena.data() + _slot.head, _slot.headSize);
+	memcpy(out + prefixSize + _slot.headSize, _payload.data(), _payload.size());
+
+	m_dead += _slot.headSize;
+	_slot.head = block + prefixSize;
+	_slot.block = block;
+	_slot.blockSize = prefixSize + length;
+}
+
+void BlockRing::compact()
+{
+	m_spare.clear();
+	m_spare.reserve(m_arena.size() - m_dead);
+	auto relocate = [&](BlockSlot& s){
+		if(!s.used || !s.hasHead())
+			return;
+		size_t from = s.hasBody() ? s.block : s.head;
+		size_t size = s.hasBody() ? s.blockSize : s.headSize;
+		size_t to = m_spare.size();
+		m_spare.insert(m_spare.end(), m_arena.begin() + from, m_arena.begin() + from + size);
+		s.head = s.head - from + to;
+		if(s.hasBody())
+			s.block = to;
+	};
+	for(auto& s: m_slots)
+		relocate(s);
+	for(auto& a: m_ahead)
+		relocate(a.second);
+
+	cdebug << "compact:arena=" << m_arena.size() << ",dead=" << m_dead << ",live=" << m_spare.size();
+	m_arena.swap(m_spare);
+	m_dead = 0;
+}
+
 void Request::clear()
 {
 	m_blocks.clear();
 	m_HeaderToNumber.clear();
 }
 
-void Request::insertBlocker(unsigned blockNumber, Blocker&& _block, const BlockHeader& _header)
+void Request::insertBlocker(unsigned blockNumber, Blocker const& _block)
 {
 	assert(blockNumber >= 1);
 	if(1 == blockNumber){
-		m_blocks[0] = m_genesis;
-		assert(_block.parent == m_genesis.hash);
+		BlockSlot& genesis = m_blocks.insert(0);
+		genesis.hash = m_genesis;
+		assert(_block.parent == m_genesis);
 	}
+
+	if(BlockSlot const* old = m_blocks.find(blockNumber))
+		removeHeader(*old);
+
+	BlockSlot& slot = m_blocks.insert(blockNumber);
+	slot.hash = _block.hash;
+	slot.parent = _block.parent;
+	slot.root = _block.root;
+	slot.id = _block.id;
+	slot.time = _block.time;
+	m_blocks.storeHead(slot, _block.head);
 	
-	if (_header.transactionsRoot() == EmptyTrie && _header.sha3Uncles() == EmptyListSHA3)
+	if (_block.root.transactionsRoot == EmptyTrie && _block.root.uncles == EmptyListSHA3)
 	{
 		//empty body, just mark as downloaded
-		RLPStream r(2);
-		r.appendRaw(RLPEmptyList);
-		r.appendRaw(RLPEmptyList);
-		r.swapOut(_block.body);
-		m_blocks[blockNumber] = move(_block);
+		static const byte emptyBody[] = { c_rlpListStart, c_rlpListStart };
+		m_blocks.storeBody(slot, bytesConstRef(emptyBody, sizeof(emptyBody)));
 		cdebug << "insert empty body blockNumber=" << blockNumber;
 		return;
 	}
 
+	if(!_block.body.empty())
+		m_blocks.storeBody(slot, _block.body);
+
 	//不同高度的块可能有相同的transactionsRoot
-	m_blocks[blockNumber] = move(_block);
-	Header headerId { _header.transactionsRoot(), _header.sha3Uncles() };
-	cdebug << "insert_head:blockNumber=" << blockNumber << ",_header.hash()=" << toJS(_header.hash()) << ",_header.parentHash()=" << _header.parentHash() << ",_header.transactionsRoot()=" << _header.transactionsRoot() << ",_header.sha3Uncles()=" << _header.sha3Uncles();
+	Header headerId = _block.root;
+	cdebug << "insert_head:blockNumber=" << blockNumber << ",_header.hash()=" << toJS(_block.hash) << ",_header.parentHash()=" << _block.parent << ",_header.transactionsRoot()=" << headerId.transactionsRoot << ",_header.sha3Uncles()=" << headerId.uncles;
 	
 	if(m_HeaderToNumber.count(headerId)){
-		cdebug << "same_transactionsRoot:blockNumber=" << blockNumber << ",_header.hash()=" << toJS(_header.hash()) << ",_header.parentHash()=" << _header.parentHash() << ",_header.transactionsRoot()=" << _header.transactionsRoot() << ",_header.sha3Uncles()=" << _header.sha3Uncles() << ",m_HeaderToNumber[headerId]=" << m_HeaderToNumber[headerId];
+		cdebug << "same_transactionsRoot:blockNumber=" << blockNumber << ",_header.hash()=" << toJS(_block.hash) << ",_header.parentHash()=" << _block.parent << ",_header.transactionsRoot()=" << headerId.transactionsRoot << ",_header.sha3Uncles()=" << headerId.uncles << ",m_HeaderToNumber[headerId]=" << m_HeaderToNumber[headerId];
 		//assert(0 == m_HeaderToNumber.count(headerId));
 	}
 	m_HeaderToNumber[headerId] = blockNumber;
 }
 
-void Request::insertBlocker(Blocker&& _blocker)
+void Request::insertBlocker(Blocker const& _blocker)
 {
-	BlockHeader header(_blocker.head, HeaderData);
-	unsigned blockNumber = header.number();
+	unsigned blockNumber = _blocker.number;
 	assert(blockNumber > 0);
 
 	if(blockNumber > upNumber()){
 		cdebug << "set_new_id: blockNumber=" << blockNumber << ",_blocker.hash=" << _blocker.hash << ",_blocker.id=" << _blocker.id << ",id()=" << id() << ",upNumber()=" << upNumber();
 
-		auto parent = m_blocks.find(blockNumber-1);
-		if(parent != m_blocks.end() && header.parentHash() != parent->second.hash){
-			cdebug << "start_clear_block: blockNumber=" << blockNumber << "header.hash()=" << header.hash() << ",parent->second.parent=" << parent->second.parent << ",parent->second.hash=" << parent->second.hash;
+		BlockSlot const* parent = m_blocks.find(blockNumber-1);
+		if(parent && _blocker.parent != parent->hash){
+			cdebug << "start_clear_block: blockNumber=" << blockNumber << "header.hash()=" << _blocker.hash << ",parent->second.parent=" << parent->parent << ",parent->second.hash=" << parent->hash;
 			clear();
 		}
 		
-		insertBlocker(blockNumber, move(_blocker), header);
+		insertBlocker(blockNumber, _blocker);
 		return;
 	}
 
 	if(_blocker.id != id()){
-		cdebug << "recv_no_expect_block: blockNumber=" << blockNumber << ",_blocker.hash=" << _blocker.hash << ",_blocker.id=" << _blocker.id << ",id()=" << id() << ",upNumber()=" << upNumber();
+		//another peer filling a gap, only take what hangs off the sync peer's chain
+		BlockSlot const* parent = m_blocks.find(blockNumber-1);
+		BlockSlot const* child = m_blocks.find(blockNumber+1);
+		bool linked = parent && parent->hash == _blocker.parent && (!child || child->parent == _blocker.hash);
+		if(!linked || haveItem(blockNumber)){
+			cdebug << "recv_no_expect_block: blockNumber=" << blockNumber << ",_blocker.hash=" << _blocker.hash << ",_blocker.id=" << _blocker.id << ",id()=" << id() << ",upNumber()=" << upNumber();
+			return;
+		}
+
+		cdebug << "insert_linked: blockNumber=" << blockNumber << ",_blocker.hash=" << _blocker.hash << ",_blocker.id=" << _blocker.id;
+		insertBlocker(blockNumber, _blocker);
 		return;
 	}
 
 	uint64_t uptime = upTime();
 	
-	auto child = m_blocks.find(blockNumber+1);
-	if(child != m_blocks.end() && child->second.parent != header.hash()){
-		cdebug << "remove_child_unmatch: blockNumber=" << blockNumber << "header.hash()=" << header.hash() << ",child->second.parent=" << child->second.parent;
-		if(child->second.time > uptime){
-			cdebug << "clear_all:child->second.time=" << child->second.time << ",uptime=" << uptime << ",underHash()=" << underHash();
+	BlockSlot const* child = m_blocks.find(blockNumber+1);
+	if(child && child->parent != _blocker.hash){
+		cdebug << "remove_child_unmatch: blockNumber=" << blockNumber << "header.hash()=" << _blocker.hash << ",child->second.parent=" << child->parent;
+		if(child->time > uptime){
+			cdebug << "clear_all:child->second.time=" << child->time << ",uptime=" << uptime << ",underHash()=" << underHash();
 			clear();
 			return;
 		}else{
@@ -165,11 +391,11 @@ void Request::insertBlocker(Blocker&& _blocker)
 		}
 	}
 
-	auto parent = m_blocks.find(blockNumber-1);
-	if(parent != m_blocks.end() && header.parentHash() != parent->second.hash){
-		cdebug << "remove_parent_unmatch: blockNumber=" << blockNumber << ",parent->second.hash=" << parent->second.hash << ",header.parentHash()=" << header.parentHash();
-		if(parent->second.time > uptime){
-			cdebug << "clear_all:parent->second.time=" << parent->second.time << ",uptime=" << uptime << ",underHash()=" << underHash();
+	BlockSlot const* parent = m_blocks.find(blockNumber-1);
+	if(parent && _blocker.parent != parent->hash){
+		cdebug << "remove_parent_unmatch: blockNumber=" << blockNumber << ",parent->second.hash=" << parent->hash << ",header.parentHash()=" << _blocker.parent;
+		if(parent->time > uptime){
+			cdebug << "clear_all:parent->second.time=" << parent->time << ",uptime=" << uptime << ",underHash()=" << underHash();
 			clear();
 			return;
 		}else{
@@ -178,20 +404,19 @@ void Request::insertBlocker(Blocker&& _blocker)
 	}
 
 	cdebug << "insert_normal: blockNumber=" << blockNumber << ",_blocker.hash=" << _blocker.hash;
-	insertBlocker(blockNumber, move(_blocker), header);
+	insertBlocker(blockNumber, _blocker);
 }
 
-void Request::removeHeader(const bytes& _head)
+void Request::removeHeader(BlockSlot const& _slot)
 {
-	BlockHeader header(_head, HeaderData);
-	if (header.transactionsRoot() != EmptyTrie || header.sha3Uncles() != EmptyListSHA3){
-		Header headerId { header.transactionsRoot(), header.sha3Uncles() };
+	Header headerId = _slot.root;
+	if (_slot.hasHead() && (headerId.transactionsRoot != EmptyTrie || headerId.uncles != EmptyListSHA3)){
 		auto iter = m_HeaderToNumber.find(headerId);
 	
-		cdebug << "header.number()=" << header.number() << "header.transactionsRoot()=" << header.transactionsRoot() << ",header.sha3Uncles()=" << header.sha3Uncles();
+		cdebug << "header.number()=" << _slot.number << "header.transactionsRoot()=" << headerId.transactionsRoot << ",header.sha3Uncles()=" << headerId.uncles;
 
-		if(iter != m_HeaderToNumber.end()){
-			cdebug << "remove_header:header.number()=" << header.number() << "header.transactionsRoot()=" << header.transactionsRoot() << ",header.sha3Uncles()=" << header.sha3Uncles();
+		if(iter != m_HeaderToNumber.end() && iter->second == _slot.number){
+			cdebug << "remove_header:header.number()=" << _slot.number << "header.transactionsRoot()=" << headerId.transactionsRoot << ",header.sha3Uncles()=" << headerId.uncles;
 			m_HeaderToNumber.erase(iter);
 		}
 	}
@@ -202,44 +427,30 @@ remove number < _blockNumber items
 */
 void Request::removeUnder(unsigned _blockNumber)
 {
-	for(auto it = m_blocks.begin(); it != m_blocks.end();){
-		if(it->first >= _blockNumber){
-			cdebug << "it->first=" << it->first << ",_blockNumber=" << _blockNumber << ",m_blocks.size()=" << m_blocks.size();
+	while(!m_blocks.empty()){
+		unsigned number = m_blocks.first();
+		if(number >= _blockNumber){
+			cdebug << "number=" << number << ",_blockNumber=" << _blockNumber << ",m_blocks.size()=" << m_blocks.size();
 			return;
 		}
 
-		if(0 == it->first){
-			it = m_blocks.erase(it);
-			continue;
-		}
-		
-		removeHeader(it->second.head);
+		removeHeader(*m_blocks.find(number));
 
-		cdebug << "remove:it->first=" << it->first;
-		it = m_blocks.erase(it);
+		cdebug << "remove:number=" << number;
+		m_blocks.erase(number);
 	}
 }
 
 /*
-remove number < _blockNumber items
+remove _blockNumber and the run of numbers right above it
 */
 void Request::removeUpWith(unsigned _blockNumber)
 {
-	for(auto it = m_blocks.find(_blockNumber); it != m_blocks.end(); _blockNumber++){
-		if(it->first != _blockNumber){
-			cdebug << "it->first=" << it->first << ",_blockNumber=" << _blockNumber << ",m_blocks.size()=" << m_blocks.size();
-			return;
-		}
-
-		if(0 == it->first){
-			it = m_blocks.erase(it);
-			continue;
-		}
-
-		removeHeader(it->second.head);
+	for(BlockSlot const* slot = m_blocks.find(_blockNumber); slot; slot = m_blocks.find(++_blockNumber)){
+		removeHeader(*slot);
 
-		cdebug << "remove:it->first=" << it->first;
-		it = m_blocks.erase(it);
+		cdebug << "remove:number=" << _blockNumber;
+		m_blocks.erase(_blockNumber);
 	}
 }
 
@@ -255,9 +466,8 @@ void Request::removeWith(unsigned _blockNumber)
 NodeID Request::id(unsigned _number)
 {
 	if(_number){
-		auto it = m_blocks.find(_number);
-		if(it != m_blocks.end())
-			return it->second.id;
+		if(BlockSlot const* slot = m_blocks.find(_number))
+			return slot->id;
 
 		return NodeID();
 	}
@@ -265,10 +475,7 @@ NodeID Request::id(unsigned _number)
 	if(m_blocks.empty())
 		return NodeID();
 
-	auto it = m_blocks.end();
-	--it;
-
-	return it->second.id;
+	return m_blocks.find(m_blocks.last())->id;
 }
 
 uint64_t Request::upTime() const
@@ -276,39 +483,25 @@ uint64_t Request::upTime() const
 	if(m_blocks.empty())
 		return 0;
 
-	auto it = m_blocks.end();
-	--it;
-
-	return it->second.time;
+	return m_blocks.find(m_blocks.last())->time;
 }
 
 h256 Request::underHash()
 {
-	auto it = m_blocks.begin();
-	if(it != m_blocks.end())
-		return it->second.hash;
+	if(!m_blocks.empty())
+		return m_blocks.find(m_blocks.first())->hash;
 
 	return h256(0);
 }
 
 unsigned Request::upNumber() const
 {
-	if(m_blocks.empty())
-		return 0;
-
-	auto it = m_blocks.end();
-	--it;
-
-	return it->first;
+	return m_blocks.empty() ? 0 : m_blocks.last();
 }
 
 unsigned Request::underNumber() const
 {
-	auto it = m_blocks.begin();
-	if(it != m_blocks.end())
-		return it->first;
-
-	return 0;
+	return m_blocks.empty() ? 0 : m_blocks.first();
 }
 
 void Request::insertBlock(bytesConstRef _block, NodeID _id)
@@ -323,11 +516,7 @@ void Request::insertBlock(bytesConstRef _block, NodeID _id)
 void Request::insertHead(bytesConstRef _block, NodeID _id)
 {
 	try{
-		Blocker blocker(_block, blockerHead, _id);
-		h256 hash = blocker.hash;
-		insertBlocker(move(blocker));
-		//assert(0 == m_heads.count(hash));
-		m_heads.insert(hash);
+		insertBlocker(Blocker(_block, blockerHead, _id));
 	}catch(...){
 		cdebug << "catch err:_block=" << _block.toBytes() << ",_id=" << _id;
 	}
@@ -349,61 +538,57 @@ void Request::insertBody(bytesConstRef _body)
 	}
 	
 	unsigned blockNumber = iter->second;
-	auto it = m_blocks.find(blockNumber);
+	BlockSlot* slot = m_blocks.find(blockNumber);
+	if(!slot || slot->hasBody())
+		return;
 
-	cdebug << "blockNumber=" << blockNumber << ",it->second.hash=" << it->second.hash << ",transactionRoot=" << transactionRoot << ",uncles=" << uncles;
-	//assert(it != m_blocks.end() && it->second.body.empty());
-	it->second.body = _body.toBytes();
+	cdebug << "blockNumber=" << blockNumber << ",slot->hash=" << slot->hash << ",transactionRoot=" << transactionRoot << ",uncles=" << uncles;
+	m_blocks.storeBody(*slot, body.payload());
 }
 
-h256s Request::requestBodys(unsigned _limit)
+/*
+bodies of any header we hold, headers are all linked to the sync peer's chain
+_skip holds the bodies already assigned; expireWork decides when those are asked again
+*/
+h256s Request::requestBodys(unsigned _limit, std::set<h256> const& _skip)
 {
 	h256s bodys;
-
 	if(m_blocks.empty())
 		return bodys;
 
-	uint64_t now = utcTime();
-	auto it = m_blocks.begin();
-	unsigned number = it->first;
-	for(; it != m_blocks.end(); ++it, ++number){
-		if(bodys.size() >= _limit || number != it->first)
-			return bodys;
-
-		//assert(now > it->second.bodyTimeout);
-		if(/*now < it->second.bodyTimeout || */!it->second.body.empty())
+	unsigned number = m_blocks.first();
+	do{
+		BlockSlot* slot = m_blocks.find(number);
+		if(!slot->hasHead() || slot->hasBody() || _skip.count(slot->hash))
 			continue;
 
-		it->second.bodyTimeout = now + REQUEST_BODY_TIMEOUT;
-		h256 hash = it->second.hash;
-		bodys.push_back(hash);
-	}
+		bodys.push_back(slot->hash);
+	}while(bodys.size() < _limit && m_blocks.next(number));
 
 	return bodys;
 }
 
-std::tuple<unsigned, unsigned> Request::requestHeads()
+/*
+(start, count) of every hole between the headers we hold
+*/
+std::vector<std::tuple<unsigned, unsigned>> Request::requestHeads() const
 {
+	std::vector<std::tuple<unsigned, unsigned>> heads;
 	if(m_blocks.empty())
-		return make_tuple(0, 0);
-	
-	auto it = m_blocks.begin();
-	unsigned number = it->first;
-	for(++it, ++number; it != m_blocks.end(); ++it, ++number){
-		if(number != it->first)
-			break;
-	}
+		return heads;
 
-	if(it == m_blocks.end())
-		return make_tuple(0, m_blocks.begin()->first);
+	unsigned number = m_blocks.first();
+	for(unsigned held = number; m_blocks.next(held); number = held){
+		if(number + 1 != held)
+			heads.push_back(make_tuple(number + 1, held - number - 1));
+	}
 
-	assert(it->first > number);
-	return make_tuple(number, it->first-number);
+	return heads;
 }
 
 bool Request::haveItem(unsigned blockNumber)
 {
-	return m_blocks.find(blockNumber) != m_blocks.end();
+	return m_blocks.find(blockNumber);
 }
 
 bool Request::empty()
@@ -418,12 +603,12 @@ unsigned Request::size()
 
 h256 Request::hash(unsigned _number)
 {
-	auto it = m_blocks.find(_number);
-	if(it == m_blocks.end())
+	BlockSlot const* slot = m_blocks.find(_number);
+	if(!slot)
 		return h256(0);
 
-	assert(it->first == _number);
-	return it->second.hash;
+	assert(slot->number == _number);
+	return slot->hash;
 }
 
 void Request::clearNeedless(class BlockChainRequest *request)
@@ -431,16 +616,16 @@ void Request::clearNeedless(class BlockChainRequest *request)
 	if(empty())
 		return;
 
-	auto it = m_blocks.begin();
-	unsigned number = it->first;
-	for(; it != m_blocks.end(); ++it){
-		if(!request->knowHash(it->second.hash)){
-			cdebug << "it->second.hash=" << it->second.hash << ",number=" << number;
+	unsigned number = m_blocks.first();
+	unsigned held = number;
+	do{
+		if(!request->knowHash(m_blocks.find(held)->hash)){
+			cdebug << "hash=" << m_blocks.find(held)->hash << ",number=" << number;
 			break;
 		}
 
-		number = it->first;
-	}
+		number = held;
+	}while(m_blocks.next(held));
 
 	if(number > 1)
 		removeUnder(number);
@@ -450,43 +635,35 @@ void Request::collectBlocks(class BlockChainRequest *request)
 {
 	clearNeedless(request);
 	
-	auto it = m_blocks.begin();
-	if(it == m_blocks.end())
+	if(m_blocks.empty())
+		return;
+
+	unsigned held = m_blocks.first();
+	if(0 == held && !m_blocks.next(held))
 		return;
-	if(0 == it->first)
-		++it;
 	
-	if(it->second.body.empty())
-		++it;
+	if(!m_blocks.find(held)->hasBody() && !m_blocks.next(held))
+		return;
 
-	unsigned blockNumber = it->first;
+	unsigned blockNumber = held;
 	unsigned maxNumber = 0;
-	for(; it != m_blocks.end(); ++it, ++blockNumber)
+	for(bool more = true; more; more = m_blocks.next(held), ++blockNumber)
 	{
-		Blocker &blocker = it->second;
-		if(blocker.body.empty() || blocker.head.empty()){
-			cdebug << "it->first=" << it->first << ",blockNumber=" << blockNumber << ",blocker.hash=" << blocker.hash;
+		BlockSlot const& blocker = *m_blocks.find(held);
+		if(!blocker.hasBody() || !blocker.hasHead()){
+			cdebug << "held=" << held << ",blockNumber=" << blockNumber << ",blocker.hash=" << blocker.hash;
 			break;
 		}
 
-		cdebug << "it->first=" << it->first << ",blocker.hash=" << blocker.hash;
-		BlockHeader header(blocker.head, HeaderData);
-		unsigned number = header.number();
-		assert(number == it->first);
-		
-		RLP body(blocker.body);
-		RLPStream blockStream(body.itemCount()+1);
-		blockStream.appendRaw(blocker.head);
-
-		for(size_t i = 0; i < body.itemCount(); i++)
-			blockStream.appendRaw(body[i].data());
-
-		bytes block;
-		blockStream.swapOut(block);
+		cdebug << "held=" << held << ",blocker.hash=" << blocker.hash;
+		unsigned number = blocker.number;
+		uint64_t blockerTime = blocker.time;
+		h256 hash = blocker.hash;
+		bytesConstRef block = m_blocks.block(blocker);
 		ImportResult result;
 
 		try{
-			result = request->bq().import(&block);
+			result = request->bq().import(block);
 		}catch (Exception const&)
 		{
 			clog(NetWarn) << "Peer causing an Exception:" << boost::current_exception_diagnostic_information() << ",block=" << block;
@@ -504,21 +681,21 @@ void Request::collectBlocks(class BlockChainRequest *request)
 		{
 			case ImportResult::AlreadyKnown:
 				{
-					QueueStatus status = request->bq().blockStatus(header.hash());
-					cdebug << "UnknownParent:status=" << (int)status << ",header.hash()=" << header.hash() << ",header.parentHash()=" << header.parentHash() << ",header.number()=" << header.number();
+					QueueStatus status = request->bq().blockStatus(hash);
+					cdebug << "UnknownParent:status=" << (int)status << ",hash=" << hash << ",number=" << number;
 					if(status != QueueStatus::Ready && status != QueueStatus::Importing){
-						if(status == QueueStatus::UnknownParent && it->first != blockNumber){
-							assert(!request->knowHash(header.hash()));
+						if(status == QueueStatus::UnknownParent && held != blockNumber){
+							assert(!request->knowHash(hash));
 							if(number == upNumber()){
-								cdebug << "UnknownParent_upNumber:blocker.time=" << blocker.time << ",upTime()=" << upTime() << ",blocker.hash=" << blocker.hash << ",upNumber()=" << upNumber();
+								cdebug << "UnknownParent_upNumber:blocker.time=" << blockerTime << ",upTime()=" << upTime() << ",blocker.hash=" << hash << ",upNumber()=" << upNumber();
 								return;
 							}
-							if(blocker.time >= upTime()){
+							if(blockerTime >= upTime()){
 								clear();
-								cdebug << "UnknownParent_time:blocker.time=" << blocker.time << ",upTime()=" << upTime() << ",blocker.hash=" << blocker.hash;
+								cdebug << "UnknownParent_time:blocker.time=" << blockerTime << ",upTime()=" << upTime() << ",blocker.hash=" << hash;
 								//return;
 							}else{
-								cdebug << "UnknownParent_time_old:blocker.time=" << blocker.time << ",upTime()=" << upTime() << ",blocker.hash=" << blocker.hash;
+								cdebug << "UnknownParent_time_old:blocker.time=" << blockerTime << ",upTime()=" << upTime() << ",blocker.hash=" << hash;
 								removeUnder(number+1);
 							}
 							
@@ -624,42 +801,21 @@ void BlockChainRequest::onBlockImported(BlockHeader const& _info)
 void BlockChainRequest::continueSync(std::shared_ptr<EthereumPeer> _peer)
 {
 	m_request.collectBlocks(this);
+	if(!m_request.empty() && knowHash(m_request.underHash())){
+		scheduleSync();
+		return;
+	}
+
 	if(m_request.empty() || _peer->id() != m_request.id()){
 		cdebug << "not_continueSync:_peer->id()=" << _peer->id() << ",m_request.id()=" << m_request.id() << ",m_request.empty()=" << m_request.empty();
 		return;
 	}
 
+	//look for the fork point, only the sync peer knows its own chain
 	unsigned start = m_request.underNumber();
 	unsigned count = 0;
 	h256 startHash = m_request.underHash();
 	unsigned mystart = static_cast<unsigned>(m_host.chain().number());
-	if(knowHash(startHash)){
-		h256s bodys = m_request.requestBodys(MAX_REQUEST_COUNT);
-		if (!bodys.empty()){
-			_peer->requestBlockBodies(bodys);
-			cdebug << "request_body:start=" << start << ",bodys.size()=" << bodys.size();
-			return;
-		}
-
-		unsigned end = start;
-		tie(start, count) = m_request.requestHeads();
-		cdebug << "start=" << start << ",count=" << count << ",mystart=" << mystart << ",end=" << end;
-		end = start + count;
-		if(mystart > end && count > MAX_REQUEST_COUNT*4){
-			start = start + count/2;
-			count = end - start;
-		}
-		
-		if(count > MAX_REQUEST_COUNT)
-			count = MAX_REQUEST_COUNT;
-
-		//assert(start > 0 && count > 0);
-		if(start > 0 && count > 0)
-			_peer->requestBlockHeaders(start, count, 0, false);
-		
-		cdebug << "request_head_konw:start=" << start << ",count=" << count;
-		return;
-	}
 
 	cdebug << "start=" << start << ",count=" << count << ",mystart=" << mystart << ",startHash=" << startHash;
 	assert(start);
@@ -681,6 +837,132 @@ void BlockChainRequest::continueSync(std::shared_ptr<EthereumPeer> _peer)
 	cdebug << "request_head_unkonw:start=" << start << ",count=" << count;
 }
 
+void BlockChainRequest::scheduleSync()
+{
+	expireWork();
+
+	u256 td = host().chain().details().totalDifficulty;
+	NodeID syncId = m_request.id();
+	host().foreachPeer([&](std::shared_ptr<EthereumPeer> _p)
+	{
+		if(_p->isConversing() || _p->isRude() || m_assigned.count(_p->id()))
+			return true;
+		if(_p->id() != syncId && _p->m_totalDifficulty <= td)
+			return true;
+
+		//stop once there is nothing left to hand out
+		return assignWork(_p);
+	});
+}
+
+bool BlockChainRequest::assignWork(std::shared_ptr<EthereumPeer> _peer)
+{
+	SyncAssignment work;
+	work.deadline = utcTime() + c_assignTimeout;
+	work.peer = _peer;
+	auto heads = m_request.requestHeads();
+
+	//the sync peer first splits large gaps with a skeleton so that others can fill them in
+	if(_peer->id() == m_request.id()){
+		bool skeleton = false;
+		for(auto const& a: m_assigned)
+			skeleton = skeleton || a.second.skip;
+
+		for(auto const& h: heads){
+			unsigned start, count;
+			tie(start, count) = h;
+			if(skeleton || count <= c_chunkHeaders)
+				continue;
+
+			work.asking = Asking::BlockHeaders;
+			work.start = start + c_chunkHeaders - 1;
+			work.count = min(c_skeletonHeaders, count / c_chunkHeaders);
+			work.skip = c_chunkHeaders - 1;
+			_peer->requestBlockHeaders(work.start, work.count, work.skip, false);
+			cdebug << "request_skeleton:start=" << work.start << ",count=" << work.count << ",_peer->id()=" << _peer->id();
+			m_assigned[_peer->id()] = move(work);
+			return true;
+		}
+	}
+
+	std::set<h256> asked;
+	for(auto const& a: m_assigned)
+		asked.insert(a.second.bodies.begin(), a.second.bodies.end());
+	work.bodies = m_request.requestBodys(c_chunkBodies, asked);
+	if(!work.bodies.empty()){
+		work.asking = Asking::BlockBodies;
+		_peer->requestBlockBodies(work.bodies);
+		cdebug << "request_body:bodys.size()=" << work.bodies.size() << ",_peer->id()=" << _peer->id();
+		m_assigned[_peer->id()] = move(work);
+		return true;
+	}
+
+	//only the bottom of a gap links to a header we hold, so each gap is one chunk
+	for(auto const& h: heads){
+		unsigned start, count;
+		tie(start, count) = h;
+		if(!start || headersAsked(start))
+			continue;
+
+		work.asking = Asking::BlockHeaders;
+		work.start = start;
+		work.count = min(c_chunkHeaders, count);
+		_peer->requestBlockHeaders(work.start, work.count, 0, false);
+		cdebug << "request_head_konw:start=" << work.start << ",count=" << work.count << ",_peer->id()=" << _peer->id();
+		m_assigned[_peer->id()] = move(work);
+		return true;
+	}
+
+	return false;
+}
+
+bool BlockChainRequest::headersAsked(unsigned _start) const
+{
+	for(auto const& a: m_assigned)
+		if(a.second.asking == Asking::BlockHeaders && !a.second.skip && a.second.start <= _start && _start < a.second.start + a.second.count)
+			return true;
+
+	return false;
+}
+
+void BlockChainRequest::expireWork()
+{
+	uint64_t now = utcTime();
+	for(auto it = m_assigned.begin(); it != m_assigned.end();){
+		if(now < it->second.deadline){
+			++it;
+			continue;
+		}
+
+		cdebug << "reassign:id=" << it->first << ",asking=" << (int)it->second.asking << ",start=" << it->second.start << ",bodies=" << it->second.bodies.size();
+		it = m_assigned.erase(it);
+	}
+}
+
+void BlockChainRequest::onPeerAborting()
+{
+	RecursiveGuard l(x_sync);
+	//the peer is gone by now, so its work is found by the expired pointer
+	for(auto it = m_assigned.begin(); it != m_assigned.end();){
+		if(!it->second.peer.expired()){
+			++it;
+			continue;
+		}
+
+		cdebug << "aborted:id=" << it->first << ",asking=" << (int)it->second.asking << ",start=" << it->second.start << ",bodies=" << it->second.bodies.size();
+		it = m_assigned.erase(it);
+	}
+	scheduleSync();
+}
+
+void BlockChainRequest::tick()
+{
+	RecursiveGuard l(x_sync);
+	//continueSync only runs when a packet arrives, which a stalled peer never sends
+	if(!m_assigned.empty() || !m_request.empty())
+		scheduleSync();
+}
+
 void BlockChainRequest::onPeerStatus(std::shared_ptr<EthereumPeer> _peer)
 {
 	RecursiveGuard l(x_sync);
@@ -719,6 +1001,7 @@ bool BlockChainRequest::knowHash(h256 _hash)
 void BlockChainRequest::onPeerBlockBodies(std::shared_ptr<EthereumPeer> _peer, RLP const& _r)
 {
 	RecursiveGuard l(x_sync);
+	m_assigned.erase(_peer->id());
 
 	size_t itemCount = _r.itemCount();
 	clog(NetMessageSummary) << "BlocksBodies (" << dec << itemCount << "entries)" << (itemCount ? "" : ": NoMoreBodies");
@@ -739,6 +1022,7 @@ void BlockChainRequest::onPeerBlockBodies(std::shared_ptr<EthereumPeer> _peer, R
 void BlockChainRequest::onPeerBlockHeaders(std::shared_ptr<EthereumPeer> _peer, RLP const& _r)
 {
 	RecursiveGuard l(x_sync);
+	m_assigned.erase(_peer->id());
 
 	size_t itemCount = _r.itemCount();
 	clog(NetMessageSummary) << "BlocksHeaders (" << dec << itemCount << "entries)" << (itemCount ? "" : ": NoMoreHeaders") << ",_peer->id()=" << _peer->id();
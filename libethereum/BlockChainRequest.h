@@ -55,59 +55,104 @@ enum
 	blockerBlock
 };
 
+struct Header
+{
+	h256 transactionsRoot;
+	h256 uncles;
+
+	bool operator<(Header const& _other) const
+	{
+		return transactionsRoot < _other.transactionsRoot || (transactionsRoot == _other.transactionsRoot && uncles < _other.uncles);
+	}
+};
+
+/// A header or whole block as received; head and body point into the packet being handled.
 class Blocker
 {
 public:
-	Blocker(h256 _hash){hash = _hash;};
-	Blocker(){time = utcTime();};
 	Blocker(bytesConstRef _block, unsigned _type, NodeID _id);
-	Blocker& operator=(Blocker&& _other)
-	{
-		assert(&_other != this);
-
-		//transaction = std::move(_other.transaction);
-		head = std::move(_other.head);
-		body = std::move(_other.body);
-		bodyTimeout = std::move(_other.bodyTimeout);
-		hash = std::move(_other.hash);
-		parent = std::move(_other.parent);
-		id = std::move(_other.id);
-		time = _other.time;
-		return *this;
-	}
-	Blocker& operator=(Blocker& _other)
-	{
-		assert(&_other != this);
-
-		//transaction = std::move(_other.transaction);
-		head = _other.head;
-		body = _other.body;
-		bodyTimeout = _other.bodyTimeout;
-		hash = _other.hash;
-		parent = _other.parent;
-		id = _other.id;
-		time = _other.time;
-		return *this;
-	}
-	
-	bytes head;		///< Header data
-	bytes body;		///< Header data
-	uint64_t bodyTimeout = 0;		///< Header data
+
+	bytesConstRef head;		///< Header data
+	bytesConstRef body;		///< Transactions and uncles, without the list prefix; empty for a header
 	h256 hash;		///< Block hash
 	h256 parent;	///< Parent hash
+	Header root;	///< Transactions root and uncles hash the body must match
+	unsigned number = 0;
 	NodeID id;
 	uint64_t time;
 };
 
-struct Header
+/// A pending block as held by Request; the bytes live in BlockRing's arena.
+struct BlockSlot
 {
-	h256 transactionsRoot;
-	h256 uncles;
+	bool hasHead() const { return headSize; }
+	bool hasBody() const { return blockSize; }
+
+	unsigned number = 0;
+	bool used = false;
+	size_t head = 0;			///< Arena offset of the header
+	size_t headSize = 0;
+	size_t block = 0;			///< Arena offset of the assembled block, once the body is in
+	size_t blockSize = 0;
+	h256 hash;		///< Block hash
+	h256 parent;	///< Parent hash
+	Header root;
+	NodeID id;
+	uint64_t time = 0;
+};
 
-	bool operator<(Header const& _other) const
-	{
-		return transactionsRoot < _other.transactionsRoot || (transactionsRoot == _other.transactionsRoot && uncles < _other.uncles);
-	}
+/**
+ * @brief Pending blocks indexed by number.
+ * A window of c_size slots starting at the lowest number holds the range being synced; the few
+ * numbers beyond it (the sync peer's head, skeleton anchors) wait in an ordered overflow until
+ * the window reaches them. Headers and assembled blocks are appended to one arena, so storing
+ * and queueing a batch costs no per-block allocation and block() is a view ready for import.
+ */
+class BlockRing
+{
+public:
+	static const unsigned c_size = 4096;
+
+	BlockRing(): m_slots(c_size) {}
+
+	BlockSlot* find(unsigned _number);
+	BlockSlot const* find(unsigned _number) const;
+	/// @returns an empty slot for _number, dropping whatever was held there.
+	BlockSlot& insert(unsigned _number);
+	void erase(unsigned _number);
+	void clear();
+
+	bool empty() const { return !m_count; }
+	unsigned size() const { return m_count; }
+	/// Lowest and highest numbers held; only meaningful when not empty.
+	unsigned first() const { return m_base; }
+	unsigned last() const { return m_last; }
+	/// Moves _number to the next number held above it. @returns false when there is none.
+	bool next(unsigned& _number) const;
+
+	void storeHead(BlockSlot& _slot, bytesConstRef _head);
+	/// Writes [head, transactions, uncles] as one block behind the header.
+	void storeBody(BlockSlot& _slot, bytesConstRef _payload);
+	bytesConstRef head(BlockSlot const& _slot) const { return bytesConstRef(m_arena.data() + _slot.head, _slot.headSize); }
+	bytesConstRef block(BlockSlot const& _slot) const { return bytesConstRef(m_arena.data() + _slot.block, _slot.blockSize); }
+
+private:
+	BlockSlot& slot(unsigned _number) { return m_slots[_number & (c_size - 1)]; }
+	BlockSlot const& slot(unsigned _number) const { return m_slots[_number & (c_size - 1)]; }
+	bool inWindow(unsigned _number) const { return _number >= m_base && _number - m_base < c_size; }
+	void release(BlockSlot const& _slot);
+	void rebase(unsigned _base);
+	void compact();
+
+	std::vector<BlockSlot> m_slots;
+	std::map<unsigned, BlockSlot> m_ahead;	///< Numbers at or past m_base + c_size
+	unsigned m_base = 0;
+	unsigned m_last = 0;
+	unsigned m_count = 0;
+
+	bytes m_arena;
+	bytes m_spare;			///< Compaction target, swapped with m_arena
+	size_t m_dead = 0;		///< Arena bytes no slot refers to any more
 };
 
 class BlockChainRequest;
@@ -116,8 +161,8 @@ class Request
 {
 public:
 	Request(h256 _hash):m_genesis(_hash){};
-	void insertBlocker(unsigned blockNumber, Blocker&& _block, const BlockHeader& _header);
-	void insertBlocker(Blocker&& _blocker);
+	void insertBlocker(unsigned blockNumber, Blocker const& _block);
+	void insertBlocker(Blocker const& _blocker);
 	void insertBlock(bytesConstRef _block, NodeID _id);
 	void insertHead(bytesConstRef _block, NodeID _id);
 	void insertBody(bytesConstRef _block);
@@ -128,12 +173,12 @@ public:
 	unsigned upNumber() const;
 	unsigned underNumber() const;
 	void removeWith(unsigned _blockNumber);
-	void removeHeader(const bytes& _head);
+	void removeHeader(BlockSlot const& _slot);
 	void removeUpWith(unsigned _blockNumber);
 	void removeUnder(unsigned blockNumber);
 
-	dev::h256s requestBodys(unsigned _limit);
-	std::tuple<unsigned, unsigned>  requestHeads();
+	dev::h256s requestBodys(unsigned _limit, std::set<h256> const& _skip);
+	std::vector<std::tuple<unsigned, unsigned>> requestHeads() const;
 
 	bool haveItem(unsigned blockNumber);
 	bool empty();
@@ -146,10 +191,21 @@ protected:
 	void clearNeedless(class BlockChainRequest *request);
 	
 private:
-	std::map<unsigned, Blocker> m_blocks;
+	BlockRing m_blocks;
 	std::map<Header, unsigned> m_HeaderToNumber;
-	Blocker m_genesis;
-	std::set<h256> m_heads;
+	h256 m_genesis;
+};
+
+/// Work handed to one peer; a peer only ever has one request in flight.
+struct SyncAssignment
+{
+	Asking asking = Asking::Nothing;
+	unsigned start = 0;			///< First header number asked for
+	unsigned count = 0;			///< Number of headers asked for
+	unsigned skip = 0;			///< Non-zero for a skeleton request
+	h256s bodies;				///< Hashes of the blocks whose bodies were asked for
+	uint64_t deadline = 0;		///< utcTime() after which the work goes to another peer
+	std::weak_ptr<EthereumPeer> peer;	///< Expires once the peer has disconnected
 };
 
 class BlockChainRequest: public BlockChainSyncInterface
@@ -173,7 +229,10 @@ public:
 	void onPeerNewHashes(std::shared_ptr<EthereumPeer> _peer, std::vector<std::pair<h256, u256>> const& _hashes);
 
 	/// Called by peer when it is disconnecting
-	void onPeerAborting(){};
+	void onPeerAborting();
+
+	/// Hands out again the work of peers that did not answer in time
+	void tick();
 
 	/// Called when a blockchain has imported a new block onto the DB
 	void onBlockImported(BlockHeader const& _info);
@@ -182,6 +241,12 @@ public:
 	bool knowHash(h256 _hash);
 private:
 	void syncPeer(std::shared_ptr<EthereumPeer> _peer, bool _force);
+
+	/// Hand headers and bodies of the pending range out to every idle peer that is ahead of us.
+	void scheduleSync();
+	bool assignWork(std::shared_ptr<EthereumPeer> _peer);
+	bool headersAsked(unsigned _start) const;
+	void expireWork();
 	
 private:
 	EthereumHost& host() { return m_host; }
@@ -191,6 +256,7 @@ private:
 	Request m_request;
 
 	mutable RecursiveMutex x_sync;
+	std::map<NodeID, SyncAssignment> m_assigned;	///< In-flight work per peer
 
 	u256 m_syncingTotalDifficulty;				///< Highest peer difficulty
 	unsigned m_highestBlock = 0;
@@ -75,6 +75,9 @@ public:
 	/// Called by peer when it is disconnecting
 	virtual void onPeerAborting(){};
 
+	/// Called by the host about once a second
+	virtual void tick(){};
+
 	/// Called when a blockchain has imported a new block onto the DB
 	virtual void onBlockImported(BlockHeader const& ){};
 
@@ -0,0 +1,230 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file BlockSegmentStore.cpp
+ */
+
+#include "BlockSegmentStore.h"
+#include <cstring>
+#include <boost/filesystem.hpp>
+#include <libdevcore/CommonIO.h>
+#include <libdevcore/Log.h>
+#include <libdevcore/RLP.h>
+#include <libethcore/BlockHeader.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+namespace fs = boost::filesystem;
+namespace bip = boost::interprocess;
+
+namespace
+{
+
+/// hash, number, offset, size and transaction count.
+size_t const c_recordHeaderSize = 32 + 4 + 8 + 4 + 4;
+
+/// Records at the end of a segment index that are checked against the data on open, in case
+/// the index made it to disk ahead of the blocks.
+unsigned const c_checkedRecords = 16;
+
+void put(bytes& io_out, uint64_t _value, size_t _size)
+{
+	bytes b(_size);
+	toBigEndian(_value, b);
+	io_out += b;
+}
+
+}
+
+BlockSegmentStore::BlockSegmentStore(fs::path const& _path, uint64_t _segmentSize):
+	m_path(_path),
+	m_segmentSize(_segmentSize)
+{
+	fs::create_directories(m_path);
+	DEV_IGNORE_EXCEPTIONS(fs::permissions(m_path, fs::owner_all));
+
+	for (unsigned i = 0; i == 0 || fs::exists(segmentPath(i, "seg")); ++i)
+	{
+		openSegment(i);
+		load(i);
+	}
+	cnote << "Opened block segments at" << m_path << ":" << m_index.size() << "blocks in" << m_segments.size() << "segments";
+}
+
+BlockSegmentStore::~BlockSegmentStore()
+{
+	for (auto const& s: m_segments)
+		DEV_IGNORE_EXCEPTIONS(s->region.flush());
+}
+
+fs::path BlockSegmentStore::segmentPath(unsigned _segment, char const* _extension) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%06u.%s", _segment, _extension);
+	return m_path / name;
+}
+
+void BlockSegmentStore::openSegment(unsigned _segment)
+{
+	fs::path const data = segmentPath(_segment, "seg");
+	if (!fs::exists(data))
+	{
+		ofstream create(data.string(), ios::binary);
+		create.close();
+		fs::resize_file(data, m_segmentSize);
+	}
+
+	unique_ptr<Segment> s(new Segment);
+	s->file = bip::file_mapping(data.string().c_str(), bip::read_write);
+	s->region = bip::mapped_region(s->file, bip::read_write);
+	s->index.open(segmentPath(_segment, "idx").string(), ios::binary | ios::app);
+	m_segments.push_back(move(s));
+}
+
+void BlockSegmentStore::load(unsigned _segment)
+{
+	Segment& s = *m_segments[_segment];
+	bytes const index = contents(segmentPath(_segment, "idx"));
+
+	struct Record
+	{
+		h256 hash;
+		unsigned number;
+		Location location;
+		size_t end;
+	};
+	vector<Record> records;
+	vector<pair<unsigned, unsigned>> transactions;
+	size_t pos = 0;
+	while (pos + c_recordHeaderSize <= index.size())
+	{
+		bytesConstRef r(index.data() + pos, index.size() - pos);
+		Record record;
+		record.hash = h256(r.cropped(0, 32));
+		record.number = fromBigEndian<unsigned>(r.cropped(32, 4));
+		record.location.segment = _segment;
+		record.location.offset = fromBigEndian<uint64_t>(r.cropped(36, 8));
+		record.location.size = fromBigEndian<unsigned>(r.cropped(44, 4));
+		record.location.transactionCount = fromBigEndian<unsigned>(r.cropped(48, 4));
+		record.location.firstTransaction = transactions.size();
+		size_t const size = c_recordHeaderSize + 8 * record.location.transactionCount;
+		if (size > r.size() || record.location.offset + record.location.size > s.region.get_size())
+			break;
+		for (unsigned i = 0; i < record.location.transactionCount; ++i)
+			transactions.emplace_back(fromBigEndian<unsigned>(r.cropped(c_recordHeaderSize + 8 * i, 4)), fromBigEndian<unsigned>(r.cropped(c_recordHeaderSize + 8 * i + 4, 4)));
+		pos += size;
+		record.end = pos;
+		records.push_back(record);
+	}
+
+	// Drop everything from the first damaged record among the last few.
+	size_t valid = records.size();
+	for (size_t i = valid > c_checkedRecords ? valid - c_checkedRecords : 0; i < valid; ++i)
+	{
+		bool intact = false;
+		DEV_IGNORE_EXCEPTIONS(intact = BlockHeader::headerHashFromBlock(bytesConstRef(data(records[i].location), records[i].location.size)) == records[i].hash);
+		if (!intact)
+			valid = i;
+	}
+	size_t const keep = valid ? records[valid - 1].end : 0;
+	if (keep != index.size())
+	{
+		cwarn << "Dropping" << (records.size() - valid) << "damaged records from block segment index" << _segment;
+		s.index.close();
+		fs::resize_file(segmentPath(_segment, "idx"), keep);
+		s.index.open(segmentPath(_segment, "idx").string(), ios::binary | ios::app);
+	}
+
+	size_t const base = m_transactions.size();
+	for (size_t i = 0; i < valid; ++i)
+	{
+		Location l = records[i].location;
+		l.firstTransaction += base;
+		m_index[records[i].hash] = l;
+		m_lastNumber = max(m_lastNumber, records[i].number);
+		s.used = max<uint64_t>(s.used, l.offset + l.size);
+	}
+	if (valid)
+		transactions.resize(records[valid - 1].location.firstTransaction + records[valid - 1].location.transactionCount);
+	else
+		transactions.clear();
+	m_transactions.insert(m_transactions.end(), transactions.begin(), transactions.end());
+}
+
+bool BlockSegmentStore::append(unsigned _number, bytesConstRef _block)
+{
+	h256 const hash = BlockHeader::headerHashFromBlock(_block);
+	RLP const transactions = RLP(_block)[1];
+
+	WriteGuard l(x_index);
+	if (m_index.count(hash) || _block.size() > m_segmentSize)
+		return false;
+
+	if (m_segments.back()->used + _block.size() > m_segments.back()->region.get_size())
+		openSegment(m_segments.size());
+	Segment& s = *m_segments.back();
+
+	Location location;
+	location.segment = m_segments.size() - 1;
+	location.offset = s.used;
+	location.size = _block.size();
+	location.firstTransaction = m_transactions.size();
+	location.transactionCount = transactions.itemCount();
+
+	bytes record = hash.asBytes();
+	put(record, _number, 4);
+	put(record, location.offset, 8);
+	put(record, location.size, 4);
+	put(record, location.transactionCount, 4);
+	for (auto const& t: transactions)
+	{
+		unsigned const offset = t.data().data() - _block.data();
+		put(record, offset, 4);
+		put(record, t.data().size(), 4);
+		m_transactions.emplace_back(offset, t.data().size());
+	}
+
+	// Data first, then the index record that makes it visible.
+	memcpy((byte*)s.region.get_address() + s.used, _block.data(), _block.size());
+	s.region.flush(s.used, _block.size());
+	s.index.write((char const*)record.data(), record.size());
+	s.index.flush();
+
+	s.used += _block.size();
+	m_index[hash] = location;
+	m_lastNumber = max(m_lastNumber, _number);
+	return true;
+}
+
+bytesConstRef BlockSegmentStore::block(h256 const& _hash) const
+{
+	ReadGuard l(x_index);
+	auto it = m_index.find(_hash);
+	if (it == m_index.end())
+		return bytesConstRef();
+	return bytesConstRef(data(it->second), it->second.size);
+}
+
+bytesConstRef BlockSegmentStore::transaction(h256 const& _blockHash, unsigned _i) const
+{
+	ReadGuard l(x_index);
+	auto it = m_index.find(_blockHash);
+	if (it == m_index.end() || _i >= it->second.transactionCount)
+		return bytesConstRef();
+	auto const& t = m_transactions[it->second.firstTransaction + _i];
+	return bytesConstRef(data(it->second) + t.first, t.second);
+}
@@ -0,0 +1,106 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file BlockSegmentStore.h
+ * Append-only, memory-mapped store of finalised blocks.
+ */
+
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+
+namespace dev
+{
+namespace eth
+{
+
+/// Size of each segment file; a new one is started when a block no longer fits.
+static const uint64_t c_blockSegmentSize = 256 * 1024 * 1024;
+
+/**
+ * @brief Blocks laid end to end in fixed-size segment files, each mapped into memory once.
+ * Every segment has a sidecar index of [hash, number, offset, size, transaction offsets]
+ * records, so block and transaction reads are slices of the mapping with no decoding.
+ * Blocks are only ever appended; the blocks database remains the authoritative copy.
+ * @threadsafe
+ */
+class BlockSegmentStore
+{
+public:
+	explicit BlockSegmentStore(boost::filesystem::path const& _path, uint64_t _segmentSize = c_blockSegmentSize);
+	~BlockSegmentStore();
+
+	/// Appends block number @a _number. @returns false if it was already stored or can never
+	/// fit in a segment.
+	bool append(unsigned _number, bytesConstRef _block);
+
+	/// @returns the block RLP, or an empty slice if the block is not stored. Valid for the
+	/// lifetime of the store.
+	bytesConstRef block(h256 const& _hash) const;
+
+	/// @returns the RLP of transaction @a _i of the block, or an empty slice.
+	bytesConstRef transaction(h256 const& _blockHash, unsigned _i) const;
+
+	bool contains(h256 const& _hash) const { ReadGuard l(x_index); return m_index.count(_hash); }
+
+	/// Highest block number appended so far; 0 when empty.
+	unsigned lastNumber() const { ReadGuard l(x_index); return m_lastNumber; }
+
+	size_t size() const { ReadGuard l(x_index); return m_index.size(); }
+
+private:
+	struct Segment
+	{
+		boost::interprocess::file_mapping file;
+		boost::interprocess::mapped_region region;
+		uint64_t used = 0;
+		std::ofstream index;
+	};
+
+	struct Location
+	{
+		unsigned segment;
+		uint64_t offset;
+		unsigned size;
+		size_t firstTransaction;
+		unsigned transactionCount;
+	};
+
+	void load(unsigned _segment);
+	void openSegment(unsigned _segment);
+	boost::filesystem::path segmentPath(unsigned _segment, char const* _extension) const;
+	byte const* data(Location const& _l) const { return (byte const*)m_segments[_l.segment]->region.get_address() + _l.offset; }
+
+	boost::filesystem::path m_path;
+	uint64_t m_segmentSize;
+
+	mutable SharedMutex x_index;
+	std::vector<std::unique_ptr<Segment>> m_segments;
+	std::unordered_map<h256, Location> m_index;
+	std::vector<std::pair<unsigned, unsigned>> m_transactions;	///< [offset in block, size] of every transaction.
+	unsigned m_lastNumber = 0;
+};
+
+}
+}
@@ -97,6 +97,11 @@ void Client::init(p2p::Host* _extNet, fs::path const& _dbPath, fs::path const& _
     // TODO: consider returning the upgrade mechanism here. will delaying the opening of the blockchain database
     // until after the construction.
     m_stateDB = State::openDB(_dbPath, bc().genesisHash(), _forceAction);
+    // State batches still queued for writing when the process died are gone, while the blocks
+    // that produced them were recorded.
+    bc().rewindToState(m_stateDB);
+    if (auto const& flat = m_stateDB.flatState())
+        flat->advance(bc().info().stateRoot());
     // LAZY. TODO: move genesis state construction/commiting to stateDB openning and have this just take the root from the genesis block.
     m_preSeal = bc().genesisBlock(m_stateDB);
     m_postSeal = m_preSeal;
@@ -286,6 +291,9 @@ void Client::reopenChain(ChainParams const& _p, WithExisting _we)
         m_stateDB = OverlayDB();
         bc().reopen(_p, _we);
         m_stateDB = State::openDB(Defaults::dbPath(), bc().genesisHash(), _we);
+        bc().rewindToState(m_stateDB);
+        if (auto const& flat = m_stateDB.flatState())
+            flat->advance(bc().info().stateRoot());
 
         m_preSeal = bc().genesisBlock(m_stateDB);
         m_preSeal.setAuthor(_p.author);
@@ -513,8 +521,9 @@ void Client::onNewBlocks(h256s const& _blocks, h256Hash& io_changed)
 
 void Client::resyncStateFromChain()
 {
+    // A block built ahead of the chain is kept as long as the chain catches up with what it is built on.
     DEV_READ_GUARDED(x_working)
-        if (bc().currentHash() == m_working.info().parentHash())
+        if (m_working.buildsOn(bc().currentHash()))
             return;
         
     // RESTART MINING
@@ -777,6 +786,10 @@ void Client::checkWatchGarbage()
 
         // blockchain GC
         bc().garbageCollect();
+        auto const stats = bc().usage();
+        clog(ClientTrace) << "DB read cache hit rates: blocks" << stats.blocksDB.hitRate()
+            << "extras" << stats.extrasDB.hitRate() << "state" << m_stateDB.cacheStats().hitRate()
+            << "trie nodes" << TrieNodeCache::get().stats().hitRate();
 
         m_lastGarbageCollection = chrono::system_clock::now();
     }
@@ -97,6 +97,7 @@ public:
     ChainParams const& chainParams() const { return bc().chainParams(); }
 
     virtual ImportResult injectTransaction(bytes const& _rlp, IfDropped _id = IfDropped::Ignore) override { prepareForTransaction(); return m_tq.import(_rlp, _id); }
+    virtual std::vector<ImportResult> injectTransactions(std::vector<bytes> const& _rlps, IfDropped _id = IfDropped::Ignore) override { prepareForTransaction(); return m_tq.import(_rlps, _id); }
 
     /// Resets the gas pricer to some other object.
     void setGasPricer(std::shared_ptr<GasPricer> _gp) { m_gp = _gp; }
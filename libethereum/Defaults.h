@@ -40,9 +40,34 @@ public:
 	static Defaults* get() { if (!s_this) s_this = new Defaults; return s_this; }
 	static void setDBPath(boost::filesystem::path const& _dbPath) { get()->m_dbPath = _dbPath; }
 	static boost::filesystem::path const& dbPath() { return get()->m_dbPath; }
+	/// Keep only the state of the last @a _history blocks and of every @a _checkpointInterval th
+	/// block; a @a _history of 0 keeps every state.
+	static void setStatePruning(unsigned _history, unsigned _checkpointInterval) { get()->m_pruneHistory = _history; get()->m_pruneCheckpoints = _checkpointInterval; }
+
+	/// Write state commits on a background thread, with up to @a _queueDepth of them waiting, and
+	/// sync every @a _syncEvery th to disk; a @a _queueDepth of 0 writes them synchronously.
+	static void setStateCommitQueue(unsigned _queueDepth, unsigned _syncEvery) { get()->m_commitQueue = _queueDepth; get()->m_commitSync = _syncEvery; }
+
+	/// Keep a flat table of the head state's accounts and storage next to the trie, for reads.
+	static void setFlatState(bool _enabled) { get()->m_flatState = _enabled; }
+
+	/// Commit each imported block's blocks, extras and state writes through one write-ahead
+	/// journal, synced once per block, instead of three independent databases.
+	static void setCommitJournal(bool _enabled) { get()->m_commitJournal = _enabled; }
+
+	/// Copy blocks @a _depth or more below the head into memory-mapped segment files, which then
+	/// serve historical block and transaction reads; a @a _depth of 0 disables them.
+	static void setBlockSegments(unsigned _depth) { get()->m_blockSegmentDepth = _depth; }
 
 private:
 	boost::filesystem::path m_dbPath;
+	unsigned m_pruneHistory = 0;
+	unsigned m_pruneCheckpoints = 0;
+	unsigned m_commitQueue = 0;
+	unsigned m_commitSync = 0;
+	bool m_flatState = false;
+	unsigned m_blockSegmentDepth = 0;
+	bool m_commitJournal = false;
 
 	static Defaults* s_this;
 };
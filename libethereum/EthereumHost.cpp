@@ -452,6 +452,7 @@ void EthereumHost::doWork()
 	{
 		m_lastTick = now;
 		foreachPeer([](std::shared_ptr<EthereumPeer> _p) { _p->tick(); return true; });
+		m_sync->tick();
 	}
 
 //	return netChange;
@@ -99,6 +99,10 @@ public:
 	/// Injects the RLP-encoded transaction given by the _rlp into the transaction queue directly.
 	virtual ImportResult injectTransaction(bytes const& _rlp, IfDropped _id = IfDropped::Ignore) = 0;
 
+	/// Injects a batch of RLP-encoded transactions into the transaction queue directly.
+	/// @returns the import result of each.
+	virtual std::vector<ImportResult> injectTransactions(std::vector<bytes> const& _rlps, IfDropped _id = IfDropped::Ignore) = 0;
+
 	/// Injects the RLP-encoded block given by the _rlp into the block queue directly.
 	virtual ImportResult injectBlock(bytes const& _block) = 0;
 
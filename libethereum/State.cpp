@@ -27,8 +27,9 @@
 #include "ExtVM.h"
 #include "TransactionQueue.h"
 #include <libdevcore/Assertions.h>
-#include <libdevcore/DBImpl.h>
+#include <libdevcore/DBFactory.h>
 #include <libdevcore/TrieHash.h>
+#include <libdevcore/WorkerPool.h>
 #include <libevm/VMFactory.h>
 #include <boost/filesystem.hpp>
 #include <boost/timer.hpp>
@@ -66,6 +67,7 @@ State::State(u256 const& _accountStartNonce, OverlayDB const& _db, BaseState _bs
     if (_bs != BaseState::PreExisting)
         // Initialise to the state entailed by the genesis block; this guarantees the trie is built correctly.
         m_state.init();
+    m_flatBase = m_state.root();
 }
 
 State::State(State const& _s):
@@ -75,6 +77,8 @@ State::State(State const& _s):
     m_unchangedCacheEntries(_s.m_unchangedCacheEntries),
     m_nonExistingAccountsCache(_s.m_nonExistingAccountsCache),
     m_touched(_s.m_touched),
+    m_flatBase(_s.m_flatBase),
+    m_flatChanges(_s.m_flatChanges),
     m_accountStartNonce(_s.m_accountStartNonce)
 {}
 
@@ -85,7 +89,7 @@ OverlayDB State::openDB(fs::path const& _basePath, h256 const& _genesisHash, Wit
     if (_we == WithExisting::Kill)
     {
         clog(StateDetail) << "Killing state database (WithExisting::Kill).";
-        fs::remove_all(path / fs::path("state"));
+        db::DBFactory::remove(path / fs::path("state"));
     }
 
     path /= fs::path(toHex(_genesisHash.ref().cropped(0, 4))) / fs::path(toString(c_databaseVersion));
@@ -94,9 +98,19 @@ OverlayDB State::openDB(fs::path const& _basePath, h256 const& _genesisHash, Wit
 
     try
     {
-        std::unique_ptr<db::DatabaseFace> db(new db::DBImpl(path / fs::path("state")));
+        std::unique_ptr<db::DatabaseFace> db = db::DBFactory::create(path / fs::path("state"));
         clog(StateDetail) << "Opened state DB.";
-        return OverlayDB(std::move(db));
+        OverlayDB ret(std::move(db));
+        if (Defaults::get()->m_commitQueue)
+            ret.enableAsyncCommit(Defaults::get()->m_commitQueue, Defaults::get()->m_commitSync);
+        if (Defaults::get()->m_commitJournal)
+            ret.enableJournal(db::CommitJournal::open(path / fs::path("journal")));
+        ret.enableNodeCache(TrieNodeCache::get());
+        if (Defaults::get()->m_flatState)
+            ret.enableFlatState();
+        if (Defaults::get()->m_pruneHistory)
+            ret.enablePruning(Defaults::get()->m_pruneHistory, Defaults::get()->m_pruneCheckpoints);
+        return ret;
     }
     catch (boost::exception const& ex)
     {
@@ -119,6 +133,9 @@ OverlayDB State::openDB(fs::path const& _basePath, h256 const& _genesisHash, Wit
 
 void State::populateFrom(AccountMap const& _map)
 {
+    // Written straight to the trie, so the flat state cannot follow.
+    m_flatBase = h256();
+    m_flatChanges.clear();
     eth::commit(_map, m_state);
     commit(State::CommitBehaviour::KeepEmptyAccounts);
 }
@@ -156,6 +173,8 @@ State& State::operator=(State const& _s)
     m_unchangedCacheEntries = _s.m_unchangedCacheEntries;
     m_nonExistingAccountsCache = _s.m_nonExistingAccountsCache;
     m_touched = _s.m_touched;
+    m_flatBase = _s.m_flatBase;
+    m_flatChanges = _s.m_flatChanges;
     m_accountStartNonce = _s.m_accountStartNonce;
     return *this;
 }
@@ -167,6 +186,9 @@ Account const* State::account(Address const& _a) const
 
 Account* State::account(Address const& _addr)
 {
+    if (m_accessLog && !m_accessLog->crediting)
+        m_accessLog->reads.insert(_addr);
+
     auto it = m_cache.find(_addr);
     if (it != m_cache.end())
         return &it->second;
@@ -175,7 +197,9 @@ Account* State::account(Address const& _addr)
         return nullptr;
 
     // Populate basic info.
-    string stateBack = m_state.at(_addr);
+    string stateBack;
+    if (!flatAccount(_addr, stateBack))
+        stateBack = m_state.at(_addr);
     if (stateBack.empty())
     {
         m_nonExistingAccountsCache.insert(_addr);
@@ -213,11 +237,80 @@ void State::clearCacheIfTooLarge() const
     }
 }
 
+bool State::flatAccount(Address const& _addr, string& o_account) const
+{
+    auto const& flat = m_db.flatState();
+    if (!flat || !m_flatBase)
+        return false;
+    h256 const h = sha3(_addr);
+    auto it = m_flatChanges.find(h);
+    if (it != m_flatChanges.end())
+    {
+        o_account = it->second.account;
+        return true;
+    }
+    return flat->account(m_flatBase, h, o_account);
+}
+
+bool State::flatStorage(Address const& _addr, u256 const& _key, u256& o_value) const
+{
+    auto const& flat = m_db.flatState();
+    if (!flat || !m_flatBase)
+        return false;
+    h256 const h = sha3(_addr);
+    h256 const slot = sha3(h256(_key));
+    auto it = m_flatChanges.find(h);
+    if (it != m_flatChanges.end())
+    {
+        auto s = it->second.slots.find(slot);
+        if (s != it->second.slots.end() || it->second.clearedStorage)
+        {
+            o_value = s != it->second.slots.end() ? s->second : 0;
+            return true;
+        }
+    }
+    return flat->storage(m_flatBase, h, slot, o_value);
+}
+
+void State::recordFlatChanges() const
+{
+    if (auto const& flat = m_db.flatState())
+        flat->record(m_flatBase, rootHash(), m_flatChanges);
+}
+
 void State::commit(CommitBehaviour _commitBehaviour)
 {
     if (_commitBehaviour == CommitBehaviour::RemoveEmptyAccounts)
         removeEmptyAccounts();
+
+    // The flat state keys slots by the life of their storage, so note whose storage is wiped.
+    bool const flat = m_db.flatState() && m_flatBase;
+    vector<pair<Address, bool>> wiped;
+    if (flat)
+        for (auto const& i: m_cache)
+            if (i.second.isDirty())
+            {
+                string const old = m_state.at(i.first);
+                h256 const oldRoot = old.empty() ? EmptyTrie : RLP(old)[2].toHash<h256>();
+                wiped.emplace_back(i.first, !i.second.isAlive() || i.second.baseRoot() != oldRoot);
+            }
+
     m_touched += dev::eth::commit(m_cache, m_state);
+
+    for (auto const& w: wiped)
+    {
+        Account const& a = m_cache.at(w.first);
+        FlatState::AccountChange& c = m_flatChanges[sha3(w.first)];
+        c.account = a.isAlive() ? m_state.at(w.first) : string();
+        if (w.second)
+        {
+            c.clearedStorage = true;
+            c.slots.clear();
+        }
+        if (a.isAlive())
+            for (auto const& s: a.storageOverlay())
+                c.slots[sha3(h256(s.first))] = s.second;
+    }
     m_changeLog.clear();
     m_cache.clear();
     m_unchangedCacheEntries.clear();
@@ -246,6 +339,8 @@ void State::setRoot(h256 const& _r)
     m_nonExistingAccountsCache.clear();
 //  m_touched.clear();
     m_state.setRoot(_r);
+    m_flatBase = _r;
+    m_flatChanges.clear();
 }
 
 bool State::addressInUse(Address const& _id) const
@@ -279,6 +374,8 @@ u256 State::balance(Address const& _id) const
 
 void State::incNonce(Address const& _addr)
 {
+    if (m_accessLog)
+        m_accessLog->writes.insert(_addr);
     if (Account* a = account(_addr))
     {
         auto oldNonce = a->nonce();
@@ -292,6 +389,8 @@ void State::incNonce(Address const& _addr)
 
 void State::setNonce(Address const& _addr, u256 const& _newNonce)
 {
+    if (m_accessLog)
+        m_accessLog->writes.insert(_addr);
     if (Account* a = account(_addr))
     {
         auto oldNonce = a->nonce();
@@ -305,6 +404,13 @@ void State::setNonce(Address const& _addr, u256 const& _newNonce)
 
 void State::addBalance(Address const& _id, u256 const& _amount)
 {
+    // A credit does not depend on the balance it adds to.
+    if (m_accessLog)
+    {
+        m_accessLog->crediting = true;
+        m_accessLog->credits[_id] += _amount;
+    }
+
     if (Account* a = account(_id))
     {
         // Log empty account being touched. Empty touched accounts are cleared
@@ -326,6 +432,9 @@ void State::addBalance(Address const& _id, u256 const& _amount)
 
     if (_amount)
         m_changeLog.emplace_back(Change::Balance, _id, _amount);
+
+    if (m_accessLog)
+        m_accessLog->crediting = false;
 }
 
 void State::subBalance(Address const& _addr, u256 const& _value)
@@ -338,6 +447,9 @@ void State::subBalance(Address const& _addr, u256 const& _value)
         // TODO: I expect this never happens.
         BOOST_THROW_EXCEPTION(NotEnoughCash());
 
+    if (m_accessLog)
+        m_accessLog->writes.insert(_addr);
+
     // Fall back to addBalance().
     addBalance(_addr, 0 - _value);
 }
@@ -347,6 +459,9 @@ void State::setBalance(Address const& _addr, u256 const& _value)
     Account* a = account(_addr);
     u256 original = a ? a->balance() : 0;
 
+    if (m_accessLog)
+        m_accessLog->writes.insert(_addr);
+
     // Fall back to addBalance().
     addBalance(_addr, _value - original);
 }
@@ -359,6 +474,8 @@ void State::createContract(Address const& _address)
 void State::createAccount(Address const& _address, Account const&& _account)
 {
     assert(!addressInUse(_address) && "Account already exists");
+    if (m_accessLog)
+        m_accessLog->writes.insert(_address);
     m_cache[_address] = std::move(_account);
     m_nonExistingAccountsCache.erase(_address);
     m_changeLog.emplace_back(Change::Create, _address);
@@ -366,6 +483,8 @@ void State::createAccount(Address const& _address, Account const&& _account)
 
 void State::kill(Address _addr)
 {
+    if (m_accessLog)
+        m_accessLog->writes.insert(_addr);
     if (auto a = account(_addr))
         a->kill();
     // If the account is not in the db, nothing to kill.
@@ -381,16 +500,23 @@ u256 State::getNonce(Address const& _addr) const
 
 u256 State::storage(Address const& _id, u256 const& _key) const
 {
+    if (m_accessLog)
+        m_accessLog->storageReads.emplace(_id, _key);
     if (Account const* a = account(_id))
     {
         auto mit = a->storageOverlay().find(_key);
         if (mit != a->storageOverlay().end())
             return mit->second;
 
-        // Not in the storage cache - go to the DB.
-        SecureTrieDB<h256, OverlayDB> memdb(const_cast<OverlayDB*>(&m_db), a->baseRoot());          // promise we won't change the overlay! :)
-        string payload = memdb.at(_key);
-        u256 ret = payload.size() ? RLP(payload).toInt<u256>() : 0;
+        // Not in the storage cache - go to the flat state or the DB. A storage root other
+        // than the empty one is always the committed one.
+        u256 ret = 0;
+        if (a->baseRoot() != EmptyTrie && !flatStorage(_id, _key, ret))
+        {
+            SecureTrieDB<h256, OverlayDB> memdb(const_cast<OverlayDB*>(&m_db), a->baseRoot());          // promise we won't change the overlay! :)
+            string payload = memdb.at(_key);
+            ret = payload.size() ? RLP(payload).toInt<u256>() : 0;
+        }
         a->setStorageCache(_key, ret);
         return ret;
     }
@@ -401,6 +527,8 @@ u256 State::storage(Address const& _id, u256 const& _key) const
 void State::setStorage(Address const& _contract, u256 const& _key, u256 const& _value)
 {
     m_changeLog.emplace_back(_contract, _key, storage(_contract, _key));
+    if (m_accessLog)
+        m_accessLog->storageWrites.emplace(_contract, _key);
     m_cache[_contract].setStorage(_key, _value);
 }
 
@@ -409,6 +537,11 @@ void State::clearStorage(Address const& _contract)
     h256 const& oldHash{m_cache[_contract].baseRoot()};
     if (oldHash == EmptyTrie)
         return;
+    if (m_accessLog)
+    {
+        m_accessLog->writes.insert(_contract);
+        m_accessLog->exclusive = true;
+    }
     m_changeLog.emplace_back(Change::StorageRoot, _contract, oldHash);
     m_cache[_contract].clearStorage();
 }
@@ -478,6 +611,11 @@ bytes const& State::code(Address const& _addr) const
 void State::setCode(Address const& _address, bytes&& _code)
 {
     m_changeLog.emplace_back(_address, code(_address));
+    if (m_accessLog)
+    {
+        m_accessLog->writes.insert(_address);
+        m_accessLog->codeWrites.insert(_address);
+    }
     m_cache[_address].setCode(std::move(_code));
 }
 
@@ -534,6 +672,8 @@ void State::rollback(size_t _savepoint)
             break;
         case Change::Balance:
             account.addBalance(0 - change.value);
+            if (m_accessLog)
+                m_accessLog->credits[change.address] -= change.value;
             break;
         case Change::Nonce:
             account.setNonce(change.value);
@@ -553,6 +693,87 @@ void State::rollback(size_t _savepoint)
     }
 }
 
+StateDiff State::diff(StateAccessLog const& _log) const
+{
+    AddressHash changed = _log.writes;
+    for (auto const& i: _log.credits)
+        changed.insert(i.first);
+    for (auto const& i: _log.storageWrites)
+        changed.insert(i.first);
+
+    StateDiff ret;
+    for (Address const& addr: changed)
+    {
+        auto it = m_cache.find(addr);
+        if (it == m_cache.end() || !it->second.isDirty())
+            continue;
+
+        Account const& a = it->second;
+        AccountDiff& d = ret[addr];
+        auto credit = _log.credits.find(addr);
+        d.header = _log.writes.count(addr) || (credit != _log.credits.end() && _log.reads.count(addr));
+        d.alive = a.isAlive();
+        if (!d.alive)
+            continue;
+
+        if (d.header)
+        {
+            d.balance = a.balance();
+            d.nonce = a.nonce();
+        }
+        else if (credit != _log.credits.end())
+        {
+            d.credit = true;
+            d.balance = credit->second;
+        }
+
+        if (_log.codeWrites.count(addr))
+        {
+            d.hasCode = true;
+            d.code = a.code();
+        }
+    }
+
+    for (auto const& i: _log.storageWrites)
+    {
+        auto d = ret.find(i.first);
+        if (d == ret.end() || !d->second.alive)
+            continue;
+        auto const& overlay = m_cache.at(i.first).storageOverlay();
+        auto s = overlay.find(i.second);
+        if (s != overlay.end())
+            d->second.storage[i.second] = s->second;
+    }
+    return ret;
+}
+
+void State::apply(StateDiff const& _diff)
+{
+    for (auto const& i: _diff)
+    {
+        Address const& addr = i.first;
+        AccountDiff const& d = i.second;
+        if (!d.alive)
+        {
+            kill(addr);
+            continue;
+        }
+
+        if (d.credit)
+            addBalance(addr, d.balance);
+        else if (d.header)
+        {
+            setNonce(addr, d.nonce);
+            setBalance(addr, d.balance);
+        }
+
+        if (d.hasCode)
+            setCode(addr, bytes(d.code));
+        for (auto const& s: d.storage)
+            setStorage(addr, s.first, s.second);
+    }
+}
+
 std::pair<ExecutionResult, TransactionReceipt> State::execute(EnvInfo const& _envInfo, SealEngineFace const& _sealEngine, Transaction const& _t, Permanence _p, OnOpFunc const& _onOp)
 {
     auto onOp = _onOp;
@@ -696,9 +917,128 @@ State& dev::eth::createIntermediateState(State& o_s, Block const& _block, unsign
     return o_s;
 }
 
+namespace
+{
+
+/// Below this many storage writes in a commit, rehashing them on one thread is quicker.
+size_t const c_minParallelStorageWrites = 256;
+
+/// The node writes of one storage trie, made over a database that is only read meanwhile, so
+/// that the tries of several accounts can be built at once and then replayed onto it in turn.
+template <class DB>
+class NodeLayer
+{
+public:
+    explicit NodeLayer(DB const& _base): m_base(&_base) {}
+
+    std::string lookup(h256 const& _h) const
+    {
+        auto it = m_nodes.find(_h);
+        return it != m_nodes.end() && it->second.second > 0 ? it->second.first : m_base->lookup(_h);
+    }
+    bool exists(h256 const& _h) const { return !lookup(_h).empty(); }
+    void insert(h256 const& _h, bytesConstRef _v)
+    {
+        auto& n = m_nodes[_h];
+        n.first = _v.toString();
+        ++n.second;
+        m_writes.push_back({Write::Insert, _h, n.first});
+    }
+    bool kill(h256 const& _h)
+    {
+        auto it = m_nodes.find(_h);
+        if (it != m_nodes.end())
+            --it->second.second;
+        m_writes.push_back({Write::Kill, _h, std::string()});
+        return true;
+    }
+    bytes lookupAux(h256 const& _h) const { return m_base->lookupAux(_h); }
+    void insertAux(h256 const& _h, bytesConstRef _v) { m_writes.push_back({Write::InsertAux, _h, _v.toString()}); }
+
+    /// Makes the writes on the database this was made over, in the same order.
+    void replay(DB& _db) const
+    {
+        for (auto const& w: m_writes)
+            if (w.kind == Write::Insert)
+                _db.insert(w.hash, bytesConstRef(w.value));
+            else if (w.kind == Write::Kill)
+                _db.kill(w.hash);
+            else
+                _db.insertAux(w.hash, bytesConstRef(w.value));
+    }
+
+private:
+    struct Write
+    {
+        enum Kind { Insert, Kill, InsertAux } kind;
+        h256 hash;
+        std::string value;
+    };
+
+    DB const* m_base;
+    std::unordered_map<h256, std::pair<std::string, int>> m_nodes;
+    std::vector<Write> m_writes;
+};
+
+/// Applies the storage writes of the accounts in @a _accounts on the shared helper threads.
+/// @returns their new storage roots.
+template <class DB>
+vector<h256> commitStorageInParallel(vector<AccountMap::const_iterator> const& _accounts, DB& _db)
+{
+    vector<NodeLayer<DB>> layers(_accounts.size(), NodeLayer<DB>(_db));
+    vector<h256> roots(_accounts.size());
+    vector<exception_ptr> errors(_accounts.size());
+
+    WorkerPool::shared().forEach(_accounts.size(), 1, [&](size_t i) {
+        try
+        {
+            Account const& a = _accounts[i]->second;
+            SecureTrieDB<h256, NodeLayer<DB>> storageDB(&layers[i], a.baseRoot());
+            for (auto const& j: a.storageOverlay())
+                if (j.second)
+                    storageDB.insert(j.first, rlp(j.second));
+                else
+                    storageDB.remove(j.first);
+            roots[i] = storageDB.root();
+        }
+        catch (...)
+        {
+            errors[i] = current_exception();
+        }
+    });
+
+    for (size_t i = 0; i < _accounts.size(); ++i)
+    {
+        if (errors[i])
+            rethrow_exception(errors[i]);
+        layers[i].replay(_db);
+    }
+    return roots;
+}
+
+}
+
 template <class DB>
 AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state)
 {
+    // Storage tries of different accounts are independent, so rehash them concurrently when
+    // there is enough to do; the account trie itself is then updated on this thread.
+    vector<AccountMap::const_iterator> withStorage;
+    size_t storageWrites = 0;
+    for (auto it = _cache.begin(); it != _cache.end(); ++it)
+        if (it->second.isDirty() && it->second.isAlive() && !it->second.storageOverlay().empty())
+        {
+            withStorage.push_back(it);
+            storageWrites += it->second.storageOverlay().size();
+        }
+    unordered_map<Address, h256> storageRoots;
+    if (withStorage.size() > 1 && storageWrites >= c_minParallelStorageWrites && WorkerPool::shared().helpers())
+    {
+        vector<h256> const roots = commitStorageInParallel(withStorage, *_state.db());
+        for (size_t i = 0; i < withStorage.size(); ++i)
+            storageRoots[withStorage[i]->first] = roots[i];
+    }
+
     AddressHash ret;
     for (auto const& i: _cache)
         if (i.second.isDirty())
@@ -710,7 +1050,10 @@ AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>
                 RLPStream s(4);
                 s << i.second.nonce() << i.second.balance();
 
-                if (i.second.storageOverlay().empty())
+                auto const root = storageRoots.find(i.first);
+                if (root != storageRoots.end())
+                    s.append(root->second);
+                else if (i.second.storageOverlay().empty())
                 {
                     assert(i.second.baseRoot());
                     s.append(i.second.baseRoot());
@@ -154,6 +154,34 @@ struct Change
 
 using ChangeLog = std::vector<Change>;
 
+/// What a State was asked for while an access log was set on it, see State::setAccessLog().
+struct StateAccessLog
+{
+	AddressHash reads;								///< Accounts looked at, including lookups of missing ones.
+	AddressHash writes;								///< Accounts whose nonce, balance, code or life changed, other than by a credit.
+	AddressHash codeWrites;							///< Accounts that got new code.
+	std::unordered_map<Address, u256> credits;		///< Net amount added by addBalance() (wrapping), rollbacks included.
+	std::set<std::pair<Address, u256>> storageReads;
+	std::set<std::pair<Address, u256>> storageWrites;
+	bool exclusive = false;							///< A storage trie was cleared; the changes cannot be replayed slot by slot.
+	bool crediting = false;							///< Inside addBalance(), whose own lookup is not a read.
+};
+
+/// Final values of an account changed by a transaction, to be replayed onto another State by State::apply().
+struct AccountDiff
+{
+	bool credit = false;		///< Only credited: balance is the amount to add.
+	bool header = false;		///< Balance and nonce are final values.
+	bool alive = true;
+	u256 balance;
+	u256 nonce;
+	bool hasCode = false;
+	bytes code;
+	std::map<u256, u256> storage;
+};
+
+using StateDiff = std::map<Address, AccountDiff>;
+
 /**
  * Model of an Ethereum state, essentially a facade for the trie.
  *
@@ -316,6 +344,10 @@ public:
 	/// Resets any uncommitted changes to the cache.
 	void setRoot(h256 const& _root);
 
+	/// Hands what was committed since the last setRoot() to the flat state, if there is one, to be
+	/// applied once this state's block is the head.
+	void recordFlatChanges() const;
+
 	/// Get the account start nonce. May be required.
 	u256 const& accountStartNonce() const { return m_accountStartNonce; }
 	u256 const& requireAccountStartNonce() const;
@@ -330,6 +362,15 @@ public:
 
 	ChangeLog const& changeLog() const { return m_changeLog; }
 
+	/// Record into @a _log every account and storage slot this state reads or writes, until set back to nullptr.
+	void setAccessLog(StateAccessLog* _log) { m_accessLog = _log; }
+
+	/// @returns what the changes since the last commit that @a _log saw amount to. Call before rolling them back.
+	StateDiff diff(StateAccessLog const& _log) const;
+
+	/// Replays @a _diff, taken from a copy of this state that read nothing this state has changed since.
+	void apply(StateDiff const& _diff);
+
 private:
 	/// Turns all "touched" empty accounts into non-alive accounts.
 	void removeEmptyAccounts();
@@ -342,6 +383,11 @@ private:
 	/// The pointer is valid until the next access to the state or account.
 	Account* account(Address const& _addr);
 
+	/// Reads an account from the flat state into @a o_account. @returns false if it cannot be used.
+	bool flatAccount(Address const& _addr, std::string& o_account) const;
+	/// Reads a committed storage slot from the flat state. @returns false if it cannot be used.
+	bool flatStorage(Address const& _addr, u256 const& _key, u256& o_value) const;
+
 	/// Purges non-modified entries in m_cache if it grows too large.
 	void clearCacheIfTooLarge() const;
 
@@ -353,11 +399,15 @@ private:
 	mutable std::vector<Address> m_unchangedCacheEntries;	///< Tracks entries in m_cache that can potentially be purged if it grows too large.
 	mutable std::set<Address> m_nonExistingAccountsCache;	///< Tracks addresses that are known to not exist.
 	AddressHash m_touched;						///< Tracks all addresses touched so far.
+	h256 m_flatBase;							///< The root m_flatChanges were made to, h256() if unknown.
+	FlatState::Changes m_flatChanges;			///< What was committed since m_flatBase.
 
 	u256 m_accountStartNonce;
 
 	friend std::ostream& operator<<(std::ostream& _out, State const& _s);
 	ChangeLog m_changeLog;
+
+	StateAccessLog* m_accessLog = nullptr;		///< Not copied with the state.
 };
 
 std::ostream& operator<<(std::ostream& _out, State const& _s);
@@ -21,6 +21,7 @@
 
 #include "TransactionQueue.h"
 
+#include <algorithm>
 #include <libdevcore/Log.h>
 #include <libethcore/Exceptions.h>
 #include "Transaction.h"
@@ -33,8 +34,10 @@ const char* TransactionQueueTraceChannel::name() { return EthCyan " ┅▶"; }
 
 const size_t c_maxVerificationQueueSize = 8192;
 
+/// Below this many transactions, a batch is not worth waking the verifier threads for.
+const size_t c_minSharedRecovery = 32;
+
 TransactionQueue::TransactionQueue(unsigned _limit, unsigned _futureLimit):
-	m_current(PriorityCompare { *this }),
 	m_limit(_limit),
 	m_futureLimit(_futureLimit)
 {
@@ -68,106 +71,241 @@ ImportResult TransactionQueue::import(bytesConstRef _transactionRLP, IfDropped _
 	}
 }
 
-ImportResult TransactionQueue::check_WITH_LOCK(h256 const& _h, IfDropped _ik)
+ImportResult TransactionQueue::check(h256 const& _h, IfDropped _ik) const
 {
-	if (m_known.count(_h))
+	KnownShard const& ks = knownShard(_h);
+	Guard l(ks.lock);
+	if (ks.known.count(_h))
 		return ImportResult::AlreadyKnown;
 
-	if (m_dropped.count(_h) && _ik == IfDropped::Ignore)
+	if (ks.dropped.count(_h) && _ik == IfDropped::Ignore)
 		return ImportResult::AlreadyInChain;
 
 	return ImportResult::Success;
 }
 
+bool TransactionQueue::lookup(h256 const& _h, Address& o_sender, u256& o_nonce) const
+{
+	KnownShard const& ks = knownShard(_h);
+	Guard l(ks.lock);
+	auto it = ks.known.find(_h);
+	if (it == ks.known.end())
+		return false;
+	o_sender = it->second.first;
+	o_nonce = it->second.second;
+	return true;
+}
+
+void TransactionQueue::forget(h256 const& _h, bool _drop)
+{
+	KnownShard& ks = knownShard(_h);
+	Guard l(ks.lock);
+	ks.known.erase(_h);
+	if (_drop)
+		ks.dropped.insert(_h);
+}
+
 ImportResult TransactionQueue::import(Transaction const& _transaction, IfDropped _ik)
 {
 	if (_transaction.hasZeroSignature())
 		return ImportResult::ZeroSignature;
 	// Check if we already know this transaction.
 	h256 h = _transaction.sha3(WithSignature);
+	ImportResult ret = check(h, _ik);
+	if (ret != ImportResult::Success)
+		return ret;
 
-	ImportResult ret;
+	Shard& s = shard(_transaction.safeSender()); // Perform EC recovery outside of the write lock
 	{
-		UpgradableGuard l(m_lock);
-		auto ir = check_WITH_LOCK(h, _ik);
-		if (ir != ImportResult::Success)
-			return ir;
+		WriteGuard l(s.lock);
+		ret = check(h, _ik);
+		if (ret == ImportResult::Success)
+			ret = manageImport_WITH_LOCK(s, h, _transaction);
+	}
+	enforceLimits();
+	return ret;
+}
 
+vector<ImportResult> TransactionQueue::import(vector<bytes> const& _txs, IfDropped _ik)
+{
+	vector<ImportResult> ret(_txs.size(), ImportResult::Malformed);
+	vector<Transaction> ts;
+	vector<size_t> indices;
+	for (size_t i = 0; i < _txs.size(); ++i)
+		try
+		{
+			Transaction t(_txs[i], CheckTransaction::Cheap);
+			if (t.hasZeroSignature())
+				ret[i] = ImportResult::ZeroSignature;
+			else
+			{
+				ts.push_back(move(t));
+				indices.push_back(i);
+			}
+		}
+		catch (Exception const&)
 		{
-			_transaction.safeSender(); // Perform EC recovery outside of the write lock
-			UpgradeGuard ul(l);
-			ret = manageImport_WITH_LOCK(h, _transaction);
 		}
+
+	// Let the verifiers help recover the senders, then wait for the ones they claimed.
+	auto recovery = make_shared<SenderRecovery>(ts);
+	if (ts.size() >= c_minSharedRecovery)
+	{
+		DEV_GUARDED(x_queue)
+			m_recoveries.push_back(recovery);
+		m_queueReady.notify_all();
 	}
+	recovery->work();
+	{
+		unique_lock<Mutex> l(recovery->x_done);
+		recovery->finished.wait(l, [&](){ return recovery->done == recovery->count; });
+	}
+	DEV_GUARDED(x_queue)
+	{
+		auto it = find(m_recoveries.begin(), m_recoveries.end(), recovery);
+		if (it != m_recoveries.end())
+			m_recoveries.erase(it);
+	}
+
+	// Those whose signature recovers no sender stay malformed.
+	array<vector<size_t>, c_shards> byShard;
+	for (size_t i = 0; i < ts.size(); ++i)
+		if (recovery->recovered[i])
+			byShard[std::hash<Address>()(ts[i].sender()) % c_shards].push_back(i);
+	for (unsigned si = 0; si < c_shards; ++si)
+		if (!byShard[si].empty())
+		{
+			Shard& s = m_shards[si];
+			WriteGuard l(s.lock);
+			for (size_t i: byShard[si])
+			{
+				h256 const h = ts[i].sha3(WithSignature);
+				ImportResult& ir = ret[indices[i]];
+				ir = check(h, _ik);
+				if (ir == ImportResult::Success)
+					ir = manageImport_WITH_LOCK(s, h, ts[i]);
+			}
+		}
+	enforceLimits();
 	return ret;
 }
 
 Transactions TransactionQueue::topTransactions(unsigned _limit, h256Hash const& _avoid) const
 {
-	ReadGuard l(m_lock);
+	// Each sender's current transactions are already in priority order, so merge them by height then gas price,
+	// taking the base nonce of each sender once instead of on every comparison.
+	struct Cursor
+	{
+		u256 height;
+		map<u256, Transaction>::const_iterator it;
+		map<u256, Transaction>::const_iterator end;
+		u256 base;
+	};
+	auto lower = [](Cursor const& _a, Cursor const& _b)
+	{
+		return _a.height > _b.height || (_a.height == _b.height && _a.it->second.gasPrice() < _b.it->second.gasPrice());
+	};
+
+	vector<ReadGuard> guards;
+	guards.reserve(c_shards);
+	for (auto const& s: m_shards)
+		guards.emplace_back(s.lock);
+
+	vector<Cursor> heap;
+	for (auto const& s: m_shards)
+		for (auto const& sender: s.senders)
+			if (!sender.second.current.empty())
+			{
+				auto const& current = sender.second.current;
+				heap.push_back(Cursor{0, current.begin(), current.end(), current.begin()->first});
+			}
+	make_heap(heap.begin(), heap.end(), lower);
+
 	Transactions ret;
-	for (auto t = m_current.begin(); ret.size() < _limit && t != m_current.end(); ++t)
-		if (!_avoid.count(t->transaction.sha3()))
-			ret.push_back(t->transaction);
+	while (ret.size() < _limit && !heap.empty())
+	{
+		pop_heap(heap.begin(), heap.end(), lower);
+		Cursor& c = heap.back();
+		if (!_avoid.count(c.it->second.sha3()))
+			ret.push_back(c.it->second);
+		if (++c.it == c.end)
+			heap.pop_back();
+		else
+		{
+			c.height = c.it->first - c.base;
+			push_heap(heap.begin(), heap.end(), lower);
+		}
+	}
 	return ret;
 }
 
 h256Hash TransactionQueue::knownTransactions() const
 {
-	ReadGuard l(m_lock);
-	return m_known;
+	h256Hash ret;
+	for (auto const& ks: m_known)
+	{
+		Guard l(ks.lock);
+		for (auto const& k: ks.known)
+			ret.insert(k.first);
+	}
+	return ret;
 }
 
-ImportResult TransactionQueue::manageImport_WITH_LOCK(h256 const& _h, Transaction const& _transaction)
+TransactionQueue::Status TransactionQueue::status() const
+{
+	Status ret;
+	DEV_GUARDED(x_queue)
+		ret.unverified = m_unverified.size();
+	ret.dropped = 0;
+	for (auto const& ks: m_known)
+		DEV_GUARDED(ks.lock)
+			ret.dropped += ks.dropped.size();
+	ret.current = m_currentSize;
+	ret.future = m_futureSize;
+	return ret;
+}
+
+ImportResult TransactionQueue::manageImport_WITH_LOCK(Shard& _shard, h256 const& _h, Transaction const& _transaction)
 {
 	try
 	{
 		assert(_h == _transaction.sha3());
 		// Remove any prior transaction with the same nonce but a lower gas price.
 		// Bomb out if there's a prior transaction with higher gas price.
-		auto cs = m_currentByAddressAndNonce.find(_transaction.from());
-		if (cs != m_currentByAddressAndNonce.end())
+		// Throws if no sender can be recovered from the signature.
+		Address const& from = _transaction.sender();
+		auto sq = _shard.senders.find(from);
+		if (sq != _shard.senders.end())
 		{
-			auto t = cs->second.find(_transaction.nonce());
-			if (t != cs->second.end())
+			auto t = sq->second.current.find(_transaction.nonce());
+			if (t != sq->second.current.end())
 			{
-				if (_transaction.gasPrice() < (*t->second).transaction.gasPrice())
+				if (_transaction.gasPrice() < t->second.gasPrice())
 					return ImportResult::OverbidGasPrice;
 				else
 				{
-					h256 dropped = (*t->second).transaction.sha3();
-					remove_WITH_LOCK(dropped);
+					h256 dropped = t->second.sha3();
+					remove_WITH_LOCK(_shard, dropped, from, _transaction.nonce());
 					m_onReplaced(dropped);
 				}
 			}
 		}
-		auto fs = m_future.find(_transaction.from());
-		if (fs != m_future.end())
+		sq = _shard.senders.find(from);
+		if (sq != _shard.senders.end())
 		{
-			auto t = fs->second.find(_transaction.nonce());
-			if (t != fs->second.end())
+			auto t = sq->second.future.find(_transaction.nonce());
+			if (t != sq->second.future.end())
 			{
-				if (_transaction.gasPrice() < t->second.transaction.gasPrice())
+				if (_transaction.gasPrice() < t->second.gasPrice())
 					return ImportResult::OverbidGasPrice;
 				else
-				{
-					fs->second.erase(t);
-					--m_futureSize;
-					if (fs->second.empty())
-						m_future.erase(fs);
-				}
+					remove_WITH_LOCK(_shard, t->second.sha3(), from, _transaction.nonce());
 			}
 		}
 		// If valid, append to transactions.
-		insertCurrent_WITH_LOCK(make_pair(_h, _transaction));
+		insertCurrent_WITH_LOCK(_shard, _h, _transaction);
 		clog(TransactionQueueTraceChannel) << "Queued vaguely legit-looking transaction" << _h;
 
-		while (m_current.size() > m_limit)
-		{
-			clog(TransactionQueueTraceChannel) << "Dropping out of bounds transaction" << _h;
-			remove_WITH_LOCK(m_current.rbegin()->transaction.sha3());
-		}
-
 		m_onReady();
 	}
 	catch (Exception const& _e)
@@ -186,172 +324,250 @@ ImportResult TransactionQueue::manageImport_WITH_LOCK(h256 const& _h, Transactio
 
 u256 TransactionQueue::maxNonce(Address const& _a) const
 {
-	ReadGuard l(m_lock);
-	return maxNonce_WITH_LOCK(_a);
+	Shard const& s = shard(_a);
+	ReadGuard l(s.lock);
+	return maxNonce_WITH_LOCK(s, _a);
 }
 
-u256 TransactionQueue::maxNonce_WITH_LOCK(Address const& _a) const
+u256 TransactionQueue::maxNonce_WITH_LOCK(Shard const& _shard, Address const& _a) const
 {
 	u256 ret = 0;
-	auto cs = m_currentByAddressAndNonce.find(_a);
-	if (cs != m_currentByAddressAndNonce.end() && !cs->second.empty())
-		ret = cs->second.rbegin()->first + 1;
-	auto fs = m_future.find(_a);
-	if (fs != m_future.end() && !fs->second.empty())
-		ret = std::max(ret, fs->second.rbegin()->first + 1);
+	auto sq = _shard.senders.find(_a);
+	if (sq == _shard.senders.end())
+		return ret;
+	if (!sq->second.current.empty())
+		ret = sq->second.current.rbegin()->first + 1;
+	if (!sq->second.future.empty())
+		ret = std::max(ret, sq->second.future.rbegin()->first + 1);
 	return ret;
 }
 
-void TransactionQueue::insertCurrent_WITH_LOCK(std::pair<h256, Transaction> const& _p)
+void TransactionQueue::insertCurrent_WITH_LOCK(Shard& _shard, h256 const& _h, Transaction const& _t)
 {
-	if (m_currentByHash.count(_p.first))
 	{
-		cwarn << "Transaction hash" << _p.first << "already in current?!";
-		return;
+		KnownShard& ks = knownShard(_h);
+		Guard l(ks.lock);
+		if (!ks.known.emplace(_h, make_pair(_t.from(), _t.nonce())).second)
+		{
+			cwarn << "Transaction hash" << _h << "already in current?!";
+			return;
+		}
 	}
 
-	Transaction const& t = _p.second;
 	// Insert into current
-	auto inserted = m_currentByAddressAndNonce[t.from()].insert(std::make_pair(t.nonce(), PriorityQueue::iterator()));
-	PriorityQueue::iterator handle = m_current.emplace(VerifiedTransaction(t));
-	inserted.first->second = handle;
-	m_currentByHash[_p.first] = handle;
+	_shard.senders[_t.from()].current.emplace(_t.nonce(), _t);
+	++m_currentSize;
 
 	// Move following transactions from future to current
-	makeCurrent_WITH_LOCK(t);
-	m_known.insert(_p.first);
+	if (makeCurrent_WITH_LOCK(_shard, _t))
+		m_onReady();
 }
 
-bool TransactionQueue::remove_WITH_LOCK(h256 const& _txHash)
+bool TransactionQueue::remove_WITH_LOCK(Shard& _shard, h256 const& _txHash, Address const& _sender, u256 const& _nonce)
 {
-	auto t = m_currentByHash.find(_txHash);
-	if (t == m_currentByHash.end())
+	auto sq = _shard.senders.find(_sender);
+	if (sq == _shard.senders.end())
 		return false;
 
-	Address from = (*t->second).transaction.from();
-	auto it = m_currentByAddressAndNonce.find(from);
-	assert (it != m_currentByAddressAndNonce.end());
-	it->second.erase((*t->second).transaction.nonce());
-	m_current.erase(t->second);
-	m_currentByHash.erase(t);
-	if (it->second.empty())
-		m_currentByAddressAndNonce.erase(it);
-	m_known.erase(_txHash);
+	auto t = sq->second.current.find(_nonce);
+	if (t != sq->second.current.end() && t->second.sha3() == _txHash)
+	{
+		sq->second.current.erase(t);
+		--m_currentSize;
+	}
+	else
+	{
+		t = sq->second.future.find(_nonce);
+		if (t == sq->second.future.end() || t->second.sha3() != _txHash)
+			return false;
+		sq->second.future.erase(t);
+		--m_futureSize;
+	}
+	if (sq->second.current.empty() && sq->second.future.empty())
+		_shard.senders.erase(sq);
+	forget(_txHash);
 	return true;
 }
 
 unsigned TransactionQueue::waiting(Address const& _a) const
 {
-	ReadGuard l(m_lock);
-	unsigned ret = 0;
-	auto cs = m_currentByAddressAndNonce.find(_a);
-	if (cs != m_currentByAddressAndNonce.end())
-		ret = cs->second.size();
-	auto fs = m_future.find(_a);
-	if (fs != m_future.end())
-		ret += fs->second.size();
-	return ret;
+	Shard const& s = shard(_a);
+	ReadGuard l(s.lock);
+	auto sq = s.senders.find(_a);
+	if (sq == s.senders.end())
+		return 0;
+	return sq->second.current.size() + sq->second.future.size();
 }
 
 void TransactionQueue::setFuture(h256 const& _txHash)
 {
-	WriteGuard l(m_lock);
-	auto it = m_currentByHash.find(_txHash);
-	if (it == m_currentByHash.end())
+	Address from;
+	u256 nonce;
+	if (!lookup(_txHash, from, nonce))
 		return;
 
-	VerifiedTransaction const& st = *(it->second);
+	Shard& s = shard(from);
+	WriteGuard l(s.lock);
+	auto sq = s.senders.find(from);
+	if (sq == s.senders.end())
+		return;
+	auto& queue = sq->second.current;
+	auto cutoff = queue.lower_bound(nonce);
+	if (cutoff == queue.end() || cutoff->first != nonce || cutoff->second.sha3() != _txHash)
+		return;
 
-	Address from = st.transaction.from();
-	auto& queue = m_currentByAddressAndNonce[from];
-	auto& target = m_future[from];
-	auto cutoff = queue.lower_bound(st.transaction.nonce());
 	for (auto m = cutoff; m != queue.end(); ++m)
 	{
-		VerifiedTransaction& t = const_cast<VerifiedTransaction&>(*(m->second)); // set has only const iterators. Since we are moving out of container that's fine
-		m_currentByHash.erase(t.transaction.sha3());
-		target.emplace(t.transaction.nonce(), move(t));
-		m_current.erase(m->second);
+		sq->second.future.emplace(m->first, move(m->second));
+		--m_currentSize;
 		++m_futureSize;
 	}
 	queue.erase(cutoff, queue.end());
-	if (queue.empty())
-		m_currentByAddressAndNonce.erase(from);
 }
 
-void TransactionQueue::makeCurrent_WITH_LOCK(Transaction const& _t)
+bool TransactionQueue::makeCurrent_WITH_LOCK(Shard& _shard, Transaction const& _t)
+{
+	auto sq = _shard.senders.find(_t.from());
+	if (sq == _shard.senders.end())
+		return false;
+
+	auto& future = sq->second.future;
+	u256 nonce = _t.nonce() + 1;
+	auto fb = future.find(nonce);
+	auto ft = fb;
+	for (; ft != future.end() && ft->first == nonce; ++ft, ++nonce)
+	{
+		sq->second.current.emplace(nonce, move(ft->second));
+		--m_futureSize;
+		++m_currentSize;
+	}
+	future.erase(fb, ft);
+	if (sq->second.current.empty() && future.empty())
+		_shard.senders.erase(sq);
+	return fb != ft;
+}
+
+void TransactionQueue::enforceLimits()
 {
-	bool newCurrent = false;
-	auto fs = m_future.find(_t.from());
-	if (fs != m_future.end())
+	if (m_currentSize > m_limit)
 	{
-		u256 nonce = _t.nonce() + 1;
-		auto fb = fs->second.find(nonce);
-		if (fb != fs->second.end())
+		vector<WriteGuard> guards;
+		guards.reserve(c_shards);
+		for (auto& s: m_shards)
+			guards.emplace_back(s.lock);
+
+		// The lowest priority transaction is the last current one of some sender: highest height, then lowest gas price.
+		// Index every sender's last one once, then each drop only exposes that sender's next.
+		struct Tail
+		{
+			u256 height;
+			u256 gasPrice;
+			Shard* shard;
+			Address sender;
+		};
+		auto better = [](Tail const& _a, Tail const& _b)
+		{
+			return _a.height < _b.height || (_a.height == _b.height && _a.gasPrice > _b.gasPrice);
+		};
+
+		vector<Tail> tails;
+		auto pushTail = [&](Shard& _s, Address const& _a, SenderQueue const& _q)
 		{
-			auto ft = fb;
-			while (ft != fs->second.end() && ft->second.transaction.nonce() == nonce)
+			if (!_q.current.empty())
+				tails.push_back(Tail{_q.current.rbegin()->first - _q.current.begin()->first, _q.current.rbegin()->second.gasPrice(), &_s, _a});
+		};
+		for (auto& s: m_shards)
+			for (auto const& sender: s.senders)
+				pushTail(s, sender.first, sender.second);
+		make_heap(tails.begin(), tails.end(), better);
+
+		while (m_currentSize > m_limit && !tails.empty())
+		{
+			pop_heap(tails.begin(), tails.end(), better);
+			Tail const worst = tails.back();
+			tails.pop_back();
+			Transaction const t = worst.shard->senders.at(worst.sender).current.rbegin()->second;
+			clog(TransactionQueueTraceChannel) << "Dropping out of bounds transaction" << t.sha3();
+			remove_WITH_LOCK(*worst.shard, t.sha3(), t.from(), t.nonce());
+			auto sq = worst.shard->senders.find(worst.sender);
+			if (sq != worst.shard->senders.end() && !sq->second.current.empty())
 			{
-				auto inserted = m_currentByAddressAndNonce[_t.from()].insert(std::make_pair(ft->second.transaction.nonce(), PriorityQueue::iterator()));
-				PriorityQueue::iterator handle = m_current.emplace(move(ft->second));
-				inserted.first->second = handle;
-				m_currentByHash[(*handle).transaction.sha3()] = handle;
-				--m_futureSize;
-				++ft;
-				++nonce;
-				newCurrent = true;
+				pushTail(*worst.shard, worst.sender, sq->second);
+				push_heap(tails.begin(), tails.end(), better);
 			}
-			fs->second.erase(fb, ft);
-			if (fs->second.empty())
-				m_future.erase(_t.from());
 		}
 	}
 
-	while (m_futureSize > m_futureLimit)
+	// TODO: priority queue for future transactions
+	// For now just drop random chain end
+	for (auto& s: m_shards)
 	{
-		// TODO: priority queue for future transactions
-		// For now just drop random chain end
-		--m_futureSize;
-		clog(TransactionQueueTraceChannel) << "Dropping out of bounds future transaction" << m_future.begin()->second.rbegin()->second.transaction.sha3();
-		m_future.begin()->second.erase(--m_future.begin()->second.end());
-		if (m_future.begin()->second.empty())
-			m_future.erase(m_future.begin());
+		if (m_futureSize <= m_futureLimit)
+			break;
+		WriteGuard l(s.lock);
+		for (auto sq = s.senders.begin(); sq != s.senders.end() && m_futureSize > m_futureLimit; )
+		{
+			auto& future = sq->second.future;
+			while (!future.empty() && m_futureSize > m_futureLimit)
+			{
+				h256 const h = future.rbegin()->second.sha3();
+				clog(TransactionQueueTraceChannel) << "Dropping out of bounds future transaction" << h;
+				future.erase(prev(future.end()));
+				--m_futureSize;
+				forget(h);
+			}
+			if (sq->second.current.empty() && future.empty())
+				sq = s.senders.erase(sq);
+			else
+				++sq;
+		}
 	}
-
-	if (newCurrent)
-		m_onReady();
 }
 
 void TransactionQueue::drop(h256 const& _txHash)
 {
-	UpgradableGuard l(m_lock);
-
-	if (!m_known.count(_txHash))
+	Address from;
+	u256 nonce;
+	if (!lookup(_txHash, from, nonce))
 		return;
 
-	UpgradeGuard ul(l);
-	m_dropped.insert(_txHash);
-	remove_WITH_LOCK(_txHash);
+	Shard& s = shard(from);
+	WriteGuard l(s.lock);
+	if (remove_WITH_LOCK(s, _txHash, from, nonce))
+		forget(_txHash, true);
 }
 
 void TransactionQueue::dropGood(Transaction const& _t)
 {
-	WriteGuard l(m_lock);
-	makeCurrent_WITH_LOCK(_t);
-	if (!m_known.count(_t.sha3()))
-		return;
-	remove_WITH_LOCK(_t.sha3());
+	{
+		Shard& s = shard(_t.from());
+		WriteGuard l(s.lock);
+		if (makeCurrent_WITH_LOCK(s, _t))
+			m_onReady();
+		Address from;
+		u256 nonce;
+		h256 const h = _t.sha3();
+		if (lookup(h, from, nonce))
+			remove_WITH_LOCK(s, h, from, nonce);
+	}
+	enforceLimits();
 }
 
 void TransactionQueue::clear()
 {
-	WriteGuard l(m_lock);
-	m_known.clear();
-	m_current.clear();
-	m_dropped.clear();
-	m_currentByAddressAndNonce.clear();
-	m_currentByHash.clear();
-	m_future.clear();
+	vector<WriteGuard> guards;
+	guards.reserve(c_shards);
+	for (auto& s: m_shards)
+		guards.emplace_back(s.lock);
+	for (auto& s: m_shards)
+		s.senders.clear();
+	for (auto& ks: m_known)
+		DEV_GUARDED(ks.lock)
+		{
+			ks.known.clear();
+			ks.dropped.clear();
+		}
+	m_currentSize = 0;
 	m_futureSize = 0;
 }
 
@@ -376,19 +592,54 @@ void TransactionQueue::enqueue(RLP const& _data, h512 const& _nodeId)
 		m_queueReady.notify_all();
 }
 
+void TransactionQueue::SenderRecovery::work()
+{
+	for (size_t i = next++; i < count; i = next++)
+	{
+		try
+		{
+			transactions[i].sender();
+			recovered[i] = 1;
+		}
+		catch (...)
+		{
+		}
+		if (++done == count)
+		{
+			Guard l(x_done);
+			finished.notify_all();
+		}
+	}
+}
+
 void TransactionQueue::verifierBody()
 {
 	while (!m_aborting)
 	{
 		UnverifiedTransaction work;
+		shared_ptr<SenderRecovery> recovery;
 
 		{
 			unique_lock<Mutex> l(x_queue);
-			m_queueReady.wait(l, [&](){ return !m_unverified.empty() || m_aborting; });
+			m_queueReady.wait(l, [&](){ return !m_unverified.empty() || !m_recoveries.empty() || m_aborting; });
 			if (m_aborting)
 				return;
-			work = move(m_unverified.front());
-			m_unverified.pop_front();
+			if (!m_recoveries.empty())
+				recovery = m_recoveries.front();
+			else
+			{
+				work = move(m_unverified.front());
+				m_unverified.pop_front();
+			}
+		}
+
+		if (recovery)
+		{
+			recovery->work();
+			DEV_GUARDED(x_queue)
+				if (!m_recoveries.empty() && m_recoveries.front() == recovery)
+					m_recoveries.pop_front();
+			continue;
 		}
 
 		try
@@ -25,6 +25,8 @@
 #include <condition_variable>
 #include <thread>
 #include <deque>
+#include <array>
+#include <atomic>
 #include <libdevcore/Common.h>
 #include <libdevcore/Guards.h>
 #include <libdevcore/Log.h>
@@ -43,6 +45,7 @@ struct TransactionQueueTraceChannel: public LogChannel { static const char* name
 /**
  * @brief A queue of Transactions, each stored as RLP.
  * Maintains a transaction queue sorted by nonce diff and gas price.
+ * Senders are spread over shards with a lock each, so imports from different senders rarely wait on each other.
  * @threadsafe
  */
 class TransactionQueue
@@ -73,6 +76,13 @@ public:
 	/// @returns Import result code.
 	ImportResult import(Transaction const& _tx, IfDropped _ik = IfDropped::Ignore);
 
+	/// Verify and add a batch of transactions to the queue synchronously.
+	/// Senders are recovered by the verifier threads along with the caller and each shard is locked once for all of its transactions.
+	/// @param _txs RLP encoded transactions.
+	/// @param _ik Set to Retry to force re-adding transactions that were previously dropped.
+	/// @returns Import result code of each transaction.
+	std::vector<ImportResult> import(std::vector<bytes> const& _txs, IfDropped _ik = IfDropped::Ignore);
+
 	/// Remove transaction from the queue
 	/// @param _txHash Trasnaction hash
 	void drop(h256 const& _txHash);
@@ -111,7 +121,7 @@ public:
 		size_t dropped;
 	};
 	/// @returns the status of the transaction queue.
-	Status status() const { Status ret; DEV_GUARDED(x_queue) { ret.unverified = m_unverified.size(); } ReadGuard l(m_lock); ret.dropped = m_dropped.size(); ret.current = m_currentByHash.size(); ret.future = m_future.size(); return ret; }
+	Status status() const;
 
 	/// @returns the transacrtion limits on current/future.
 	Limits limits() const { return Limits{m_limit, m_futureLimit}; }
@@ -130,18 +140,6 @@ public:
 
 private:
 
-	/// Verified and imported transaction
-	struct VerifiedTransaction
-	{
-		VerifiedTransaction(Transaction const& _t): transaction(_t) {}
-		VerifiedTransaction(VerifiedTransaction&& _t): transaction(std::move(_t.transaction)) {}
-
-		VerifiedTransaction(VerifiedTransaction const&) = delete;
-		VerifiedTransaction& operator=(VerifiedTransaction const&) = delete;
-
-		Transaction transaction; ///< Transaction data
-	};
-
 	/// Transaction pending verification
 	struct UnverifiedTransaction
 	{
@@ -164,52 +162,82 @@ private:
 		h512 nodeId;		///< Network Id of the peer transaction comes from
 	};
 
-	struct PriorityCompare
+	/// Senders of a batch given to import(), recovered by whichever of the caller and the verifier threads claims each.
+	struct SenderRecovery
 	{
-		TransactionQueue& queue;
-		/// Compare transaction by nonce height and gas price.
-		bool operator()(VerifiedTransaction const& _first, VerifiedTransaction const& _second) const
-		{
-			u256 const& height1 = _first.transaction.nonce() - queue.m_currentByAddressAndNonce[_first.transaction.sender()].begin()->first;
-			u256 const& height2 = _second.transaction.nonce() - queue.m_currentByAddressAndNonce[_second.transaction.sender()].begin()->first;
-			return height1 < height2 || (height1 == height2 && _first.transaction.gasPrice() > _second.transaction.gasPrice());
-		}
+		explicit SenderRecovery(std::vector<Transaction> const& _ts): transactions(_ts), count(_ts.size()), recovered(_ts.size(), 0) {}
+
+		/// Recovers senders until none is left unclaimed.
+		void work();
+
+		std::vector<Transaction> const& transactions;	///< Only touched for claimed indices, it goes away once all are done.
+		size_t const count;
+		std::vector<char> recovered;					///< Whether each sender could be recovered; read once all are done.
+		std::atomic<size_t> next = {0};
+		std::atomic<size_t> done = {0};
+		Mutex x_done;
+		std::condition_variable finished;				///< Signaled when done reaches count.
 	};
 
-	// Use a set with dynamic comparator for minmax priority queue. The comparator takes into account min account nonce. Updating it does not affect the order.
-	using PriorityQueue = std::multiset<VerifiedTransaction, PriorityCompare>;
+	/// Transactions of one sender by nonce. Those in current are ordered in the queue by their height,
+	/// the nonce less the lowest current nonce, then by gas price.
+	struct SenderQueue
+	{
+		std::map<u256, Transaction> current;
+		std::map<u256, Transaction> future;
+	};
 
-	ImportResult import(bytesConstRef _tx, IfDropped _ik = IfDropped::Ignore);
-	ImportResult check_WITH_LOCK(h256 const& _h, IfDropped _ik);
-	ImportResult manageImport_WITH_LOCK(h256 const& _h, Transaction const& _transaction);
+	/// Senders whose address hashes to the same shard, behind their own lock.
+	struct Shard
+	{
+		mutable SharedMutex lock;
+		std::unordered_map<Address, SenderQueue> senders;
+	};
 
-	void insertCurrent_WITH_LOCK(std::pair<h256, Transaction> const& _p);
-	void makeCurrent_WITH_LOCK(Transaction const& _t);
-	bool remove_WITH_LOCK(h256 const& _txHash);
-	u256 maxNonce_WITH_LOCK(Address const& _a) const;
-	void verifierBody();
+	/// Transactions in the queue and those dropped, sharded by hash.
+	struct KnownShard
+	{
+		mutable Mutex lock;
+		std::unordered_map<h256, std::pair<Address, u256>> known;		///< Sender and nonce of transactions in the queue, current or future.
+		h256Hash dropped;													///< Transactions that have previously been dropped
+	};
+
+	static const unsigned c_shards = 16;
 
-	mutable SharedMutex m_lock;													///< General lock.
-	h256Hash m_known;															///< Headers of transactions in both sets.
+	Shard& shard(Address const& _a) { return m_shards[std::hash<Address>()(_a) % c_shards]; }
+	Shard const& shard(Address const& _a) const { return m_shards[std::hash<Address>()(_a) % c_shards]; }
+	KnownShard& knownShard(h256 const& _h) { return m_known[std::hash<h256>()(_h) % c_shards]; }
+	KnownShard const& knownShard(h256 const& _h) const { return m_known[std::hash<h256>()(_h) % c_shards]; }
 
-	std::unordered_map<h256, std::function<void(ImportResult)>> m_callbacks;	///< Called once.
-	h256Hash m_dropped;															///< Transactions that have previously been dropped
+	ImportResult import(bytesConstRef _tx, IfDropped _ik = IfDropped::Ignore);
+	ImportResult check(h256 const& _h, IfDropped _ik) const;
+	bool lookup(h256 const& _h, Address& o_sender, u256& o_nonce) const;
+	void forget(h256 const& _h, bool _drop = false);
+	ImportResult manageImport_WITH_LOCK(Shard& _shard, h256 const& _h, Transaction const& _transaction);
+
+	void insertCurrent_WITH_LOCK(Shard& _shard, h256 const& _h, Transaction const& _t);
+	bool makeCurrent_WITH_LOCK(Shard& _shard, Transaction const& _t);
+	bool remove_WITH_LOCK(Shard& _shard, h256 const& _txHash, Address const& _sender, u256 const& _nonce);
+	u256 maxNonce_WITH_LOCK(Shard const& _shard, Address const& _a) const;
+	/// Drops the lowest priority current and arbitrary future transactions beyond the limits. Call holding no shard lock.
+	void enforceLimits();
+	void verifierBody();
 
-	PriorityQueue m_current;
-	std::unordered_map<h256, PriorityQueue::iterator> m_currentByHash;			///< Transaction hash to set ref
-	std::unordered_map<Address, std::map<u256, PriorityQueue::iterator>> m_currentByAddressAndNonce; ///< Transactions grouped by account and nonce
-	std::unordered_map<Address, std::map<u256, VerifiedTransaction>> m_future;	/// Future transactions
+	std::array<Shard, c_shards> m_shards;
+	std::array<KnownShard, c_shards> m_known;
+	std::atomic<size_t> m_currentSize = {0};									///< Current number of pending transactions
+	std::atomic<size_t> m_futureSize = {0};										///< Current number of future transactions
 
 	Signal<> m_onReady;															///< Called when a subsequent call to import transactions will return a non-empty container. Be nice and exit fast.
 	Signal<ImportResult, h256 const&, h512 const&> m_onImport;					///< Called for each import attempt. Arguments are result, transaction id an node id. Be nice and exit fast.
 	Signal<h256 const&> m_onReplaced;											///< Called whan transction is dropped during a call to import() to make room for another transaction.
 	unsigned m_limit;															///< Max number of pending transactions
 	unsigned m_futureLimit;														///< Max number of future transactions
-	unsigned m_futureSize = 0;													///< Current number of future transactions
 
 	std::condition_variable m_queueReady;										///< Signaled when m_unverified has a new entry.
 	std::vector<std::thread> m_verifiers;
 	std::deque<UnverifiedTransaction> m_unverified;								///< Pending verification queue
+	std::deque<std::shared_ptr<SenderRecovery>> m_recoveries;					///< Batches the verifiers can help with
 	mutable Mutex x_queue;														///< Verification queue mutex
 	std::atomic<bool> m_aborting = {false};										///< Exit condition for verifier.
 };
@@ -0,0 +1,324 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file Arith256.cpp
+ */
+
+#include "Arith256.h"
+
+namespace dev
+{
+namespace eth
+{
+namespace arith
+{
+namespace
+{
+inline int leadingZeros(uint64_t _x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(_x);
+#else
+    int n = 0;
+    for (uint64_t bit = uint64_t(1) << 63; bit && !(_x & bit); bit >>= 1)
+        ++n;
+    return n;
+#endif
+}
+
+/// Divides the 128-bit (@a _hi, @a _lo) by @a _d, where _hi < _d so that the quotient fits.
+inline uint64_t div128(uint64_t _hi, uint64_t _lo, uint64_t _d, uint64_t& o_r)
+{
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    uint64_t q;
+    __asm__("divq %4" : "=a"(q), "=d"(o_r) : "a"(_lo), "d"(_hi), "r"(_d));
+    return q;
+#elif defined(__SIZEOF_INT128__)
+    unsigned __int128 const n = ((unsigned __int128)_hi << 64) | _lo;
+    o_r = uint64_t(n % _d);
+    return uint64_t(n / _d);
+#else
+    // two steps of 64 by 32 bits, from Hacker's Delight (divlu)
+    uint64_t const b = uint64_t(1) << 32;
+    int const s = leadingZeros(_d);
+    uint64_t const v = _d << s;
+    uint64_t const vn1 = v >> 32, vn0 = uint32_t(v);
+    uint64_t const un32 = (_hi << s) | (s ? _lo >> (64 - s) : 0);
+    uint64_t const un10 = _lo << s;
+    uint64_t const un1 = un10 >> 32, un0 = uint32_t(un10);
+
+    uint64_t q1 = un32 / vn1;
+    uint64_t rhat = un32 - q1 * vn1;
+    while (q1 >= b || q1 * vn0 > ((rhat << 32) | un1))
+    {
+        --q1;
+        rhat += vn1;
+        if (rhat >= b)
+            break;
+    }
+    uint64_t const un21 = (un32 << 32) + un1 - q1 * v;
+    uint64_t q0 = un21 / vn1;
+    rhat = un21 - q0 * vn1;
+    while (q0 >= b || q0 * vn0 > ((rhat << 32) | un0))
+    {
+        --q0;
+        rhat += vn1;
+        if (rhat >= b)
+            break;
+    }
+    o_r = ((un21 << 32) + un0 - q0 * v) >> s;
+    return (q1 << 32) + q0;
+#endif
+}
+
+/// Knuth's algorithm D (TAOCP vol. 2, 4.3.1) on 64-bit limbs.
+/// Divides the @a _m limbs of @a _u by the @a _n limbs of @a _v, where _m >= _n, _m <= 8 and
+/// the top limb of @a _v is not zero. @a o_q gets _m - _n + 1 limbs, @a o_r gets _n.
+void divKnuth(uint64_t* o_q, uint64_t* o_r, uint64_t const* _u, uint64_t const* _v, int _m, int _n)
+{
+    if (_n == 1)
+    {
+        uint64_t r = 0;
+        for (int j = _m - 1; j >= 0; --j)
+            o_q[j] = div128(r, _u[j], _v[0], r);
+        o_r[0] = r;
+        return;
+    }
+
+    // normalise so that the top limb of the divisor has its high bit set
+    int const s = leadingZeros(_v[_n - 1]);
+    uint64_t vn[4];
+    uint64_t un[9];
+    for (int i = _n - 1; i > 0; --i)
+        vn[i] = (_v[i] << s) | (s ? _v[i - 1] >> (64 - s) : 0);
+    vn[0] = _v[0] << s;
+    un[_m] = s ? _u[_m - 1] >> (64 - s) : 0;
+    for (int i = _m - 1; i > 0; --i)
+        un[i] = (_u[i] << s) | (s ? _u[i - 1] >> (64 - s) : 0);
+    un[0] = _u[0] << s;
+
+    uint64_t const vTop = vn[_n - 1];
+    uint64_t const vNext = vn[_n - 2];
+    for (int j = _m - _n; j >= 0; --j)
+    {
+        // estimate the quotient limb from the top two limbs; it is at most one too large
+        // once corrected against the next divisor limb
+        uint64_t qhat;
+        uint64_t rhat;
+        bool rhatOverflow = false;
+        if (un[j + _n] >= vTop)
+        {
+            qhat = ~uint64_t(0);
+            rhat = un[j + _n - 1] + vTop;
+            rhatOverflow = rhat < vTop;
+        }
+        else
+            qhat = div128(un[j + _n], un[j + _n - 1], vTop, rhat);
+        while (!rhatOverflow)
+        {
+            uint64_t hi;
+            uint64_t const lo = mul64(qhat, vNext, hi);
+            if (hi < rhat || (hi == rhat && lo <= un[j + _n - 2]))
+                break;
+            --qhat;
+            rhat += vTop;
+            rhatOverflow = rhat < vTop;
+        }
+
+        // multiply and subtract
+        uint64_t carry = 0;
+        uint64_t borrow = 0;
+        for (int i = 0; i < _n; ++i)
+        {
+            uint64_t hi;
+            uint64_t lo = mul64(qhat, vn[i], hi);
+            lo += carry;
+            hi += lo < carry;
+            carry = hi;
+            uint64_t const x = un[i + j];
+            uint64_t const d = x - lo;
+            un[i + j] = d - borrow;
+            borrow = (x < lo) | (d < borrow);
+        }
+        uint64_t const x = un[j + _n];
+        bool const negative = x < carry || x - carry < borrow;
+        un[j + _n] = x - carry - borrow;
+
+        o_q[j] = qhat;
+        if (negative)
+        {
+            // subtracted one divisor too many, add it back
+            --o_q[j];
+            uint64_t c = 0;
+            for (int i = 0; i < _n; ++i)
+            {
+                uint64_t const sum = un[i + j] + c;
+                c = sum < c;
+                un[i + j] = sum + vn[i];
+                c |= un[i + j] < sum;
+            }
+            un[j + _n] += c;
+        }
+    }
+
+    // unnormalise the remainder
+    for (int i = 0; i < _n; ++i)
+        o_r[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+}
+
+inline int significantLimbs(uint64_t const* _limbs, int _n)
+{
+    while (_n > 0 && !_limbs[_n - 1])
+        --_n;
+    return _n;
+}
+
+/// Divides the @a _limbs limbs of @a _u (at most 8) by @a _v, which is not zero.
+/// @a o_q, if given, gets _limbs limbs.
+void divModWide(uint64_t const* _u, unsigned _limbs, Word256 const& _v, uint64_t* o_q, Word256& o_r)
+{
+    uint64_t q[8] = {};
+    int const m = significantLimbs(_u, _limbs);
+    int const n = significantLimbs(_v.limbs, 4);
+
+    o_r = Word256{{0, 0, 0, 0}};
+    if (m < n)
+        // dividend smaller than the divisor, so it fits in a word
+        std::memcpy(o_r.limbs, _u, m * sizeof(uint64_t));
+    else
+        divKnuth(q, o_r.limbs, _u, _v.limbs, m, n);
+
+    if (o_q)
+        std::memcpy(o_q, q, _limbs * sizeof(uint64_t));
+}
+
+inline bool fits64(Word256 const& _a)
+{
+    return !(_a.limbs[1] | _a.limbs[2] | _a.limbs[3]);
+}
+
+inline Word256 abs(Word256 const& _a)
+{
+    return isNegative(_a) ? negate(_a) : _a;
+}
+}
+
+void divMod(Word256 const& _a, Word256 const& _b, Word256& o_quotient, Word256& o_remainder)
+{
+    o_quotient = o_remainder = Word256{{0, 0, 0, 0}};
+    if (isZero(_b))
+        return;
+    if (fits64(_a) && fits64(_b))
+    {
+        o_quotient.limbs[0] = _a.limbs[0] / _b.limbs[0];
+        o_remainder.limbs[0] = _a.limbs[0] % _b.limbs[0];
+        return;
+    }
+    if (lt(_a, _b))
+    {
+        o_remainder = _a;
+        return;
+    }
+    divModWide(_a.limbs, 4, _b, o_quotient.limbs, o_remainder);
+}
+
+Word256 div(Word256 const& _a, Word256 const& _b)
+{
+    Word256 q, r;
+    divMod(_a, _b, q, r);
+    return q;
+}
+
+Word256 mod(Word256 const& _a, Word256 const& _b)
+{
+    Word256 q, r;
+    divMod(_a, _b, q, r);
+    return r;
+}
+
+Word256 sdiv(Word256 const& _a, Word256 const& _b)
+{
+    Word256 q = div(abs(_a), abs(_b));
+    return isNegative(_a) != isNegative(_b) ? negate(q) : q;
+}
+
+Word256 smod(Word256 const& _a, Word256 const& _b)
+{
+    // the remainder takes the sign of the dividend
+    Word256 r = mod(abs(_a), abs(_b));
+    return isNegative(_a) ? negate(r) : r;
+}
+
+Word256 addmod(Word256 const& _a, Word256 const& _b, Word256 const& _m)
+{
+    Word256 r = {{0, 0, 0, 0}};
+    if (isZero(_m))
+        return r;
+    bool carry;
+    Word256 const sum = add(_a, _b, carry);
+    if (!carry && lt(sum, _m))
+        return sum;
+    uint64_t const wide[5] = {sum.limbs[0], sum.limbs[1], sum.limbs[2], sum.limbs[3], carry};
+    divModWide(wide, 5, _m, nullptr, r);
+    return r;
+}
+
+Word256 mulmod(Word256 const& _a, Word256 const& _b, Word256 const& _m)
+{
+    Word256 r = {{0, 0, 0, 0}};
+    if (isZero(_m))
+        return r;
+
+    // full 512-bit product
+    uint64_t product[8] = {};
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        uint64_t carry = 0;
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            uint64_t hi;
+            uint64_t lo = mul64(_a.limbs[i], _b.limbs[j], hi);
+            lo += carry;
+            hi += lo < carry;
+            product[i + j] += lo;
+            hi += product[i + j] < lo;
+            carry = hi;
+        }
+        product[i + 4] = carry;
+    }
+    divModWide(product, 8, _m, nullptr, r);
+    return r;
+}
+
+Word256 exp(Word256 _base, Word256 const& _exponent)
+{
+    Word256 ret = {{1, 0, 0, 0}};
+    int top = 255;
+    while (top >= 0 && !(_exponent.limbs[top / 64] >> (top % 64) & 1))
+        --top;
+    for (int bit = 0; bit <= top; ++bit)
+    {
+        if (_exponent.limbs[bit / 64] >> (bit % 64) & 1)
+            ret = mul(ret, _base);
+        if (bit < top)
+            _base = mul(_base, _base);
+    }
+    return ret;
+}
+
+}
+}
+}
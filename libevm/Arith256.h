@@ -0,0 +1,253 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file Arith256.h
+ * Fixed-width 256-bit arithmetic for the interpreters' hot opcodes.
+ */
+
+#pragma once
+
+#include <libdevcore/Common.h>
+
+#include <cstring>
+
+namespace dev
+{
+namespace eth
+{
+/// A 256-bit EVM word as four 64-bit limbs, least significant first.
+struct Word256
+{
+    uint64_t limbs[4];
+};
+
+namespace arith
+{
+using limb_type = boost::multiprecision::limb_type;
+
+/// Reads the limbs of @a _v without going through the generic multiprecision code.
+inline Word256 toWord(u256 const& _v)
+{
+    Word256 ret = {{0, 0, 0, 0}};
+    auto const& b = _v.backend();
+    if (sizeof(limb_type) == sizeof(uint64_t))
+        std::memcpy(ret.limbs, b.limbs(), b.size() * sizeof(limb_type));
+    else
+        for (unsigned i = 0; i < b.size(); ++i)
+            ret.limbs[i * sizeof(limb_type) / 8] |=
+                uint64_t(b.limbs()[i]) << (i * sizeof(limb_type) * 8 % 64);
+    return ret;
+}
+
+inline void fromWord(Word256 const& _w, u256& o_v)
+{
+    auto& b = o_v.backend();
+    unsigned const n = 32 / sizeof(limb_type);
+    b.resize(n, n);
+    if (sizeof(limb_type) == sizeof(uint64_t))
+        std::memcpy(b.limbs(), _w.limbs, sizeof(_w.limbs));
+    else
+        for (unsigned i = 0; i < n; ++i)
+            b.limbs()[i] = limb_type(_w.limbs[i * sizeof(limb_type) / 8] >> (i * sizeof(limb_type) * 8 % 64));
+    b.normalize();
+}
+
+inline u256 fromWord(Word256 const& _w)
+{
+    u256 ret;
+    fromWord(_w, ret);
+    return ret;
+}
+
+inline bool isZero(Word256 const& _a)
+{
+    return !(_a.limbs[0] | _a.limbs[1] | _a.limbs[2] | _a.limbs[3]);
+}
+
+inline bool isNegative(Word256 const& _a)
+{
+    return _a.limbs[3] >> 63;
+}
+
+/// @returns @a _a + @a _b mod 2^256, and the carry out in @a o_carry.
+inline Word256 add(Word256 const& _a, Word256 const& _b, bool& o_carry)
+{
+    Word256 ret;
+    uint64_t carry = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        uint64_t s = _a.limbs[i] + carry;
+        carry = s < carry;
+        ret.limbs[i] = s + _b.limbs[i];
+        carry |= ret.limbs[i] < s;
+    }
+    o_carry = carry;
+    return ret;
+}
+
+inline Word256 add(Word256 const& _a, Word256 const& _b)
+{
+    bool carry;
+    return add(_a, _b, carry);
+}
+
+inline Word256 sub(Word256 const& _a, Word256 const& _b)
+{
+    Word256 ret;
+    uint64_t borrow = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        uint64_t d = _a.limbs[i] - _b.limbs[i];
+        uint64_t b = _a.limbs[i] < _b.limbs[i];
+        ret.limbs[i] = d - borrow;
+        borrow = b | (d < borrow);
+    }
+    return ret;
+}
+
+inline Word256 negate(Word256 const& _a)
+{
+    return sub(Word256{{0, 0, 0, 0}}, _a);
+}
+
+/// @returns the 128-bit product of @a _a and @a _b, the high half in @a o_hi.
+inline uint64_t mul64(uint64_t _a, uint64_t _b, uint64_t& o_hi)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 p = (unsigned __int128)_a * _b;
+    o_hi = uint64_t(p >> 64);
+    return uint64_t(p);
+#else
+    uint64_t const aLo = uint32_t(_a), aHi = _a >> 32;
+    uint64_t const bLo = uint32_t(_b), bHi = _b >> 32;
+    uint64_t const ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+    uint64_t const mid = (ll >> 32) + uint32_t(lh) + uint32_t(hl);
+    o_hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return (mid << 32) | uint32_t(ll);
+#endif
+}
+
+/// @returns @a _a * @a _b mod 2^256.
+inline Word256 mul(Word256 const& _a, Word256 const& _b)
+{
+    Word256 ret = {{0, 0, 0, 0}};
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        uint64_t carry = 0;
+        for (unsigned j = 0; i + j < 4; ++j)
+        {
+            uint64_t hi;
+            uint64_t lo = mul64(_a.limbs[i], _b.limbs[j], hi);
+            lo += carry;
+            hi += lo < carry;
+            ret.limbs[i + j] += lo;
+            hi += ret.limbs[i + j] < lo;
+            carry = hi;
+        }
+    }
+    return ret;
+}
+
+inline Word256 bitNot(Word256 const& _a)
+{
+    return {{~_a.limbs[0], ~_a.limbs[1], ~_a.limbs[2], ~_a.limbs[3]}};
+}
+
+/// @returns byte @a _i of @a _a counting from the most significant end, as BYTE does.
+inline uint64_t byteAt(Word256 const& _a, unsigned _i)
+{
+    if (_i >= 32)
+        return 0;
+    unsigned const pos = 31 - _i;
+    return (_a.limbs[pos / 8] >> (pos % 8 * 8)) & 0xff;
+}
+
+inline bool eq(Word256 const& _a, Word256 const& _b)
+{
+    return !((_a.limbs[0] ^ _b.limbs[0]) | (_a.limbs[1] ^ _b.limbs[1]) |
+             (_a.limbs[2] ^ _b.limbs[2]) | (_a.limbs[3] ^ _b.limbs[3]));
+}
+
+inline bool lt(Word256 const& _a, Word256 const& _b)
+{
+    for (unsigned i = 4; i--;)
+        if (_a.limbs[i] != _b.limbs[i])
+            return _a.limbs[i] < _b.limbs[i];
+    return false;
+}
+
+/// Less-than on the two's complement interpretation of @a _a and @a _b.
+inline bool slt(Word256 const& _a, Word256 const& _b)
+{
+    bool const aNeg = isNegative(_a);
+    if (aNeg != isNegative(_b))
+        return aNeg;
+    return lt(_a, _b);
+}
+
+inline Word256 shl(Word256 const& _a, unsigned _shift)
+{
+    Word256 ret = {{0, 0, 0, 0}};
+    if (_shift >= 256)
+        return ret;
+    unsigned const limbShift = _shift / 64, bitShift = _shift % 64;
+    for (unsigned i = 4; i-- > limbShift;)
+    {
+        ret.limbs[i] = _a.limbs[i - limbShift] << bitShift;
+        if (bitShift && i > limbShift)
+            ret.limbs[i] |= _a.limbs[i - limbShift - 1] >> (64 - bitShift);
+    }
+    return ret;
+}
+
+/// Logical right shift, or arithmetic when @a _signed.
+inline Word256 shr(Word256 const& _a, unsigned _shift, bool _signed = false)
+{
+    uint64_t const fill = _signed && isNegative(_a) ? ~uint64_t(0) : 0;
+    Word256 ret = {{fill, fill, fill, fill}};
+    if (_shift >= 256)
+        return ret;
+    unsigned const limbShift = _shift / 64, bitShift = _shift % 64;
+    for (unsigned i = 0; i + limbShift < 4; ++i)
+    {
+        ret.limbs[i] = _a.limbs[i + limbShift] >> bitShift;
+        uint64_t const next = i + limbShift + 1 < 4 ? _a.limbs[i + limbShift + 1] : fill;
+        if (bitShift)
+            ret.limbs[i] |= next << (64 - bitShift);
+    }
+    return ret;
+}
+
+/// Quotient and remainder of @a _a by @a _b, both zero if @a _b is zero.
+void divMod(Word256 const& _a, Word256 const& _b, Word256& o_quotient, Word256& o_remainder);
+
+Word256 div(Word256 const& _a, Word256 const& _b);
+Word256 mod(Word256 const& _a, Word256 const& _b);
+Word256 sdiv(Word256 const& _a, Word256 const& _b);
+Word256 smod(Word256 const& _a, Word256 const& _b);
+
+/// (@a _a + @a _b) mod @a _m without wrapping at 2^256, zero if @a _m is zero.
+Word256 addmod(Word256 const& _a, Word256 const& _b, Word256 const& _m);
+
+/// (@a _a * @a _b) mod @a _m over the full 512-bit product, zero if @a _m is zero.
+Word256 mulmod(Word256 const& _a, Word256 const& _b, Word256 const& _m);
+
+/// @a _base to the power @a _exponent mod 2^256.
+Word256 exp(Word256 _base, Word256 const& _exponent);
+
+}
+}
+}
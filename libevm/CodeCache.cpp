@@ -0,0 +1,374 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file CodeCache.cpp
+ */
+
+#include "CodeCache.h"
+#include "Instruction.h"
+#include "VM.h"
+#include "VMConfig.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+/// Whether the gas of @a _op is fully given by its tier and it cannot leave the frame, so
+/// that it can be charged as part of a basic block.
+bool isBlockMetered(Instruction _op)
+{
+    switch (_op)
+    {
+    case Instruction::STOP:
+    case Instruction::RETURN:
+    case Instruction::INVALID:
+    case Instruction::BLOCKHASH:
+        return false;
+    default:
+        break;
+    }
+    // subroutines, SIMD, calls and creates all price or route themselves
+    if ((byte)_op >= (byte)Instruction::JUMPTO)
+        return false;
+    return instructionInfo(_op).gasPriceTier < Tier::Special;
+}
+
+/// Whether a basic block has to end after @a _op: it branches, or reads the gas left,
+/// which must not include the prepaid cost of what follows.
+bool endsBlock(Instruction _op)
+{
+    return _op == Instruction::JUMP || _op == Instruction::JUMPI ||
+           _op == Instruction::JUMPC || _op == Instruction::JUMPCI || _op == Instruction::GAS;
+}
+
+void buildBlocks(AnalysedCode& _a, size_t _nBytes)
+{
+    static const int64_t c_tierGas[] = {VMSchedule::stepGas0, VMSchedule::stepGas1,
+        VMSchedule::stepGas2, VMSchedule::stepGas3, VMSchedule::stepGas4, VMSchedule::stepGas5,
+        VMSchedule::stepGas6};
+
+    bytes const& code = _a.code;
+    _a.blockAt.assign(code.size(), 0);
+
+    BasicBlock block;
+    size_t start = 0;
+    int depth = 0;
+    int required = 0;
+    int growth = 0;
+    bool open = false;
+    auto close = [&](size_t _end) {
+        if (!open)
+            return;
+        block.length = _end - start;
+        block.stackRequired = required;
+        block.stackMaxGrowth = growth;
+        _a.blocks.push_back(block);
+        _a.blockAt[start] = _a.blocks.size();
+        open = false;
+    };
+
+    TRACE_STR(1, "Build basic blocks")
+    size_t pc = 0;
+    while (pc < _nBytes)
+    {
+        Instruction op = Instruction(code[pc]);
+        size_t next = pc + 1;
+        if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
+            next += (byte)op - (byte)Instruction::PUSH1 + 1;
+        else if (op == Instruction::PUSHC)
+            next = pc + 3 + code[pc + 3];
+#if EIP_615
+        else if (
+            op == Instruction::JUMPTO ||
+            op == Instruction::JUMPIF ||
+            op == Instruction::JUMPSUB)
+            next += 5;
+        else if (op == Instruction::JUMPV || op == Instruction::JUMPSUBV)
+            next += 1 + 4 * code[pc + 1];
+        else if (op == Instruction::BEGINDATA)
+            break;
+#endif
+
+        if (!isBlockMetered(op))
+            close(pc);
+        else
+        {
+            if (!open)
+            {
+                block = BasicBlock();
+                start = pc;
+                depth = required = growth = 0;
+                open = true;
+            }
+            InstructionInfo const info = instructionInfo(op);
+            required = std::max(required, info.args - depth);
+            depth += info.ret - info.args;
+            growth = std::max(growth, depth);
+            block.gas += c_tierGas[static_cast<unsigned>(info.gasPriceTier)];
+            if (endsBlock(op))
+                close(next);
+        }
+        pc = next;
+    }
+    close(std::min(pc, _nBytes));
+}
+}
+
+bool AnalysedCode::isJumpDest(u256 const& _dest) const
+{
+    // use binary search of array because hashtable collisions are exploitable
+    return _dest <= 0x7FFFFFFFFFFFFFFF && binary_search(jumpDests.begin(), jumpDests.end(), uint64_t(_dest));
+}
+
+size_t AnalysedCode::memoryUsed() const
+{
+    return sizeof(AnalysedCode) + code.capacity() + pool.capacity() * sizeof(u256) +
+           (jumpDests.capacity() + beginSubs.capacity()) * sizeof(uint64_t) +
+           blocks.capacity() * sizeof(BasicBlock) + blockAt.capacity() * sizeof(uint32_t);
+}
+
+shared_ptr<AnalysedCode const> analyseCode(bytesConstRef _code)
+{
+    auto ret = make_shared<AnalysedCode>();
+    ret->originalSize = _code.size();
+
+    // Copy code so that it can be safely modified and extend code by
+    // 33 zero bytes to allow reading virtual data at the end
+    // of the code without bounds checks.
+    bytes& code = ret->code;
+    code.reserve(_code.size() + 33);
+    code.assign(_code.begin(), _code.end());
+    code.resize(_code.size() + 33);
+
+    size_t const nBytes = _code.size();
+
+    // build a table of jump destinations for use in verifyJumpDest
+
+    TRACE_STR(1, "Build JUMPDEST table")
+    for (size_t pc = 0; pc < nBytes; ++pc)
+    {
+        Instruction op = Instruction(code[pc]);
+        TRACE_OP(2, pc, op);
+
+        // make synthetic ops in user code trigger invalid instruction if run
+        if (
+            op == Instruction::PUSHC ||
+            op == Instruction::JUMPC ||
+            op == Instruction::JUMPCI
+        )
+        {
+            TRACE_OP(1, pc, op);
+            code[pc] = (byte)Instruction::INVALID;
+        }
+
+        if (op == Instruction::JUMPDEST)
+        {
+            ret->jumpDests.push_back(pc);
+        }
+        else if (
+            (byte)Instruction::PUSH1 <= (byte)op &&
+            (byte)op <= (byte)Instruction::PUSH32
+        )
+        {
+            pc += (byte)op - (byte)Instruction::PUSH1 + 1;
+        }
+#if EIP_615
+        else if (
+            op == Instruction::JUMPTO ||
+            op == Instruction::JUMPIF ||
+            op == Instruction::JUMPSUB)
+        {
+            ++pc;
+            pc += 4;
+        }
+        else if (op == Instruction::JUMPV || op == Instruction::JUMPSUBV)
+        {
+            ++pc;
+            pc += 4 * code[pc];  // number of 4-byte dests followed by table
+        }
+        else if (op == Instruction::BEGINSUB)
+        {
+            ret->beginSubs.push_back(pc);
+        }
+        else if (op == Instruction::BEGINDATA)
+        {
+            break;
+        }
+#endif
+    }
+
+#ifdef EVM_DO_FIRST_PASS_OPTIMIZATION
+
+    TRACE_STR(1, "Do first pass optimizations")
+    for (size_t pc = 0; pc < nBytes; ++pc)
+    {
+        u256 val = 0;
+        Instruction op = Instruction(code[pc]);
+
+        if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
+        {
+            byte nPush = (byte)op - (byte)Instruction::PUSH1 + 1;
+
+            // decode pushed bytes to integral value
+            val = code[pc+1];
+            for (uint64_t i = pc+2, n = nPush; --n; ++i) {
+                val = (val << 8) | code[i];
+            }
+
+        #if EVM_USE_CONSTANT_POOL
+
+            // add value to constant pool and replace PUSHn with PUSHC
+            // place offset in code as 2 bytes MSB-first
+            // followed by one byte count of remaining pushed bytes
+            if (5 < nPush)
+            {
+                uint16_t pool_off = ret->pool.size();
+                TRACE_VAL(1, "stash", val);
+                TRACE_VAL(1, "... in pool at offset" , pool_off);
+                ret->pool.push_back(val);
+
+                TRACE_PRE_OPT(1, pc, op);
+                code[pc] = byte(op = Instruction::PUSHC);
+                code[pc+3] = nPush - 2;
+                code[pc+2] = pool_off & 0xff;
+                code[pc+1] = pool_off >> 8;
+                TRACE_POST_OPT(1, pc, op);
+            }
+
+        #endif
+
+        #if EVM_REPLACE_CONST_JUMP
+            // replace JUMP or JUMPI to constant location with JUMPC or JUMPCI
+            // verifyJumpDest is M = log(number of jump destinations)
+            // outer loop is N = number of bytes in code array
+            // so complexity is N log M, worst case is N log N
+            size_t i = pc + nPush + 1;
+            op = Instruction(code[i]);
+            if (op == Instruction::JUMP)
+            {
+                TRACE_VAL(1, "Replace const JUMP with JUMPC to", val)
+                TRACE_PRE_OPT(1, i, op);
+
+                if (ret->isJumpDest(val))
+                    code[i] = byte(op = Instruction::JUMPC);
+
+                TRACE_POST_OPT(1, i, op);
+            }
+            else if (op == Instruction::JUMPI)
+            {
+                TRACE_VAL(1, "Replace const JUMPI with JUMPCI to", val)
+                TRACE_PRE_OPT(1, i, op);
+
+                if (ret->isJumpDest(val))
+                    code[i] = byte(op = Instruction::JUMPCI);
+
+                TRACE_POST_OPT(1, i, op);
+            }
+        #endif
+
+            pc += nPush;
+        }
+    }
+    TRACE_STR(1, "Finished optimizations")
+#endif
+
+    buildBlocks(*ret, nBytes);
+    return ret;
+}
+
+CodeCache& CodeCache::get()
+{
+    static CodeCache s_cache(32 * 1024 * 1024);
+    return s_cache;
+}
+
+shared_ptr<AnalysedCode const> CodeCache::analysis(h256 const& _codeHash, bytesConstRef _code)
+{
+    if (_codeHash)
+    {
+        Guard l(x_cache);
+        auto it = m_entries.find(_codeHash);
+        if (it != m_entries.end() && it->second.code->originalSize == _code.size())
+        {
+            ++m_hits;
+            m_lru.splice(m_lru.begin(), m_lru, it->second.position);
+            return it->second.code;
+        }
+        ++m_misses;
+    }
+
+    // Analysed without the lock; racing frames may both do it, the first one is kept.
+    shared_ptr<AnalysedCode const> ret = analyseCode(_code);
+    if (!_codeHash)
+        return ret;
+
+    Guard l(x_cache);
+    size_t const size = ret->memoryUsed();
+    if (size > m_capacity || m_entries.count(_codeHash))
+        return ret;
+    m_lru.push_front(_codeHash);
+    m_entries[_codeHash] = Entry{ret, m_lru.begin()};
+    m_used += size;
+    evict();
+    return ret;
+}
+
+void CodeCache::evict()
+{
+    while (m_used > m_capacity && !m_lru.empty())
+    {
+        auto it = m_entries.find(m_lru.back());
+        m_used -= it->second.code->memoryUsed();
+        m_entries.erase(it);
+        m_lru.pop_back();
+    }
+}
+
+void CodeCache::setCapacity(size_t _capacity)
+{
+    Guard l(x_cache);
+    m_capacity = _capacity;
+    evict();
+}
+
+void CodeCache::clear()
+{
+    Guard l(x_cache);
+    m_entries.clear();
+    m_lru.clear();
+    m_used = 0;
+}
+
+CodeCache::Stats CodeCache::stats() const
+{
+    Guard l(x_cache);
+    Stats ret;
+    ret.hits = m_hits;
+    ret.misses = m_misses;
+    ret.used = m_used;
+    ret.capacity = m_capacity;
+    ret.entries = m_entries.size();
+    return ret;
+}
+
+}
+}
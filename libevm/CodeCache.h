@@ -0,0 +1,120 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file CodeCache.h
+ * Analysed EVM code shared by every call frame that runs it.
+ */
+
+#pragma once
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace dev
+{
+namespace eth
+{
+/// A straight run of instructions with fixed gas costs, ending at the first jump, GAS or
+/// instruction that prices itself. Its gas and stack bounds are checked once, on entry.
+struct BasicBlock
+{
+    uint64_t gas = 0;               ///< Sum of the tier gas of its instructions.
+    uint32_t length = 0;            ///< Bytes of code it covers.
+    uint32_t stackRequired = 0;     ///< Items that must be on the stack on entry.
+    uint32_t stackMaxGrowth = 0;    ///< Most items it holds above the entry height.
+};
+
+/// Code prepared for the interpreters: a copy padded with 33 zero bytes, with PUSHn/JUMP
+/// rewritten to PUSHC/JUMPC(I) by the first-pass optimisations, the constant pool those
+/// refer to, the sorted jump destinations and the basic blocks. Never changes once built.
+struct AnalysedCode
+{
+    bytes code;
+    std::vector<u256> pool;
+    std::vector<uint64_t> jumpDests;
+    std::vector<uint64_t> beginSubs;
+    std::vector<BasicBlock> blocks;
+    std::vector<uint32_t> blockAt;  ///< 1 + index of the block starting at each pc, 0 if none.
+    size_t originalSize = 0;
+
+    /// @returns whether @a _dest is the position of a JUMPDEST.
+    bool isJumpDest(u256 const& _dest) const;
+
+    /// Bytes of memory held, as charged against the cache capacity.
+    size_t memoryUsed() const;
+};
+
+/// Analyses @a _code from scratch.
+std::shared_ptr<AnalysedCode const> analyseCode(bytesConstRef _code);
+
+/**
+ * @brief Bounded LRU of analysed code keyed by code hash, shared by the interpreters.
+ * A cache hit turns the per-call copy, jump table scan and optimisation pass into a lookup.
+ * @threadsafe
+ */
+class CodeCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t used = 0;
+        size_t capacity = 0;
+        size_t entries = 0;
+    };
+
+    /// The cache used by the interpreters, 32MB unless resized.
+    static CodeCache& get();
+
+    explicit CodeCache(size_t _capacity): m_capacity(_capacity) {}
+
+    /// @returns the analysis of @a _code, whose hash is @a _codeHash, from the cache or made
+    /// and cached now. Code with a zero hash is analysed but not cached.
+    std::shared_ptr<AnalysedCode const> analysis(h256 const& _codeHash, bytesConstRef _code);
+
+    /// Sets the capacity in bytes, evicting as needed; 0 disables caching.
+    void setCapacity(size_t _capacity);
+    void clear();
+
+    Stats stats() const;
+
+private:
+    using LRU = std::list<h256>;
+    struct Entry
+    {
+        std::shared_ptr<AnalysedCode const> code;
+        LRU::iterator position;
+    };
+
+    void evict();
+
+    mutable Mutex x_cache;
+    size_t m_capacity;
+    size_t m_used = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    LRU m_lru;              ///< Most recently used first.
+    std::unordered_map<h256, Entry> m_entries;
+};
+
+}
+}
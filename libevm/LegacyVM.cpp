@@ -26,16 +26,6 @@ uint64_t LegacyVM::memNeed(u256 _offset, u256 _size)
 	return toInt63(_size ? u512(_offset) + _size : u512(0));
 }
 
-template <class S> S divWorkaround(S const& _a, S const& _b)
-{
-	return (S)(s512(_a) / s512(_b));
-}
-
-template <class S> S modWorkaround(S const& _a, S const& _b)
-{
-	return (S)(s512(_a) % s512(_b));
-}
-
 
 //
 // for decoding destinations of JUMPTO, JUMPV, JUMPSUB and JUMPSUBV
@@ -72,6 +62,13 @@ uint64_t LegacyVM::decodeJumpvDest(const byte* const _code, uint64_t& _pc, byte
 // for tracing, checking, metering, measuring ...
 //
 void LegacyVM::onOperation()
+{
+	if (m_profile)
+		m_profile->onOp(m_OP);
+	traceOperation();
+}
+
+void LegacyVM::traceOperation()
 {
 	if (m_onOp)
 		(m_onOp)(++m_nSteps, m_PC, m_OP,
@@ -170,9 +167,12 @@ owning_bytes_ref LegacyVM::exec(u256& _io_gas, ExtVMFace& _ext, OnOpFunc const&
 	m_ext = &_ext;
 	m_schedule = &m_ext->evmSchedule();
 	m_onOp = _onOp;
-	m_onFail = &LegacyVM::onOperation; // this results in operations that fail being logged twice in the trace
+	m_onFail = &LegacyVM::traceOperation; // this results in operations that fail being logged twice in the trace
 	m_PC = 0;
 
+	ProfileScope profile(m_ext->myAddress, m_io_gas);
+	m_profile = profile.active() ? &profile : nullptr;
+
 	try
 	{
 		// trampoline to minimize depth of call stack when calling out
@@ -189,6 +189,7 @@ owning_bytes_ref LegacyVM::exec(u256& _io_gas, ExtVMFace& _ext, OnOpFunc const&
 	}
 
 	*m_io_gas_p = m_io_gas;
+	profile.finish(m_io_gas);
 	return std::move(m_output);
 }
 
@@ -423,7 +424,7 @@ void LegacyVM::interpretCases()
 			updateIOGas();
 
 			u256 base = m_SP[0];
-			m_SPP[0] = exp256(base, expon);
+			arith::fromWord(arith::exp(arith::toWord(base), arith::toWord(expon)), m_SPP[0]);
 		}
 		NEXT
 
@@ -437,7 +438,7 @@ void LegacyVM::interpretCases()
 			updateIOGas();
 
 			//pops two items and pushes their sum mod 2^256.
-			m_SPP[0] = m_SP[0] + m_SP[1];
+			arith::fromWord(arith::add(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
 		}
 		NEXT
 
@@ -447,7 +448,7 @@ void LegacyVM::interpretCases()
 			updateIOGas();
 
 			//pops two items and pushes their product mod 2^256.
-			m_SPP[0] = m_SP[0] * m_SP[1];
+			arith::fromWord(arith::mul(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
 		}
 		NEXT
 
@@ -456,7 +457,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_SPP[0] = m_SP[0] - m_SP[1];
+			arith::fromWord(arith::sub(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
 		}
 		NEXT
 
@@ -465,7 +466,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_SPP[0] = m_SP[1] ? divWorkaround(m_SP[0], m_SP[1]) : 0;
+			arith::fromWord(arith::div(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
 		}
 		NEXT
 
@@ -474,7 +475,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_SPP[0] = m_SP[1] ? s2u(divWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+			arith::fromWord(arith::sdiv(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
 			--m_SP;
 		}
 		NEXT
@@ -484,7 +485,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_SPP[0] = m_SP[1] ? modWorkaround(m_SP[0], m_SP[1]) : 0;
+			arith::fromWord(arith::mod(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
 		}
 		NEXT
 
@@ -493,7 +494,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_SPP[0] = m_SP[1] ? s2u(modWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+			arith::fromWord(arith::smod(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
 		}
 		NEXT
 
@@ -502,7 +503,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_SPP[0] = ~m_SP[0];
+			arith::fromWord(arith::bitNot(arith::toWord(m_SP[0])), m_SPP[0]);
 		}
 		NEXT
 
@@ -592,7 +593,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_SPP[0] = m_SP[0] < 32 ? (m_SP[1] >> (unsigned)(8 * (31 - m_SP[0]))) & 0xff : 0;
+			m_SPP[0] = m_SP[0] < 32 ? arith::byteAt(arith::toWord(m_SP[1]), unsigned(m_SP[0])) : 0;
 		}
 		NEXT
 
@@ -664,7 +665,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) + u512(m_SP[1])) % m_SP[2]) : 0;
+			arith::fromWord(arith::addmod(arith::toWord(m_SP[0]), arith::toWord(m_SP[1]), arith::toWord(m_SP[2])), m_SPP[0]);
 		}
 		NEXT
 
@@ -673,7 +674,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) * u512(m_SP[1])) % m_SP[2]) : 0;
+			arith::fromWord(arith::mulmod(arith::toWord(m_SP[0]), arith::toWord(m_SP[1]), arith::toWord(m_SP[2])), m_SPP[0]);
 		}
 		NEXT
 
@@ -701,7 +702,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_PC = decodeJumpDest(m_code.data(), m_PC);
+			m_PC = decodeJumpDest(m_code, m_PC);
 		}
 		CONTINUE
 
@@ -711,7 +712,7 @@ void LegacyVM::interpretCases()
 			updateIOGas();
 
 			if (m_SP[0])
-				m_PC = decodeJumpDest(m_code.data(), m_PC);
+				m_PC = decodeJumpDest(m_code, m_PC);
 			else
 				++m_PC;
 		}
@@ -721,7 +722,7 @@ void LegacyVM::interpretCases()
 		{
 			ON_OP();
 			updateIOGas();
-			m_PC = decodeJumpvDest(m_code.data(), m_PC, byte(m_SP[0]));
+			m_PC = decodeJumpvDest(m_code, m_PC, byte(m_SP[0]));
 		}
 		CONTINUE
 
@@ -730,7 +731,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 			*m_RP++ = m_PC++;
-			m_PC = decodeJumpDest(m_code.data(), m_PC);
+			m_PC = decodeJumpDest(m_code, m_PC);
 		}
 		CONTINUE
 
@@ -739,7 +740,7 @@ void LegacyVM::interpretCases()
 			ON_OP();
 			updateIOGas();
 			*m_RP++ = m_PC;
-			m_PC = decodeJumpvDest(m_code.data(), m_PC, byte(m_SP[0]));
+			m_PC = decodeJumpvDest(m_code, m_PC, byte(m_SP[0]));
 		}
 		CONTINUE
 
@@ -1207,11 +1208,12 @@ void LegacyVM::interpretCases()
 			else if (m_SP[0] >= m_ext->data.size())
 				m_SP[0] = u256(0);
 			else
-			{ 	h256 r;
-				for (uint64_t i = (uint64_t)m_SP[0], e = (uint64_t)m_SP[0] + (uint64_t)32, j = 0; i < e; ++i, ++j)
-					r[j] = i < m_ext->data.size() ? m_ext->data[i] : 0;
+			{
+				h256 r;
+				size_t const offset = (size_t)m_SP[0];
+				simd::copyZeroExtend(r.data(), h256::size, m_ext->data.data() + offset, m_ext->data.size() - offset);
 				m_SP[0] = (u256)r;
-			};
+			}
 		}
 		NEXT
 
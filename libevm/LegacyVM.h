@@ -17,9 +17,14 @@
 
 #pragma once
 
+#include "Arith256.h"
+#include "CodeCache.h"
 #include "Instruction.h"
 #include "VMConfig.h"
 #include "VMFace.h"
+#include "VMProfiler.h"
+
+#include <libdevcore/SIMD.h>
 
 namespace dev
 {
@@ -53,12 +58,11 @@ private:
 
 	static std::array<InstructionMetric, 256> c_metrics;
 	static void initMetrics();
-	static u256 exp256(u256 _base, u256 _exponent);
-	void copyCode(int);
 	typedef void (LegacyVM::*MemFnPtr)();
 	MemFnPtr m_bounce = 0;
 	MemFnPtr m_onFail = 0;
 	uint64_t m_nSteps = 0;
+	ProfileScope* m_profile = nullptr;	// set while the profiler watches this frame
 	EVMSchedule const* m_schedule = nullptr;
 
 	// return bytes
@@ -67,8 +71,9 @@ private:
 	// space for memory
 	bytes m_mem;
 
-	// space for code
-	bytes m_code;
+	// analysed code, shared with other frames through the CodeCache
+	std::shared_ptr<AnalysedCode const> m_analysis;
+	byte const* m_code = nullptr;
 
 	/// RETURNDATA buffer for memory returned from direct subcalls.
 	bytes m_returnData;
@@ -87,7 +92,7 @@ private:
 #endif
 
 	// constant pool
-	std::vector<u256> m_pool;
+	u256 const* m_pool = nullptr;
 
 	// interpreter state
 	Instruction m_OP;                   // current operation
@@ -126,11 +131,10 @@ private:
 	void throwDisallowedStateChange();
 	void throwBufferOverrun(bigint const& _enfOfAccess);
 
-	std::vector<uint64_t> m_beginSubs;
-	std::vector<uint64_t> m_jumpDests;
 	int64_t verifyJumpDest(u256 const& _dest, bool _throw = true);
 
 	void onOperation();
+	void traceOperation();
 	void adjustStack(unsigned _removed, unsigned _added);
 	uint64_t gasForMem(u512 _size);
 	void updateSSGas();
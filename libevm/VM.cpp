@@ -32,6 +32,22 @@ void destroy(evmc_instance* _instance)
     delete static_cast<dev::eth::VM*>(_instance);
 }
 
+int setOption(evmc_instance* _instance, char const* _name, char const* _value) noexcept
+{
+    auto vm = static_cast<dev::eth::VM*>(_instance);
+    if (std::strcmp(_name, "metering") == 0)
+    {
+        if (std::strcmp(_value, "block") == 0)
+            vm->setBlockMetering(true);
+        else if (std::strcmp(_value, "instruction") == 0)
+            vm->setBlockMetering(false);
+        else
+            return 0;
+        return 1;
+    }
+    return 0;
+}
+
 void delete_output(const evmc_result* result)
 {
     delete[] result->output_data;
@@ -86,7 +102,7 @@ namespace eth
 {
 VM::VM()
   : evmc_instance{
-        EVMC_ABI_VERSION, "interpreter", ETH_PROJECT_VERSION, ::destroy, ::execute, nullptr}
+        EVMC_ABI_VERSION, "interpreter", ETH_PROJECT_VERSION, ::destroy, ::execute, ::setOption}
 {}
 
 uint64_t VM::memNeed(u256 _offset, u256 _size)
@@ -94,16 +110,6 @@ uint64_t VM::memNeed(u256 _offset, u256 _size)
     return toInt63(_size ? u512(_offset) + _size : u512(0));
 }
 
-template <class S> S divWorkaround(S const& _a, S const& _b)
-{
-    return (S)(s512(_a) / s512(_b));
-}
-
-template <class S> S modWorkaround(S const& _a, S const& _b)
-{
-    return (S)(s512(_a) % s512(_b));
-}
-
 
 //
 // for decoding destinations of JUMPTO, JUMPV, JUMPSUB and JUMPSUBV
@@ -202,17 +208,54 @@ void VM::logGasMem()
     updateMem(memNeed(m_SP[0], m_SP[1]));
 }
 
+//
+// charge the gas of the basic block starting at the PC and check its stack bounds
+//
+bool VM::enterBlock()
+{
+    m_blockLength = 0;
+    if (!m_blockMetering)
+        return false;
+    uint32_t index = m_analysis->blockAt[m_PC];
+    if (!index)
+        return false;
+
+    BasicBlock const& block = m_analysis->blocks[index - 1];
+    if (uint64_t(m_stackEnd - m_SPP) < block.stackRequired)
+        throwBadStack(block.stackRequired, 0);
+    if (uint64_t(m_SPP - m_stack) < block.stackMaxGrowth)
+        throwBadStack(0, block.stackMaxGrowth);
+    if (m_io_gas < block.gas)
+        throwOutOfGas();
+    m_io_gas -= block.gas;
+
+    m_blockBegin = m_PC;
+    m_blockLength = block.length;
+    return true;
+}
+
 void VM::fetchInstruction()
 {
     m_OP = Instruction(m_code[m_PC]);
     const InstructionMetric& metric = c_metrics[static_cast<size_t>(m_OP)];
-    adjustStack(metric.args, metric.ret);
+    if (m_PC - m_blockBegin < m_blockLength || enterBlock())
+    {
+        // bounds and fees were settled on entry to the block
+        m_SP = m_SPP;
+        m_SPP += metric.args;
+        m_SPP -= metric.ret;
+        m_runGas = 0;
+    }
+    else
+    {
+        adjustStack(metric.args, metric.ret);
 
-    // FEES...
-    std::array<int64_t, 9> tierStepGas{
-        {VMSchedule::stepGas0, VMSchedule::stepGas1, VMSchedule::stepGas2, VMSchedule::stepGas3,
-            VMSchedule::stepGas4, VMSchedule::stepGas5, VMSchedule::stepGas6, 0, 0}};
-    m_runGas = tierStepGas[static_cast<unsigned>(metric.gasPriceTier)];
+        // FEES...
+        std::array<int64_t, 9> tierStepGas{
+            {VMSchedule::stepGas0, VMSchedule::stepGas1, VMSchedule::stepGas2, VMSchedule::stepGas3,
+                VMSchedule::stepGas4, VMSchedule::stepGas5, VMSchedule::stepGas6, 0, 0}};
+        m_runGas = tierStepGas[static_cast<unsigned>(metric.gasPriceTier)];
+    }
     m_newMemSize = m_mem.size();
     m_copyMemSize = 0;
 }
@@ -240,15 +283,20 @@ owning_bytes_ref VM::exec(evmc_context* _context, evmc_revision _rev, const evmc
     m_message = _msg;
     m_io_gas = uint64_t(_msg->gas);
     m_PC = 0;
+    m_blockLength = 0;
     m_pCode = _code;
     m_codeSize = _codeSize;
 
+    ProfileScope profile(fromEvmC(_msg->destination), m_io_gas);
+    m_profile = profile.active() ? &profile : nullptr;
+
     // trampoline to minimize depth of call stack when calling out
     m_bounce = &VM::initEntry;
     do
         (this->*m_bounce)();
     while (m_bounce);
 
+    profile.finish(m_io_gas);
     return std::move(m_output);
 }
 
@@ -526,7 +574,7 @@ void VM::interpretCases()
             updateIOGas();
 
             u256 base = m_SP[0];
-            m_SPP[0] = exp256(base, expon);
+            arith::fromWord(arith::exp(arith::toWord(base), arith::toWord(expon)), m_SPP[0]);
         }
         NEXT
 
@@ -540,7 +588,7 @@ void VM::interpretCases()
             updateIOGas();
 
             //pops two items and pushes their sum mod 2^256.
-            m_SPP[0] = m_SP[0] + m_SP[1];
+            arith::fromWord(arith::add(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
         }
         NEXT
 
@@ -550,7 +598,7 @@ void VM::interpretCases()
             updateIOGas();
 
             //pops two items and pushes their product mod 2^256.
-            m_SPP[0] = m_SP[0] * m_SP[1];
+            arith::fromWord(arith::mul(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
         }
         NEXT
 
@@ -559,7 +607,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[0] - m_SP[1];
+            arith::fromWord(arith::sub(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
         }
         NEXT
 
@@ -568,7 +616,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? divWorkaround(m_SP[0], m_SP[1]) : 0;
+            arith::fromWord(arith::div(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
         }
         NEXT
 
@@ -577,7 +625,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? s2u(divWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+            arith::fromWord(arith::sdiv(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
             --m_SP;
         }
         NEXT
@@ -587,7 +635,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? modWorkaround(m_SP[0], m_SP[1]) : 0;
+            arith::fromWord(arith::mod(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
         }
         NEXT
 
@@ -596,7 +644,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? s2u(modWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+            arith::fromWord(arith::smod(arith::toWord(m_SP[0]), arith::toWord(m_SP[1])), m_SPP[0]);
         }
         NEXT
 
@@ -605,7 +653,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = ~m_SP[0];
+            arith::fromWord(arith::bitNot(arith::toWord(m_SP[0])), m_SPP[0]);
         }
         NEXT
 
@@ -695,7 +743,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[0] < 32 ? (m_SP[1] >> (unsigned)(8 * (31 - m_SP[0]))) & 0xff : 0;
+            m_SPP[0] = m_SP[0] < 32 ? arith::byteAt(arith::toWord(m_SP[1]), unsigned(m_SP[0])) : 0;
         }
         NEXT
 
@@ -767,7 +815,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) + u512(m_SP[1])) % m_SP[2]) : 0;
+            arith::fromWord(arith::addmod(arith::toWord(m_SP[0]), arith::toWord(m_SP[1]), arith::toWord(m_SP[2])), m_SPP[0]);
         }
         NEXT
 
@@ -776,7 +824,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) * u512(m_SP[1])) % m_SP[2]) : 0;
+            arith::fromWord(arith::mulmod(arith::toWord(m_SP[0]), arith::toWord(m_SP[1]), arith::toWord(m_SP[2])), m_SPP[0]);
         }
         NEXT
 
@@ -804,7 +852,8 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_PC = decodeJumpDest(m_code.data(), m_PC);
+            m_PC = decodeJumpDest(m_code, m_PC);
+            m_blockLength = 0;
         }
         CONTINUE
 
@@ -814,7 +863,10 @@ void VM::interpretCases()
             updateIOGas();
 
             if (m_SP[0])
-                m_PC = decodeJumpDest(m_code.data(), m_PC);
+            {
+                m_PC = decodeJumpDest(m_code, m_PC);
+                m_blockLength = 0;
+            }
             else
                 ++m_PC;
         }
@@ -824,7 +876,8 @@ void VM::interpretCases()
         {
             ON_OP();
             updateIOGas();
-            m_PC = decodeJumpvDest(m_code.data(), m_PC, byte(m_SP[0]));
+            m_PC = decodeJumpvDest(m_code, m_PC, byte(m_SP[0]));
+            m_blockLength = 0;
         }
         CONTINUE
 
@@ -833,7 +886,8 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
             *m_RP++ = m_PC++;
-            m_PC = decodeJumpDest(m_code.data(), m_PC);
+            m_PC = decodeJumpDest(m_code, m_PC);
+            m_blockLength = 0;
         }
         CONTINUE
 
@@ -842,7 +896,8 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
             *m_RP++ = m_PC;
-            m_PC = decodeJumpvDest(m_code.data(), m_PC, byte(m_SP[0]));
+            m_PC = decodeJumpvDest(m_code, m_PC, byte(m_SP[0]));
+            m_blockLength = 0;
         }
         CONTINUE
 
@@ -852,6 +907,7 @@ void VM::interpretCases()
             updateIOGas();
 
             m_PC = *m_RP--;
+            m_blockLength = 0;
         }
         NEXT
 
@@ -1316,11 +1372,12 @@ void VM::interpretCases()
             else if (m_SP[0] >= dataSize)
                 m_SP[0] = u256(0);
             else
-            {     h256 r;
-                for (uint64_t i = (uint64_t)m_SP[0], e = (uint64_t)m_SP[0] + (uint64_t)32, j = 0; i < e; ++i, ++j)
-                    r[j] = i < dataSize ? data[i] : 0;
+            {
+                h256 r;
+                size_t const offset = (size_t)m_SP[0];
+                simd::copyZeroExtend(r.data(), h256::size, data + offset, dataSize - offset);
                 m_SP[0] = (u256)r;
-            };
+            }
         }
         NEXT
 
@@ -1427,7 +1484,7 @@ void VM::interpretCases()
             size_t numCopied = m_context->fn_table->copy_code(
                 m_context, &address, codeOffset, &m_mem[memoryOffset], size);
 
-            std::fill_n(&m_mem[memoryOffset + numCopied], size - numCopied, 0);
+            simd::copyZeroExtend(&m_mem[memoryOffset + numCopied], size - numCopied, nullptr, 0);
         }
         NEXT
 
@@ -1596,6 +1653,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
             m_PC = verifyJumpDest(m_SP[0]);
+            m_blockLength = 0;
         }
         CONTINUE
 
@@ -1604,7 +1662,10 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
             if (m_SP[1])
+            {
                 m_PC = verifyJumpDest(m_SP[0]);
+                m_blockLength = 0;
+            }
             else
                 ++m_PC;
         }
@@ -1617,6 +1678,7 @@ void VM::interpretCases()
             updateIOGas();
 
             m_PC = uint64_t(m_SP[0]);
+            m_blockLength = 0;
 #else
             throwBadInstruction();
 #endif
@@ -1630,7 +1692,10 @@ void VM::interpretCases()
             updateIOGas();
 
             if (m_SP[1])
+            {
                 m_PC = uint64_t(m_SP[0]);
+                m_blockLength = 0;
+            }
             else
                 ++m_PC;
 #else
@@ -17,9 +17,14 @@
 
 #pragma once
 
+#include "Arith256.h"
+#include "CodeCache.h"
 #include "Instruction.h"
 #include "VMConfig.h"
 #include "VMFace.h"
+#include "VMProfiler.h"
+
+#include <libdevcore/SIMD.h>
 
 #include <evmc/evmc.h>
 
@@ -79,6 +84,10 @@ public:
         return stack;
     };
 
+    /// Check gas and stack once per basic block rather than per instruction. Off unless
+    /// turned on with the "metering=block" option.
+    void setBlockMetering(bool _enabled) { m_blockMetering = _enabled; }
+
     uint64_t m_io_gas = 0;
 private:
     evmc_context* m_context = nullptr;
@@ -88,11 +97,10 @@ private:
 
     static std::array<InstructionMetric, 256> c_metrics;
     static void initMetrics();
-    static u256 exp256(u256 _base, u256 _exponent);
-    void copyCode(int);
     typedef void (VM::*MemFnPtr)();
     MemFnPtr m_bounce = nullptr;
     uint64_t m_nSteps = 0;
+    ProfileScope* m_profile = nullptr;  // set while the profiler watches this frame
 
     // return bytes
     owning_bytes_ref m_output;
@@ -102,8 +110,9 @@ private:
 
     uint8_t const* m_pCode = nullptr;
     size_t m_codeSize = 0;
-    // space for code
-    bytes m_code;
+    // analysed code, shared with other frames through the CodeCache
+    std::shared_ptr<AnalysedCode const> m_analysis;
+    byte const* m_code = nullptr;
 
     /// RETURNDATA buffer for memory returned from direct subcalls.
     bytes m_returnData;
@@ -122,7 +131,7 @@ private:
 #endif
 
     // constant pool
-    std::vector<u256> m_pool;
+    u256 const* m_pool = nullptr;
 
     // interpreter state
     Instruction m_OP;         // current operation
@@ -138,6 +147,13 @@ private:
     uint64_t m_newMemSize = 0;
     uint64_t m_copyMemSize = 0;
 
+    // basic block being run, its gas and stack bounds already checked; every taken jump
+    // clears it, so jumping back into the block enters it and pays for it again
+    bool m_blockMetering = false;
+    uint64_t m_blockBegin = 0;
+    uint64_t m_blockLength = 0;
+    bool enterBlock();
+
     // initialize interpreter
     void initEntry();
     void optimize();
@@ -163,11 +179,13 @@ private:
     void throwDisallowedStateChange();
     void throwBufferOverrun(bigint const& _enfOfAccess);
 
-    std::vector<uint64_t> m_beginSubs;
-    std::vector<uint64_t> m_jumpDests;
     int64_t verifyJumpDest(u256 const& _dest, bool _throw = true);
 
-    void onOperation() {}
+    void onOperation()
+    {
+        if (m_profile)
+            m_profile->onOp(m_OP);
+    }
     void adjustStack(unsigned _removed, unsigned _added);
     uint64_t gasForMem(u512 _size);
     void updateSSGas();
@@ -205,6 +223,7 @@ private:
     //
 #if EIP_616
 
+    void xop(simd::LaneOp _op, uint8_t _type);
     void xadd    (uint8_t);
     void xmul    (uint8_t);
     void xsub    (uint8_t);
@@ -30,10 +30,11 @@ void VM::copyDataToMemory(bytesConstRef _data, u256*_sp)
 
     size_t sizeToBeCopied = bigIndex + size > _data.size() ? _data.size() < bigIndex ? 0 : _data.size() - index : size;
 
-    if (sizeToBeCopied > 0)
-        std::memcpy(m_mem.data() + offset, _data.data() + index, sizeToBeCopied);
-    if (size > sizeToBeCopied)
-        std::memset(m_mem.data() + offset + sizeToBeCopied, 0, size - sizeToBeCopied);
+    // offset is meaningless when nothing is copied, as memNeed() charged nothing for it
+    if (!size)
+        return;
+    uint8_t const* src = sizeToBeCopied ? _data.data() + index : nullptr;
+    simd::copyZeroExtend(m_mem.data() + offset, size, src, sizeToBeCopied);
 }
 
 
@@ -75,6 +76,8 @@ void VM::throwRevertInstruction(owning_bytes_ref&& _output)
 {
     // We can't use BOOST_THROW_EXCEPTION here because it makes a copy of exception inside and
     // RevertInstruction has no copy constructor
+    if (m_profile)
+        m_profile->finish(m_io_gas);
     throw RevertInstruction(std::move(_output));
 }
 
@@ -85,15 +88,9 @@ void VM::throwBufferOverrun(bigint const& _endOfAccess)
 
 int64_t VM::verifyJumpDest(u256 const& _dest, bool _throw)
 {
-    // check for overflow
-    if (_dest <= 0x7FFFFFFFFFFFFFFF) {
-
-        // check for within bounds and to a jump destination
-        // use binary search of array because hashtable collisions are exploitable
-        uint64_t pc = uint64_t(_dest);
-        if (std::binary_search(m_jumpDests.begin(), m_jumpDests.end(), pc))
-            return pc;
-    }
+    // check for overflow, within bounds and to a jump destination
+    if (m_analysis->isJumpDest(_dest))
+        return uint64_t(_dest);
     if (_throw)
         throwBadJumpDestination();
     return -1;
@@ -16,8 +16,10 @@
 */
 
 #include "VMFactory.h"
+#include "CodeCache.h"
 #include "EVMC.h"
 #include "LegacyVM.h"
+#include "VMProfiler.h"
 #include "interpreter.h"
 
 #if ETH_EVMJIT
@@ -149,6 +151,16 @@ po::options_description vmProgramOptions(unsigned _lineLength)
             ->notifier(parseEvmcOptions),
         "EVM-C option");
 
+    add("vm-code-cache",
+        po::value<size_t>()
+            ->value_name("<MB>")
+            ->default_value(32)
+            ->notifier([](size_t _mb) { CodeCache::get().setCapacity(_mb * 1024 * 1024); }),
+        "Size of the cache of analysed contract code used by the interpreters (0 disables it).");
+    add("vm-profile",
+        po::bool_switch()->notifier([](bool _on) { VMProfiler::get().setEnabled(_on); }),
+        "Count opcodes and per-contract gas in the interpreters from startup (see debug_evmProfile).");
+
     return opts;
 }
 
@@ -0,0 +1,210 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VMProfiler.h"
+
+#include <chrono>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define DEV_PROFILE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DEV_PROFILE_TSC 1
+#else
+#define DEV_PROFILE_TSC 0
+#endif
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+/// The innermost profiled frame running on this thread.
+thread_local ProfileScope* t_current = nullptr;
+}
+
+char const* opcodeClass(Instruction _op)
+{
+    uint8_t const op = static_cast<uint8_t>(_op);
+    switch (_op)
+    {
+    case Instruction::POP: return "stack";
+    case Instruction::MLOAD:
+    case Instruction::MSTORE:
+    case Instruction::MSTORE8:
+    case Instruction::MSIZE: return "memory";
+    case Instruction::SLOAD:
+    case Instruction::SSTORE: return "storage";
+    case Instruction::JUMP:
+    case Instruction::JUMPI:
+    case Instruction::PC:
+    case Instruction::GAS:
+    case Instruction::JUMPDEST:
+    case Instruction::JUMPC:
+    case Instruction::JUMPCI: return "flow";
+    case Instruction::PUSHC: return "push";
+    default: break;
+    }
+    if (op < 0x10)
+        return "arithmetic";
+    if (op < 0x20)
+        return "comparison";
+    if (op < 0x30)
+        return "sha3";
+    if (op < 0x40)
+        return "environment";
+    if (op < 0x50)
+        return "block";
+    if (op >= 0x60 && op < 0x80)
+        return "push";
+    if (op >= 0x80 && op < 0x90)
+        return "dup";
+    if (op >= 0x90 && op < 0xa0)
+        return "swap";
+    if (op >= 0xa0 && op < 0xb0)
+        return "log";
+    if (op >= 0xf0)
+        return "system";
+    return "other";
+}
+
+char const* profileTickUnit()
+{
+    return DEV_PROFILE_TSC ? "cycles" : "ns";
+}
+
+uint64_t profileTicks()
+{
+#if DEV_PROFILE_TSC
+    return __rdtsc() | 1;
+#else
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count() | 1;
+#endif
+}
+
+VMProfiler& VMProfiler::get()
+{
+    static VMProfiler s_profiler;
+    return s_profiler;
+}
+
+void VMProfiler::reset()
+{
+    Guard l(x_profile);
+    m_ops = {};
+    m_contracts.clear();
+}
+
+ProfileSnapshot VMProfiler::snapshot() const
+{
+    ProfileSnapshot ret;
+    ret.enabled = enabled();
+    ret.sampleInterval = sampleInterval();
+    Guard l(x_profile);
+    ret.ops = m_ops;
+    ret.contracts = m_contracts;
+    return ret;
+}
+
+ProfileSnapshot VMProfiler::snapshotAndReset()
+{
+    ProfileSnapshot ret;
+    ret.enabled = enabled();
+    ret.sampleInterval = sampleInterval();
+    Guard l(x_profile);
+    ret.ops = m_ops;
+    m_ops = {};
+    ret.contracts.swap(m_contracts);
+    return ret;
+}
+
+void VMProfiler::merge(Address const& _contract, Frame const& _frame, unsigned _interval, uint64_t _gas, uint64_t _selfGas)
+{
+    uint64_t instructions = 0;
+    uint64_t ticks = 0;
+    for (auto count: _frame.counts)
+        instructions += count;
+    for (auto t: _frame.ticks)
+        ticks += t;
+
+    Guard l(x_profile);
+    for (unsigned i = 0; i < 256; ++i)
+    {
+        m_ops[i].count += _frame.counts[i];
+        m_ops[i].samples += _frame.samples[i];
+        m_ops[i].ticks += _frame.ticks[i];
+    }
+    ContractProfile& contract = m_contracts[_contract];
+    ++contract.calls;
+    contract.gas += _gas;
+    contract.selfGas += _selfGas;
+    contract.instructions += instructions;
+    contract.sloads += _frame.counts[static_cast<uint8_t>(Instruction::SLOAD)];
+    contract.sstores += _frame.counts[static_cast<uint8_t>(Instruction::SSTORE)];
+    // the interval may have changed since the frame started; scale by the one it sampled with
+    contract.estimatedTicks += ticks * _interval;
+}
+
+ProfileScope::ProfileScope(Address const& _contract, uint64_t _gas)
+{
+    VMProfiler const& profiler = VMProfiler::get();
+    if (!profiler.enabled())
+        return;
+
+    m_frame.reset(new VMProfiler::Frame);
+    m_contract = _contract;
+    m_gas = _gas;
+    m_interval = profiler.sampleInterval();
+    m_countdown = m_interval;
+
+    // the caller's timed instruction is the call itself; don't charge it with this frame
+    m_parent = t_current;
+    if (m_parent)
+        m_parent->pauseSample();
+    t_current = this;
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (!m_frame)
+        return;
+    if (m_sampleStart)
+        closeSample();
+
+    uint64_t const used = m_gas > m_gasLeft ? m_gas - m_gasLeft : 0;
+    VMProfiler::get().merge(m_contract, *m_frame, m_interval, used, used > m_childGas ? used - m_childGas : 0);
+
+    t_current = m_parent;
+    if (m_parent)
+        m_parent->m_childGas += used;
+}
+
+void ProfileScope::closeSample()
+{
+    // a thread moved to a core with a counter behind the last one reads a tick in the past
+    uint64_t const now = profileTicks();
+    ++m_frame->samples[m_sampleOp];
+    if (now > m_sampleStart)
+        m_frame->ticks[m_sampleOp] += now - m_sampleStart;
+    m_sampleStart = 0;
+}
+
+}
+}
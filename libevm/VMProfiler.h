@@ -0,0 +1,170 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file VMProfiler.h
+ * Opcode and per-contract counters gathered by the interpreters while they run.
+ */
+
+#pragma once
+
+#include "Instruction.h"
+
+#include <libdevcore/Address.h>
+#include <libdevcore/Guards.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+namespace dev
+{
+namespace eth
+{
+/// Counts for one opcode. Only one instruction in every sample interval is timed, so
+/// ticks / samples estimates the cost of one execution.
+struct OpProfile
+{
+    uint64_t count = 0;
+    uint64_t samples = 0;
+    uint64_t ticks = 0;
+};
+
+/// Counts for one contract, by the address its code ran as.
+struct ContractProfile
+{
+    uint64_t calls = 0;
+    uint64_t gas = 0;           ///< Gas used by its frames, including the frames they called.
+    uint64_t selfGas = 0;       ///< Gas used by its frames, less that of the interpreted frames they called.
+    uint64_t instructions = 0;
+    uint64_t sloads = 0;
+    uint64_t sstores = 0;
+    uint64_t estimatedTicks = 0;  ///< Ticks of its timed instructions, each scaled by its frame's sample interval.
+};
+
+struct ProfileSnapshot
+{
+    bool enabled = false;
+    unsigned sampleInterval = 0;
+    std::array<OpProfile, 256> ops;
+    std::unordered_map<Address, ContractProfile> contracts;
+};
+
+/// @returns the group @a _op is listed under in the Yellow Paper, e.g. "arithmetic" or "storage".
+char const* opcodeClass(Instruction _op);
+
+/// @returns the unit of the tick counts: "cycles" where the time stamp counter is read, else "ns".
+char const* profileTickUnit();
+
+/// @returns the current tick, never 0.
+uint64_t profileTicks();
+
+/**
+ * @brief Aggregates the counters of every profiled call frame. Switched off by default, so the
+ * interpreters pay one untaken branch per instruction until it is enabled.
+ * @threadsafe
+ */
+class VMProfiler
+{
+public:
+    static VMProfiler& get();
+
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    /// Frames already running when this is called keep the state they started with.
+    void setEnabled(bool _enabled) { m_enabled.store(_enabled, std::memory_order_relaxed); }
+
+    /// Times one in every @a _interval instructions; 0 only counts. 64 unless changed.
+    void setSampleInterval(unsigned _interval) { m_sampleInterval.store(_interval, std::memory_order_relaxed); }
+    unsigned sampleInterval() const { return m_sampleInterval.load(std::memory_order_relaxed); }
+
+    void reset();
+    ProfileSnapshot snapshot() const;
+    /// Like snapshot() followed by reset(), but no frame merged in between is lost.
+    ProfileSnapshot snapshotAndReset();
+
+private:
+    friend class ProfileScope;
+    struct Frame;
+    void merge(Address const& _contract, Frame const& _frame, unsigned _interval, uint64_t _gas, uint64_t _selfGas);
+
+    std::atomic<bool> m_enabled{false};
+    std::atomic<unsigned> m_sampleInterval{64};
+
+    mutable Mutex x_profile;
+    std::array<OpProfile, 256> m_ops;
+    std::unordered_map<Address, ContractProfile> m_contracts;
+};
+
+/**
+ * @brief Profiles one call frame of an interpreter for as long as it lives. Does nothing if the
+ * profiler was off when it was made; the interpreter then leaves its op hook unset.
+ */
+class ProfileScope
+{
+public:
+    ProfileScope(Address const& _contract, uint64_t _gas);
+    ~ProfileScope();
+    ProfileScope(ProfileScope const&) = delete;
+    ProfileScope& operator=(ProfileScope const&) = delete;
+
+    bool active() const { return !!m_frame; }
+
+    /// Called as each instruction starts.
+    void onOp(Instruction _op);
+
+    /// Records the gas left when the frame halts normally or reverts. A frame destroyed without
+    /// it failed exceptionally and is counted as having used all of its gas.
+    void finish(uint64_t _gasLeft) { m_gasLeft = _gasLeft; }
+
+private:
+    void closeSample();
+    void pauseSample() { m_sampleStart = 0; }
+
+    std::unique_ptr<VMProfiler::Frame> m_frame;
+    Address m_contract;
+    ProfileScope* m_parent = nullptr;
+    uint64_t m_gas = 0;
+    uint64_t m_gasLeft = 0;
+    uint64_t m_childGas = 0;
+    unsigned m_interval = 0;
+    unsigned m_countdown = 0;
+    uint8_t m_sampleOp = 0;
+    uint64_t m_sampleStart = 0;  ///< Tick the timed instruction started at, 0 if none is.
+};
+
+struct VMProfiler::Frame
+{
+    std::array<uint64_t, 256> counts{};
+    std::array<uint64_t, 256> samples{};
+    std::array<uint64_t, 256> ticks{};
+};
+
+inline void ProfileScope::onOp(Instruction _op)
+{
+    uint8_t const op = static_cast<uint8_t>(_op);
+    ++m_frame->counts[op];
+    if (m_sampleStart)
+        closeSample();
+    if (m_interval && !--m_countdown)
+    {
+        m_countdown = m_interval;
+        m_sampleOp = op;
+        m_sampleStart = profileTicks();
+    }
+}
+
+}
+}
@@ -44,74 +44,43 @@ inline a8x32  const& v8x32 (u256 const& _stackItem) { return (a8x32&) *(a8x32*)
 
 enum { Bits8, Bits16, Bits32, Bits64 };
 
-// tried using template template functions, gave up fighting the compiler after a day
-#define EVALXOPS(OP, _type) EVALXOP(OP, int8_t, int16_t, int32_t, int64_t, _type)
-#define EVALXOPU(OP, _type) EVALXOP(OP, uint8_t, uint16_t, uint32_t, uint64_t, _type)
-#define EVALXOP(OP, T8, T16, T32, T64, _type) \
-{ \
-    uint8_t const t = (_type) & 0xf; \
-    m_SPP[0] = 0; \
-    switch (t) \
-    { \
-    case Bits8: \
-        for (int i = 0; i < 32; ++i) \
-            v8x32(m_SPP[0])[i]  = (uint8_t) OP((T8) v8x32(m_SP[0])[i],  (T8) v8x32(m_SP[1])[i]); \
-        break; \
-    case Bits16: \
-        for (int i = 0; i < 16; ++i) \
-            v16x16(m_SPP[0])[i] = (uint16_t)OP((T16)v16x16(m_SP[0])[i], (T16)v16x16(m_SP[1])[i]); \
-        break; \
-    case Bits32: \
-        for (int i = 0; i < 8; ++i) \
-            v32x8(m_SPP[0])[i]  = (uint32_t)OP((T32)v32x8(m_SP[0])[i],  (T32)v32x8(m_SP[1])[i]); \
-        break; \
-    case Bits64: \
-        for (int i = 0; i < 4; ++i) \
-            v64x4(m_SPP[0])[i]  = (uint64_t)OP((T64)v64x4(m_SP[0])[i],  (T64)v64x4(m_SP[1])[i]); \
-        break; \
-    default: throwBadInstruction(); \
-    } \
+// The lane-wise ops all go through the kernels in libdevcore/SIMD.h, which pick the widest
+// vector unit the CPU has at runtime. The low nibble of the type selects the lane width.
+void VM::xop(simd::LaneOp _op, uint8_t _type)
+{
+    uint8_t const width = _type & 0xf;
+    if (width >= simd::LaneWidthCount)
+        throwBadInstruction();
+    // read both operands before writing, m_SPP[0] may be the same slot as m_SP[1]
+    Word256 const a = arith::toWord(m_SP[0]);
+    Word256 const b = arith::toWord(m_SP[1]);
+    Word256 r;
+    simd::laneKernel(_op, simd::LaneWidth(width))(r.limbs, a.limbs, b.limbs);
+    arith::fromWord(r, m_SPP[0]);
 }
-#define ADD( x1, x2) ((x1) + (x2))
-#define MUL( x1, x2) ((x1) * (x2))
-#define SUB( x1, x2) ((x1) - (x2))
-#define DIV( x1, x2) ((x1) / (x2))
-#define MOD( x1, x2) ((x1) % (x2))
-#define LT(  x1, x2) ((x1) < (x2))
-#define GT(  x1, x2) ((x1) > (x2))
-#define EQ(  x1, x2) ((x1) == (x2))
-#define ZERO(x1, x2) ((x1) == 0)
-#define AND( x1, x2) ((x1) & (x2))
-#define OR(  x1, x2) ((x1) | (x2))
-#define XOR( x1, x2) ((x1) ^ (x2))
-#define NOT( x1, x2) (~(x1))
-#define SHR( x1, x2) ((x1) >> (x2))
-#define SHL( x1, x2) ((x1) << (x2))
-#define ROL( x1, x2) (((x1) << (x2))|((x1) >> (sizeof(x1) * 8 - (x2))))
-#define ROR( x1, x2) (((x1) >> (x2))|((x1) << (sizeof(x1) * 8 - (x2))))
-
-void VM::xadd (uint8_t _type) { EVALXOPU(ADD, _type); }
-void VM::xmul (uint8_t _type) { EVALXOPU(MUL, _type); }
-void VM::xsub (uint8_t _type) { EVALXOPU(SUB, _type); }
-void VM::xdiv (uint8_t _type) { EVALXOPU(DIV, _type); }
-void VM::xsdiv(uint8_t _type) { EVALXOPS(DIV, _type); }
-void VM::xmod (uint8_t _type) { EVALXOPU(MOD, _type); }
-void VM::xsmod(uint8_t _type) { EVALXOPS(MOD, _type); }
-void VM::xlt  (uint8_t _type) { EVALXOPU(LT,  _type); }
-void VM::xslt (uint8_t _type) { EVALXOPS(LT,  _type); }
-void VM::xgt  (uint8_t _type) { EVALXOPU(GT,  _type); }
-void VM::xsgt (uint8_t _type) { EVALXOPS(GT,  _type); }
-void VM::xeq  (uint8_t _type) { EVALXOPU(EQ,  _type); }
-void VM::xzero(uint8_t _type) { EVALXOPU(ZERO,_type); }
-void VM::xand (uint8_t _type) { EVALXOPU(AND, _type); }
-void VM::xoor (uint8_t _type) { EVALXOPU(OR,  _type); }
-void VM::xxor (uint8_t _type) { EVALXOPU(XOR, _type); }
-void VM::xnot (uint8_t _type) { EVALXOPU(NOT, _type); }
-void VM::xshr (uint8_t _type) { EVALXOPU(SHR, _type); }
-void VM::xsar (uint8_t _type) { EVALXOPS(SHR, _type); }
-void VM::xshl (uint8_t _type) { EVALXOPU(SHL, _type); }
-void VM::xrol (uint8_t _type) { EVALXOPU(ROL, _type); }
-void VM::xror (uint8_t _type) { EVALXOPU(ROR, _type); }
+
+void VM::xadd (uint8_t _type) { xop(simd::LaneOp::Add,  _type); }
+void VM::xmul (uint8_t _type) { xop(simd::LaneOp::Mul,  _type); }
+void VM::xsub (uint8_t _type) { xop(simd::LaneOp::Sub,  _type); }
+void VM::xdiv (uint8_t _type) { xop(simd::LaneOp::Div,  _type); }
+void VM::xsdiv(uint8_t _type) { xop(simd::LaneOp::SDiv, _type); }
+void VM::xmod (uint8_t _type) { xop(simd::LaneOp::Mod,  _type); }
+void VM::xsmod(uint8_t _type) { xop(simd::LaneOp::SMod, _type); }
+void VM::xlt  (uint8_t _type) { xop(simd::LaneOp::Lt,   _type); }
+void VM::xslt (uint8_t _type) { xop(simd::LaneOp::SLt,  _type); }
+void VM::xgt  (uint8_t _type) { xop(simd::LaneOp::Gt,   _type); }
+void VM::xsgt (uint8_t _type) { xop(simd::LaneOp::SGt,  _type); }
+void VM::xeq  (uint8_t _type) { xop(simd::LaneOp::Eq,   _type); }
+void VM::xzero(uint8_t _type) { xop(simd::LaneOp::Zero, _type); }
+void VM::xand (uint8_t _type) { xop(simd::LaneOp::And,  _type); }
+void VM::xoor (uint8_t _type) { xop(simd::LaneOp::Or,   _type); }
+void VM::xxor (uint8_t _type) { xop(simd::LaneOp::Xor,  _type); }
+void VM::xnot (uint8_t _type) { xop(simd::LaneOp::Not,  _type); }
+void VM::xshr (uint8_t _type) { xop(simd::LaneOp::Shr,  _type); }
+void VM::xsar (uint8_t _type) { xop(simd::LaneOp::Sar,  _type); }
+void VM::xshl (uint8_t _type) { xop(simd::LaneOp::Shl,  _type); }
+void VM::xrol (uint8_t _type) { xop(simd::LaneOp::Rol,  _type); }
+void VM::xror (uint8_t _type) { xop(simd::LaneOp::Ror,  _type); }
 
 // SIMD type encodes log base 2 of lane width and count - one in each nibble
 //
@@ -4,16 +4,12 @@
 
 #include "Common.h"
 #include "Qpos.h"
+#include "QposSignVerifier.h"
 
-#include <sys/syscall.h>  
 #include <json/json.h>
 
-#define gettidv1() syscall(__NR_gettid)  
-#define gettidv2() syscall(SYS_gettid) 
-
-#define QPOS_SIGNAL SIGUSR1
-#define QPOS_SIGNAL_REPORT SIGUSR2
-
+#define QPOS_TICK_INTERVAL (1*TIME_PER_SECOND)
+#define QPOS_MIN_TICK_WAIT (TIME_PER_SECOND/100)
 #define QPOS_VOTE_TIMEOUT (10*TIME_PER_SECOND)
 #define QPOS_HEART_TIMEOUT (2*TIME_PER_SECOND)
 
@@ -31,21 +27,94 @@ void Qpos::tick()
 	
 	int64_t now = utcTime();
 	if(qposInitial == m_consensusState){
-		bool have;
-		bytes blockBytes;
-		tie(have, blockBytes) = m_blocks.tryPop(0);
+		if(pipelined() && m_sealedNumber > m_blockReport && now > m_consensusTimeOut){
+			// Sealed blocks never made it into our chain, fall back to the imported head.
+			cdebug << "m_sealedNumber=" << m_sealedNumber << ",m_blockReport=" << m_blockReport;
+			m_sealedNumber = (int64_t)m_blockReport;
+			m_blockNumber = m_sealedNumber;
+			resetConfig();
+			// Drops what the client built on top of them.
+			if(m_onSealGenerated)
+				m_onSealGenerated(bytes(), true);
+		}
 
-		if(have && !blockBytes.empty())
-			generateSealBegin(blockBytes);
+		proposeNext();
 	}else{
 		if(now > m_consensusTimeOut){
-			cdebug << "m_idUnVoted.size()=" << m_idUnVoted.size() << ",m_idVoted.size()=" << m_idVoted.size() << ",nodeCount()=" << nodeCount();
+			cdebug << "m_blockNumber=" << m_blockNumber << ",m_rounds.size()=" << m_rounds.size() << ",nodeCount()=" << nodeCount();
 
 			resetConfig();
 		}
 	}
 }
 
+void Qpos::post(std::function<void()> const& _f)
+{
+	if(m_strand)
+		m_strand->post(_f);
+}
+
+void Qpos::scheduleTick()
+{
+	// Wake up at the nearest consensus deadline instead of polling once a second. Deadlines
+	// already past were handled by the tick just run, or wait on something else happening.
+	int64_t now = utcTime();
+	int64_t next = now + QPOS_TICK_INTERVAL;
+	auto consider = [&](int64_t _deadline) {
+		if(_deadline > now && _deadline < next)
+			next = _deadline;
+	};
+	consider(m_voteTimeOut);
+	if(qposInitial != m_consensusState || (pipelined() && m_sealedNumber > m_blockReport))
+		consider(m_consensusTimeOut);
+	// Ticks act once a deadline has passed, not when it is reached.
+	int64_t wait = max<int64_t>(next - now + 1, QPOS_MIN_TICK_WAIT);
+
+	std::shared_ptr<std::atomic<bool>> ticking = m_ticking;
+	m_tickTimer->expires_from_now(boost::posix_time::microseconds(wait));
+	m_tickTimer->async_wait(m_strand->wrap([=](boost::system::error_code const& _e) {
+		// The flag outlives us, so it is checked first.
+		if(_e == boost::asio::error::operation_aborted || !*ticking)
+			return;
+
+		this->tick();
+		this->scheduleTick();
+	}));
+}
+
+void Qpos::stopTicking()
+{
+	if(!m_tickTimer || !*m_ticking)
+		return;
+
+	// Once the cancellation has run on the strand no tick is running or will run again. The
+	// io_service may already be stopped and never run it, so the wait for it is bounded; the
+	// cleared flag alone then keeps the handlers left queued from touching us.
+	*m_ticking = false;
+	auto cancelled = std::make_shared<std::promise<void>>();
+	std::future<void> done = cancelled->get_future();
+	std::shared_ptr<deadline_timer> timer = m_tickTimer;
+	post([=]() {
+		timer->cancel();
+		cancelled->set_value();
+	});
+	if(done.wait_for(std::chrono::seconds(1)) != std::future_status::ready)
+		cwarn << "Qpos tick timer not cancelled within a second; leaving it to the strand.";
+}
+
+void Qpos::proposeNext()
+{
+	if(!mayPropose())
+		return;
+
+	bool have;
+	bytes blockBytes;
+	tie(have, blockBytes) = m_blocks.tryPop(0);
+
+	if(have && !blockBytes.empty())
+		generateSealBegin(blockBytes);
+}
+
 bool Qpos::interpret(QposPeer* _p, unsigned _id, RLP const& _r)
 {
 	unsigned msgType;
@@ -97,7 +166,7 @@ void Qpos::reportBlock(unsigned _blockNumber, bool _force)
 {
 	if(_blockNumber > m_blockReport || _force){
 		m_blockReport = _blockNumber;
-		kill(m_hostTid, QPOS_SIGNAL_REPORT);
+		post([=]() { this->reportBlockSelf(); });
 	}
 
 	cdebug << "_blockNumber=" << _blockNumber << ",m_blockNumber=" << m_blockNumber << ",_force=" << _force;
@@ -107,7 +176,12 @@ void Qpos::reportBlockSelf()
 {
 	unsigned long long blockNumber = m_blockReport;
 
-	cdebug << "blockNumber=" << blockNumber << ",m_blockNumber=" << m_blockNumber;
+	cdebug << "blockNumber=" << blockNumber << ",m_blockNumber=" << m_blockNumber << ",m_sealedNumber=" << m_sealedNumber;
+
+	// In pipelined mode the next block may already be voted on top of blocks that are still importing.
+	bool inFlight = pipelined() && qposWaitingVote == m_consensusState && m_blockNumber + 1 > (int64_t)blockNumber;
+	if(pipelined())
+		blockNumber = max<unsigned long long>(blockNumber, m_sealedNumber);
 
 	m_blockNumber = blockNumber;
 	m_blockNumberRecv = blockNumber;
@@ -130,16 +204,36 @@ void Qpos::reportBlockSelf()
 		m_isLeader = false;
 	}
 
+	if(inFlight){
+		pruneRounds(m_blockReport);
+		return;
+	}
+
 	resetConfig();
+	// The import may have made room in the pipeline for a block already queued.
+	if(pipelined() && m_isLeader)
+		proposeNext();
+}
+
+void Qpos::pruneRounds(int64_t _imported)
+{
+	for(auto it = m_rounds.begin(); it != m_rounds.end() && it->first <= _imported;)
+		it = m_rounds.erase(it);
 }
 
 void Qpos::resetConfig()
 {
-	m_blockBytes = bytes();
+	// Sealed rounds above the imported head are kept: the next proposal links to them.
+	pruneRounds(m_blockReport);
+	for(auto it = m_rounds.begin(); it != m_rounds.end();){
+		if(it->second.sealed)
+			++it;
+		else
+			it = m_rounds.erase(it);
+	}
+
 	//m_currentView = 0;
 	m_consensusTimeOut = 0;
-	m_idVoted.clear();
-	m_idUnVoted.clear();
 	m_last_consensus_time = utcTime();
 	m_consensusState = qposInitial;
 
@@ -147,39 +241,25 @@ void Qpos::resetConfig()
 	cdebug << ",id()=" << id() << ",m_currentView=" << (unsigned)m_currentView << ",m_miners.size()=" << m_miners.size() << ",m_isLeader=" << m_isLeader;
 }
 
-void Qpos::signalHandler(const boost::system::error_code& err, int signal)
-{
-	cdebug << "_host.onTick err = " << err << ",signal = " << signal << ",m_hostTid=" << m_hostTid;
-
-	if(QPOS_SIGNAL == signal){
-		tick();
-	}else if(QPOS_SIGNAL_REPORT == signal){
-		reportBlockSelf();
-	}
-	m_sigset->async_wait(boost::bind(&Qpos::signalHandler, this, _1, _2));
-}
-
 void Qpos::initEnv(class Client *_c, p2p::Host *_host, BlockChain* _bc, bool _importAnyNode)
 {
 	m_importAnyNode = _importAnyNode;
-	m_sigset = new signal_set(_host->ioService(), QPOS_SIGNAL, QPOS_SIGNAL_REPORT);
-	m_sigset->async_wait(boost::bind(&Qpos::signalHandler, this, _1, _2));
+	stopTicking();
+	m_ticking = std::make_shared<std::atomic<bool>>(true);
+	// Peer messages are interpreted on the host's network thread, which is also the only thread
+	// running its io_service, so handlers on this strand never race with them.
+	m_strand.reset(new io_service::strand(_host->ioService()));
+	m_tickTimer = std::make_shared<deadline_timer>(_host->ioService());
 
 	DumpStack();
 	
 	srand(utcTime());
 	QposSealEngine::initEnv(_c, _host, _bc, _importAnyNode);
 
-	_host->onTick(1000, [=](const boost::system::error_code& _e) {
-		(void)_e;
-		this->tick();
-	});
+	m_pipelineDepth = static_cast<unsigned>(chainParams().u256Param("qposPipelineDepth"));
+	cdebug << "m_pipelineDepth=" << m_pipelineDepth;
 
-	_host->onInit([=]() {
-		m_hostTid = gettidv1();
-
-		cdebug << "_host.onTick  m_hostTid =" << m_hostTid;
-	});
+	post([=]() { this->scheduleTick(); });
 
 	_c->onFilter([=](p2p::NodeID _nodeid, unsigned _id) -> bool{
 		if(m_importAnyNode || m_miners.empty())
@@ -212,19 +292,22 @@ bool Qpos::msgVerify(const NodeID &_nodeID, bytes const&  _msg, h520 const&  _ms
 {
 	BlockHeader header(_msg);
 	//h256 hash =  sha3(_msg);
-	h256 hash =  header.hash(WithoutSeal);
+	return msgVerify(_nodeID, header.hash(WithoutSeal), _msgSign);
+}
 
-	cdebug << "_nodeID=" << _nodeID << ",hash=" << hash << ",_msgSign=" << _msgSign;
-	return dev::verify(_nodeID, _msgSign, hash);
+bool Qpos::msgVerify(const NodeID &_nodeID, h256 const& _hash, h520 const&  _msgSign)
+{
+	cdebug << "_nodeID=" << _nodeID << ",hash=" << _hash << ",_msgSign=" << _msgSign;
+	return dev::verify(_nodeID, _msgSign, _hash);
 }
 
-bytes Qpos::authBytes()
+bytes Qpos::authBytes(QposRound const& _round)
 {
 	bytes ret;
 	RLPStream authListStream;
-	authListStream.appendList(m_idVoted.size()*2);
+	authListStream.appendList(_round.voted.size()*2);
 
-	for(auto it : m_idVoted){
+	for(auto it : _round.voted){
 		authListStream << it.first; 
 		authListStream << it.second; 
 	}
@@ -261,18 +344,32 @@ void Qpos::onBroadBlock(QposPeer* _p, RLP const& _r)
 		m_blockNumber = number;
 	}
 
+	if(pipelined() && number > m_sealedNumber){
+		QposRound& round = m_rounds[number];
+		round = QposRound();
+		round.hash = header.hash();
+		round.signHash = header.hash(WithoutSeal);
+		round.sealed = true;
+		m_sealedNumber = number;
+	}
+
 	m_onSealGenerated(blockBytes, false);
 }
 
-void Qpos::voteBlockEnd()
+void Qpos::voteBlockEnd(int64_t _number)
 {
-	if(nodeCount() && (int64_t)m_idUnVoted.size() >= (nodeCount()+1)/2){
-		cdebug << "Vote failed: m_idUnVoted.size()=" << m_idUnVoted.size() << ",m_idVoted.size()=" << m_idVoted.size() << ",nodeCount()=" << nodeCount();
+	auto found = m_rounds.find(_number);
+	if(found == m_rounds.end() || found->second.sealed)
+		return;
+
+	QposRound& round = found->second;
+	if(nodeCount() && (int64_t)round.unVoted.size() >= (nodeCount()+1)/2){
+		cdebug << "Vote failed: round.unVoted.size()=" << round.unVoted.size() << ",round.voted.size()=" << round.voted.size() << ",nodeCount()=" << nodeCount();
 
 		//broadBlock(bytes());
 		resetConfig();
-	}else if(0 == nodeCount() || (int64_t)m_idVoted.size() > nodeCount()/2){
-		cdebug << "Vote succed, m_blockBytes.size() = " << m_blockBytes.size();
+	}else if(0 == nodeCount() || (int64_t)round.voted.size() > nodeCount()/2){
+		cdebug << "Vote succed, round.blockBytes.size() = " << round.blockBytes.size() << ",_number=" << _number;
 
 		try{
 			if(m_onSealGenerated){
@@ -283,14 +380,14 @@ void Qpos::voteBlockEnd()
 				ret["owner"] = id().hex();
 				ret["sign"] = Json::Value(Json::objectValue);
 
-				for(auto it : m_idVoted){
+				for(auto it : round.voted){
 					ret["sign"][it.first.hex()] = it.second.hex();
 				}
 
 				
 
 				std::vector<std::pair<NodeID, Signature>> sig_list;
-				for(auto it : m_idVoted){
+				for(auto it : round.voted){
 					sig_list.push_back(it);
 				}
 
@@ -299,8 +396,8 @@ void Qpos::voteBlockEnd()
 				info.append(id()); 
 				info.appendVector(sig_list); // sign_list
 
-				BlockHeader header(m_blockBytes);
-				RLP r(m_blockBytes);
+				BlockHeader header(round.blockBytes);
+				RLP r(round.blockBytes);
 				RLPStream rs;
 				rs.appendList(4);
 				rs.appendRaw(r[0].data()); // header
@@ -317,7 +414,18 @@ void Qpos::voteBlockEnd()
 				
 				cdebug << "Vote_succed: idx.count blockBytes.size() = " << blockBytes.size() << ",header.number()=" << header.number() << ",header.hash()=" << header.hash(WithoutSeal);
 				
+				round.sealed = true;
+				round.blockBytes.clear();
 				broadBlock(blockBytes);
+
+				if(pipelined()){
+					// Do not wait for our own import of this block: the next height can be voted right away.
+					m_sealedNumber = _number;
+					m_blockNumber = _number;
+					m_consensusTimeOut = utcTime() + m_consensusTimeInterval;
+					m_consensusState = qposInitial;
+					proposeNext();
+				}
 			}
 		}catch(...){
 			cwarn << "m_consensusFinishedFunc run err";
@@ -336,20 +444,29 @@ void Qpos::onBlockVoteAck(QposPeer* _p, RLP const& _r)
 	int64_t currentView = _r[0][2].toInt();
 	Signature mySign = h520(_r[0][3].toBytes());
 	NodeID idrecv(_r[0][4].toBytes());
+	// Acks from peers without per-height rounds do not carry the block number.
+	int64_t number = _r[0].itemCount() > 5 ? _r[0][5].toInt<int64_t>() : m_blockNumber + 1;
+
+	auto found = m_rounds.find(number);
+	if(found == m_rounds.end() || found->second.sealed){
+		cdebug << "number=" << number << ",m_blockNumber=" << m_blockNumber;
+		return;
+	}
 
-	bool v = msgVerify(_p->id(), m_blockBytes, mySign);
-	cdebug << ",v=" << v << ",currentView=" << currentView << ",nodeCount()=" << nodeCount() << ",vote=" << vote << ",m_currentView=" << m_currentView << ",m_blockNumber=" << m_blockNumber << ",idrecv=" << idrecv << ",m_consensusState=" << static_cast<unsigned>(m_consensusState);
+	QposRound& round = found->second;
+	bool v = msgVerify(_p->id(), round.signHash, mySign);
+	cdebug << ",v=" << v << ",currentView=" << currentView << ",nodeCount()=" << nodeCount() << ",vote=" << vote << ",m_currentView=" << m_currentView << ",number=" << number << ",idrecv=" << idrecv << ",m_consensusState=" << static_cast<unsigned>(m_consensusState);
 	if(!v || currentView != m_currentView || qposFinished == m_consensusState)
 		return;
 	
 	if(vote){
-		m_idVoted[_p->id()] = mySign;
+		round.voted[_p->id()] = mySign;
 	}else{
-		m_idUnVoted.insert(_p->id());
+		round.unVoted.insert(_p->id());
 	}
 
-	cdebug << ",m_idUnVoted.size()=" << m_idUnVoted.size() << ",m_idVoted.size()=" << m_idVoted.size() << ",nodeCount()=" << nodeCount();
-	voteBlockEnd();
+	cdebug << ",round.unVoted.size()=" << round.unVoted.size() << ",round.voted.size()=" << round.voted.size() << ",nodeCount()=" << nodeCount();
+	voteBlockEnd(number);
 }
 
 void Qpos::onBlockVote(QposPeer* _p, RLP const& _r)
@@ -362,26 +479,33 @@ void Qpos::onBlockVote(QposPeer* _p, RLP const& _r)
 	bool vote = false;
 	int64_t now = utcTime();
 
-	bool verify = msgVerify(_p->id(), blockBytes, mySign);
+	h256 signHash = header.hash(WithoutSeal);
+	bool verify = msgVerify(_p->id(), signHash, mySign);
 	bool verifyblock = true;
 	//verifyblock = verifyBlock(blockBytes);
 
-	cdebug << "verify =" << verify << ",verifyblock=" << verifyblock << ",nodeCount()=" << nodeCount() << ",currentView=" << currentView << ",m_currentView=" << m_currentView << ",blockNumber=" << blockNumber << ",m_blockNumber=" << m_blockNumber;
-	if(verify && verifyblock && m_blockNumber + 1 == blockNumber && currentView == m_currentView){
+	// A pipelined proposal must build on the block we last saw sealed at the height below it.
+	auto parent = m_rounds.find(blockNumber - 1);
+	bool linked = parent == m_rounds.end() || !parent->second.sealed || parent->second.hash == header.parentHash();
+
+	cdebug << "verify =" << verify << ",verifyblock=" << verifyblock << ",linked=" << linked << ",nodeCount()=" << nodeCount() << ",currentView=" << currentView << ",m_currentView=" << m_currentView << ",blockNumber=" << blockNumber << ",m_blockNumber=" << m_blockNumber;
+	if(verify && verifyblock && linked && m_blockNumber + 1 == blockNumber && currentView == m_currentView){
 		vote = true;
-		m_idVoted.clear();
-		m_idUnVoted.clear();
 		m_consensusTimeOut = utcTime() + m_consensusTimeInterval;
-		m_blockBytes = blockBytes;
-		m_idVoted[_p->id()] = mySign;
-		cdebug << "m_currentView =" << m_currentView << ",m_blockBytes.size()=" << m_blockBytes.size();
+
+		QposRound& round = m_rounds[blockNumber];
+		round = QposRound();
+		round.hash = header.hash();
+		round.signHash = signHash;
+		round.voted[_p->id()] = mySign;
+		cdebug << "m_currentView =" << m_currentView << ",blockBytes.size()=" << blockBytes.size();
 	}
 	
 	h256 hash =  sha3(blockBytes);
-	mySign = sign(header.hash(WithoutSeal));
+	mySign = sign(signHash);
 
 	if(vote)
-		m_idVoted[id()] = mySign;
+		m_rounds[blockNumber].voted[id()] = mySign;
 	
 	RLPStream data;
 	data << qposBlockVoteAck;
@@ -389,6 +513,7 @@ void Qpos::onBlockVote(QposPeer* _p, RLP const& _r)
 	data << m_currentView; 
 	data << mySign; 
 	data << _p->id(); 
+	data << blockNumber;
 
 	m_voteTimeOut = now + QPOS_VOTE_TIMEOUT;
 
@@ -473,17 +598,17 @@ void Qpos::onVoteAck(QposPeer* _p, RLP const& _r)
 	}
 }
 
-void Qpos::voteBlockBegin()
+void Qpos::voteBlockBegin(int64_t _number)
 {
-	BlockHeader header(m_blockBytes);
-	Signature mySign = sign(header.hash(WithoutSeal));
-	m_idVoted[id()] = mySign;
+	QposRound& round = m_rounds[_number];
+	Signature mySign = sign(round.signHash);
+	round.voted[id()] = mySign;
 
 	m_consensusTimeOut = utcTime() + m_consensusTimeInterval;
 	m_consensusState = qposWaitingVote;
 	
 	if(1 >= m_miners.size()){
-		voteBlockEnd();
+		voteBlockEnd(_number);
 		return;
 	}
 	
@@ -491,11 +616,11 @@ void Qpos::voteBlockBegin()
 	msg << qposBlockVote;
 	msg << m_currentView;
 	msg << mySign;
-	msg << m_blockBytes; 
+	msg << round.blockBytes; 
 
 	m_voteTimeOut = utcTime() + QPOS_HEART_TIMEOUT;
 	multicast(m_miners, msg);
-	cdebug << ",header.hash(WithoutSeal)=" << header.hash(WithoutSeal) << ",mySign=" << mySign << ",m_blockBytes.size()=" << m_blockBytes.size() << ",m_miners.size()=" << m_miners.size();
+	cdebug << ",round.signHash=" << round.signHash << ",mySign=" << mySign << ",round.blockBytes.size()=" << round.blockBytes.size() << ",m_miners.size()=" << m_miners.size();
 }
 
 void Qpos::generateSealBegin(bytes const& _block)
@@ -505,12 +630,22 @@ void Qpos::generateSealBegin(bytes const& _block)
 		cdebug << "m_blockNumber=" << m_blockNumber << ",header.number()=" << header.number();
 		return;
 	}
+
+	auto parent = m_rounds.find(m_blockNumber);
+	if(parent != m_rounds.end() && parent->second.sealed && parent->second.hash != header.parentHash()){
+		cdebug << "stale parent, header.parentHash()=" << header.parentHash() << ",sealed=" << parent->second.hash;
+		return;
+	}
 	
-	m_blockBytes = _block;
+	QposRound& round = m_rounds[header.number()];
+	round = QposRound();
+	round.blockBytes = _block;
+	round.hash = header.hash();
+	round.signHash = header.hash(WithoutSeal);
 
-	cdebug << "m_miners.size()=" << m_miners.size() << ",m_consensusState=" << m_consensusState << ",m_blockBytes.size()=" << m_blockBytes.size();
+	cdebug << "m_miners.size()=" << m_miners.size() << ",m_consensusState=" << m_consensusState << ",round.blockBytes.size()=" << round.blockBytes.size();
 
-	voteBlockBegin();
+	voteBlockBegin(header.number());
 }
 
 void Qpos::generateSeal(bytes const& _block)
@@ -519,7 +654,10 @@ void Qpos::generateSeal(bytes const& _block)
 	//return;
 	
 	m_blocks.push(_block);
-	kill(m_hostTid, QPOS_SIGNAL);
+	post([=]() {
+		if(m_isLeader && qposInitial == m_consensusState)
+			this->proposeNext();
+	});
 }
 
 bool Qpos::shouldSeal(Interface * _client)
@@ -527,6 +665,9 @@ bool Qpos::shouldSeal(Interface * _client)
 	int64_t blockNumber = _client->number();
 	bool isLeader = m_isLeader;
 	bool ret = m_consensusState == qposInitial && isLeader;
+	// Within the pipeline the client builds the next block on the sealed ones the chain has yet to import.
+	if(!mayPropose())
+		ret = false;
 	int64_t now = utcTime();
 
 	static int64_t s_timeout = 0;
@@ -551,6 +692,8 @@ bool Qpos::checkBlockSign(BlockHeader const& _header, bytesConstRef _block) cons
 	//return true;
 	Timer t;
 
+	noteMinerSetChange(_header, _block);
+
 	set<NodeID> miner_list;
 	if (!getMinerList(miner_list, static_cast<BlockNumber>(_header.number() - 1))) {
 		cwarn << "checkBlockSign failed for getMinerList return false, blk=" <<  _header.number() - 1;
@@ -566,25 +709,15 @@ bool Qpos::checkBlockSign(BlockHeader const& _header, bytesConstRef _block) cons
 	if (!b.isList() || b.itemCount() < 4)
 		return false;
 
-	const std::vector<std::pair<p2p::NodeID, Signature>> &sign_list = b[3][1].toVector<std::pair<p2p::NodeID, Signature>>();
+	QposSignList const sign_list = b[3][1].toVector<std::pair<p2p::NodeID, Signature>>();
+	h256 const hash = _header.hash(WithoutSeal);
 
-	set<p2p::NodeID> signs;
-	for (auto item : sign_list) {
-		cdebug << "item.first=" << item.first << ",miner_list=" << miner_list;
-		if (!miner_list.count(item.first) || !dev::verify(item.first, item.second, _header.hash(WithoutSeal))) {
-			cdebug << "checkBlockSign failed, verify false, blk=" << _header.number() << ",hash=" << _header.hash(WithoutSeal);
-			continue;
-		}
-		
-		cdebug << "checkBlockSign signs.size()=" << signs.size() << ",miner_list.size()=" << miner_list.size();
-		signs.insert(item.first);
-		if(signs.size() >= (miner_list.size()+1)/2){
-			cdebug << "checkBlockSign succeed signs.size()=" << signs.size() << ",miner_list.size()=" << miner_list.size();
-			return true;
-		}
+	if(verifyQuorum(sign_list, miner_list, hash, (miner_list.size()+1)/2)){
+		cdebug << "checkBlockSign succeed sign_list.size()=" << sign_list.size() << ",miner_list.size()=" << miner_list.size() << ",timecost=" << t.elapsed() * 1000 << "ms";
+		return true;
 	}
 
-	cdebug << "checkBlockSign failed, blk=" << _header.number() << ",hash=" << _header.hash(WithoutSeal) << ",timecost=" << t.elapsed() / 1000 << "ms";
+	cdebug << "checkBlockSign failed, blk=" << _header.number() << ",hash=" << hash << ",timecost=" << t.elapsed() * 1000 << "ms";
 	return false;
 }
 
@@ -2,6 +2,8 @@
 #pragma once
 
 #include <atomic>
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 #include <set>
@@ -34,6 +36,17 @@ enum qposState
 	qposFinished
 };
 
+/// Vote state of a single proposed block height.
+struct QposRound
+{
+	bytes blockBytes;
+	h256 hash;		///< Header hash including seal; what the next block names as parent.
+	h256 signHash;	///< Header hash without seal; what the miners sign.
+	set<NodeID> unVoted;
+	map<NodeID, Signature> voted;
+	bool sealed = false;
+};
+
 class Qpos:public QposSealEngine
 {
 public:
@@ -51,8 +64,18 @@ public:
 	void reportBlock(unsigned _blockNumber, bool _force = false);
 	h512s getMinerNodeList();
 	int64_t lastConsensusTime() const { /*Guard l(m_mutex);*/ return m_last_consensus_time;};
+	/// Highest block that gathered a majority but may not be imported yet (pipelined mode only).
+	int64_t sealedNumber() const { return m_sealedNumber; }
+	bool pipelined() const { return m_pipelineDepth > 1; }
+	/// Whether the next block may be proposed: fewer than qposPipelineDepth blocks, counting it,
+	/// may be sealed but not imported.
+	bool mayPropose() const { return !pipelined() || m_sealedNumber - m_blockReport < (int64_t)m_pipelineDepth; }
 
 	bool checkBlockSign(BlockHeader const& _header, bytesConstRef _block) const override;
+
+	/// Cancels the tick timer and waits until no tick runs; the engine is idle until initEnv().
+	/// Called by the client that started ticking before it goes away; later calls do nothing.
+	void stopTicking();
 protected:
 	virtual void tick();
 	void reportBlockSelf();
@@ -65,15 +88,19 @@ protected:
 	void onVote(QposPeer* _p, RLP const& _r);
 	void onVoteAck(QposPeer* _p, RLP const& _r);
 	void voteTick();
-	bytes authBytes();
+	bytes authBytes(QposRound const& _round);
 	void broadBlock(bytes const& _bolck);
 	void onBroadBlock(QposPeer* _p, RLP const& _r);
-	void voteBlockEnd();
-	void voteBlockBegin();
+	void voteBlockEnd(int64_t _number);
+	void voteBlockBegin(int64_t _number);
+	void proposeNext();
+	void pruneRounds(int64_t _imported);
 	bool msgVerify(const NodeID &_nodeID, bytes const&  _msg, h520 const&  _msgSign);
+	bool msgVerify(const NodeID &_nodeID, h256 const& _hash, h520 const&  _msgSign);
 	void addNodes(const std::string &_nodes);
 	int64_t nodeCount() const;
-	void signalHandler(const boost::system::error_code& err, int signal);
+	void post(std::function<void()> const& _f);
+	void scheduleTick();
 	
 private:
 	unsigned m_consensusTimeInterval = (20*TIME_PER_SECOND);
@@ -85,11 +112,11 @@ private:
 	int64_t m_blockNumberRecv = 0;
 	set<NodeID> m_miners;
 	
-	bytes m_blockBytes;
+	std::map<int64_t, QposRound> m_rounds;	///< Vote state keyed by block height.
+	std::atomic<int64_t> m_sealedNumber = {0};
+	unsigned m_pipelineDepth = 0;			///< Blocks that may be sealed but not imported, counting the one proposed; 0 or 1 keeps one block at a time.
 	int64_t m_currentView = 0;
 	int64_t m_consensusTimeOut = -1;
-	set<NodeID> m_idUnVoted;
-	map<NodeID, Signature> m_idVoted;
 	//unsigned m_consensusState = qposInitial;
 	std::atomic<unsigned> m_consensusState = { qposFinished };
 	
@@ -97,8 +124,9 @@ private:
 
 	concurrent_queue<bytes> m_blocks;
 
-	std::atomic<pid_t> m_hostTid = {0};
-	boost::asio::signal_set *m_sigset;
+	std::unique_ptr<boost::asio::io_service::strand> m_strand;	///< Serialises consensus events on the host's io_service.
+	std::shared_ptr<boost::asio::deadline_timer> m_tickTimer;
+	std::shared_ptr<std::atomic<bool>> m_ticking;	///< Cleared by stopTicking(); shared with the pending tick handler.
 
 	int64_t m_voteTimeOut = 0;
 	set<NodeID> m_voted;
@@ -62,6 +62,7 @@ QposClient::QposClient(
 }
 
 QposClient::~QposClient() {
+	raft()->stopTicking();
 	raft()->cancelGeneration();
 	stopWorking();
 }
@@ -69,6 +70,8 @@ QposClient::~QposClient() {
 void QposClient::init(ChainParams const&, p2p::Host *_host) {
 	raft()->onSealGenerated([ = ](bytes const & _block, bool _isOurs) {
 		if(_block.size() == 0){
+			DEV_WRITE_GUARDED(x_working)
+				m_next = Block(Block::Null);
 			resetState();
 			cdebug << "_block.size() == 0";
 			return;
@@ -174,10 +177,25 @@ void QposClient::rejigSealing()
 			{
 				if (m_working.isSealed())
 				{
-					clog(ClientNote) << "Tried to seal sealed block...";
-					m_needStateReset = true;
+					if (raft()->sealedNumber() < m_working.info().number() || !m_next.buildsOn(m_working.info().hash()))
+					{
+						clog(ClientNote) << "Tried to seal sealed block...";
+						m_needStateReset = true;
+						return;
+					}
+
+					// Our block has its votes; fill the next one while the chain imports it.
+					m_working = m_next;
+					m_next = Block(Block::Null);
+					DEV_WRITE_GUARDED(x_postSeal)
+						m_postSeal = m_working;
+					onTransactionQueueReady();
 					return;
 				}
+
+				// Ahead of the chain only a block on the last one sealed can be voted on.
+				if (raft()->pipelined() && m_working.info().number() <= raft()->sealedNumber())
+					return;
 				
 
 				u256 now_time = u256(utcTime());
@@ -189,11 +207,15 @@ void QposClient::rejigSealing()
 
 				m_working.commitToSeal(bc(), m_extraData);
 				m_sealingInfo = m_working.info();
+				if (raft()->pipelined())
+					m_next = m_working;
 
 				RLPStream h;
 				m_sealingInfo.streamRLP(h);
 
 				m_working.sealBlock(h.out());
+				if (raft()->pipelined() && !m_next.buildOn(m_working.info()))
+					m_next = Block(Block::Null);
 			}
 			DEV_READ_GUARDED(x_working)
 			{
@@ -61,6 +61,7 @@ protected:
 	bool submitSealed(bytes const& _block, bool _isOurs);
 
 	BlockHeader  m_last_commited_block;
+	Block m_next{Block::Null};		///< In pipelined mode, built on m_working while it is voted on; guarded by x_working.
 	bool m_noEmptyBlock = true;
 	bool m_importAnyNode;
 };
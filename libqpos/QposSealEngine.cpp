@@ -73,6 +73,8 @@ void QposSealEngine::initEnv(class Client *_c, p2p::Host *_host, BlockChain* _bc
 	const Address addr = jsToAddress(nodeAddress());
 	m_client->onImprted(addr, [&]()
 	{
+			DEV_GUARDED(x_minerCache)
+				m_minerCache = MinerSetCache();
 			this->getMinerList();
 	});
 	
@@ -276,13 +278,57 @@ bool QposSealEngine::getMinerList()
 
 bool QposSealEngine::getMinerList(set<NodeID> &_miner_list, BlockNumber _blk_no) const 
 {
+	bool const historic = _blk_no != PendingBlock && _blk_no != LatestBlock;
+	if(historic){
+		Guard l(x_minerCache);
+		MinerSetCache const& c = m_minerCache;
+		bool const covered = c.from != PendingBlock && c.from <= _blk_no && m_bc->numberHash(c.from) == c.fromHash
+			&& m_minerSetChanges.upper_bound(c.from) == m_minerSetChanges.upper_bound(_blk_no);
+		if(covered){
+			_miner_list = c.miners;
+			return true;
+		}
+	}
+
 	string out = m_client->getNodes("", _blk_no);
 	_miner_list = strToNode(out);
 	cdebug << "_blk_no=" << _blk_no << ",out=" << out;
 
+	h256 const hash = historic ? m_bc->numberHash(_blk_no) : h256();
+	if(hash){
+		Guard l(x_minerCache);
+		if(m_minerCache.from == PendingBlock || _blk_no > m_minerCache.from){
+			m_minerCache.from = _blk_no;
+			m_minerCache.fromHash = hash;
+			m_minerCache.miners = _miner_list;
+			m_minerSetChanges.erase(m_minerSetChanges.begin(), m_minerSetChanges.upper_bound(_blk_no));
+		}
+	}
+
 	return true;
 }
 
+void QposSealEngine::noteMinerSetChange(BlockHeader const& _header, bytesConstRef _block) const
+{
+	// Like the onImprted hook, only direct calls to the Node contract are taken as membership changes.
+	static Address const c_node = jsToAddress(nodeAddress());
+	RLP const block(_block);
+	if(!block.isList() || block.itemCount() < 2)
+		return;
+
+	for(auto const& tx : block[1]){
+		if(!tx.isList() || tx.itemCount() < 4)
+			continue;
+
+		RLP const to = tx[3];
+		if(to.isData() && to.size() == Address::size && to.toHash<Address>() == c_node){
+			Guard l(x_minerCache);
+			m_minerSetChanges.insert(static_cast<BlockNumber>(_header.number()));
+			return;
+		}
+	}
+}
+
 bool QposSealEngine::getNodes(set<QposNode> &_miner_list) 
 {
 	DEV_RECURSIVE_GUARDED(x_nodes)
@@ -97,6 +97,8 @@ protected:
 	virtual void tick();
 	bool getMinerList();
 	bool getMinerList(set<NodeID> &_miner_list, BlockNumber _blk_no = PendingBlock) const;
+	/// Records whether @a _block calls the Node contract, which ends the cached miner set at its height.
+	void noteMinerSetChange(BlockHeader const& _header, bytesConstRef _block) const;
 
 	bool getNodes(set<QposNode> &_miner_list);
 		
@@ -132,6 +134,19 @@ private:
 	std::set<QposNode> m_nodes;
 	std::string m_nodes_str;
 	bool m_nodes_changed = true;
+
+	/// Miner set read from the Node contract at block @a from. It stays valid for every later block of the
+	/// same chain up to the first one that sends a transaction to the contract.
+	struct MinerSetCache
+	{
+		BlockNumber from = PendingBlock;
+		h256 fromHash;
+		std::set<NodeID> miners;
+	};
+
+	mutable Mutex x_minerCache;
+	mutable MinerSetCache m_minerCache;
+	mutable std::set<BlockNumber> m_minerSetChanges;	///< Heights above m_minerCache.from that call the Node contract.
 };
 
 }
@@ -0,0 +1,62 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file QposSignVerifier.cpp
+ */
+
+#include "QposSignVerifier.h"
+
+#include <libdevcore/WorkerPool.h>
+
+#include <atomic>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+namespace
+{
+/// Below this many signatures per thread, handing some to a helper costs more than the recovery it saves.
+size_t const c_minSignsPerThread = 4;
+}
+
+bool dev::eth::verifyQuorum(QposSignList const& _signs, set<p2p::NodeID> const& _miners, h256 const& _hash, size_t _quorum)
+{
+	// Only the first signature of each miner counts; everything else is rejected without any ECDSA work.
+	vector<pair<p2p::NodeID, Signature> const*> candidates;
+	set<p2p::NodeID> seen;
+	for (auto const& s: _signs)
+		if (_miners.count(s.first) && seen.insert(s.first).second)
+			candidates.push_back(&s);
+
+	if (candidates.size() < _quorum)
+		return false;
+
+	size_t const maxInvalid = candidates.size() - _quorum;
+	atomic<size_t> valid(0);
+	atomic<size_t> invalid(0);
+	WorkerPool::shared().forEach(candidates.size(), c_minSignsPerThread, [&](size_t i)
+	{
+		if (valid >= _quorum || invalid > maxInvalid)
+			return;
+		if (dev::verify(candidates[i]->first, candidates[i]->second, _hash))
+			++valid;
+		else
+			++invalid;
+	});
+
+	return valid >= _quorum;
+}
@@ -0,0 +1,42 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file QposSignVerifier.h
+ * Verification of the miner signature list carried by QPOS blocks.
+ */
+
+#pragma once
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <libdevcrypto/Common.h>
+#include <libp2p/Common.h>
+
+namespace dev
+{
+namespace eth
+{
+
+using QposSignList = std::vector<std::pair<p2p::NodeID, Signature>>;
+
+/// @returns true if at least @a _quorum distinct members of @a _miners signed @a _hash in @a _signs.
+/// Verification stops as soon as the outcome is known; long lists are shared with the helper threads.
+bool verifyQuorum(QposSignList const& _signs, std::set<p2p::NodeID> const& _miners, h256 const& _hash, size_t _quorum);
+
+}
+}
@@ -4,6 +4,7 @@
 #include <libethcore/CommonJS.h>
 #include <libethereum/Client.h>
 #include <libethereum/Executive.h>
+#include <libevm/VMProfiler.h>
 #include "Debug.h"
 #include "JsonHelper.h"
 using namespace std;
@@ -182,6 +183,87 @@ std::string Debug::debug_preimage(std::string const& _hashedKey)
 	return key.empty() ? std::string() : toHexPrefixed(key);
 }
 
+Json::Value Debug::debug_evmProfile(Json::Value const& _options)
+{
+	VMProfiler& profiler = VMProfiler::get();
+	unsigned limit = 100;
+	bool reset = false;
+	if (_options.isObject())
+	{
+		if (!_options["sampleInterval"].empty())
+			profiler.setSampleInterval(_options["sampleInterval"].asUInt());
+		if (!_options["enable"].empty())
+			profiler.setEnabled(_options["enable"].asBool());
+		if (!_options["limit"].empty())
+			limit = _options["limit"].asUInt();
+		if (!_options["reset"].empty())
+			reset = _options["reset"].asBool();
+	}
+	ProfileSnapshot const snapshot = reset ? profiler.snapshotAndReset() : profiler.snapshot();
+
+	Json::Value ret(Json::objectValue);
+	ret["enabled"] = snapshot.enabled;
+	ret["sampleInterval"] = snapshot.sampleInterval;
+	ret["tickUnit"] = profileTickUnit();
+
+	// opcodes never timed contribute their count but no ticks to the class estimate
+	Json::Value opcodes(Json::objectValue);
+	Json::Value classes(Json::objectValue);
+	for (unsigned i = 0; i < snapshot.ops.size(); ++i)
+	{
+		OpProfile const& op = snapshot.ops[i];
+		if (!op.count)
+			continue;
+		Instruction const inst = static_cast<Instruction>(i);
+		string name = instructionInfo(inst).name;
+		if (name.empty())
+			name = toHexPrefixed(bytes{byte(i)});
+		uint64_t const avgTicks = op.samples ? op.ticks / op.samples : 0;
+
+		Json::Value& o = opcodes[name];
+		o["count"] = Json::UInt64(op.count);
+		o["samples"] = Json::UInt64(op.samples);
+		o["avgTicks"] = Json::UInt64(avgTicks);
+
+		Json::Value& c = classes[opcodeClass(inst)];
+		c["count"] = Json::UInt64(c["count"].asUInt64() + op.count);
+		c["estimatedTicks"] = Json::UInt64(c["estimatedTicks"].asUInt64() + avgTicks * op.count);
+	}
+	ret["opcodes"] = opcodes;
+	ret["classes"] = classes;
+
+	// the contracts with the most gas of their own first
+	vector<pair<Address, ContractProfile>> contracts(snapshot.contracts.begin(), snapshot.contracts.end());
+	auto const byCost = [](pair<Address, ContractProfile> const& _a, pair<Address, ContractProfile> const& _b) {
+		return _a.second.selfGas > _b.second.selfGas;
+	};
+	if (contracts.size() > limit)
+	{
+		partial_sort(contracts.begin(), contracts.begin() + limit, contracts.end(), byCost);
+		contracts.resize(limit);
+	}
+	else
+		sort(contracts.begin(), contracts.end(), byCost);
+	Json::Value top(Json::arrayValue);
+	for (auto const& entry: contracts)
+	{
+		ContractProfile const& p = entry.second;
+		Json::Value c;
+		c["address"] = toJS(entry.first);
+		c["calls"] = Json::UInt64(p.calls);
+		c["gas"] = Json::UInt64(p.gas);
+		c["selfGas"] = Json::UInt64(p.selfGas);
+		c["instructions"] = Json::UInt64(p.instructions);
+		c["sloads"] = Json::UInt64(p.sloads);
+		c["sstores"] = Json::UInt64(p.sstores);
+		c["estimatedTicks"] = Json::UInt64(p.estimatedTicks);
+		top.append(c);
+	}
+	ret["contracts"] = top;
+	ret["contractCount"] = Json::UInt64(snapshot.contracts.size());
+	return ret;
+}
+
 Json::Value Debug::debug_traceCall(Json::Value const& _call, std::string const& _blockNumber, Json::Value const& _options)
 {
 	Json::Value ret;
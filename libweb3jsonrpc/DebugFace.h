@@ -20,6 +20,7 @@ namespace dev {
                     this->bindAndAddMethod(jsonrpc::Procedure("debug_traceBlockByNumber", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",jsonrpc::JSON_INTEGER,"param2",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::DebugFace::debug_traceBlockByNumberI);
                     this->bindAndAddMethod(jsonrpc::Procedure("debug_traceBlockByHash", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",jsonrpc::JSON_STRING,"param2",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::DebugFace::debug_traceBlockByHashI);
                     this->bindAndAddMethod(jsonrpc::Procedure("debug_traceCall", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",jsonrpc::JSON_OBJECT,"param2",jsonrpc::JSON_STRING,"param3",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::DebugFace::debug_traceCallI);
+                    this->bindAndAddMethod(jsonrpc::Procedure("debug_evmProfile", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::DebugFace::debug_evmProfileI);
                 }
 
                 inline virtual void debug_traceTransactionI(const Json::Value &request, Json::Value &response)
@@ -46,12 +47,17 @@ namespace dev {
                 {
                     response = this->debug_traceCall(request[0u], request[1u].asString(), request[2u]);
                 }
+                inline virtual void debug_evmProfileI(const Json::Value &request, Json::Value &response)
+                {
+                    response = this->debug_evmProfile(request[0u]);
+                }
                 virtual Json::Value debug_traceTransaction(const std::string& param1, const Json::Value& param2) = 0;
                 virtual Json::Value debug_storageRangeAt(const std::string& param1, int param2, const std::string& param3, const std::string& param4, int param5) = 0;
                 virtual std::string debug_preimage(const std::string& param1) = 0;
                 virtual Json::Value debug_traceBlockByNumber(int param1, const Json::Value& param2) = 0;
                 virtual Json::Value debug_traceBlockByHash(const std::string& param1, const Json::Value& param2) = 0;
                 virtual Json::Value debug_traceCall(const Json::Value& param1, const std::string& param2, const Json::Value& param3) = 0;
+                virtual Json::Value debug_evmProfile(const Json::Value& param1) = 0;
         };
 
     }
@@ -337,6 +337,51 @@ string Eth::eth_sendRawTransaction(std::string const& _rlp)
 	}
 }
 
+Json::Value Eth::eth_sendRawTransactions(Json::Value const& _rlps)
+{
+	if (!_rlps.isArray())
+		BOOST_THROW_EXCEPTION(JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS));
+
+	// Undecodable hex is reported as malformed without holding up the rest of the batch.
+	vector<bytes> rlps;
+	vector<unsigned> indices;
+	Json::Value ret(Json::arrayValue);
+	for (unsigned i = 0; i < _rlps.size(); ++i)
+	{
+		Json::Value result(Json::objectValue);
+		result["hash"] = Json::Value();
+		result["result"] = toString(ImportResult::Malformed);
+		if (_rlps[i].isString())
+		{
+			bytes rlp = jsToBytes(_rlps[i].asString());
+			if (!rlp.empty())
+			{
+				result["hash"] = toJS(sha3(rlp));
+				rlps.push_back(move(rlp));
+				indices.push_back(i);
+			}
+		}
+		ret.append(result);
+	}
+
+	try
+	{
+		vector<ImportResult> results = client()->injectTransactions(rlps);
+		for (unsigned i = 0; i < results.size(); ++i)
+		{
+			Json::Value& r = ret[indices[i]];
+			r["result"] = toString(results[i]);
+			if (results[i] == ImportResult::Malformed)
+				r["hash"] = Json::Value();
+		}
+	}
+	catch (...)
+	{
+		BOOST_THROW_EXCEPTION(JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS));
+	}
+	return ret;
+}
+
 string Eth::eth_call(Json::Value const& _json, string const& _blockNumber)
 {
 	try
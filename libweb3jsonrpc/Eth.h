@@ -122,6 +122,7 @@ public:
 	virtual std::string eth_signTransaction(Json::Value const& _transaction) override;
 	virtual Json::Value eth_inspectTransaction(std::string const& _rlp) override;
 	virtual std::string eth_sendRawTransaction(std::string const& _rlp) override;
+	virtual Json::Value eth_sendRawTransactions(Json::Value const& _rlps) override;
 	virtual bool eth_notePassword(std::string const&) override { return false; }
 	virtual Json::Value eth_syncing() override;
 	
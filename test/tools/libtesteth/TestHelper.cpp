@@ -693,6 +693,21 @@ RLPStream createRLPStreamFromTransactionFields(json_spirit::mObject const& _tObj
     return rlpStream;
 }
 
+bytes withUnrecoverableSignature(Transaction const& _t)
+{
+    bytes const rlp = _t.rlp();
+    RLP const fields(rlp);
+    for (unsigned r = 1;; ++r)
+    {
+        RLPStream s(9);
+        for (unsigned i = 0; i < 7; ++i)
+            s.appendRaw(fields[i].data());
+        s << u256(r) << fields[8].toInt<u256>();
+        if (Transaction(s.out(), CheckTransaction::Cheap).safeSender() == ZeroAddress)
+            return s.out();
+    }
+}
+
 dev::eth::BlockHeader constructHeader(h256 const& _parentHash, h256 const& _sha3Uncles,
     Address const& _author, h256 const& _stateRoot, h256 const& _transactionsRoot,
     h256 const& _receiptsRoot, dev::eth::LogBloom const& _logBloom, u256 const& _difficulty,
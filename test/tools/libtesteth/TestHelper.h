@@ -123,6 +123,8 @@ dev::eth::BlockHeader constructHeader(
 	bytes const& _extraData);
 void updateEthashSeal(dev::eth::BlockHeader& _header, h256 const& _mixHash, dev::eth::Nonce const& _nonce);
 RLPStream createRLPStreamFromTransactionFields(json_spirit::mObject const& _tObj);
+/// @returns @a _t with an r no key could have signed with, so that no sender can be recovered.
+bytes withUnrecoverableSignature(eth::Transaction const& _t);
 json_spirit::mObject fillJsonWithStateChange(eth::State const& _stateOrig, eth::State const& _statePost, eth::ChangeLog const& _changeLog);
 json_spirit::mObject fillJsonWithState(eth::State const& _state);
 json_spirit::mObject fillJsonWithState(eth::State const& _state, eth::AccountMaskMap const& _map);
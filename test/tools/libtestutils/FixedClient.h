@@ -54,6 +54,7 @@ public:
     void prepareForTransaction() override {}
     std::pair<h256, Address> submitTransaction(eth::TransactionSkeleton const&, Secret const&) override { return {}; };
     eth::ImportResult injectTransaction(bytes const&, eth::IfDropped) override { return {}; }
+    std::vector<eth::ImportResult> injectTransactions(std::vector<bytes> const& _rlps, eth::IfDropped) override { return std::vector<eth::ImportResult>(_rlps.size()); }
     eth::ExecutionResult call(Address const&, u256, Address, bytes const&, u256, u256, eth::BlockNumber, eth::FudgeFactor) override { return {}; };
 
 private:
@@ -0,0 +1,164 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file SIMD.cpp
+ * Cross-checks the vector kernels of every instruction set the CPU supports against the
+ * portable ones.
+ */
+
+#include <libdevcore/SIMD.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+#include <random>
+
+using namespace std;
+using namespace dev;
+using namespace dev::simd;
+using namespace dev::test;
+
+namespace
+{
+using Word = array<uint8_t, 32>;
+
+/// Random words, biased towards lanes that are zero, all ones or equal to the other operand.
+Word randomWord(mt19937_64& _rng, Word const* _other = nullptr)
+{
+    Word w;
+    for (auto& b: w)
+        b = uint8_t(_rng());
+    for (size_t i = 0; i < w.size(); ++i)
+        switch (_rng() % 8)
+        {
+        case 0: w[i] = 0; break;
+        case 1: w[i] = 0xff; break;
+        case 2: w[i] = 0x80; break;
+        case 3: if (_other) w[i] = (*_other)[i]; break;
+        default: break;
+        }
+    return w;
+}
+
+vector<Isa> supportedIsas()
+{
+    vector<Isa> ret{Isa::Scalar};
+    for (Isa isa: {Isa::SSE42, Isa::AVX2})
+        if (isa <= detectedIsa())
+            ret.push_back(isa);
+    return ret;
+}
+
+/// Restores the dispatch after a test forced an instruction set.
+struct IsaGuard
+{
+    Isa const saved = activeIsa();
+    ~IsaGuard() { setIsa(saved); }
+};
+}
+
+BOOST_FIXTURE_TEST_SUITE(SIMDTests, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(laneKernelsAgree)
+{
+    Kernels const& reference = kernels(Isa::Scalar);
+    mt19937_64 rng(616);
+    for (Isa isa: supportedIsas())
+    {
+        Kernels const& k = kernels(isa);
+        for (unsigned op = 0; op < unsigned(LaneOp::Count); ++op)
+            for (unsigned width = 0; width < LaneWidthCount; ++width)
+                for (unsigned n = 0; n < 200; ++n)
+                {
+                    Word const a = randomWord(rng);
+                    Word const b = randomWord(rng, &a);
+                    Word expected;
+                    Word actual;
+                    reference.lanes[op][width](expected.data(), a.data(), b.data());
+                    k.lanes[op][width](actual.data(), a.data(), b.data());
+                    BOOST_REQUIRE_MESSAGE(expected == actual,
+                        isaName(isa) << " op " << op << " width " << width);
+                }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(laneSemantics)
+{
+    IsaGuard guard;
+    for (Isa isa: supportedIsas())
+    {
+        setIsa(isa);
+        BOOST_CHECK(activeIsa() == isa);
+
+        Word a{};
+        Word b{};
+        Word r;
+        a[0] = 0x80;  // lane 0: -128 signed, 128 unsigned
+        b[0] = 1;
+        a[1] = 7;     // lane 1: divided by zero
+        laneKernel(LaneOp::Lt, Lanes8)(r.data(), a.data(), b.data());
+        BOOST_CHECK_EQUAL(r[0], 0);
+        laneKernel(LaneOp::SLt, Lanes8)(r.data(), a.data(), b.data());
+        BOOST_CHECK_EQUAL(r[0], 1);
+        laneKernel(LaneOp::Add, Lanes8)(r.data(), a.data(), a.data());
+        BOOST_CHECK_EQUAL(r[0], 0);
+        BOOST_CHECK_EQUAL(r[1], 14);
+        laneKernel(LaneOp::Div, Lanes8)(r.data(), a.data(), b.data());
+        BOOST_CHECK_EQUAL(r[0], 0x80);
+        BOOST_CHECK_EQUAL(r[1], 0);
+        laneKernel(LaneOp::Zero, Lanes64)(r.data(), a.data(), b.data());
+        BOOST_CHECK_EQUAL(r[0], 0);
+        BOOST_CHECK_EQUAL(r[8], 1);
+
+        // Lanes are in memory order, so 16-bit lanes carry across byte pairs only.
+        a.fill(0xff);
+        b = Word{};
+        b[0] = 1;
+        laneKernel(LaneOp::Add, Lanes16)(r.data(), a.data(), b.data());
+        BOOST_CHECK_EQUAL(r[0], 0);
+        BOOST_CHECK_EQUAL(r[1], 0);
+        BOOST_CHECK_EQUAL(r[2], 0xff);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(byteKernelsAgree)
+{
+    Kernels const& reference = kernels(Isa::Scalar);
+    mt19937_64 rng(1);
+    for (Isa isa: supportedIsas())
+    {
+        Kernels const& k = kernels(isa);
+        for (size_t dstSize = 0; dstSize < 100; ++dstSize)
+            for (size_t srcSize: {size_t(0), size_t(1), size_t(15), size_t(16), size_t(31),
+                     size_t(32), size_t(33), dstSize / 2, dstSize, dstSize + 7})
+            {
+                vector<uint8_t> src(srcSize);
+                for (auto& b: src)
+                    b = uint8_t(rng());
+                vector<uint8_t> expected(dstSize, 0xcc);
+                vector<uint8_t> actual(dstSize, 0xcc);
+                reference.copyZeroExtend(expected.data(), dstSize, src.data(), srcSize);
+                k.copyZeroExtend(actual.data(), dstSize, src.data(), srcSize);
+                BOOST_REQUIRE_MESSAGE(expected == actual,
+                    isaName(isa) << " copy " << srcSize << " into " << dstSize);
+
+                size_t const n = min(srcSize, dstSize);
+                reference.xorBytes(expected.data(), src.data(), n);
+                k.xorBytes(actual.data(), src.data(), n);
+                BOOST_REQUIRE_MESSAGE(expected == actual, isaName(isa) << " xor " << n);
+            }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file WorkerPool.cpp
+ * Tests for the helper threads shared by batches of independent work.
+ */
+
+#include <libdevcore/WorkerPool.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+
+using namespace std;
+using namespace dev;
+using namespace dev::test;
+
+BOOST_FIXTURE_TEST_SUITE(WorkerPoolTests, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(everyIndexOnce)
+{
+    WorkerPool pool(3);
+    vector<atomic<unsigned>> calls(1000);
+    pool.forEach(calls.size(), 1, [&](size_t i) { ++calls[i]; });
+    for (auto const& c: calls)
+        BOOST_CHECK_EQUAL(c, 1);
+}
+
+BOOST_AUTO_TEST_CASE(smallBatchStaysOnCaller)
+{
+    WorkerPool pool(3);
+    atomic<unsigned> elsewhere(0);
+    thread::id const caller = this_thread::get_id();
+    pool.forEach(15, 16, [&](size_t) {
+        if (this_thread::get_id() != caller)
+            ++elsewhere;
+    });
+    BOOST_CHECK_EQUAL(elsewhere, 0);
+}
+
+BOOST_AUTO_TEST_CASE(withoutHelpers)
+{
+    WorkerPool pool(0);
+    BOOST_CHECK_EQUAL(pool.helpers(), 0);
+    size_t sum = 0;
+    pool.forEach(100, 1, [&](size_t i) { sum += i; });
+    BOOST_CHECK_EQUAL(sum, 4950);
+}
+
+BOOST_AUTO_TEST_CASE(concurrentAndNestedBatches)
+{
+    WorkerPool pool(2);
+    atomic<size_t> sum(0);
+    vector<thread> callers;
+    for (unsigned t = 0; t < 4; ++t)
+        callers.emplace_back([&]() {
+            pool.forEach(50, 1, [&](size_t i) {
+                pool.forEach(10, 1, [&](size_t j) { sum += i * j; });
+            });
+        });
+    for (auto& c: callers)
+        c.join();
+    BOOST_CHECK_EQUAL(sum, 4 * 1225 * 45);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -615,6 +615,34 @@ template<typename Trie> void perfTestTrie(char const* _name)
 	}
 }
 
+BOOST_AUTO_TEST_CASE(largeTrieRootMatchesTrie)
+{
+	// Big enough for subtries to be hashed on helper threads.
+	for (unsigned count: {100u, 5000u})
+	{
+		vector<bytes> items;
+		MemoryDB m;
+		GenericTrieDB<MemoryDB> t(&m);
+		t.init();
+		for (unsigned i = 0; i < count; ++i)
+		{
+			items.push_back(rlp(sha3(toString(i))));
+			t.insert(rlp(i), items.back());
+		}
+		BOOST_CHECK_EQUAL(orderedTrieRoot(items), t.root());
+
+		BytesMap hashed;
+		for (unsigned i = 0; i < count; ++i)
+			hashed[sha3(toString(i)).asBytes()] = bytes(i % 40 + 1, byte(i));
+		MemoryDB m2;
+		GenericTrieDB<MemoryDB> t2(&m2);
+		t2.init();
+		for (auto const& i: hashed)
+			t2.insert(i.first, i.second);
+		BOOST_CHECK_EQUAL(hash256(hashed), t2.root());
+	}
+}
+
 BOOST_AUTO_TEST_CASE(triePerf)
 {
 	if (test::Options::get().all)
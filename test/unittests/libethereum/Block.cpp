@@ -142,6 +142,58 @@ BOOST_AUTO_TEST_CASE(bCopyOperator)
 	BOOST_CHECK_EXCEPTION(block32.populateFromChain(blockchain, h256("0x0000000000000000000000000000000000000000000000000000000000000001")), BlockNotFound, is_critical);
 }
 
+BOOST_AUTO_TEST_CASE(bBuildOnUnimported)
+{
+	TestBlockChain testBlockchain(TestBlockChain::defaultGenesisBlock());
+	TestBlock const& genesisBlock = testBlockchain.testGenesis();
+	OverlayDB const& genesisDB = genesisBlock.state().db();
+	BlockChain& blockchain = testBlockchain.interfaceUnsafe();
+	h256 const genesisHash = blockchain.currentHash();
+
+	TestBlock testBlock;
+	testBlock.addTransaction(TestTransaction::defaultTransaction(1));
+	TransactionQueue& tq = testBlock.transactionQueue();
+	ZeroGasPricer gp;
+
+	auto seal = [&](Block& _block)
+	{
+		Notified<bytes> sealed;
+		blockchain.sealEngine()->onSealGenerated([&](bytes const& _header) { sealed = _header; });
+		blockchain.sealEngine()->generateSeal(_block.info());
+		sealed.waitNot({});
+		blockchain.sealEngine()->onSealGenerated([](bytes const&) {});
+		BOOST_REQUIRE(_block.sealBlock(sealed));
+	};
+
+	Block first = blockchain.genesisBlock(genesisDB);
+	first.sync(blockchain);
+	first.sync(blockchain, tq, gp);
+	BOOST_REQUIRE_EQUAL(first.pending().size(), 1);
+	first.commitToSeal(blockchain);
+	Block second = first;
+	seal(first);
+	BOOST_REQUIRE(second.buildOn(first.info()));
+
+	// The second block is built and sealed while the chain still ends at genesis.
+	testBlock.addTransaction(TestTransaction::defaultTransaction(2));
+	BOOST_CHECK(second.buildsOn(first.info().hash()));
+	BOOST_CHECK(second.buildsOn(genesisHash));
+	second.sync(blockchain, tq, gp);
+	BOOST_REQUIRE_EQUAL(second.pending().size(), 1);
+	BOOST_CHECK_EQUAL(second.pending()[0].nonce(), 2);
+	BOOST_CHECK_EQUAL(tq.topTransactions(4).size(), 2);
+	second.commitToSeal(blockchain);
+	seal(second);
+	BOOST_CHECK_EQUAL(second.info().number(), 2);
+	BOOST_CHECK_EQUAL(second.info().parentHash(), first.info().hash());
+	BOOST_CHECK(!blockchain.isKnown(first.info().hash()));
+	BOOST_CHECK_EQUAL(blockchain.currentHash(), genesisHash);
+
+	blockchain.import(first.blockData(), genesisDB);
+	blockchain.import(second.blockData(), genesisDB);
+	BOOST_CHECK_EQUAL(blockchain.currentHash(), second.info().hash());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_CASE(bGasPricer)
@@ -0,0 +1,135 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file BlockArchive.cpp
+ * BlockArchiveWriter/BlockArchiveReader round trips.
+ */
+
+#include <libethereum/BlockArchive.h>
+#include <libethereum/BlockChain.h>
+#include <test/tools/libtesteth/TestHelper.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+
+vector<bytes> readAll(BlockArchiveReader& _reader, vector<bytes>* o_receipts = nullptr)
+{
+    vector<bytes> blocks;
+    BlockArchiveReader::Entry entry;
+    while (_reader.next(entry))
+    {
+        blocks.push_back(entry.block);
+        if (o_receipts)
+            o_receipts->push_back(entry.receipts);
+    }
+    return blocks;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(BlockArchiveSuite, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(roundTripWithReceipts)
+{
+    TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+    vector<TestBlock> mined;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        TestBlock block;
+        if (i == 1)
+            block.addTransaction(TestTransaction::defaultTransaction(1));
+        block.mine(bc);
+        bc.addBlock(block);
+        mined.push_back(block);
+    }
+
+    BlockChain const& chain = bc.getInterface();
+    stringstream archive;
+    BlockArchiveWriter writer(archive, true);
+    for (unsigned i = 1; i <= 3; ++i)
+    {
+        h256 const hash = chain.numberHash(i);
+        bytes const block = chain.block(hash);
+        bytes const receipts = chain.receipts(hash).rlp();
+        writer.append(&block, &receipts);
+    }
+    writer.finish();
+
+    BlockArchiveReader reader(archive);
+    BOOST_REQUIRE(reader.isArchive());
+    BOOST_REQUIRE(reader.hasReceipts());
+    vector<bytes> receipts;
+    vector<bytes> blocks = readAll(reader, &receipts);
+    BOOST_REQUIRE_EQUAL(blocks.size(), 3);
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK(blocks[i] == chain.block(chain.numberHash(i + 1)));
+        BOOST_CHECK(receipts[i] == chain.receipts(chain.numberHash(i + 1)).rlp());
+    }
+    BOOST_CHECK_EQUAL(RLP(receipts[1]).itemCount(), 1);
+
+    BOOST_REQUIRE_EQUAL(reader.index().size(), 1);
+    BOOST_CHECK_EQUAL(reader.index()[0].firstNumber, 1);
+    BOOST_CHECK_EQUAL(reader.index()[0].count, 3);
+    BOOST_CHECK_EQUAL(reader.checkpoint().number, 3);
+    BOOST_CHECK_EQUAL(reader.checkpoint().hash, chain.numberHash(3));
+    BOOST_CHECK_EQUAL(reader.checkpoint().stateRoot, chain.info(chain.numberHash(3)).stateRoot());
+}
+
+BOOST_AUTO_TEST_CASE(mismatchedReceiptsAreRejected)
+{
+    TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+    TestBlock block;
+    block.addTransaction(TestTransaction::defaultTransaction(1));
+    block.mine(bc);
+    bc.addBlock(block);
+
+    stringstream archive;
+    BlockArchiveWriter writer(archive, true);
+    writer.append(&block.bytes(), &RLPEmptyList);
+    writer.finish();
+
+    BlockArchiveReader reader(archive);
+    BOOST_CHECK_THROW(readAll(reader), BlockArchiveReceiptsMismatch);
+}
+
+BOOST_AUTO_TEST_CASE(legacyStreamIsDetected)
+{
+    TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+    stringstream legacy;
+    vector<bytes> expected;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        TestBlock block;
+        block.mine(bc);
+        bc.addBlock(block);
+        expected.push_back(block.bytes());
+        legacy.write((char const*)block.bytes().data(), block.bytes().size());
+    }
+
+    BlockArchiveReader reader(legacy);
+    BOOST_CHECK(!reader.isArchive());
+    BOOST_CHECK(readAll(reader) == expected);
+    BOOST_CHECK(!reader.checkpoint().hash);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -97,6 +97,46 @@ BOOST_AUTO_TEST_CASE(Mining_2_mineUncles)
     bc.addBlock(block2);
 }
 
+BOOST_AUTO_TEST_CASE(verifyBlockRecoversSenders)
+{
+    TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+    TestBlock block;
+    unsigned const count = 64;
+    for (unsigned i = 0; i < count; ++i)
+        block.addTransaction(TestTransaction::defaultTransaction(i, 1, 21000));
+    block.mine(bc);
+
+    VerifiedBlockRef const verified = bc.getInterface().verifyBlock(&block.bytes(), {}, ImportRequirements::OutOfOrderChecks);
+    BOOST_REQUIRE_EQUAL(verified.transactions.size(), count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        BOOST_CHECK_EQUAL(verified.transactions[i].nonce(), i);
+        BOOST_CHECK(verified.transactions[i].hasSender());
+        BOOST_CHECK_EQUAL(verified.transactions[i].sender(), Address("a94f5374fce5edbc8e2a8697c15331677e6ebf0b"));
+    }
+    bc.addBlock(block);
+}
+
+BOOST_AUTO_TEST_CASE(importUsesVerifiedSenders)
+{
+    TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+    TestBlock block;
+    for (unsigned i = 0; i < 32; ++i)
+        block.addTransaction(TestTransaction::defaultTransaction(i, 1, 21000));
+    block.mine(bc);
+
+    // Enactment must take the senders cached by verification instead of recovering them again:
+    // pinned to an account without funds, the block no longer applies.
+    VerifiedBlockRef verified = bc.getInterface().verifyBlock(&block.bytes(), {}, ImportRequirements::OutOfOrderChecks);
+    for (Transaction& t: verified.transactions)
+        t.forceSender(Address(0x5742));
+    BOOST_CHECK_THROW(bc.interfaceUnsafe().import(verified, bc.testGenesis().state().db()), Exception);
+    BOOST_CHECK_EQUAL(bc.getInterface().number(), 0);
+
+    BOOST_CHECK(bc.addBlock(block));
+    BOOST_CHECK_EQUAL(bc.getInterface().number(), 1);
+}
+
 
 /*
 
@@ -201,6 +241,31 @@ BOOST_AUTO_TEST_CASE(insertWithoutParent)
     BOOST_REQUIRE_EQUAL(bcRef.chainStartBlockNumber(), 10);
 }
 
+BOOST_AUTO_TEST_CASE(rewindToState)
+{
+    TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        TestTransaction tr = TestTransaction::defaultTransaction(i);
+        TestBlock block;
+        block.addTransaction(tr);
+        block.mine(bc);
+        bc.addBlock(block);
+    }
+
+    BlockChain& bcRef = bc.interfaceUnsafe();
+    bcRef.rewindToState(bc.testGenesis().state().db());
+    BOOST_CHECK_EQUAL(bcRef.number(), 2);
+
+    // Only the state of block 1 made it to disk.
+    OverlayDB partial;
+    h256 const root = bcRef.info(bcRef.numberHash(1)).stateRoot();
+    string const node = bc.testGenesis().state().db().lookup(root);
+    partial.insert(root, &node);
+    bcRef.rewindToState(partial);
+    BOOST_CHECK_EQUAL(bcRef.number(), 1);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,172 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file BlockParallelSync.cpp
+ * Tests that Block::sync() builds the same block whether or not it speculates transactions in parallel.
+ */
+
+#include <libethereum/Block.h>
+#include <libethereum/TransactionQueue.h>
+#include <libdevcore/SHA3.h>
+#include <test/tools/libtesteth/TestHelper.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
+#include <test/tools/libtesteth/Options.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace utf = boost::unit_test;
+
+namespace
+{
+
+Secret const c_richSecret("0x45a915e4d060149eb4365960e6a7a45f334393093061116b197e3240065ff2d8");
+u256 const c_funding = 100000000;
+
+/// A block on top of genesis in which @a _senders accounts have been funded.
+class FundedBlock
+{
+public:
+	explicit FundedBlock(unsigned _senders):
+		m_chain(TestBlockChain::defaultGenesisBlock(100000000)),
+		m_block(m_chain.getInterface().genesisBlock(m_chain.testGenesis().state().db()))
+	{
+		for (unsigned i = 0; i < _senders; ++i)
+			m_senders.push_back(KeyPair(Secret(sha3("sender" + toString(i)))));
+
+		Transactions funding;
+		for (unsigned i = 0; i < _senders; ++i)
+			funding.push_back(Transaction(c_funding, 1, 21000, m_senders[i].address(), bytes(), i, c_richSecret));
+
+		m_block.setAuthor(Address(sha3("author")));
+		m_block.sync(chain());
+		sync(m_block, funding, 1);
+		BOOST_REQUIRE_EQUAL(m_block.pending().size(), _senders);
+	}
+
+	BlockChain const& chain() const { return m_chain.getInterface(); }
+	Block const& block() const { return m_block; }
+	KeyPair const& sender(unsigned _i) const { return m_senders.at(_i); }
+
+	void sync(Block& _block, Transactions const& _ts, unsigned _threads) const
+	{
+		TransactionQueue tq;
+		for (auto const& t: _ts)
+			tq.import(t.rlp());
+		ZeroGasPricer gp;
+		_block.setSyncThreads(_threads);
+		_block.sync(chain(), tq, gp, 60000);
+	}
+
+private:
+	TestBlockChain m_chain;
+	Block m_block;
+	vector<KeyPair> m_senders;
+};
+
+void checkSameBlock(Block const& _serial, Block const& _parallel)
+{
+	BOOST_REQUIRE_EQUAL(_serial.pending().size(), _parallel.pending().size());
+	BOOST_CHECK_EQUAL(_serial.state().rootHash(), _parallel.state().rootHash());
+	for (unsigned i = 0; i < _serial.pending().size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(_serial.pending()[i].sha3(), _parallel.pending()[i].sha3());
+		BOOST_CHECK(_serial.receipt(i).rlp() == _parallel.receipt(i).rlp());
+	}
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(BlockParallelSyncSuite, FrontierNoProofTestFixture)
+
+BOOST_AUTO_TEST_CASE(sameBlockAsSerial)
+{
+	unsigned const senders = 8;
+	FundedBlock funded(senders);
+	Address const shared(sha3("shared recipient"));
+
+	// Every sender pays the shared recipient twice, then pays the next sender,
+	// whose own transactions have to be executed again once that is merged.
+	Transactions ts;
+	for (unsigned i = 0; i < senders; ++i)
+	{
+		Secret const& s = funded.sender(i).secret();
+		ts.push_back(Transaction(1000 + i, 1, 21000, shared, bytes(), 0, s));
+		ts.push_back(Transaction(10, 1, 21000, shared, bytes(), 1, s));
+		ts.push_back(Transaction(7, 1, 21000, funded.sender((i + 1) % senders).address(), bytes(), 2, s));
+	}
+
+	Block serial = funded.block();
+	funded.sync(serial, ts, 1);
+	BOOST_REQUIRE_EQUAL(serial.pending().size(), senders * 4);
+
+	for (unsigned threads: {2, 4, 8})
+	{
+		Block parallel = funded.block();
+		funded.sync(parallel, ts, threads);
+		checkSameBlock(serial, parallel);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(failedTransactionsAsSerial)
+{
+	FundedBlock funded(4);
+
+	// A nonce gap, a transfer the sender cannot afford and one more than the block's gas.
+	Transactions ts;
+	ts.push_back(Transaction(1, 1, 21000, Address(1), bytes(), 1, funded.sender(0).secret()));
+	ts.push_back(Transaction(c_funding * 2, 1, 21000, Address(2), bytes(), 0, funded.sender(1).secret()));
+	ts.push_back(Transaction(1, 1, 200000000, Address(3), bytes(), 0, funded.sender(2).secret()));
+	ts.push_back(Transaction(1, 1, 21000, Address(4), bytes(), 0, funded.sender(3).secret()));
+
+	Block serial = funded.block();
+	funded.sync(serial, ts, 1);
+	Block parallel = funded.block();
+	funded.sync(parallel, ts, 4);
+	checkSameBlock(serial, parallel);
+}
+
+BOOST_AUTO_TEST_CASE(PerfParallelSync, *utf::label("perf"))
+{
+	if (!test::Options::get().all)
+	{
+		std::cout << "Skipping test BlockParallelSyncSuite/PerfParallelSync. Use --all to run it.\n";
+		return;
+	}
+
+	unsigned const senders = 64;
+	unsigned const perSender = 8;
+	FundedBlock funded(senders);
+
+	Transactions ts;
+	for (unsigned i = 0; i < senders; ++i)
+		for (unsigned n = 0; n < perSender; ++n)
+			ts.push_back(Transaction(1, 1, 21000, Address(sha3(toString(i * perSender + n))), bytes(), n, funded.sender(i).secret()));
+
+	for (unsigned threads: {1, 2, 4, 8})
+	{
+		Block block = funded.block();
+		auto start = chrono::steady_clock::now();
+		funded.sync(block, ts, threads);
+		double const ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		BOOST_CHECK_EQUAL(block.pending().size(), senders * (perSender + 1));
+		std::cout << threads << " threads: " << ts.size() << " transfers in " << ms << "ms, " << ts.size() * 1000 / ms << " tx/s\n";
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file BlockRing.cpp
+ * Tests for the pending block store used by BlockChainRequest.
+ */
+
+#include <libethereum/BlockChainRequest.h>
+#include <libdevcore/RLP.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+vector<unsigned> heldNumbers(BlockRing const& _ring)
+{
+	vector<unsigned> ret;
+	if (_ring.empty())
+		return ret;
+	unsigned n = _ring.first();
+	do
+		ret.push_back(n);
+	while (_ring.next(n));
+	return ret;
+}
+}
+
+BOOST_FIXTURE_TEST_SUITE(BlockRingSuite, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(orderAcrossWindow)
+{
+	BlockRing ring;
+	unsigned far = 10 + BlockRing::c_size * 3;
+	for (unsigned n: {12u, far, 10u, 11u, 20u})
+		ring.insert(n).hash = h256(n);
+
+	BOOST_CHECK_EQUAL(ring.size(), 5u);
+	BOOST_CHECK_EQUAL(ring.first(), 10u);
+	BOOST_CHECK_EQUAL(ring.last(), far);
+	BOOST_CHECK(heldNumbers(ring) == vector<unsigned>({10, 11, 12, 20, far}));
+	BOOST_CHECK(!ring.find(13));
+	BOOST_REQUIRE(ring.find(far));
+	BOOST_CHECK_EQUAL(ring.find(far)->hash, h256(far));
+
+	// a number below the window pushes the top of it into the overflow
+	unsigned low = 30;
+	unsigned high = low + BlockRing::c_size;
+	ring.insert(high).hash = h256(high);
+	for (unsigned n = 10; n <= 20; ++n)
+		ring.erase(n);
+	BOOST_CHECK_EQUAL(ring.first(), high);
+	ring.insert(low);
+	BOOST_CHECK(heldNumbers(ring) == vector<unsigned>({low, high, far}));
+
+	// dropping the bottom brings the overflow back into the window
+	ring.erase(low);
+	BOOST_CHECK_EQUAL(ring.first(), high);
+	BOOST_REQUIRE(ring.find(high));
+	BOOST_CHECK_EQUAL(ring.find(high)->hash, h256(high));
+	ring.erase(far);
+	BOOST_CHECK_EQUAL(ring.last(), high);
+	ring.erase(high);
+	BOOST_CHECK(ring.empty());
+}
+
+BOOST_AUTO_TEST_CASE(assembledBlockMatchesRLPStream)
+{
+	BlockRing ring;
+	for (size_t txSize: {1u, 100u})
+	{
+		bytes head = rlpList(u256(1), bytes(txSize < 10 ? 4 : 40, 3));
+		RLPStream txs(1);
+		txs << bytes(txSize, 7);
+		RLPStream body(2);
+		body.appendRaw(txs.out());
+		body.appendRaw(RLPEmptyList);
+
+		RLPStream expected(3);
+		expected.appendRaw(head);
+		expected.appendRaw(txs.out());
+		expected.appendRaw(RLPEmptyList);
+
+		BlockSlot& slot = ring.insert(unsigned(txSize));
+		ring.storeHead(slot, &head);
+		BOOST_CHECK(!slot.hasBody());
+		ring.storeBody(slot, RLP(body.out()).payload());
+		BOOST_CHECK(slot.hasBody());
+		BOOST_CHECK(ring.block(slot).toBytes() == expected.out());
+		BOOST_CHECK(ring.head(slot).toBytes() == head);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
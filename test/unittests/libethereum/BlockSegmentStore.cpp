@@ -0,0 +1,135 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file BlockSegmentStore.cpp
+ * BlockSegmentStore tests.
+ */
+
+#include <libethereum/BlockSegmentStore.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libdevcore/TransientDirectory.h>
+#include <test/tools/libtesteth/TestHelper.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+
+/// A block-shaped RLP: [header, transactions, uncles].
+bytes makeBlock(unsigned _number, unsigned _transactions)
+{
+    RLPStream s(3);
+    s.appendList(2) << _number << "header";
+    s.appendList(_transactions);
+    for (unsigned i = 0; i < _transactions; ++i)
+        s.appendList(2) << _number << string(40 + i, 'a' + i);
+    s.appendList(0);
+    return s.out();
+}
+
+h256 hashOf(bytes const& _block)
+{
+    return sha3(RLP(_block)[0].data());
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(BlockSegmentStoreSuite, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(appendAndRead)
+{
+    TransientDirectory dir;
+    BlockSegmentStore store(dir.path());
+    vector<bytes> blocks;
+    for (unsigned i = 1; i <= 3; ++i)
+    {
+        blocks.push_back(makeBlock(i, i));
+        BOOST_CHECK(store.append(i, &blocks.back()));
+    }
+    BOOST_CHECK(!store.append(3, &blocks.back()));
+    BOOST_CHECK_EQUAL(store.size(), 3);
+    BOOST_CHECK_EQUAL(store.lastNumber(), 3);
+
+    for (auto const& b: blocks)
+    {
+        BOOST_CHECK(store.block(hashOf(b)).toBytes() == b);
+        RLP const transactions = RLP(b)[1];
+        for (unsigned i = 0; i < transactions.itemCount(); ++i)
+            BOOST_CHECK(store.transaction(hashOf(b), i).toBytes() == transactions[i].data().toBytes());
+        BOOST_CHECK(store.transaction(hashOf(b), transactions.itemCount()).empty());
+    }
+    BOOST_CHECK(store.block(h256(1)).empty());
+}
+
+BOOST_AUTO_TEST_CASE(reopenAcrossSegments)
+{
+    TransientDirectory dir;
+    vector<bytes> blocks;
+    {
+        BlockSegmentStore store(dir.path(), 512);
+        for (unsigned i = 1; i <= 10; ++i)
+        {
+            blocks.push_back(makeBlock(i, 2));
+            BOOST_REQUIRE(store.append(i, &blocks.back()));
+        }
+    }
+    BOOST_CHECK(boost::filesystem::exists(dir.path() + "/000001.seg"));
+
+    BlockSegmentStore store(dir.path(), 512);
+    BOOST_CHECK_EQUAL(store.size(), 10);
+    BOOST_CHECK_EQUAL(store.lastNumber(), 10);
+    for (auto const& b: blocks)
+    {
+        BOOST_CHECK(store.block(hashOf(b)).toBytes() == b);
+        BOOST_CHECK(store.transaction(hashOf(b), 1).toBytes() == RLP(b)[1][1].data().toBytes());
+    }
+
+    bytes const next = makeBlock(11, 1);
+    BOOST_CHECK(store.append(11, &next));
+    BOOST_CHECK(store.block(hashOf(next)).toBytes() == next);
+}
+
+BOOST_AUTO_TEST_CASE(damagedTailIsDropped)
+{
+    TransientDirectory dir;
+    bytes const first = makeBlock(1, 1);
+    bytes const second = makeBlock(2, 1);
+    {
+        BlockSegmentStore store(dir.path());
+        store.append(1, &first);
+        store.append(2, &second);
+    }
+    {
+        fstream segment(dir.path() + "/000000.seg", ios::in | ios::out | ios::binary);
+        segment.seekp(first.size() + 4);
+        segment.write("\xff\xff\xff\xff", 4);
+    }
+
+    BlockSegmentStore store(dir.path());
+    BOOST_CHECK_EQUAL(store.size(), 1);
+    BOOST_CHECK(store.block(hashOf(first)).toBytes() == first);
+    BOOST_CHECK(store.block(hashOf(second)).empty());
+    BOOST_CHECK(store.append(2, &second));
+    BOOST_CHECK(store.block(hashOf(second)).toBytes() == second);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -54,6 +54,40 @@ BOOST_AUTO_TEST_CASE(LoadAccountCode)
 	));
 }
 
+BOOST_AUTO_TEST_CASE(StorageCommittedAtOnceMatchesOneByOne)
+{
+	// One commit of all the writes is enough for the storage tries to be rehashed in parallel;
+	// committing one account at a time is not.
+	State together{0};
+	State oneByOne{0};
+	for (unsigned round = 0; round < 2; ++round)
+	{
+		for (unsigned a = 0; a < 8; ++a)
+		{
+			Address const addr(a + 1);
+			if (round == 0)
+			{
+				together.addBalance(addr, 1);
+				oneByOne.addBalance(addr, 1);
+			}
+			for (unsigned k = 0; k < 64; ++k)
+			{
+				// The second round overwrites half of the slots and clears the rest.
+				u256 const value = round == 0 ? u256(a * 1000 + k + 1) : (k % 2 ? u256(k) : u256(0));
+				together.setStorage(addr, k, value);
+				oneByOne.setStorage(addr, k, value);
+			}
+			oneByOne.commit(State::CommitBehaviour::KeepEmptyAccounts);
+		}
+		together.commit(State::CommitBehaviour::KeepEmptyAccounts);
+
+		BOOST_REQUIRE_EQUAL(together.rootHash(), oneByOne.rootHash());
+		for (unsigned a = 0; a < 8; ++a)
+			BOOST_CHECK_EQUAL(together.storageRoot(Address(a + 1)), oneByOne.storageRoot(Address(a + 1)));
+		BOOST_CHECK_EQUAL(together.storage(Address(3), 5), oneByOne.storage(Address(3), 5));
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
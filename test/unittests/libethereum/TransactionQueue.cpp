@@ -282,6 +282,121 @@ BOOST_AUTO_TEST_CASE(tqLimit)
 	BOOST_REQUIRE(topTr.size() == 1); // 1 imported transaction
 }
 
+BOOST_AUTO_TEST_CASE(tqBatchImport)
+{
+	TransactionQueue tq;
+	const u256 gasCost = 20 * szabo;
+	const u256 gas = 25000;
+	Address dest = Address("0x095e7baea6a6c7c4c2dfeb977efac326af552d87");
+	Secret sender1 = Secret("0x3333333333333333333333333333333333333333333333333333333333333333");
+	Secret sender2 = Secret("0x4444444444444444444444444444444444444444444444444444444444444444");
+	Transaction tx0(0, gasCost, gas, dest, bytes(), 0, sender1);
+	Transaction tx1(0, gasCost, gas, dest, bytes(), 1, sender1);
+	Transaction tx2(0, gasCost, gas, dest, bytes(), 0, sender2);
+	Transaction tx2Cheaper(1, gasCost - 1, gas, dest, bytes(), 0, sender2);
+	bytes malformed = tx0.rlp();
+	malformed.at(0) = 03;
+
+	vector<ImportResult> results = tq.import(vector<bytes>{tx0.rlp(), tx1.rlp(), malformed, tx2.rlp(), tx0.rlp(), tx2Cheaper.rlp()});
+	BOOST_REQUIRE_EQUAL(results.size(), 6u);
+	BOOST_CHECK(results[0] == ImportResult::Success);
+	BOOST_CHECK(results[1] == ImportResult::Success);
+	BOOST_CHECK(results[2] == ImportResult::Malformed);
+	BOOST_CHECK(results[3] == ImportResult::Success);
+	BOOST_CHECK(results[4] == ImportResult::AlreadyKnown);
+	BOOST_CHECK(results[5] == ImportResult::OverbidGasPrice);
+
+	Transactions top = tq.topTransactions(256);
+	BOOST_REQUIRE_EQUAL(top.size(), 3u);
+	BOOST_CHECK_EQUAL(top[2].sha3(), tx1.sha3());
+	BOOST_CHECK_EQUAL(tq.status().current, 3u);
+
+	tq.drop(tx0.sha3());
+	BOOST_CHECK(tq.import(vector<bytes>{tx0.rlp()}) == vector<ImportResult>{ImportResult::AlreadyInChain});
+	BOOST_CHECK(tq.import(vector<bytes>{tx0.rlp()}, IfDropped::Retry) == vector<ImportResult>{ImportResult::Success});
+
+	// A signature which recovers no sender is malformed, not queued under the zero address.
+	bytes const badSignature = withUnrecoverableSignature(Transaction(0, gasCost, gas, dest, bytes(), 2, sender1));
+	BOOST_CHECK(tq.import(vector<bytes>{badSignature}) == vector<ImportResult>{ImportResult::Malformed});
+	BOOST_CHECK(tq.import(badSignature) == ImportResult::Malformed);
+	BOOST_CHECK(tq.import(Transaction(badSignature, CheckTransaction::Cheap)) == ImportResult::Malformed);
+	BOOST_CHECK_EQUAL(tq.status().current, 3u);
+
+	// Large enough for the verifier threads to help.
+	vector<bytes> batch;
+	for (unsigned i = 0; i < 256; ++i)
+		batch.push_back(Transaction(0, gasCost, gas, dest, bytes(), 0, Secret(sha3("batch" + toString(i)))).rlp());
+	batch[100] = withUnrecoverableSignature(Transaction(batch[100], CheckTransaction::Everything));
+	results = tq.import(batch);
+	vector<ImportResult> expected(batch.size(), ImportResult::Success);
+	expected[100] = ImportResult::Malformed;
+	BOOST_CHECK(results == expected);
+	BOOST_CHECK_EQUAL(tq.status().current, 258u);
+	for (auto const& t: tq.topTransactions(512))
+		BOOST_CHECK(t.sender() != ZeroAddress);
+}
+
+BOOST_AUTO_TEST_CASE(tqBatchOverLimit)
+{
+	unsigned const senders = 32;
+	unsigned const limit = 8;
+	TransactionQueue tq(limit, limit);
+	Address dest = Address("0x095e7baea6a6c7c4c2dfeb977efac326af552d87");
+
+	// Second nonces are dropped first, then the cheapest first nonces.
+	vector<bytes> batch;
+	for (unsigned i = 0; i < senders; ++i)
+	{
+		Secret const secret(sha3("limit" + toString(i)));
+		batch.push_back(Transaction(0, szabo + i, 25000, dest, bytes(), 0, secret).rlp());
+		batch.push_back(Transaction(0, szabo + i, 25000, dest, bytes(), 1, secret).rlp());
+	}
+	tq.import(batch);
+
+	Transactions top = tq.topTransactions(senders * 2);
+	BOOST_REQUIRE_EQUAL(top.size(), limit);
+	BOOST_CHECK_EQUAL(tq.status().current, limit);
+	for (unsigned i = 0; i < top.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(top[i].nonce(), 0);
+		BOOST_CHECK_EQUAL(top[i].gasPrice(), szabo + senders - 1 - i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(tqConcurrentImport)
+{
+	unsigned const senders = 16;
+	unsigned const perSender = 8;
+	TransactionQueue tq(senders * perSender, 1024);
+	Address dest = Address("0x095e7baea6a6c7c4c2dfeb977efac326af552d87");
+
+	vector<thread> importers;
+	vector<Address> from(senders);
+	for (unsigned i = 0; i < senders; ++i)
+		importers.emplace_back([&, i]()
+		{
+			KeyPair key(Secret(sha3("sender" + toString(i))));
+			from[i] = key.address();
+			for (unsigned n = 0; n < perSender; ++n)
+				tq.import(Transaction(0, szabo, 25000, dest, bytes(), perSender - 1 - n, key.secret()));
+		});
+	for (auto& t: importers)
+		t.join();
+
+	BOOST_CHECK_EQUAL(tq.status().current, senders * perSender);
+	for (unsigned i = 0; i < senders; ++i)
+	{
+		BOOST_CHECK_EQUAL(tq.waiting(from[i]), perSender);
+		BOOST_CHECK_EQUAL(tq.maxNonce(from[i]), perSender);
+	}
+
+	// All first nonces come before any second one.
+	Transactions top = tq.topTransactions(senders * perSender);
+	BOOST_REQUIRE_EQUAL(top.size(), senders * perSender);
+	for (unsigned i = 0; i < top.size(); ++i)
+		BOOST_CHECK_EQUAL(top[i].nonce(), i / senders);
+}
+
 BOOST_AUTO_TEST_CASE(tqEqueue)
 {
 	TransactionQueue tq;
@@ -0,0 +1,214 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file Arith256.cpp
+ * Cross-checks the fixed-width 256-bit kernels against boost::multiprecision.
+ */
+
+#include <libevm/Arith256.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+#include <random>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+u256 const c_max = ~u256(0);
+u256 const c_hibit = u256(1) << 255;
+
+/// Random words of every width, with the edge cases mixed in.
+class Words
+{
+public:
+    u256 next()
+    {
+        switch (m_rng() % 8)
+        {
+        case 0:
+        {
+            static u256 const edges[] = {0, 1, 2, c_max, c_max - 1, c_hibit, c_hibit - 1,
+                c_hibit + 1, u256(1) << 64, (u256(1) << 64) - 1, u256(1) << 128, u256(1) << 192};
+            return edges[m_rng() % (sizeof(edges) / sizeof(edges[0]))];
+        }
+        default:
+        {
+            u256 ret = 0;
+            unsigned limbs = 1 + m_rng() % 4;
+            for (unsigned i = 0; i < limbs; ++i)
+                ret = (ret << 64) | u256(m_rng());
+            // thin out some limbs to reach the short division and normalisation paths
+            if (m_rng() % 3 == 0)
+                ret &= ~(u256(0xffffffff) << (32 * (m_rng() % 8)));
+            return ret;
+        }
+        }
+    }
+
+private:
+    mt19937_64 m_rng{1234};
+};
+
+u256 sdivReference(u256 const& _a, u256 const& _b)
+{
+    return _b ? s2u(s256(s512(u2s(_a)) / s512(u2s(_b)))) : 0;
+}
+
+u256 smodReference(u256 const& _a, u256 const& _b)
+{
+    return _b ? s2u(s256(s512(u2s(_a)) % s512(u2s(_b)))) : 0;
+}
+
+u256 expReference(u256 _base, u256 _exponent)
+{
+    u256 result = 1;
+    while (_exponent)
+    {
+        if (static_cast<boost::multiprecision::limb_type>(_exponent) & 1)
+            result *= _base;
+        _base *= _base;
+        _exponent >>= 1;
+    }
+    return result;
+}
+
+u256 sarReference(u256 const& _a, unsigned _shift)
+{
+    bool negative = (_a & c_hibit) != 0;
+    if (_shift >= 256)
+        return negative ? c_max : 0;
+    u256 ret = _a >> _shift;
+    if (negative && _shift)
+        ret |= c_max << (256 - _shift);
+    return ret;
+}
+
+unsigned const c_rounds = 20000;
+}
+
+BOOST_FIXTURE_TEST_SUITE(Arith256Tests, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(roundTrip)
+{
+    Words words;
+    for (unsigned i = 0; i < c_rounds; ++i)
+    {
+        u256 a = words.next();
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::toWord(a)), a);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(addSubMul)
+{
+    Words words;
+    for (unsigned i = 0; i < c_rounds; ++i)
+    {
+        u256 a = words.next();
+        u256 b = words.next();
+        auto wa = arith::toWord(a);
+        auto wb = arith::toWord(b);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::add(wa, wb)), u256(a + b));
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::sub(wa, wb)), u256(a - b));
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::mul(wa, wb)), u256(a * b));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(division)
+{
+    Words words;
+    for (unsigned i = 0; i < c_rounds; ++i)
+    {
+        u256 a = words.next();
+        u256 b = words.next();
+        auto wa = arith::toWord(a);
+        auto wb = arith::toWord(b);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::div(wa, wb)), b ? u256(a / b) : 0);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::mod(wa, wb)), b ? u256(a % b) : 0);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::sdiv(wa, wb)), sdivReference(a, b));
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::smod(wa, wb)), smodReference(a, b));
+    }
+    // the one signed overflow wraps
+    BOOST_CHECK_EQUAL(arith::fromWord(arith::sdiv(arith::toWord(c_hibit), arith::toWord(c_max))), c_hibit);
+}
+
+BOOST_AUTO_TEST_CASE(modularArithmetic)
+{
+    Words words;
+    for (unsigned i = 0; i < c_rounds; ++i)
+    {
+        u256 a = words.next();
+        u256 b = words.next();
+        u256 m = words.next();
+        auto wa = arith::toWord(a);
+        auto wb = arith::toWord(b);
+        auto wm = arith::toWord(m);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::addmod(wa, wb, wm)),
+            m ? u256((u512(a) + u512(b)) % m) : 0);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::mulmod(wa, wb, wm)),
+            m ? u256((u512(a) * u512(b)) % m) : 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(exponentiation)
+{
+    Words words;
+    for (unsigned i = 0; i < c_rounds / 10; ++i)
+    {
+        u256 base = words.next();
+        u256 exponent = words.next();
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::exp(arith::toWord(base), arith::toWord(exponent))),
+            expReference(base, exponent));
+    }
+    BOOST_CHECK_EQUAL(arith::fromWord(arith::exp(arith::toWord(0), arith::toWord(0))), 1);
+}
+
+BOOST_AUTO_TEST_CASE(comparisonsAndShifts)
+{
+    Words words;
+    for (unsigned i = 0; i < c_rounds; ++i)
+    {
+        u256 a = words.next();
+        u256 b = words.next();
+        unsigned shift = i % 300;
+        auto wa = arith::toWord(a);
+        auto wb = arith::toWord(b);
+        BOOST_REQUIRE_EQUAL(arith::lt(wa, wb), a < b);
+        BOOST_REQUIRE_EQUAL(arith::slt(wa, wb), u2s(a) < u2s(b));
+        BOOST_REQUIRE_EQUAL(arith::eq(wa, wb), a == b);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::shl(wa, shift)), shift < 256 ? u256(a << shift) : 0);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::shr(wa, shift)), shift < 256 ? u256(a >> shift) : 0);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::shr(wa, shift, true)), sarReference(a, shift));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(notAndByte)
+{
+    Words words;
+    for (unsigned i = 0; i < c_rounds; ++i)
+    {
+        u256 a = words.next();
+        unsigned index = i % 40;
+        auto wa = arith::toWord(a);
+        BOOST_REQUIRE_EQUAL(arith::fromWord(arith::bitNot(wa)), ~a);
+        BOOST_REQUIRE_EQUAL(arith::byteAt(wa, index),
+            index < 32 ? u256((a >> (8 * (31 - index))) & 0xff) : 0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
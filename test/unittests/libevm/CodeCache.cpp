@@ -0,0 +1,295 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file CodeCache.cpp
+ * Tests for the cache of analysed EVM code.
+ */
+
+#include <libevm/CodeCache.h>
+#include <libevm/Instruction.h>
+#include <libevm/interpreter.h>
+#include <libdevcore/SHA3.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <map>
+#include <random>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+// PUSH1 4 JUMP INVALID JUMPDEST PUSH1 0x5b STOP JUMPDEST
+bytes const c_code = fromHex("600456fe5b605b005b");
+
+/// Storage of the minimal host the metering comparisons execute against.
+map<h256, h256> s_storage;
+
+void getStorage(evmc_uint256be* o_result, evmc_context*, evmc_address const*, evmc_uint256be const* _key)
+{
+    h256 const value = s_storage[h256(_key->bytes, h256::ConstructFromPointer)];
+    std::memcpy(o_result->bytes, value.data(), sizeof(o_result->bytes));
+}
+
+void setStorage(evmc_context*, evmc_address const*, evmc_uint256be const* _key, evmc_uint256be const* _value)
+{
+    s_storage[h256(_key->bytes, h256::ConstructFromPointer)] = h256(_value->bytes, h256::ConstructFromPointer);
+}
+
+void getTxContext(evmc_tx_context* o_result, evmc_context*)
+{
+    std::memset(o_result, 0, sizeof(*o_result));
+    o_result->block_number = 5;
+}
+
+evmc_context_fn_table const c_fnTable = {
+    nullptr,
+    getStorage,
+    setStorage,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    getTxContext,
+    nullptr,
+    nullptr,
+};
+
+struct Outcome
+{
+    evmc_status_code status;
+    int64_t gasLeft;
+    bytes output;
+};
+
+/// Runs @a _code with a fresh interpreter using the given metering mode.
+Outcome execute(bytes const& _code, int64_t _gas, char const* _metering)
+{
+    s_storage.clear();
+    evmc_context context{&c_fnTable};
+    evmc_instance* vm = evmc_create_interpreter();
+    BOOST_REQUIRE(vm->set_option(vm, "metering", _metering));
+
+    evmc_message msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.gas = _gas;
+    h256 const hash = sha3(_code);
+    std::memcpy(msg.code_hash.bytes, hash.data(), sizeof(msg.code_hash.bytes));
+
+    evmc_result result = vm->execute(vm, &context, EVMC_BYZANTIUM, &msg, _code.data(), _code.size());
+    Outcome outcome{result.status_code, result.gas_left,
+        bytes(result.output_data, result.output_data + result.output_size)};
+    if (result.release)
+        result.release(&result);
+    vm->destroy(vm);
+    return outcome;
+}
+
+/// Block metering charges a basic block up front; it must never change what a
+/// transaction observes compared with charging each instruction as it runs.
+void checkSameOutcome(bytes const& _code, int64_t _gas)
+{
+    Outcome const instruction = execute(_code, _gas, "instruction");
+    Outcome const block = execute(_code, _gas, "block");
+    BOOST_TEST_INFO(toHex(_code) << " with gas " << _gas);
+    BOOST_CHECK_EQUAL(instruction.status, block.status);
+    BOOST_CHECK_EQUAL(instruction.gasLeft, block.gasLeft);
+    BOOST_CHECK(instruction.output == block.output);
+}
+}
+
+BOOST_FIXTURE_TEST_SUITE(CodeCacheTests, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(jumpDestsSkipPushData)
+{
+    auto analysis = analyseCode(&c_code);
+    BOOST_REQUIRE_EQUAL(analysis->jumpDests.size(), 2);
+    BOOST_CHECK_EQUAL(analysis->jumpDests[0], 4);
+    BOOST_CHECK_EQUAL(analysis->jumpDests[1], 8);
+    BOOST_CHECK(analysis->isJumpDest(4));
+    BOOST_CHECK(!analysis->isJumpDest(6));
+    BOOST_CHECK(!analysis->isJumpDest(u256(1) << 64));
+    BOOST_CHECK_EQUAL(analysis->originalSize, c_code.size());
+    BOOST_CHECK_EQUAL(analysis->code.size(), c_code.size() + 33);
+}
+
+BOOST_AUTO_TEST_CASE(basicBlocksEndAtJumpsAndPricedOps)
+{
+    auto analysis = analyseCode(&c_code);
+    BOOST_REQUIRE_EQUAL(analysis->blocks.size(), 2);
+    BOOST_REQUIRE_EQUAL(analysis->blockAt[0], 1);
+    BOOST_CHECK_EQUAL(analysis->blockAt[2], 0);
+    BOOST_REQUIRE_EQUAL(analysis->blockAt[5], 2);
+
+    // PUSH1 JUMP
+    BasicBlock const& first = analysis->blocks[0];
+    BOOST_CHECK_EQUAL(first.length, 3);
+    BOOST_CHECK_EQUAL(first.gas, 3 + 8);
+    BOOST_CHECK_EQUAL(first.stackRequired, 0);
+    BOOST_CHECK_EQUAL(first.stackMaxGrowth, 1);
+
+    // PUSH1, then STOP prices itself
+    BasicBlock const& second = analysis->blocks[1];
+    BOOST_CHECK_EQUAL(second.length, 2);
+    BOOST_CHECK_EQUAL(second.gas, 3);
+}
+
+BOOST_AUTO_TEST_CASE(basicBlockStackBounds)
+{
+    // ADD ADD DUP1 DUP1 POP JUMPI
+    bytes code = fromHex("010180805057");
+    auto analysis = analyseCode(&code);
+    BOOST_REQUIRE_EQUAL(analysis->blocks.size(), 1);
+    BasicBlock const& block = analysis->blocks[0];
+    BOOST_CHECK_EQUAL(block.length, code.size());
+    BOOST_CHECK_EQUAL(block.stackRequired, 3);
+    BOOST_CHECK_EQUAL(block.stackMaxGrowth, 0);
+    BOOST_CHECK_EQUAL(block.gas, 3 + 3 + 3 + 3 + 2 + 10);
+}
+
+BOOST_AUTO_TEST_CASE(syntheticOpsAreInvalid)
+{
+    bytes code = {byte(Instruction::PUSHC), byte(Instruction::JUMPC), byte(Instruction::STOP)};
+    auto analysis = analyseCode(&code);
+    BOOST_CHECK_EQUAL(analysis->code[0], byte(Instruction::INVALID));
+    BOOST_CHECK_EQUAL(analysis->code[1], byte(Instruction::INVALID));
+    BOOST_CHECK_EQUAL(analysis->code[2], byte(Instruction::STOP));
+}
+
+BOOST_AUTO_TEST_CASE(sameHashIsShared)
+{
+    CodeCache cache(1024 * 1024);
+    h256 hash = sha3(c_code);
+    auto first = cache.analysis(hash, &c_code);
+    auto second = cache.analysis(hash, &c_code);
+    BOOST_CHECK_EQUAL(first.get(), second.get());
+    BOOST_CHECK_EQUAL(cache.stats().hits, 1);
+    BOOST_CHECK_EQUAL(cache.stats().misses, 1);
+    BOOST_CHECK_EQUAL(cache.stats().entries, 1);
+}
+
+BOOST_AUTO_TEST_CASE(zeroHashIsNotCached)
+{
+    CodeCache cache(1024 * 1024);
+    auto first = cache.analysis(h256(), &c_code);
+    auto second = cache.analysis(h256(), &c_code);
+    BOOST_CHECK(first.get() != second.get());
+    BOOST_CHECK_EQUAL(cache.stats().entries, 0);
+}
+
+BOOST_AUTO_TEST_CASE(leastRecentlyUsedIsEvicted)
+{
+    size_t const entrySize = analyseCode(&c_code)->memoryUsed();
+    CodeCache cache(entrySize * 2);
+    h256 a(1), b(2), c(3);
+    auto analysisA = cache.analysis(a, &c_code);
+    cache.analysis(b, &c_code);
+    cache.analysis(a, &c_code);
+    cache.analysis(c, &c_code);
+
+    BOOST_CHECK_EQUAL(cache.stats().entries, 2);
+    BOOST_CHECK_LE(cache.stats().used, entrySize * 2);
+    BOOST_CHECK_EQUAL(cache.analysis(a, &c_code).get(), analysisA.get());
+    BOOST_CHECK_EQUAL(cache.stats().misses, 3);
+
+    cache.setCapacity(0);
+    BOOST_CHECK_EQUAL(cache.stats().entries, 0);
+    BOOST_CHECK_EQUAL(cache.stats().used, 0);
+}
+
+BOOST_AUTO_TEST_CASE(blockMeteringMatchesAtEdgeCases)
+{
+    vector<bytes> const programs = {
+        // PUSH1 1 PUSH1 2 ADD PUSH1 0 MSTORE PUSH1 32 PUSH1 0 RETURN: out of gas at every step
+        fromHex("600160020160005260206000f3"),
+        // PUSH1 1 PUSH1 2 ADD PUSH1 0 SSTORE PUSH1 0 SLOAD STOP: out of gas around the store
+        fromHex("600160020160005560005400"),
+        // PUSH1 1 PUSH1 2 ADD ADD STOP: stack underflow in the middle of a block
+        fromHex("600160020101" "00"),
+        // PUSH1 1 PUSH1 0 MSTORE POP POP: underflow after a priced memory expansion
+        fromHex("6001600052505000"),
+        // JUMPDEST PUSH1 1 PUSH1 2 PUSH1 0 JUMP: grows the stack until it overflows mid-block
+        fromHex("5b60016002600056"),
+        // PUSH1 3 JUMP INVALID: jump to a non-JUMPDEST
+        fromHex("600356fe"),
+        // PUSH1 4 JUMP PUSH1 0x5b STOP: jump into push data
+        fromHex("600456605b00"),
+        // PUSH1 1 PUSH1 6 JUMPI PUSH1 0x5b STOP: conditional jump into push data
+        fromHex("6001600657605b00"),
+        // PUSH1 2 PUSH1 3 MUL PUSH1 0 MSTORE PUSH1 32 PUSH1 0 REVERT
+        fromHex("600260030260005260206000fd"),
+    };
+    for (bytes const& code: programs)
+        for (int64_t gas = 0; gas < 100; ++gas)
+        {
+            checkSameOutcome(code, gas);
+            checkSameOutcome(code, 20000 + gas);
+        }
+
+    // PUSH1 0 x 1023 followed by a block that pushes past the limit of 1024
+    bytes overflow;
+    for (int i = 0; i < 1023; ++i)
+        overflow += fromHex("6000");
+    overflow += fromHex("5b600160016001" "00");
+    checkSameOutcome(overflow, 1000000);
+    checkSameOutcome(overflow, 1023 * 3 + 4);
+}
+
+BOOST_AUTO_TEST_CASE(blockMeteringChargesEveryLoopIteration)
+{
+    // JUMPDEST PUSH1 0 JUMP: a loop whose body is one basic block runs out of gas
+    Outcome const loop = execute(fromHex("5b600056"), 100000, "block");
+    BOOST_CHECK_EQUAL(loop.status, EVMC_FAILURE);
+    BOOST_CHECK_EQUAL(loop.gasLeft, 0);
+    checkSameOutcome(fromHex("5b600056"), 100000);
+
+    // JUMPDEST PUSH1 1 PUSH1 0 JUMP: the same loop, overflowing the stack long before the gas ends
+    Outcome const growing = execute(fromHex("5b6001600056"), 1000000, "block");
+    BOOST_CHECK_EQUAL(growing.status, EVMC_FAILURE);
+    checkSameOutcome(fromHex("5b6001600056"), 1000000);
+
+    // PUSH1 0 JUMPDEST PUSH1 1 ADD PUSH1 2 JUMP: jumps back into the middle of its block
+    checkSameOutcome(fromHex("60005b600101600256"), 100000);
+}
+
+BOOST_AUTO_TEST_CASE(blockMeteringMatchesOnRandomCode)
+{
+    bytes const ops = fromHex(
+        "0102030410111415161718191a" "505152535455565758595a5b5b"
+        "60606061617f808185909100f3fd30363839" "0a20fe8f9f");
+    mt19937 rng(42);
+    for (int i = 0; i < 2000; ++i)
+    {
+        bytes code;
+        for (unsigned p = rng() % 6; p > 0; --p)
+            code += bytes{0x60, byte(rng() % 40)};
+        for (unsigned n = 1 + rng() % 60; n > 0; --n)
+        {
+            byte const op = ops[rng() % ops.size()];
+            code.push_back(op);
+            if (op >= byte(Instruction::PUSH1) && op <= byte(Instruction::PUSH32))
+                for (int k = 0; k <= op - byte(Instruction::PUSH1); ++k)
+                    code.push_back(byte(rng() % 4 ? rng() % 8 : rng() % 64));
+        }
+        checkSameOutcome(code, rng() % 3 ? rng() % 200 : rng() % 100000);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
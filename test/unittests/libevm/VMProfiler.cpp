@@ -0,0 +1,201 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file VMProfiler.cpp
+ * Tests for the interpreter profiler's counting and gas attribution.
+ */
+
+#include <libevm/VMProfiler.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+Address const c_caller{0xca11e4};
+Address const c_callee{0xca11ee};
+
+/// Enables a clean profiler for a test case and switches it off again afterwards.
+struct ProfilerFixture: TestOutputHelperFixture
+{
+    ProfilerFixture()
+    {
+        VMProfiler::get().reset();
+        VMProfiler::get().setSampleInterval(0);
+        VMProfiler::get().setEnabled(true);
+    }
+    ~ProfilerFixture()
+    {
+        VMProfiler::get().setEnabled(false);
+        VMProfiler::get().setSampleInterval(64);
+        VMProfiler::get().reset();
+    }
+};
+
+uint64_t count(ProfileSnapshot const& _s, Instruction _op)
+{
+    return _s.ops[static_cast<uint8_t>(_op)].count;
+}
+}
+
+BOOST_FIXTURE_TEST_SUITE(VMProfilerTests, ProfilerFixture)
+
+BOOST_AUTO_TEST_CASE(disabledRecordsNothing)
+{
+    VMProfiler::get().setEnabled(false);
+    {
+        ProfileScope scope(c_caller, 1000);
+        BOOST_CHECK(!scope.active());
+        scope.finish(0);
+    }
+    ProfileSnapshot const s = VMProfiler::get().snapshot();
+    BOOST_CHECK(!s.enabled);
+    BOOST_CHECK(s.contracts.empty());
+}
+
+BOOST_AUTO_TEST_CASE(nestedFramesSplitGas)
+{
+    {
+        ProfileScope caller(c_caller, 1000);
+        BOOST_REQUIRE(caller.active());
+        caller.onOp(Instruction::SLOAD);
+        caller.onOp(Instruction::SSTORE);
+        caller.onOp(Instruction::CALL);
+        {
+            ProfileScope callee(c_callee, 300);
+            callee.onOp(Instruction::PUSH1);
+            callee.onOp(Instruction::SLOAD);
+            callee.onOp(Instruction::STOP);
+            callee.finish(100);
+        }
+        caller.onOp(Instruction::STOP);
+        caller.finish(400);
+    }
+
+    ProfileSnapshot const s = VMProfiler::get().snapshot();
+    BOOST_REQUIRE_EQUAL(s.contracts.size(), 2);
+    ContractProfile const& caller = s.contracts.at(c_caller);
+    BOOST_CHECK_EQUAL(caller.calls, 1);
+    BOOST_CHECK_EQUAL(caller.gas, 600);
+    BOOST_CHECK_EQUAL(caller.selfGas, 400);
+    BOOST_CHECK_EQUAL(caller.instructions, 4);
+    BOOST_CHECK_EQUAL(caller.sloads, 1);
+    BOOST_CHECK_EQUAL(caller.sstores, 1);
+
+    ContractProfile const& callee = s.contracts.at(c_callee);
+    BOOST_CHECK_EQUAL(callee.gas, 200);
+    BOOST_CHECK_EQUAL(callee.selfGas, 200);
+    BOOST_CHECK_EQUAL(callee.instructions, 3);
+    BOOST_CHECK_EQUAL(callee.sloads, 1);
+    BOOST_CHECK_EQUAL(callee.sstores, 0);
+
+    BOOST_CHECK_EQUAL(count(s, Instruction::SLOAD), 2);
+    BOOST_CHECK_EQUAL(count(s, Instruction::STOP), 2);
+    BOOST_CHECK_EQUAL(s.ops[static_cast<uint8_t>(Instruction::SLOAD)].samples, 0);
+}
+
+BOOST_AUTO_TEST_CASE(failedFrameUsesAllGas)
+{
+    {
+        ProfileScope scope(c_callee, 500);
+        scope.onOp(Instruction::INVALID);
+    }
+    BOOST_CHECK_EQUAL(VMProfiler::get().snapshot().contracts.at(c_callee).gas, 500);
+}
+
+BOOST_AUTO_TEST_CASE(samplingTimesEveryNthInstruction)
+{
+    VMProfiler::get().setSampleInterval(2);
+    {
+        ProfileScope scope(c_caller, 100);
+        for (unsigned i = 0; i < 10; ++i)
+            scope.onOp(i % 2 ? Instruction::MUL : Instruction::ADD);
+        scope.finish(0);
+    }
+    ProfileSnapshot const s = VMProfiler::get().snapshot();
+    BOOST_CHECK_EQUAL(s.sampleInterval, 2);
+    BOOST_CHECK_EQUAL(count(s, Instruction::ADD), 5);
+    BOOST_CHECK_EQUAL(count(s, Instruction::MUL), 5);
+    BOOST_CHECK_EQUAL(s.ops[static_cast<uint8_t>(Instruction::ADD)].samples, 0);
+    BOOST_CHECK_EQUAL(s.ops[static_cast<uint8_t>(Instruction::MUL)].samples, 5);
+}
+
+BOOST_AUTO_TEST_CASE(resetClears)
+{
+    {
+        ProfileScope scope(c_caller, 10);
+        scope.onOp(Instruction::ADD);
+    }
+    VMProfiler::get().reset();
+    ProfileSnapshot const s = VMProfiler::get().snapshot();
+    BOOST_CHECK(s.contracts.empty());
+    BOOST_CHECK_EQUAL(count(s, Instruction::ADD), 0);
+}
+
+BOOST_AUTO_TEST_CASE(snapshotAndResetTakesEverything)
+{
+    {
+        ProfileScope scope(c_caller, 10);
+        scope.onOp(Instruction::ADD);
+    }
+    ProfileSnapshot const taken = VMProfiler::get().snapshotAndReset();
+    BOOST_CHECK_EQUAL(taken.contracts.size(), 1);
+    BOOST_CHECK_EQUAL(count(taken, Instruction::ADD), 1);
+
+    ProfileSnapshot const s = VMProfiler::get().snapshot();
+    BOOST_CHECK(s.contracts.empty());
+    BOOST_CHECK_EQUAL(count(s, Instruction::ADD), 0);
+}
+
+BOOST_AUTO_TEST_CASE(estimatedTicksUseTheFramesInterval)
+{
+    VMProfiler::get().setSampleInterval(2);
+    {
+        ProfileScope scope(c_caller, 100);
+        VMProfiler::get().setSampleInterval(1000);
+        for (unsigned i = 0; i < 10; ++i)
+            scope.onOp(Instruction::ADD);
+        scope.finish(0);
+    }
+    ProfileSnapshot const s = VMProfiler::get().snapshot();
+    OpProfile const& add = s.ops[static_cast<uint8_t>(Instruction::ADD)];
+    BOOST_CHECK_EQUAL(add.samples, 5);
+    BOOST_CHECK_EQUAL(s.contracts.at(c_caller).estimatedTicks, add.ticks * 2);
+}
+
+BOOST_AUTO_TEST_CASE(opcodeClasses)
+{
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::ADD), "arithmetic");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::BYTE), "comparison");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::SHA3), "sha3");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::CALLDATALOAD), "environment");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::NUMBER), "block");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::SSTORE), "storage");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::MSTORE8), "memory");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::JUMPCI), "flow");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::PUSHC), "push");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::PUSH32), "push");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::DUP16), "dup");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::SWAP1), "swap");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::LOG4), "log");
+    BOOST_CHECK_EQUAL(opcodeClass(Instruction::DELEGATECALL), "system");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,125 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file QposSignVerifier.cpp
+ * Tests and micro-benchmarks for QPOS block signature verification.
+ */
+
+#include <libqpos/QposSignVerifier.h>
+#include <libdevcore/SHA3.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <test/tools/libtesteth/Options.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace utf = boost::unit_test;
+
+namespace
+{
+struct SignedMiners
+{
+	SignedMiners(unsigned _count, h256 const& _hash)
+	{
+		for (unsigned i = 0; i < _count; ++i)
+		{
+			KeyPair k = KeyPair::create();
+			miners.insert(k.pub());
+			signs.emplace_back(k.pub(), dev::sign(k.secret(), _hash));
+		}
+	}
+
+	set<p2p::NodeID> miners;
+	QposSignList signs;
+};
+
+void benchmark(unsigned _miners)
+{
+	h256 const hash = sha3("qpos block");
+	SignedMiners m(_miners, hash);
+	size_t const quorum = (_miners + 1) / 2;
+	unsigned const rounds = 200;
+
+	Timer t;
+	for (unsigned i = 0; i < rounds; ++i)
+	{
+		size_t valid = 0;
+		for (auto const& s: m.signs)
+			if (dev::verify(s.first, s.second, hash) && ++valid >= quorum)
+				break;
+		BOOST_REQUIRE(valid >= quorum);
+	}
+	double sequential = t.elapsed();
+
+	t.restart();
+	for (unsigned i = 0; i < rounds; ++i)
+		BOOST_REQUIRE(verifyQuorum(m.signs, m.miners, hash, quorum));
+	double batched = t.elapsed();
+
+	cnote << _miners << "miners: sequential" << sequential * 1000000 / rounds << "us/block, verifyQuorum" << batched * 1000000 / rounds << "us/block";
+}
+}
+
+BOOST_FIXTURE_TEST_SUITE(QposSignVerifierTest, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(quorumReached)
+{
+	h256 const hash = sha3("block");
+	SignedMiners m(16, hash);
+	BOOST_CHECK(verifyQuorum(m.signs, m.miners, hash, 8));
+	BOOST_CHECK(verifyQuorum(m.signs, m.miners, hash, 16));
+	BOOST_CHECK(!verifyQuorum(m.signs, m.miners, sha3("other block"), 8));
+}
+
+BOOST_AUTO_TEST_CASE(duplicatesAndStrangersDoNotCount)
+{
+	h256 const hash = sha3("block");
+	SignedMiners m(4, hash);
+	SignedMiners strangers(4, hash);
+
+	QposSignList signs(4, m.signs.front());
+	signs.insert(signs.end(), strangers.signs.begin(), strangers.signs.end());
+	BOOST_CHECK(verifyQuorum(signs, m.miners, hash, 1));
+	BOOST_CHECK(!verifyQuorum(signs, m.miners, hash, 2));
+}
+
+BOOST_AUTO_TEST_CASE(invalidSignaturesAreSkipped)
+{
+	h256 const hash = sha3("block");
+	SignedMiners m(32, hash);
+	for (size_t i = 0; i < m.signs.size(); i += 2)
+		m.signs[i].second = dev::sign(Secret(sha3("wrong key")), hash);
+
+	BOOST_CHECK(verifyQuorum(m.signs, m.miners, hash, 16));
+	BOOST_CHECK(!verifyQuorum(m.signs, m.miners, hash, 17));
+}
+
+BOOST_AUTO_TEST_CASE(PerfVerifyQuorum, *utf::label("perf"))
+{
+	if (!test::Options::get().all)
+	{
+		std::cout << "Skipping test QposSignVerifierTest/PerfVerifyQuorum. Use --all to run it.\n";
+		return;
+	}
+
+	for (unsigned miners: {4, 16, 64})
+		benchmark(miners);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,140 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file asynccommitdb.cpp
+ * Tests that AsyncCommitDB reads through its queue and writes every batch.
+ */
+
+#include <libdevcore/AsyncCommitDB.h>
+#include <libdevcore/InMemoryDB.h>
+#include <libdevcore/OverlayDB.h>
+#include <libdevcore/SHA3.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace dev;
+using namespace dev::db;
+using namespace dev::test;
+
+namespace
+{
+/// In-memory database whose commits wait until it is opened.
+class GatedDB : public InMemoryDB
+{
+public:
+    void commit(std::unique_ptr<WriteBatchFace> _batch) override
+    {
+        {
+            std::unique_lock<Mutex> l(x_gate);
+            m_gateChanged.wait(l, [&]() { return m_open; });
+        }
+        InMemoryDB::commit(std::move(_batch));
+        ++m_commits;
+    }
+    void sync() override { ++m_syncs; }
+
+    void open()
+    {
+        {
+            Guard l(x_gate);
+            m_open = true;
+        }
+        m_gateChanged.notify_all();
+    }
+
+    std::atomic<unsigned> m_commits{0};
+    std::atomic<unsigned> m_syncs{0};
+
+private:
+    Mutex x_gate;
+    std::condition_variable m_gateChanged;
+    bool m_open = false;
+};
+}
+
+BOOST_FIXTURE_TEST_SUITE(AsyncCommitDBTests, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(readsQueuedWrites)
+{
+    auto backing = make_shared<GatedDB>();
+    backing->insert(Slice("old"), Slice("disk"));
+    backing->insert(Slice("gone"), Slice("disk"));
+
+    AsyncCommitDB db(backing, 4, 2);
+    auto batch = db.createWriteBatch();
+    batch->insert(Slice("a"), Slice("1"));
+    batch->insert(Slice("old"), Slice("new"));
+    db.commit(move(batch));
+    batch = db.createWriteBatch();
+    batch->insert(Slice("a"), Slice("2"));
+    batch->kill(Slice("gone"));
+    db.commit(move(batch));
+
+    // nothing has reached the backing database yet
+    BOOST_CHECK_EQUAL(db.queued(), 2u);
+    BOOST_CHECK(!backing->exists(Slice("a")));
+    BOOST_CHECK_EQUAL(db.lookup(Slice("a")), "2");
+    BOOST_CHECK_EQUAL(db.lookup(Slice("old")), "new");
+    BOOST_CHECK(!db.exists(Slice("gone")));
+    BOOST_CHECK_EQUAL(db.lookup(Slice("gone")), "");
+    BOOST_CHECK(backing->exists(Slice("gone")));
+
+    backing->open();
+    db.flush();
+    BOOST_CHECK_EQUAL(db.queued(), 0u);
+    BOOST_CHECK_EQUAL(backing->m_commits, 2u);
+    BOOST_CHECK_EQUAL(backing->m_syncs, 1u);
+    BOOST_CHECK_EQUAL(backing->lookup(Slice("a")), "2");
+    BOOST_CHECK_EQUAL(backing->lookup(Slice("old")), "new");
+    BOOST_CHECK(!backing->exists(Slice("gone")));
+}
+
+BOOST_AUTO_TEST_CASE(writesEverythingWhenDestroyed)
+{
+    auto backing = make_shared<GatedDB>();
+    {
+        AsyncCommitDB db(backing, 1, 0);
+        db.insert(Slice("k0"), Slice("v0"));
+        backing->open();
+        for (unsigned i = 1; i < 50; ++i)
+            db.insert(Slice(toString(i)), Slice("v" + toString(i)));
+        db.kill(Slice("k0"));
+    }
+    BOOST_CHECK_EQUAL(backing->m_commits, 51u);
+    BOOST_CHECK_EQUAL(backing->m_syncs, 0u);
+    BOOST_CHECK(!backing->exists(Slice("k0")));
+    for (unsigned i = 1; i < 50; ++i)
+        BOOST_CHECK_EQUAL(backing->lookup(Slice(toString(i))), "v" + toString(i));
+}
+
+BOOST_AUTO_TEST_CASE(overlayCommitsInBackground)
+{
+    auto store = make_shared<InMemoryStore>();
+    h256 const h = sha3("value");
+    {
+        OverlayDB odb(unique_ptr<DatabaseFace>(new InMemoryDB(store)));
+        odb.enableAsyncCommit(2, 1);
+        string const value = "v";
+        odb.insert(h, &value);
+        odb.commit();
+        BOOST_CHECK_EQUAL(odb.lookup(h), "v");
+    }
+    OverlayDB reopened(unique_ptr<DatabaseFace>(new InMemoryDB(store)));
+    BOOST_CHECK_EQUAL(reopened.lookup(h), "v");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
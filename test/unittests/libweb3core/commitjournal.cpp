@@ -0,0 +1,209 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file commitjournal.cpp
+ * Tests that CommitJournal holds grouped writes back and writes them again after a crash.
+ */
+
+#include <libdevcore/CommitJournal.h>
+#include <libdevcore/InMemoryDB.h>
+#include <libdevcore/TransientDirectory.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <future>
+#include <thread>
+
+using namespace std;
+using namespace dev;
+using namespace dev::db;
+using namespace dev::test;
+
+namespace
+{
+/// Holds every commit until it is released, like a database whose write queue is full.
+class BlockingDB : public InMemoryDB
+{
+public:
+    void commit(std::unique_ptr<WriteBatchFace> _batch) override
+    {
+        committing.set_value();
+        released.wait();
+        InMemoryDB::commit(move(_batch));
+    }
+
+    promise<void> committing;
+    shared_future<void> released;
+};
+}
+
+BOOST_FIXTURE_TEST_SUITE(CommitJournalTests, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(groupIsWrittenWhenItEnds)
+{
+    TransientDirectory dir;
+    auto journal = CommitJournal::open(dir.path() + "/journal");
+    auto blocks = make_shared<InMemoryDB>();
+    auto extras = make_shared<InMemoryDB>();
+    extras->insert(Slice("gone"), Slice("disk"));
+    auto journaledBlocks = journal->attach("blocks", blocks);
+    auto journaledExtras = journal->attach("extras", extras);
+
+    {
+        CommitJournal::Group group(journal.get());
+        auto batch = journaledBlocks->createWriteBatch();
+        batch->insert(Slice("block"), Slice("1"));
+        journaledBlocks->commit(move(batch));
+        {
+            CommitJournal::Group nested(journal.get());
+            journaledExtras->insert(Slice("best"), Slice("1"));
+            journaledExtras->kill(Slice("gone"));
+        }
+
+        // held back, but readable through the journal
+        BOOST_CHECK(!blocks->exists(Slice("block")));
+        BOOST_CHECK(!extras->exists(Slice("best")));
+        BOOST_CHECK(extras->exists(Slice("gone")));
+        BOOST_CHECK_EQUAL(journaledBlocks->lookup(Slice("block")), "1");
+        BOOST_CHECK_EQUAL(journaledExtras->lookup(Slice("best")), "1");
+        BOOST_CHECK(!journaledExtras->exists(Slice("gone")));
+        BOOST_CHECK_EQUAL(journal->records(), 0u);
+    }
+
+    BOOST_CHECK_EQUAL(journal->records(), 1u);
+    BOOST_CHECK_EQUAL(blocks->lookup(Slice("block")), "1");
+    BOOST_CHECK_EQUAL(extras->lookup(Slice("best")), "1");
+    BOOST_CHECK(!extras->exists(Slice("gone")));
+
+    // outside a group every commit is a record of its own
+    journaledBlocks->insert(Slice("block"), Slice("2"));
+    BOOST_CHECK_EQUAL(journal->records(), 2u);
+    BOOST_CHECK_EQUAL(blocks->lookup(Slice("block")), "2");
+}
+
+BOOST_AUTO_TEST_CASE(recordsAreWrittenAgainOnOpen)
+{
+    TransientDirectory dir;
+    string const path = dir.path() + "/journal";
+    {
+        auto journal = CommitJournal::open(path);
+        auto state = journal->attach("state", make_shared<InMemoryDB>());
+        auto extras = journal->attach("extras", make_shared<InMemoryDB>());
+        {
+            CommitJournal::Group group(journal.get());
+            state->insert(Slice("node"), Slice("n1"));
+            extras->insert(Slice("best"), Slice("1"));
+        }
+        {
+            CommitJournal::Group group(journal.get());
+            state->kill(Slice("node"));
+            extras->insert(Slice("best"), Slice("2"));
+        }
+    }
+
+    // a torn record at the end, as left by a crash halfway through writing it
+    {
+        ofstream out(path, ios::binary | ios::app);
+        out.write("\0\0\1\0garbage", 11);
+    }
+
+    // the databases lost everything; the journal brings them back to the last record
+    auto journal = CommitJournal::open(path);
+    BOOST_CHECK_EQUAL(journal->records(), 2u);
+    auto state = make_shared<InMemoryDB>();
+    auto extras = make_shared<InMemoryDB>();
+    auto journaledState = journal->attach("state", state);
+    BOOST_CHECK(!state->exists(Slice("node")));
+    BOOST_CHECK_EQUAL(extras->lookup(Slice("best")), "");
+    auto journaledExtras = journal->attach("extras", extras);
+    BOOST_CHECK_EQUAL(extras->lookup(Slice("best")), "2");
+
+    journaledExtras->insert(Slice("best"), Slice("3"));
+    BOOST_CHECK_EQUAL(journal->records(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(groupsArePerThread)
+{
+    TransientDirectory dir;
+    auto journal = CommitJournal::open(dir.path() + "/journal");
+    auto state = make_shared<InMemoryDB>();
+    auto extras = make_shared<InMemoryDB>();
+    auto journaledState = journal->attach("state", state);
+    auto journaledExtras = journal->attach("extras", extras);
+
+    CommitJournal::Group group(journal.get());
+    journaledExtras->insert(Slice("best"), Slice("1"));
+
+    // another thread's commit is a record of its own, written at once, and sees the group's writes
+    string seen;
+    thread([&]() {
+        journaledState->insert(Slice("node"), Slice("n1"));
+        seen = journaledExtras->lookup(Slice("best"));
+    }).join();
+    BOOST_CHECK_EQUAL(journal->records(), 1u);
+    BOOST_CHECK_EQUAL(state->lookup(Slice("node")), "n1");
+    BOOST_CHECK_EQUAL(seen, "1");
+    BOOST_CHECK(!extras->exists(Slice("best")));
+}
+
+BOOST_AUTO_TEST_CASE(readsDoNotWaitForWrites)
+{
+    TransientDirectory dir;
+    auto journal = CommitJournal::open(dir.path() + "/journal");
+    auto state = make_shared<BlockingDB>();
+    auto extras = make_shared<InMemoryDB>();
+    extras->insert(Slice("best"), Slice("0"));
+    auto journaledState = journal->attach("state", state);
+    auto journaledExtras = journal->attach("extras", extras);
+
+    promise<void> release;
+    state->released = release.get_future().share();
+    thread writer([&]() { journaledState->insert(Slice("node"), Slice("n1")); });
+    state->committing.get_future().wait();
+
+    // the record is synced and being written to the database; both stay readable meanwhile
+    BOOST_CHECK_EQUAL(journaledState->lookup(Slice("node")), "n1");
+    BOOST_CHECK(!state->exists(Slice("node")));
+    BOOST_CHECK_EQUAL(journaledExtras->lookup(Slice("best")), "0");
+
+    release.set_value();
+    writer.join();
+    BOOST_CHECK_EQUAL(state->lookup(Slice("node")), "n1");
+    BOOST_CHECK_EQUAL(journal->records(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(checkpointEmptiesTheJournal)
+{
+    TransientDirectory dir;
+    string const path = dir.path() + "/journal";
+    auto journal = CommitJournal::open(path);
+    auto extras = journal->attach("extras", make_shared<InMemoryDB>());
+    extras->insert(Slice("best"), Slice("1"));
+    BOOST_CHECK_EQUAL(journal->records(), 1u);
+
+    journal->checkpoint();
+    BOOST_CHECK_EQUAL(journal->records(), 0u);
+
+    // nothing is written again to a database attached under the same name
+    journal.reset();
+    extras.reset();
+    auto reopened = CommitJournal::open(path);
+    auto fresh = make_shared<InMemoryDB>();
+    auto journaledFresh = reopened->attach("extras", fresh);
+    BOOST_CHECK(!fresh->exists(Slice("best")));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
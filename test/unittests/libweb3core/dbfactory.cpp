@@ -0,0 +1,137 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file dbfactory.cpp
+ * Tests that every database kind behaves the same behind DBFactory.
+ */
+
+#include <libdevcore/DBFactory.h>
+#include <libdevcore/LevelDB.h>
+#include <libdevcore/TransientDirectory.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace dev;
+using namespace dev::db;
+using namespace dev::test;
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+/// Selects a database kind for the lifetime of the object.
+class KindSetter
+{
+public:
+    explicit KindSetter(DatabaseKind _kind): m_previous(DBFactory::kind()) { DBFactory::setKind(_kind); }
+    ~KindSetter() { DBFactory::setKind(m_previous); }
+
+private:
+    DatabaseKind m_previous;
+};
+
+vector<pair<string, string>> records(DatabaseFace const& _db)
+{
+    vector<pair<string, string>> ret;
+    _db.forEach([&](Slice _key, Slice _value) {
+        ret.emplace_back(_key.toString(), _value.toString());
+        return true;
+    });
+    return ret;
+}
+
+vector<DatabaseKind> const c_kinds = {DatabaseKind::LevelDB, DatabaseKind::MemoryDB};
+}
+
+BOOST_FIXTURE_TEST_SUITE(DBFactoryTests, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(basicUsage)
+{
+    for (auto kind: c_kinds)
+    {
+        TransientDirectory td;
+        KindSetter setter(kind);
+        auto db = DBFactory::create(td.path() / fs::path("basic"));
+
+        BOOST_CHECK(!db->exists(Slice("a")));
+        BOOST_CHECK(db->lookup(Slice("a")).empty());
+        db->insert(Slice("b"), Slice("2"));
+        db->insert(Slice("a"), Slice("1"));
+        BOOST_CHECK(db->exists(Slice("a")));
+        BOOST_CHECK_EQUAL(db->lookup(Slice("a")), "1");
+
+        auto batch = db->createWriteBatch();
+        batch->insert(Slice("c"), Slice("3"));
+        batch->kill(Slice("b"));
+        batch->insert(Slice("a"), Slice("4"));
+        BOOST_CHECK_EQUAL(db->lookup(Slice("c")), "");
+        db->commit(std::move(batch));
+
+        BOOST_CHECK(!db->exists(Slice("b")));
+        BOOST_CHECK(records(*db) == (vector<pair<string, string>>{{"a", "4"}, {"c", "3"}}));
+
+        db->kill(Slice("a"));
+        BOOST_CHECK(records(*db) == (vector<pair<string, string>>{{"c", "3"}}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reopenRenameRemove)
+{
+    for (auto kind: c_kinds)
+    {
+        TransientDirectory td;
+        KindSetter setter(kind);
+        fs::path const extras = td.path() / fs::path("extras");
+        fs::path const old = td.path() / fs::path("extras.old");
+
+        DBFactory::create(extras)->insert(Slice("best"), Slice("1"));
+        BOOST_CHECK_EQUAL(DBFactory::create(extras)->lookup(Slice("best")), "1");
+
+        DBFactory::create(old)->insert(Slice("stale"), Slice("x"));
+        DBFactory::rename(extras, old);
+        BOOST_CHECK(records(*DBFactory::create(old)) == (vector<pair<string, string>>{{"best", "1"}}));
+        BOOST_CHECK(records(*DBFactory::create(extras)).empty());
+
+        DBFactory::remove(old);
+        BOOST_CHECK(records(*DBFactory::create(old)).empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(levelDBCacheStats)
+{
+    TransientDirectory td;
+    DatabaseSettings settings;
+    settings.cacheSize = 1024 * 1024;
+    settings.bloomBitsPerKey = 10;
+
+    // Reopening moves the records from the log into a table file, which reads go through.
+    LevelDB(td.path(), settings).insert(Slice("key"), Slice("value"));
+    LevelDB db(td.path(), settings);
+    BOOST_CHECK_EQUAL(db.cacheStats().capacity, settings.cacheSize);
+    for (unsigned i = 0; i < 4; ++i)
+        BOOST_CHECK_EQUAL(db.lookup(Slice("key")), "value");
+
+    DatabaseCacheStats const stats = db.cacheStats();
+    BOOST_CHECK_GT(stats.hits, 0u);
+    BOOST_CHECK_GT(stats.misses, 0u);
+    BOOST_CHECK_GT(stats.used, 0u);
+    BOOST_CHECK_GT(stats.hitRate(), 0.5);
+
+    BOOST_CHECK_EQUAL(LevelDB(td.path() / fs::path("plain")).cacheStats().capacity, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,227 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file flatstate.cpp
+ * Tests for the flat table of the head state.
+ */
+
+#include <libdevcore/FlatState.h>
+#include <libdevcore/InMemoryDB.h>
+#include <libdevcore/OverlayDB.h>
+#include <libdevcore/TrieDB.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace dev;
+using namespace dev::db;
+using namespace dev::test;
+
+namespace
+{
+string account(unsigned _nonce, h256 const& _storageRoot = EmptyTrie)
+{
+    return asString(rlpList(_nonce, 0, _storageRoot, EmptySHA3));
+}
+
+string flatAccount(FlatState const& _flat, h256 const& _root, h256 const& _account)
+{
+    string ret;
+    BOOST_REQUIRE(_flat.account(_root, _account, ret));
+    return ret;
+}
+
+u256 flatStorage(FlatState const& _flat, h256 const& _root, h256 const& _account, h256 const& _slot)
+{
+    u256 ret;
+    BOOST_REQUIRE(_flat.storage(_root, _account, _slot, ret));
+    return ret;
+}
+}
+
+BOOST_FIXTURE_TEST_SUITE(FlatStateTests, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(rebuildFromTrie)
+{
+    auto store = make_shared<InMemoryStore>();
+    h256 root;
+    {
+        OverlayDB odb(unique_ptr<DatabaseFace>(new InMemoryDB(store)));
+        HashedGenericTrieDB<OverlayDB> storage(&odb);
+        storage.init();
+        storage.insert(h256(1).ref(), asString(rlp(u256(11))));
+        storage.insert(h256(2).ref(), asString(rlp(u256(22))));
+        HashedGenericTrieDB<OverlayDB> state(&odb);
+        state.init();
+        state.insert(h256(10).ref(), account(1, storage.root()));
+        state.insert(h256(20).ref(), account(2));
+        root = state.root();
+        odb.commit();
+    }
+
+    FlatState flat(make_shared<InMemoryDB>(store));
+    BOOST_CHECK(!flat.root());
+    string a;
+    BOOST_CHECK(!flat.account(root, sha3(h256(10)), a));
+
+    flat.advance(root);
+    flat.waitForBuild();
+    BOOST_REQUIRE_EQUAL(flat.root(), root);
+    BOOST_CHECK_EQUAL(flatAccount(flat, root, sha3(h256(20))), account(2));
+    BOOST_CHECK(flatAccount(flat, root, sha3(h256(30))).empty());
+    BOOST_CHECK_EQUAL(flatStorage(flat, root, sha3(h256(10)), sha3(h256(1))), 11);
+    BOOST_CHECK_EQUAL(flatStorage(flat, root, sha3(h256(10)), sha3(h256(2))), 22);
+    BOOST_CHECK_EQUAL(flatStorage(flat, root, sha3(h256(10)), sha3(h256(3))), 0);
+
+    // Reopened at the same root without a rebuild.
+    FlatState reopened(make_shared<InMemoryDB>(store));
+    BOOST_CHECK_EQUAL(reopened.root(), root);
+    BOOST_CHECK_EQUAL(flatAccount(reopened, root, sha3(h256(20))), account(2));
+}
+
+BOOST_AUTO_TEST_CASE(advanceAndReorganise)
+{
+    auto store = make_shared<InMemoryStore>();
+    h256 root0;
+    {
+        OverlayDB odb(unique_ptr<DatabaseFace>(new InMemoryDB(store)));
+        HashedGenericTrieDB<OverlayDB> state(&odb);
+        state.init();
+        root0 = state.root();
+        odb.commit();
+    }
+    FlatState flat(make_shared<InMemoryDB>(store));
+    flat.advance(root0);
+    flat.waitForBuild();
+    BOOST_REQUIRE_EQUAL(flat.root(), root0);
+
+    h256 const a = sha3("a");
+    h256 const s = sha3("slot");
+    h256 const root1(1), root2(2), root3(3);
+
+    FlatState::Changes c1;
+    c1[a].account = account(1);
+    c1[a].slots[s] = 5;
+    flat.record(root0, root1, c1);
+
+    FlatState::Changes c2;
+    c2[a].account = account(2);
+    c2[a].slots[s] = 6;
+    flat.record(root1, root2, c2);
+
+    // A sibling of root2 which wiped the storage.
+    FlatState::Changes c3;
+    c3[a].account = account(3);
+    c3[a].clearedStorage = true;
+    flat.record(root1, root3, c3);
+
+    flat.advance(root2);
+    BOOST_REQUIRE_EQUAL(flat.root(), root2);
+    string ignored;
+    BOOST_CHECK(!flat.account(root1, a, ignored));
+    BOOST_CHECK_EQUAL(flatAccount(flat, root2, a), account(2));
+    BOOST_CHECK_EQUAL(flatStorage(flat, root2, a, s), 6);
+
+    flat.advance(root3);
+    BOOST_REQUIRE_EQUAL(flat.root(), root3);
+    BOOST_CHECK_EQUAL(flatAccount(flat, root3, a), account(3));
+    BOOST_CHECK_EQUAL(flatStorage(flat, root3, a, s), 0);
+
+    // Back to the first branch: the wiped slot comes back.
+    flat.advance(root2);
+    BOOST_REQUIRE_EQUAL(flat.root(), root2);
+    BOOST_CHECK_EQUAL(flatStorage(flat, root2, a, s), 6);
+
+    // Deleting the account.
+    FlatState::Changes c4;
+    c4[a].clearedStorage = true;
+    flat.record(root2, h256(4), c4);
+    flat.advance(h256(4));
+    BOOST_CHECK(flatAccount(flat, h256(4), a).empty());
+    BOOST_CHECK_EQUAL(flatStorage(flat, h256(4), a, s), 0);
+}
+
+BOOST_AUTO_TEST_CASE(sweepKeepsOtherRecords)
+{
+    auto store = make_shared<InMemoryStore>();
+    h256 root1, root2;
+    {
+        OverlayDB odb(unique_ptr<DatabaseFace>(new InMemoryDB(store)));
+        HashedGenericTrieDB<OverlayDB> storage(&odb);
+        storage.init();
+        storage.insert(h256(1).ref(), asString(rlp(u256(11))));
+        HashedGenericTrieDB<OverlayDB> state1(&odb);
+        state1.init();
+        state1.insert(h256(10).ref(), account(1, storage.root()));
+        root1 = state1.root();
+        HashedGenericTrieDB<OverlayDB> state2(&odb);
+        state2.init();
+        state2.insert(h256(10).ref(), account(1, storage.root()));
+        state2.insert(h256(20).ref(), account(2));
+        root2 = state2.root();
+        odb.commit();
+    }
+
+    // Nodes, code and aux entries whose hashes start like the flat records.
+    map<string, string> others;
+    for (byte prefix: {byte(0xfa), byte(0xfb)})
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            h256 h = sha3(to_string(i));
+            h[0] = prefix;
+            others[asString(h.asBytes())] = "node";
+            bytes aux = h.asBytes();
+            aux.push_back(255);
+            others[asString(aux)] = "aux";
+        }
+    for (auto const& o: others)
+        store->records.insert(o);
+
+    FlatState flat(make_shared<InMemoryDB>(store));
+    flat.advance(root1);
+    flat.waitForBuild();
+    BOOST_REQUIRE_EQUAL(flat.root(), root1);
+    // Nothing recorded leads to root2, so this rebuilds and sweeps the first build's records.
+    flat.advance(root2);
+    flat.waitForBuild();
+    BOOST_REQUIRE_EQUAL(flat.root(), root2);
+    BOOST_CHECK_EQUAL(flatAccount(flat, root2, sha3(h256(20))), account(2));
+    BOOST_CHECK_EQUAL(flatStorage(flat, root2, sha3(h256(10)), sha3(h256(1))), 11);
+
+    for (auto const& o: others)
+    {
+        auto it = store->records.find(o.first);
+        BOOST_REQUIRE(it != store->records.end());
+        BOOST_CHECK_EQUAL(it->second, o.second);
+    }
+    unsigned accounts = 0;
+    unsigned slots = 0;
+    for (auto const& r: store->records)
+        if (r.first.size() == 37 && byte(r.first[0]) == 0xfa)
+            ++accounts;
+        else if (r.first.size() == 77 && byte(r.first[0]) == 0xfb)
+            ++slots;
+    BOOST_CHECK_EQUAL(accounts, 2);
+    BOOST_CHECK_EQUAL(slots, 1);
+
+    // The trie is still whole.
+    OverlayDB odb(unique_ptr<DatabaseFace>(new InMemoryDB(store)));
+    HashedGenericTrieDB<OverlayDB> state(&odb);
+    state.setRoot(root2);
+    BOOST_CHECK_EQUAL(state.at(h256(20).ref()), account(2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -21,8 +21,10 @@
  */
 
 #include <libdevcore/DBImpl.h>
+#include <libdevcore/InMemoryDB.h>
 #include <libdevcore/OverlayDB.h>
 #include <libdevcore/TransientDirectory.h>
+#include <libdevcore/TrieDB.h>
 #include <test/tools/libtesteth/TestOutputHelper.h>
 #include <boost/test/unit_test.hpp>
 
@@ -30,6 +32,30 @@ using namespace std;
 using namespace dev;
 using namespace dev::test;
 
+namespace
+{
+/// An OverlayDB over a fresh in-memory database, pruning with @a _history and @a _checkpoints.
+OverlayDB pruningDB(unsigned _history, unsigned _checkpoints = 0)
+{
+    OverlayDB ret(std::unique_ptr<db::DatabaseFace>(new db::InMemoryDB()));
+    ret.enablePruning(_history, _checkpoints);
+    return ret;
+}
+
+/// Settles every block number up to @a _head - history, block n's canonical hash being h256(n).
+void canonicalise(OverlayDB const& _odb, unsigned _head)
+{
+    _odb.pruner()->canonicalise(_head, [](unsigned _n) { return h256(_n); });
+}
+
+bool onDisk(OverlayDB const& _odb, h256 const& _h)
+{
+    OverlayDB reader = _odb;
+    reader.rollback();
+    return reader.exists(_h);
+}
+}
+
 BOOST_FIXTURE_TEST_SUITE(OverlayDBTests, TestOutputHelperFixture)
 
 BOOST_AUTO_TEST_CASE(basicUsage)
@@ -116,4 +142,161 @@ BOOST_AUTO_TEST_CASE(rollback)
     BOOST_CHECK(!odb.get().size());
 }
 
+BOOST_AUTO_TEST_CASE(pruneRemovedNodes)
+{
+    OverlayDB odb = pruningDB(2);
+    string const a = "a", b = "b", c = "c";
+
+    odb.insert(sha3(a), &a);
+    odb.insert(sha3(b), &b);
+    odb.commit(1, h256(1));
+
+    odb.kill(sha3(a));
+    odb.insert(sha3(c), &c);
+    odb.commit(2, h256(2));
+
+    // Block 2 is still within the last two blocks' states.
+    canonicalise(odb, 3);
+    BOOST_CHECK(onDisk(odb, sha3(a)));
+
+    canonicalise(odb, 4);
+    BOOST_CHECK(!onDisk(odb, sha3(a)));
+    BOOST_CHECK(onDisk(odb, sha3(b)));
+    BOOST_CHECK(onDisk(odb, sha3(c)));
+    BOOST_CHECK_EQUAL(odb.pruner()->prunedNodes(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(pruneKeepsReinsertedNodes)
+{
+    OverlayDB odb = pruningDB(1);
+    string const a = "a";
+
+    odb.insert(sha3(a), &a);
+    odb.commit(1, h256(1));
+    odb.kill(sha3(a));
+    odb.commit(2, h256(2));
+    odb.insert(sha3(a), &a);
+    odb.commit(3, h256(3));
+
+    canonicalise(odb, 10);
+    BOOST_CHECK(onDisk(odb, sha3(a)));
+}
+
+BOOST_AUTO_TEST_CASE(pruneUndoesSideBlocks)
+{
+    OverlayDB odb = pruningDB(1);
+    string const a = "a", b = "b", side = "side";
+
+    odb.insert(sha3(a), &a);
+    odb.commit(1, h256(1));
+
+    // A side block at number 2 removes a and adds its own node; the canonical one adds b.
+    OverlayDB sideBlock = odb;
+    sideBlock.kill(sha3(a));
+    sideBlock.insert(sha3(side), &side);
+    sideBlock.commit(2, h256(0xbad));
+    odb.insert(sha3(b), &b);
+    odb.commit(2, h256(2));
+
+    canonicalise(odb, 3);
+    BOOST_CHECK(onDisk(odb, sha3(a)));
+    BOOST_CHECK(onDisk(odb, sha3(b)));
+    BOOST_CHECK(!onDisk(odb, sha3(side)));
+}
+
+BOOST_AUTO_TEST_CASE(pruneIgnoresSettledEras)
+{
+    OverlayDB odb = pruningDB(1);
+    string const a = "a", b = "b", late = "late";
+
+    odb.insert(sha3(a), &a);
+    odb.commit(1, h256(1));
+    odb.commit(2, h256(2));
+    canonicalise(odb, 3);
+    odb.insert(sha3(b), &b);
+    odb.commit(3, h256(3));
+
+    // A side block at the already settled number 2 shares b; it must hold no reference to it.
+    OverlayDB sideBlock = odb;
+    sideBlock.insert(sha3(b), &b);
+    sideBlock.insert(sha3(late), &late);
+    sideBlock.commit(2, h256(0xbad));
+
+    odb.kill(sha3(b));
+    odb.commit(4, h256(4));
+    canonicalise(odb, 10);
+    BOOST_CHECK(!onDisk(odb, sha3(b)));
+    BOOST_CHECK(onDisk(odb, sha3(late)));
+    BOOST_CHECK(onDisk(odb, sha3(a)));
+}
+
+BOOST_AUTO_TEST_CASE(pruneKeepsCheckpoints)
+{
+    OverlayDB odb = pruningDB(1, 2);
+    string const a = "a", b = "b";
+
+    odb.insert(sha3(a), &a);
+    odb.commit(1, h256(1));
+    odb.insert(sha3(b), &b);
+    odb.commit(2, h256(2));
+    odb.kill(sha3(a));
+    odb.kill(sha3(b));
+    odb.commit(3, h256(3));
+
+    // Block 2 is a checkpoint, so what its state had stays.
+    canonicalise(odb, 10);
+    BOOST_CHECK(onDisk(odb, sha3(a)));
+    BOOST_CHECK(onDisk(odb, sha3(b)));
+}
+
+BOOST_AUTO_TEST_CASE(prunedTrieKeepsRecentStates)
+{
+    unsigned const history = 4;
+    unsigned const blocks = 40;
+    OverlayDB odb = pruningDB(history);
+    OverlayDB archive(std::unique_ptr<db::DatabaseFace>(new db::InMemoryDB()));
+
+    std::map<bytes, bytes> contents;
+    vector<pair<h256, std::map<bytes, bytes>>> states;
+    GenericTrieDB<OverlayDB> trie(&odb);
+    GenericTrieDB<OverlayDB> archiveTrie(&archive);
+    trie.init();
+    archiveTrie.init();
+    odb.commit(0, h256(0));
+    archive.commit();
+    for (unsigned n = 1; n <= blocks; ++n)
+    {
+        // Overwrite some keys, add others and now and then remove one.
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            bytes const key = sha3(toString(n * 7 + i)).asBytes();
+            bytes const value = rlp(n * 100 + i);
+            contents[bytes(key.begin(), key.begin() + 1 + i % 3)] = value;
+            trie.insert(bytesConstRef(key.data(), 1 + i % 3), &value);
+            archiveTrie.insert(bytesConstRef(key.data(), 1 + i % 3), &value);
+        }
+        if (n % 3 == 0)
+        {
+            trie.remove(&contents.begin()->first);
+            archiveTrie.remove(&contents.begin()->first);
+            contents.erase(contents.begin());
+        }
+        odb.commit(n, h256(n));
+        archive.commit();
+        canonicalise(odb, n);
+        states.emplace_back(trie.root(), contents);
+    }
+
+    BOOST_CHECK_EQUAL(trie.root(), archiveTrie.root());
+    BOOST_CHECK_GT(odb.pruner()->prunedNodes(), 0u);
+
+    for (unsigned n = blocks - history; n <= blocks; ++n)
+    {
+        auto const& state = states[n - 1];
+        GenericTrieDB<OverlayDB> at(&odb, state.first);
+        for (auto const& i: state.second)
+            BOOST_CHECK(at.at(i.first) == asString(i.second));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
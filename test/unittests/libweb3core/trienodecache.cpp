@@ -0,0 +1,120 @@
+/*
+    This file is part of cpp-ethereum.
+
+    cpp-ethereum is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    cpp-ethereum is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file trienodecache.cpp
+ * Tests for the trie node cache shared by state databases.
+ */
+
+#include <libdevcore/TrieNodeCache.h>
+#include <libdevcore/InMemoryDB.h>
+#include <libdevcore/OverlayDB.h>
+#include <libdevcore/SHA3.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+
+using namespace std;
+using namespace dev;
+using namespace dev::db;
+using namespace dev::test;
+
+BOOST_FIXTURE_TEST_SUITE(TrieNodeCacheTests, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(evictsLeastRecentlyUsed)
+{
+    // Hashes with the same first byte share a shard of 1/16th of the capacity.
+    TrieNodeCache cache(16 * 1000);
+    string const node(400, 'n');
+    h256 a(1), b(2), c(3);
+    a[0] = b[0] = c[0] = 7;
+
+    cache.insert(a, node);
+    cache.insert(b, node);
+    BOOST_CHECK_EQUAL(cache.lookup(a), node);
+    cache.insert(c, node);
+
+    BOOST_CHECK_EQUAL(cache.lookup(a), node);
+    BOOST_CHECK(cache.lookup(b).empty());
+    BOOST_CHECK_EQUAL(cache.lookup(c), node);
+
+    auto const stats = cache.stats();
+    BOOST_CHECK_EQUAL(stats.hits, 3u);
+    BOOST_CHECK_EQUAL(stats.misses, 1u);
+    BOOST_CHECK_LE(stats.used, stats.capacity);
+
+    cache.setCapacity(0);
+    BOOST_CHECK(cache.lookup(a).empty());
+    cache.insert(a, node);
+    BOOST_CHECK(cache.lookup(a).empty());
+    BOOST_CHECK_EQUAL(cache.stats().used, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(sharedAcrossOverlays)
+{
+    TrieNodeCache cache(1024 * 1024);
+    auto store = make_shared<InMemoryStore>();
+    string const value = "node";
+    h256 const h = sha3(value);
+    {
+        OverlayDB odb(unique_ptr<DatabaseFace>(new InMemoryDB(store)));
+        odb.insert(h, &value);
+        odb.commit();
+    }
+
+    OverlayDB first(unique_ptr<DatabaseFace>(new InMemoryDB(store)));
+    first.enableNodeCache(cache);
+    BOOST_CHECK_EQUAL(first.lookup(h), value);
+
+    // Read by another overlay without going to its database.
+    store->records.clear();
+    OverlayDB second(unique_ptr<DatabaseFace>(new InMemoryDB(store)));
+    second.enableNodeCache(cache);
+    BOOST_CHECK_EQUAL(second.lookup(h), value);
+    BOOST_CHECK_EQUAL(cache.stats().hits, 1u);
+
+    // Missing nodes are not cached.
+    BOOST_CHECK(second.lookup(h256(5)).empty());
+    BOOST_CHECK(cache.lookup(h256(5)).empty());
+}
+
+BOOST_AUTO_TEST_CASE(concurrentUse)
+{
+    TrieNodeCache cache(64 * 1024);
+    atomic<unsigned> wrong{0};
+    vector<thread> threads;
+    for (unsigned t = 0; t < 4; ++t)
+        threads.emplace_back([&cache, &wrong, t]() {
+            for (unsigned i = 0; i < 2000; ++i)
+            {
+                string const node = toString((i * 7 + t) % 500);
+                h256 const h = sha3(node);
+                string const found = cache.lookup(h);
+                if (found.empty())
+                    cache.insert(h, node);
+                else if (found != node)
+                    ++wrong;
+            }
+        });
+    for (auto& t: threads)
+        t.join();
+    BOOST_CHECK_EQUAL(wrong, 0u);
+    auto const stats = cache.stats();
+    BOOST_CHECK_EQUAL(stats.hits + stats.misses, 8000u);
+    BOOST_CHECK_LE(stats.used, stats.capacity);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
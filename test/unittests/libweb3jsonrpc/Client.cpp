@@ -29,9 +29,12 @@
 #include <libweb3jsonrpc/Eth.h>
 #include <libdevcore/TransientDirectory.h>
 #include <libdevcore/FileSystem.h>
+#include <libethcore/CommonJS.h>
 #include <libethcore/KeyManager.h>
+#include <libethereum/Transaction.h>
 #include <libwebthree/WebThree.h>
 #include <libp2p/Network.h>
+#include <test/tools/libtesteth/TestHelper.h>
 #include <test/tools/libtesteth/TestOutputHelper.h>
 
 // This is defined by some weird windows header - workaround for now.
@@ -132,6 +135,41 @@ BOOST_AUTO_TEST_CASE(Personal)
     BOOST_CHECK_EQUAL(sendingShouldFail(), "Transaction rejected by user.");
 }
 
+BOOST_AUTO_TEST_CASE(SendRawTransactions)
+{
+    TransientDirectory tempDir;
+    setDataDir(tempDir.path());
+
+    dev::WebThreeDirect web3(WebThreeDirect::composeClientVersion("eth"), getDataDir(), string(),
+        ChainParams(), WithExisting::Kill, set<string>{"eth"}, p2p::NetworkPreferences(0));
+    web3.stopNetwork();
+    web3.ethereum()->stopSealing();
+
+    FixedAccountHolder accountHolder([&](){ return web3.ethereum(); }, vector<KeyPair>());
+    rpc::Eth eth(*web3.ethereum(), accountHolder);
+
+    Address const dest("0x095e7baea6a6c7c4c2dfeb977efac326af552d87");
+    Transaction const good(0, 20 * szabo, 25000, dest, bytes(), 0, Secret(sha3("sender")));
+
+    bytes const goodRlp = good.rlp();
+    bytes const badSignature = withUnrecoverableSignature(good);
+
+    Json::Value rlps(Json::arrayValue);
+    rlps.append(toJS(goodRlp));
+    rlps.append(toJS(badSignature));
+    rlps.append("0xzz");
+    Json::Value const results = eth.eth_sendRawTransactions(rlps);
+    BOOST_REQUIRE_EQUAL(results.size(), 3u);
+    BOOST_CHECK_EQUAL(results[0]["hash"].asString(), toJS(good.sha3()));
+    BOOST_CHECK_EQUAL(results[0]["result"].asString(), "Success");
+    for (unsigned i: {1, 2})
+    {
+        BOOST_CHECK(results[i]["hash"].isNull());
+        BOOST_CHECK_EQUAL(results[i]["result"].asString(), "Malformed");
+    }
+    BOOST_CHECK_EQUAL(web3.ethereum()->transactionQueueStatus().current, 1u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -0,0 +1,69 @@
+{
+	let r := 0
+	for { let i := 0 } lt(i, 1048576) { i := add(i, 1) } {
+
+		0xfe7fb0d1f59dfe9492ffbf73683fd1e870eec79504c60144cc7f5fc2bad1e611
+		0xf5470b43c6549b016288e9a65629687dc75a95db0bc7ec6b1c8af11df6a1da97
+		0xf5470b43c6549b016288e9a65629687dc75a95db0bc7ec6b1c8af11df6a1da97
+
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		pop
+		dup1
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		pop
+		dup1
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		pop
+		dup1
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		pop
+		dup1
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		pop
+		dup1
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		pop
+		dup1
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		pop
+		dup1
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+		dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod dup3 swap1 dup3 addmod
+
+		=: r
+		pop
+		pop
+	}
+	switch r
+	case 0x61bcb260d1be61ce5b1b8cd534c2d1d32e177a3b7be69ed01d4406d1b3a122f7 {
+		stop
+	}
+	default {
+		0
+		0
+		revert
+	}
+}
@@ -40,7 +40,8 @@ N = 0
 for test in tests:
 	sys.stdout.write(test)
 	if test in ['nop', 'pop', 'add64', 'add128', 'add256', 'sub64', 'sub128', 'sub256',
-	            'mul64', 'mul128', 'mul256', 'div64', 'div128', 'div256']:
+	            'mul64', 'mul128', 'mul256', 'div64', 'div128', 'div256',
+	            'sdiv', 'smod', 'addmod', 'mulmod']:
 		N = N_ops
 	else:
 		N = N_app
@@ -19,7 +19,7 @@ for line in sys.stdin:
 	seconds = [second for second in line.rstrip().split(', ')]
 	test = seconds.pop(0)
 	if test not in ['nop', 'pop', 'add64', 'add128', 'add256', 'sub64', 'sub128', 'sub256',
-	                'mul64', 'mul128', 'mul256', 'div64', 'div128', 'div256']:
+	                'mul64', 'mul128', 'mul256', 'div64', 'div128', 'div256', 'sdiv']:
 		continue
 	if test not in tests:
 		tests += [test]
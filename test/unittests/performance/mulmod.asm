@@ -0,0 +1,69 @@
+{
+	let r := 0
+	for { let i := 0 } lt(i, 1048576) { i := add(i, 1) } {
+
+		0xfe7fb0d1f59dfe9492ffbf73683fd1e870eec79504c60144cc7f5fc2bad1e611
+		0xa1f5aac137876480252e5dcac62c354ec0d42b76b0642b6181ed099849ea1d57
+		0xa1f5aac137876480252e5dcac62c354ec0d42b76b0642b6181ed099849ea1d57
+
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		pop
+		dup1
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		pop
+		dup1
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		pop
+		dup1
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		pop
+		dup1
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		pop
+		dup1
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		pop
+		dup1
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		pop
+		dup1
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+		dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod dup3 swap1 dup3 mulmod
+
+		=: r
+		pop
+		pop
+	}
+	switch r
+	case 0x3828ace0d85b7c972abe0a07aa9b33025873638e38d5b8f65710ddf9976203d2 {
+		stop
+	}
+	default {
+		0
+		0
+		revert
+	}
+}
@@ -0,0 +1,69 @@
+{
+	let r := 0
+	for { let i := 0 } lt(i, 1048576) { i := add(i, 1) } {
+
+		0xffffffffffffffffffffffffffffffff00c06feb0df24d651fb50d3d2d9a21e9
+		0x80d7f5e3c8e0b6c4a2d5ff3f28d1e7aa91f8c2e6d4b3a1c5e7f9d8b6a4c2e0f1
+		0xffffffffffffffffffffffffffffffff00c06feb0df24d651fb50d3d2d9a21e9
+
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop
+		dup2
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop
+		dup2
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop
+		dup2
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop
+		dup2
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop
+		dup2
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop
+		dup2
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop
+		dup2
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+		pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod pop dup2 dup2 smod
+
+		=: r
+		pop
+		pop
+	}
+	switch r
+	case 0xffffffffffffffffffffffffffffffff22a64b69763e385dc60fbbd862bdc2aa {
+		stop
+	}
+	default {
+		0
+		0
+		revert
+	}
+}
@@ -0,0 +1,11 @@
+{
+	let r := 0
+	for { let i := 0 } lt(i, 65536) { i := add(i, 1) } {
+
+		let k := and(i, 255)
+		sstore(k, add(sload(k), i))
+		r := add(r, sload(and(add(i, 1), 255)))
+	}
+	mstore(0, r)
+	return(0, 32)
+}
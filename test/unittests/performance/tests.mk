@@ -34,6 +34,16 @@ ifdef PARITY
 	PARITY_ = $(call STATS,parity) $(PARITY) stats --gas 10000000000 --code `cat $*.bin`; touch $*.ran
 endif
 
+# ethvm with the legacy VM, and with the interpreter metering gas and stack per
+# instruction and per basic block
+ifdef ETHVM
+	METERING_ = \
+		echo "metering: $* legacy"; $(STATS) $(ETHVM) --vm legacy $*.bin test; \
+		echo "metering: $* instruction"; $(STATS) $(ETHVM) --vm interpreter --evmc metering=instruction $*.bin test; \
+		echo "metering: $* block"; $(STATS) $(ETHVM) --vm interpreter --evmc metering=block $*.bin test; \
+		touch $*.metered
+endif
+
 # Macs ignore or reject --format parameter
 #STATS = time --format "stats: $(1) $* %U %M"
 STATS = time -p
@@ -50,6 +60,10 @@ STATS = time -p
 	$(call EVM_)
 	$(call PARITY_)
 
+# .metered files mark a program run once under each kind of metering
+%.metered : %.bin
+	$(call METERING_)
+
 %.ran : %.c
 	gcc -O0 -S $*.c
 	gcc -o $* $*.s
@@ -75,6 +89,8 @@ all : ops programs
 #   * t(pop) = user time for pop can be much less than big arithmetic OPs
 #   * (t(OP) - (t(pop) + t(nop))/2)/N = estimated time per OP, less all overhead
 # for all tests except exp N = 2**27, for exp N=2**17 and the last formula gets trickier
+#   * smod, addmod and mulmod run each OP with three more stack OPs instead of one, so the
+#     overhead to subtract is larger
 ops : \
 	nop.ran \
 	pop.ran \
@@ -90,6 +106,10 @@ ops : \
 	div64.ran \
 	div128.ran \
 	div256.ran \
+	sdiv.ran \
+	smod.ran \
+	addmod.ran \
+	mulmod.ran \
 	exp.ran
 
 # C versions for comparison
@@ -106,8 +126,18 @@ programs : \
 	mix.ran \
 	rng.ran
 
+# arithmetic- and storage-heavy programs for comparing gas metering
+#
+#     make -f tests.mk SOLC=solc ETHVM=ethvm metering
+metering : \
+	add256.metered \
+	mul256.metered \
+	div256.metered \
+	mix.metered \
+	storage.metered
+
 clean :
-	rm *.ran *.bin *.evm *.s mul64c poplnkc popincc
+	rm *.ran *.metered *.bin *.evm *.s mul64c poplnkc popincc
 	
 rerun :
 	rm *.ran